@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <MonitorSolver.h>
+
+#ifndef MONITOR_FOLDER
+#  error Please define MONITOR_FOLDER.
+#endif
+
+#define EXPECT_TRUE(pred) if (!(pred)) { throw std::runtime_error(#pred); }
+
+/// A line of an event log, as written by a monitor with bWriteEventLog.
+struct Command {
+  enum Type { Event, Remove, Solve } type;
+  std::string argument;
+};
+
+struct Options {
+  std::string rules_file = MONITOR_FOLDER "/uncontrolled-intersection.cl";
+  std::string geometry_file;
+  std::string events_file;
+  size_t vehicles = 200u;
+  size_t concurrent_vehicles = 6u;
+  FMonitorSolver::FSettings settings;
+};
+
+static std::string Load(const std::string &filename) {
+  std::ifstream file(filename);
+  EXPECT_TRUE(file.good());
+  return std::string{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+static std::vector<Command> ParseEventLog(const std::string &log) {
+  std::vector<Command> commands;
+  std::istringstream stream(log);
+  std::string line;
+  while (std::getline(stream, line)) {
+    line.erase(line.find_last_not_of(" \t\r") + 1u);
+    if (line == "%solve") {
+      commands.push_back({Command::Solve, ""});
+    } else if (line.compare(0u, 8u, "%remove ") == 0) {
+      commands.push_back({Command::Remove, line.substr(8u)});
+    } else if (!line.empty() && (line[0u] != '%')) {
+      commands.push_back({Command::Event, line});
+    }
+  }
+  return commands;
+}
+
+/// Four-way intersection with a left, straight and right lane per fork.
+static std::string MakeGeometry() {
+  const char *turns[] = {"right", "straight", "left"};
+  const char *signals[] = {"right", "off", "left"};
+  std::ostringstream geometry;
+  for (auto fork = 0u; fork < 4u; ++fork) {
+    geometry << "isOnRightOf(f_" << (fork + 3u) % 4u << ", f_" << fork << ").\n";
+    for (auto turn = 0u; turn < 3u; ++turn) {
+      geometry << "laneFromTo(l_" << fork << "_" << turns[turn] << ", f_" << fork << ", e_" << (fork + 3u - turn) % 4u << ").\n";
+      geometry << "laneCorrectSignal(l_" << fork << "_" << turns[turn] << ", " << signals[turn] << ").\n";
+    }
+  }
+  for (auto fork0 = 0u; fork0 < 4u; ++fork0) {
+    for (auto turn0 = 0u; turn0 < 3u; ++turn0) {
+      for (auto fork1 = 0u; fork1 < 4u; ++fork1) {
+        for (auto turn1 = 0u; turn1 < 3u; ++turn1) {
+          const bool same_exit = (fork0 + 3u - turn0) % 4u == (fork1 + 3u - turn1) % 4u;
+          const bool crossing = (fork0 != fork1) && (turn0 != 0u) && (turn1 != 0u);
+          if (((fork0 == fork1) && (turn0 == turn1)) || same_exit || crossing) {
+            geometry << "overlaps(l_" << fork0 << "_" << turns[turn0] << ", l_" << fork1 << "_" << turns[turn1] << ").\n";
+          }
+        }
+      }
+    }
+  }
+  return geometry.str();
+}
+
+/// Vehicles arriving at random forks, each one going through the events the
+/// monitor reports, a few steps forward every time step.
+static std::vector<Command> MakeEventLog(const Options &options) {
+  const char *turns[] = {"right", "straight", "left"};
+  const char *signals[] = {"right", "off", "left"};
+  struct Vehicle {
+    std::string name;
+    unsigned fork;
+    unsigned turn;
+    unsigned stage;
+  };
+  std::mt19937_64 rng(42u);
+  std::bernoulli_distribution coin(0.5);
+  std::vector<Command> commands;
+  std::vector<Vehicle> vehicles;
+  size_t spawned = 0u;
+  for (auto time = 0u; (spawned < options.vehicles) || !vehicles.empty(); ++time) {
+    const auto t = std::to_string(time);
+    if ((spawned < options.vehicles) && (vehicles.size() < options.concurrent_vehicles) && coin(rng)) {
+      vehicles.push_back({"v_" + std::to_string(spawned++), static_cast<unsigned>(rng() % 4u), static_cast<unsigned>(rng() % 3u), 0u});
+    }
+    for (auto &vehicle : vehicles) {
+      const auto fork = "f_" + std::to_string(vehicle.fork);
+      const auto lane = "l_" + std::to_string(vehicle.fork) + "_" + turns[vehicle.turn];
+      const auto exit = "e_" + std::to_string((vehicle.fork + 3u - vehicle.turn) % 4u);
+      if ((vehicle.stage > 0u) && !coin(rng)) {
+        continue;
+      }
+      switch (vehicle.stage++) {
+        case 0u:
+          commands.push_back({Command::Event, "arrivedAtForkAtTime(" + vehicle.name + ", " + fork + ", " + t + ")."});
+          commands.push_back({Command::Event, "signaledAtForkAtTime(" + vehicle.name + ", " + signals[vehicle.turn] + ", " + fork + ", " + t + ")."});
+          break;
+        case 1u:
+          commands.push_back({Command::Event, "enteredForkAtTime(" + vehicle.name + ", " + fork + ", " + t + ")."});
+          break;
+        case 2u:
+          commands.push_back({Command::Event, "enteredLaneAtTime(" + vehicle.name + ", " + lane + ", " + t + ")."});
+          break;
+        case 3u:
+          commands.push_back({Command::Event, "leftLaneAtTime(" + vehicle.name + ", " + lane + ", " + t + ")."});
+          break;
+        default:
+          commands.push_back({Command::Event, "exitedFromAtTime(" + vehicle.name + ", " + exit + ", " + t + ")."});
+          break;
+      }
+      commands.push_back({Command::Solve, ""});
+    }
+    for (auto it = vehicles.begin(); it != vehicles.end();) {
+      if (it->stage > 4u) {
+        commands.push_back({Command::Remove, it->name});
+        it = vehicles.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  return commands;
+}
+
+struct Run {
+  std::vector<double> latencies; // microseconds.
+  std::vector<std::vector<std::string>> models;
+  double setup = 0.0;            // microseconds.
+  FMonitorSolver::FStatistics statistics;
+};
+
+static double ElapsedMicroseconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+static Run Replay(
+    const std::string &geometry,
+    const std::string &rules,
+    const std::vector<Command> &commands,
+    const FMonitorSolver::FSettings &settings) {
+  Run run;
+  auto start = std::chrono::steady_clock::now();
+  FMonitorSolver solver(geometry, rules, settings);
+  run.setup = ElapsedMicroseconds(start);
+  for (auto &&command : commands) {
+    switch (command.type) {
+      case Command::Event:
+        EXPECT_TRUE(solver.AddEvent(command.argument));
+        break;
+      case Command::Remove:
+        solver.RemoveVehicle(command.argument);
+        break;
+      case Command::Solve: {
+        start = std::chrono::steady_clock::now();
+        auto result = solver.Solve();
+        run.latencies.push_back(ElapsedMicroseconds(start));
+        std::vector<std::string> model;
+        for (auto &&atom : result.Model) {
+          model.push_back(atom.Text);
+        }
+        std::sort(model.begin(), model.end());
+        run.models.push_back(std::move(model));
+        break;
+      }
+    }
+  }
+  run.statistics = solver.GetStatistics();
+  return run;
+}
+
+static void Report(const char *name, Run run) {
+  auto &latencies = run.latencies;
+  EXPECT_TRUE(!latencies.empty());
+  std::sort(latencies.begin(), latencies.end());
+  double total = 0.0;
+  for (auto latency : latencies) {
+    total += latency;
+  }
+  auto percentile = [&](double p) {
+    return latencies[static_cast<size_t>(p * static_cast<double>(latencies.size() - 1u))];
+  };
+  std::cout << name << ": " << latencies.size() << " solves"
+            << ", setup " << run.setup / 1000.0 << " ms"
+            << ", mean " << total / static_cast<double>(latencies.size()) << " us"
+            << ", median " << percentile(0.5) << " us"
+            << ", p99 " << percentile(0.99) << " us"
+            << ", max " << latencies.back() << " us"
+            << ", total " << total / 1000.0 << " ms"
+            << ", fallbacks " << run.statistics.Fallbacks
+            << ", pruned " << run.statistics.PrunedVehicles << '\n';
+}
+
+static Options ParseArguments(int argc, const char *argv[]) {
+  Options options;
+  std::vector<std::string> files;
+  for (auto i = 1; i < argc; ++i) {
+    const std::string argument = argv[i];
+    const auto value = argument.substr(argument.find('=') + 1u);
+    if (argument.compare(0u, 11u, "--vehicles=") == 0) {
+      options.vehicles = std::stoul(value);
+    } else if (argument.compare(0u, 13u, "--concurrent=") == 0) {
+      options.concurrent_vehicles = std::stoul(value);
+    } else if (argument.compare(0u, 15u, "--max-vehicles=") == 0) {
+      options.settings.MaxVehicles = std::stoul(value);
+    } else if (argument.compare(0u, 17u, "--max-time-steps=") == 0) {
+      options.settings.MaxTimeSteps = std::stoul(value);
+    } else if (argument.compare(0u, 10u, "--horizon=") == 0) {
+      options.settings.EventHorizon = std::stoi(value);
+    } else {
+      files.push_back(argument);
+    }
+  }
+  EXPECT_TRUE(files.empty() || (files.size() == 3u));
+  if (files.size() == 3u) {
+    options.rules_file = files[0u];
+    options.geometry_file = files[1u];
+    options.events_file = files[2u];
+  }
+  return options;
+}
+
+int main(int argc, const char *argv[]) {
+  try {
+
+    const auto options = ParseArguments(argc, argv);
+    const auto rules = Load(options.rules_file);
+    const auto geometry = options.geometry_file.empty() ? MakeGeometry() : Load(options.geometry_file);
+    const auto commands = options.events_file.empty() ?
+        MakeEventLog(options) :
+        ParseEventLog(Load(options.events_file));
+
+    auto settings = options.settings;
+    settings.Mode = FMonitorSolver::EMode::FromScratch;
+    auto from_scratch = Replay(geometry, rules, commands, settings);
+    settings.Mode = FMonitorSolver::EMode::Incremental;
+    auto incremental = Replay(geometry, rules, commands, settings);
+
+    size_t mismatches = 0u;
+    for (auto i = 0u; i < from_scratch.models.size(); ++i) {
+      if (from_scratch.models[i] != incremental.models[i]) {
+        ++mismatches;
+      }
+    }
+
+    Report("from scratch", std::move(from_scratch));
+    Report("incremental ", std::move(incremental));
+    std::cout << "models differ in " << mismatches << " solves\n";
+    return mismatches == 0u ? EXIT_SUCCESS : EXIT_FAILURE;
+
+  } catch (const std::exception &e) {
+    std::cerr << "\nException: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
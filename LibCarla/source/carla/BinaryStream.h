@@ -0,0 +1,177 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace carla {
+
+  /// FNV-1a hash.
+  inline uint64_t ComputeFnv1aHash(const unsigned char *data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0u; i < size; ++i) {
+      hash ^= data[i];
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  // ===========================================================================
+  // -- BinaryWriter -----------------------------------------------------------
+  // ===========================================================================
+
+  class BinaryWriter {
+  public:
+
+    template <typename T>
+    void Write(const T &value) {
+      static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Not a plain type.");
+      const auto *begin = reinterpret_cast<const unsigned char *>(&value);
+      _buffer.insert(_buffer.end(), begin, begin + sizeof(T));
+    }
+
+    void Write(bool value) {
+      Write(static_cast<uint8_t>(value ? 1u : 0u));
+    }
+
+    void Write(const std::string &str) {
+      WriteCount(str.size());
+      _buffer.insert(_buffer.end(), str.begin(), str.end());
+    }
+
+    void WriteCount(size_t count) {
+      DEBUG_ASSERT(count <= std::numeric_limits<uint32_t>::max());
+      Write(static_cast<uint32_t>(count));
+    }
+
+    /// Write the elements of @a values one after the other, the count is
+    /// written separately.
+    template <typename T>
+    void WriteArray(const std::vector<T> &values) {
+      static_assert(std::is_trivially_copyable<T>::value, "Not a plain type.");
+      const auto *begin = reinterpret_cast<const unsigned char *>(values.data());
+      _buffer.insert(_buffer.end(), begin, begin + values.size() * sizeof(T));
+    }
+
+    /// Overwrite the value previously written at @a offset.
+    template <typename T>
+    void Patch(size_t offset, const T &value) {
+      DEBUG_ASSERT(offset + sizeof(T) <= _buffer.size());
+      std::memcpy(_buffer.data() + offset, &value, sizeof(T));
+    }
+
+    size_t size() const {
+      return _buffer.size();
+    }
+
+    std::vector<unsigned char> &buffer() {
+      return _buffer;
+    }
+
+  private:
+
+    std::vector<unsigned char> _buffer;
+  };
+
+  // ===========================================================================
+  // -- BinaryReader -----------------------------------------------------------
+  // ===========================================================================
+
+  /// Reads values from a block of memory. Instead of reading past the end,
+  /// the reader is flagged as failed and returns default values, so the
+  /// caller only needs to check Failed() once at the end.
+  class BinaryReader {
+  public:
+
+    BinaryReader(const unsigned char *data, size_t size)
+      : _it(data),
+        _end(data + size) {}
+
+    template <typename T>
+    T Read() {
+      static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Not a plain type.");
+      T value{};
+      if (Remaining() < sizeof(T)) {
+        Fail();
+      } else {
+        std::memcpy(&value, _it, sizeof(T));
+        _it += sizeof(T);
+      }
+      return value;
+    }
+
+    bool ReadBool() {
+      return Read<uint8_t>() != 0u;
+    }
+
+    std::string ReadString() {
+      const auto size = ReadCount();
+      std::string result(reinterpret_cast<const char *>(_it), size);
+      _it += size;
+      return result;
+    }
+
+    /// Read the number of elements of a container. Every element takes at
+    /// least one byte, so a count greater than the remaining bytes can only
+    /// come from corrupted data.
+    uint32_t ReadCount() {
+      const auto count = Read<uint32_t>();
+      if (count > Remaining()) {
+        Fail();
+        return 0u;
+      }
+      return count;
+    }
+
+    /// Append @a count elements written with BinaryWriter::WriteArray to
+    /// @a values.
+    template <typename T>
+    void ReadArray(const size_t count, std::vector<T> &values) {
+      static_assert(std::is_trivially_copyable<T>::value, "Not a plain type.");
+      if (count > Remaining() / sizeof(T)) {
+        Fail();
+        return;
+      }
+      if (count == 0u) {
+        return;
+      }
+      const auto size = values.size();
+      values.resize(size + count);
+      std::memcpy(values.data() + size, _it, count * sizeof(T));
+      _it += count * sizeof(T);
+    }
+
+    void Fail() {
+      _failed = true;
+      _it = _end;
+    }
+
+    bool Failed() const {
+      return _failed;
+    }
+
+    size_t Remaining() const {
+      return static_cast<size_t>(_end - _it);
+    }
+
+  private:
+
+    const unsigned char *_it;
+
+    const unsigned char *_end;
+
+    bool _failed = false;
+  };
+
+} // namespace carla
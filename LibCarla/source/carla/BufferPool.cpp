@@ -0,0 +1,169 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/BufferPool.h"
+
+#include "carla/Debug.h"
+
+namespace carla {
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  static std::atomic_size_t DEFAULT_MAX_BYTES_HELD{std::numeric_limits<size_t>::max()};
+
+  static std::atomic_size_t GLOBAL_ALLOCATIONS{0u};
+  static std::atomic_size_t GLOBAL_REUSES{0u};
+  static std::atomic_size_t GLOBAL_RELEASES{0u};
+  static std::atomic_size_t GLOBAL_BUFFERS_HELD{0u};
+  static std::atomic_size_t GLOBAL_BYTES_HELD{0u};
+
+  /// Index of the most significant bit, @a value must be greater than zero.
+  static size_t FloorLog2(size_t value) {
+    DEBUG_ASSERT(value > 0u);
+    size_t result = 0u;
+    while (value >>= 1u) {
+      ++result;
+    }
+    return result;
+  }
+
+  /// Smallest size class whose buffers can hold @a size bytes.
+  static size_t CeilLog2(size_t size) {
+    return size <= 1u ? 0u : FloorLog2(size - 1u) + 1u;
+  }
+
+  // ===========================================================================
+  // -- BufferPool -------------------------------------------------------------
+  // ===========================================================================
+
+  constexpr size_t BufferPool::NUMBER_OF_SIZE_CLASSES;
+
+  BufferPool::BufferPool()
+    : _max_bytes_held(DEFAULT_MAX_BYTES_HELD.load()) {}
+
+  BufferPool::~BufferPool() {
+    // The buffers still in the queues are deleted after this, they no longer
+    // find their way back to this pool.
+    GLOBAL_BUFFERS_HELD -= _buffers_held;
+    GLOBAL_BYTES_HELD -= _bytes_held;
+  }
+
+  Buffer BufferPool::Pop() {
+    Buffer item;
+    if (TryPop(_last_size_class, item)) {
+      ++_reuses;
+      ++GLOBAL_REUSES;
+    } else {
+      ++_allocations;
+      ++GLOBAL_ALLOCATIONS;
+    }
+    return Adopt(std::move(item));
+  }
+
+  Buffer BufferPool::Pop(const size_t size) {
+    const auto size_class = CeilLog2(size);
+    Buffer item;
+    if ((size_class < NUMBER_OF_SIZE_CLASSES) && TryPop(size_class, item)) {
+      ++_reuses;
+      ++GLOBAL_REUSES;
+    } else {
+      ++_allocations;
+      ++GLOBAL_ALLOCATIONS;
+      if (size_class < NUMBER_OF_SIZE_CLASSES) {
+        item.reset(static_cast<Buffer::size_type>(size_t(1u) << size_class));
+      } else {
+        item.reset(static_cast<uint64_t>(size));
+      }
+    }
+    DEBUG_ASSERT(item.capacity() >= size);
+    item.reset(static_cast<Buffer::size_type>(size));
+    return Adopt(std::move(item));
+  }
+
+  void BufferPool::Shrink(const size_t bytes) {
+    for (auto i = NUMBER_OF_SIZE_CLASSES; (i > 0u) && (_bytes_held > bytes); --i) {
+      Buffer item;
+      while ((_bytes_held > bytes) && TryPop(i - 1u, item)) {
+        // Clear it so it does not return to the pool.
+        item.clear();
+        ++_releases;
+        ++GLOBAL_RELEASES;
+      }
+    }
+  }
+
+  BufferPoolStatistics BufferPool::GetStatistics() const {
+    BufferPoolStatistics result;
+    result.allocations = _allocations;
+    result.reuses = _reuses;
+    result.releases = _releases;
+    result.buffers_held = _buffers_held;
+    result.bytes_held = _bytes_held;
+    return result;
+  }
+
+  BufferPoolStatistics BufferPool::GetGlobalStatistics() {
+    BufferPoolStatistics result;
+    result.allocations = GLOBAL_ALLOCATIONS;
+    result.reuses = GLOBAL_REUSES;
+    result.releases = GLOBAL_RELEASES;
+    result.buffers_held = GLOBAL_BUFFERS_HELD;
+    result.bytes_held = GLOBAL_BYTES_HELD;
+    return result;
+  }
+
+  void BufferPool::SetDefaultMaxBytesHeld(const size_t bytes) {
+    DEFAULT_MAX_BYTES_HELD = bytes;
+  }
+
+  size_t BufferPool::GetDefaultMaxBytesHeld() {
+    return DEFAULT_MAX_BYTES_HELD;
+  }
+
+  void BufferPool::Push(Buffer &&buffer) {
+    const size_t capacity = buffer.capacity();
+    DEBUG_ASSERT(capacity > 0u);
+    if (_bytes_held + capacity > _max_bytes_held) {
+      // Not moved, the memory is deleted with the buffer.
+      ++_releases;
+      ++GLOBAL_RELEASES;
+      return;
+    }
+    const auto size_class = FloorLog2(capacity);
+    DEBUG_ASSERT(size_class < NUMBER_OF_SIZE_CLASSES);
+    ++_buffers_held;
+    ++GLOBAL_BUFFERS_HELD;
+    _bytes_held += capacity;
+    GLOBAL_BYTES_HELD += capacity;
+    _last_size_class = size_class;
+    _size_classes[size_class].queue.enqueue(std::move(buffer));
+  }
+
+  bool BufferPool::TryPop(const size_t size_class, Buffer &item) {
+    DEBUG_ASSERT(size_class < NUMBER_OF_SIZE_CLASSES);
+    if (!_size_classes[size_class].queue.try_dequeue(item)) {
+      return false;
+    }
+    const size_t capacity = item.capacity();
+    --_buffers_held;
+    --GLOBAL_BUFFERS_HELD;
+    _bytes_held -= capacity;
+    GLOBAL_BYTES_HELD -= capacity;
+    return true;
+  }
+
+  Buffer BufferPool::Adopt(Buffer &&item) {
+#if __cplusplus >= 201703L // C++17
+    item._parent_pool = weak_from_this();
+#else
+    item._parent_pool = shared_from_this();
+#endif
+    return std::move(item);
+  }
+
+} // namespace carla
@@ -17,44 +17,121 @@
 #  pragma clang diagnostic pop
 #endif
 
+#include <array>
+#include <atomic>
+#include <limits>
 #include <memory>
 
 namespace carla {
 
+  /// Counters of one or several buffer pools.
+  struct BufferPoolStatistics {
+    /// Number of buffers popped that did not find any memory to reuse.
+    size_t allocations = 0u;
+
+    /// Number of buffers popped that reused memory held by the pool.
+    size_t reuses = 0u;
+
+    /// Number of buffers deleted instead of returning to the pool because the
+    /// pool was above its limit, or deleted by Shrink.
+    size_t releases = 0u;
+
+    /// Number of buffers currently held by the pool.
+    size_t buffers_held = 0u;
+
+    /// Memory currently held by the pool, in bytes.
+    size_t bytes_held = 0u;
+  };
+
   /// A pool of Buffer. Buffers popped from this pool automatically return to
   /// the pool on destruction so the allocated memory can be reused.
   ///
+  /// Buffers are kept in power-of-two size classes by capacity, so a big
+  /// buffer is not handed out when a small one is requested. The pool stops
+  /// keeping buffers once the memory it holds reaches its limit, returning
+  /// buffers are deleted instead.
+  ///
   /// @warning Buffers adjust their size only by growing, they never shrink
-  /// unless explicitly cleared. The allocated memory is only deleted when this
-  /// pool is destroyed.
+  /// unless explicitly cleared. The memory held is only deleted when this
+  /// pool is destroyed or shrunk.
   class BufferPool : public std::enable_shared_from_this<BufferPool> {
   public:
 
-    BufferPool() = default;
+    BufferPool();
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}
+    ~BufferPool();
 
     /// Pop a Buffer from the queue, creates a new one if the queue is empty.
-    Buffer Pop() {
-      Buffer item;
-      _queue.try_dequeue(item); // we don't care if it fails.
-#if __cplusplus >= 201703L // C++17
-      item._parent_pool = weak_from_this();
-#else
-      item._parent_pool = shared_from_this();
-#endif
-      return item;
+    ///
+    /// As the size is unknown, the buffer is taken from the size class of the
+    /// last buffer returned to the pool, which works well for pools serving
+    /// messages of similar size.
+    Buffer Pop();
+
+    /// Pop a Buffer of @a size bytes. Reuses a buffer from the matching size
+    /// class if available, otherwise allocates a new one with the capacity
+    /// rounded up to the next power of two.
+    Buffer Pop(size_t size);
+
+    /// Set the maximum amount of memory, in bytes, this pool keeps. Buffers
+    /// returning to a pool above this limit are deleted. Does not delete the
+    /// memory already held, use Shrink for that.
+    void SetMaxBytesHeld(size_t bytes) {
+      _max_bytes_held = bytes;
+    }
+
+    size_t GetMaxBytesHeld() const {
+      return _max_bytes_held;
     }
 
+    /// Delete buffers held by this pool, starting by the biggest size
+    /// classes, until it holds @a bytes or less.
+    void Shrink(size_t bytes = 0u);
+
+    BufferPoolStatistics GetStatistics() const;
+
+    /// Counters aggregated over every pool in this process.
+    static BufferPoolStatistics GetGlobalStatistics();
+
+    /// Default limit of the memory held by pools created from now on, by
+    /// default there is no limit.
+    static void SetDefaultMaxBytesHeld(size_t bytes);
+
+    static size_t GetDefaultMaxBytesHeld();
+
   private:
 
     friend class Buffer;
 
-    void Push(Buffer &&buffer) {
-      _queue.enqueue(std::move(buffer));
-    }
+    /// Buffers with capacity in [2^i, 2^(i+1)) go to class i.
+    static constexpr size_t NUMBER_OF_SIZE_CLASSES = 32u;
+
+    void Push(Buffer &&buffer);
+
+    bool TryPop(size_t size_class, Buffer &item);
+
+    Buffer Adopt(Buffer &&item);
+
+    struct SizeClass {
+      // Start without preallocated blocks, most classes are never used.
+      moodycamel::ConcurrentQueue<Buffer> queue{0u};
+    };
+
+    std::array<SizeClass, NUMBER_OF_SIZE_CLASSES> _size_classes;
+
+    std::atomic_size_t _last_size_class{0u};
+
+    std::atomic_size_t _max_bytes_held;
+
+    std::atomic_size_t _allocations{0u};
+
+    std::atomic_size_t _reuses{0u};
+
+    std::atomic_size_t _releases{0u};
+
+    std::atomic_size_t _buffers_held{0u};
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;
+    std::atomic_size_t _bytes_held{0u};
   };
 
 } // namespace carla
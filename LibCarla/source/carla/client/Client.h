@@ -43,6 +43,12 @@ namespace client {
       return _simulator->GetServerVersion();
     }
 
+    /// Return the traffic counters of the streaming server of the simulator,
+    /// summed over every session.
+    streaming::detail::tcp::SessionStatistics GetStreamingStatistics() const {
+      return _simulator->GetStreamingStatistics();
+    }
+
     std::vector<std::string> GetAvailableMaps() const {
       return _simulator->GetAvailableMaps();
     }
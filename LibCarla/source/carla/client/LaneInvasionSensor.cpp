@@ -12,9 +12,11 @@
 #include "carla/client/detail/Simulator.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
+#include "carla/road/LaneTracker.h"
 #include "carla/sensor/data/LaneInvasionEvent.h"
 
 #include <exception>
+#include <mutex>
 
 namespace carla {
 namespace client {
@@ -64,6 +66,11 @@ namespace client {
         size_t frame,
         const geom::Transform &vehicle_transform) const;
 
+    /// Move the lane trackers to @a bounds and return the lane markings
+    /// crossed since their last update.
+    std::vector<road::element::LaneMarking> CalculateCrossedLanes(
+        const Bounds &bounds) const;
+
     ActorId _parent;
 
     geom::BoundingBox _parent_bounding_box;
@@ -73,6 +80,14 @@ namespace client {
     Sensor::CallbackFunctionType _callback;
 
     mutable AtomicSharedPtr<const Bounds> _bounds;
+
+    /// Lane of each corner of the bounding box, so every tick only searches
+    /// the lanes around the previous one.
+    mutable std::array<road::LaneTracker, 4u> _trackers;
+
+    mutable size_t _tracked_frame = 0u;
+
+    mutable std::mutex _trackers_mutex;
   };
 
   void LaneInvasionCallback::Tick(const WorldSnapshot &snapshot) const {
@@ -87,6 +102,7 @@ namespace client {
 
     // First frame it'll be null.
     if ((prev == nullptr) && _bounds.compare_exchange(&prev, next)) {
+      CalculateCrossedLanes(*next);
       return;
     }
 
@@ -106,11 +122,7 @@ namespace client {
     } while (!_bounds.compare_exchange(&prev, next));
 
     // Finally it's safe to compute the crossed lanes.
-    std::vector<road::element::LaneMarking> crossed_lanes;
-    for (auto i = 0u; i < 4u; ++i) {
-      const auto lanes = _map->CalculateCrossedLanes(prev->corners[i], next->corners[i]);
-      crossed_lanes.insert(crossed_lanes.end(), lanes.begin(), lanes.end());
-    }
+    auto crossed_lanes = CalculateCrossedLanes(*next);
 
     if (!crossed_lanes.empty()) {
       _callback(MakeShared<sensor::data::LaneInvasionEvent>(
@@ -135,6 +147,22 @@ namespace client {
         location + Rotate(yaw, geom::Location(-box.extent.x, -box.extent.y, 0.0f))}});
   }
 
+  std::vector<road::element::LaneMarking> LaneInvasionCallback::CalculateCrossedLanes(
+      const Bounds &bounds) const {
+    std::vector<road::element::LaneMarking> crossed_lanes;
+    std::lock_guard<std::mutex> lock(_trackers_mutex);
+    // Another thread may have processed a newer frame already.
+    if ((_tracked_frame != 0u) && (bounds.frame <= _tracked_frame)) {
+      return crossed_lanes;
+    }
+    _tracked_frame = bounds.frame;
+    for (auto i = 0u; i < 4u; ++i) {
+      const auto lanes = _map->CalculateCrossedLanes(_trackers[i], bounds.corners[i]);
+      crossed_lanes.insert(crossed_lanes.end(), lanes.begin(), lanes.end());
+    }
+    return crossed_lanes;
+  }
+
   // ===========================================================================
   // -- LaneInvasionSensor -----------------------------------------------------
   // ===========================================================================
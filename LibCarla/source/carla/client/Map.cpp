@@ -6,25 +6,107 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/ThreadGroup.h"
 #include "carla/client/Waypoint.h"
-#include "carla/opendrive/OpenDriveParser.h"
+#include "carla/client/detail/MapCache.h"
 #include "carla/road/Map.h"
 #include "carla/road/RoadTypes.h"
 
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace carla {
 namespace client {
 
   static auto MakeMap(const std::string &opendrive_contents) {
-    auto stream = std::istringstream(opendrive_contents);
-    auto map = opendrive::OpenDriveParser::Load(stream.str());
+    auto map = detail::MapCache::Load(opendrive_contents);
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
     }
     return std::move(*map);
   }
 
+  /// Call @a process(begin, end) for consecutive chunks of the range [0,
+  /// size), split among @a worker_threads threads, if zero use all hardware
+  /// concurrency. Exceptions are rethrown in the calling thread.
+  template <typename FunctorT>
+  static void ProcessInChunks(const size_t size, size_t worker_threads, FunctorT &&process) {
+    // Number of items each worker takes at once.
+    constexpr size_t chunk_size = 64u;
+    const size_t number_of_chunks = (size + chunk_size - 1u) / chunk_size;
+    if (worker_threads == 0u) {
+      worker_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    worker_threads = std::min(worker_threads, number_of_chunks);
+    if (worker_threads <= 1u) {
+      process(size_t(0u), size);
+      return;
+    }
+
+    std::atomic_size_t next_chunk{0u};
+    std::exception_ptr exception;
+    std::mutex exception_mutex;
+
+    auto worker = [&]() {
+      try {
+        for (auto chunk = next_chunk++; chunk < number_of_chunks; chunk = next_chunk++) {
+          process(chunk * chunk_size, std::min((chunk + 1u) * chunk_size, size));
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(exception_mutex);
+        exception = std::current_exception();
+        // Make the other workers stop as soon as possible.
+        next_chunk = number_of_chunks;
+      }
+    };
+
+    {
+      ThreadGroup workers;
+      workers.CreateThreads(worker_threads - 1u, worker);
+      worker();
+    } // Join the workers.
+
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  /// Results of ProcessInChunks that are concatenated in order once all the
+  /// chunks are processed, each chunk is keyed by its first index.
+  class WaypointArraysChunks {
+  public:
+
+    void Add(size_t begin, road::WaypointArrays chunk) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _chunks.emplace_back(begin, std::move(chunk));
+    }
+
+    road::WaypointArrays Concatenate() {
+      std::sort(_chunks.begin(), _chunks.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first < rhs.first;
+      });
+      size_t size = 0u;
+      for (const auto &chunk : _chunks) {
+        size += chunk.second.size();
+      }
+      road::WaypointArrays result;
+      result.reserve(size);
+      for (const auto &chunk : _chunks) {
+        result.append(chunk.second);
+      }
+      return result;
+    }
+
+  private:
+
+    std::mutex _mutex;
+
+    std::vector<std::pair<size_t, road::WaypointArrays>> _chunks;
+  };
+
   Map::Map(rpc::MapInfo description)
     : _description(std::move(description)),
       _map(MakeMap(_description.open_drive_file)) {}
@@ -52,6 +134,25 @@ namespace client {
         nullptr;
   }
 
+  std::vector<road::element::Waypoint> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      uint32_t lane_type,
+      size_t worker_threads) const {
+    std::vector<road::element::Waypoint> result(locations.size());
+    ProcessInChunks(locations.size(), worker_threads, [&](size_t begin, size_t end) {
+      for (auto i = begin; i < end; ++i) {
+        const auto waypoint = project_to_road ?
+            _map.GetClosestWaypointOnRoad(locations[i], lane_type) :
+            _map.GetWaypoint(locations[i], lane_type);
+        if (waypoint.has_value()) {
+          result[i] = *waypoint;
+        }
+      }
+    });
+    return result;
+  }
+
   Map::TopologyList Map::GetTopology() const {
     namespace re = carla::road::element;
     std::unordered_map<re::Waypoint, SharedPtr<Waypoint>> waypoints;
@@ -87,12 +188,165 @@ namespace client {
     return result;
   }
 
+  road::WaypointArrays Map::GenerateWaypointArrays(
+      const double distance,
+      const size_t worker_threads) const {
+    std::vector<road::RoadId> roads;
+    roads.reserve(_map.GetMap().GetRoadCount());
+    for (const auto &pair : _map.GetMap().GetRoads()) {
+      roads.emplace_back(pair.first);
+    }
+    WaypointArraysChunks chunks;
+    ProcessInChunks(roads.size(), worker_threads, [&](size_t begin, size_t end) {
+      road::WaypointArrays chunk;
+      for (auto i = begin; i < end; ++i) {
+        _map.GenerateWaypoints(roads[i], distance, chunk);
+      }
+      chunks.Add(begin, std::move(chunk));
+    });
+    return chunks.Concatenate();
+  }
+
+  road::WaypointArrays Map::GetNext(
+      const std::vector<road::element::Waypoint> &waypoints,
+      const double distance,
+      std::vector<size_t> &offsets,
+      const size_t worker_threads) const {
+    // Number of waypoints following each input, turned into offsets below.
+    std::vector<size_t> counts(waypoints.size(), 0u);
+    WaypointArraysChunks chunks;
+    ProcessInChunks(waypoints.size(), worker_threads, [&](size_t begin, size_t end) {
+      road::WaypointArrays chunk;
+      for (auto i = begin; i < end; ++i) {
+        if (waypoints[i].lane_id != 0) {
+          const auto size = chunk.size();
+          _map.GetNext(waypoints[i], distance, chunk);
+          counts[i] = chunk.size() - size;
+        }
+      }
+      chunks.Add(begin, std::move(chunk));
+    });
+    offsets.resize(waypoints.size() + 1u);
+    offsets[0u] = 0u;
+    for (auto i = 0u; i < counts.size(); ++i) {
+      offsets[i + 1u] = offsets[i] + counts[i];
+    }
+    return chunks.Concatenate();
+  }
+
+  void Map::SetLaneCenterlineResolution(const double resolution) {
+    std::lock_guard<std::mutex> lock(_lane_centerlines_mutex);
+    _lane_centerline_resolution = std::max(resolution, 0.0);
+    _lane_centerlines.reset();
+  }
+
+  geom::Transform Map::ComputeTransform(const road::element::Waypoint waypoint) const {
+    if (_lane_centerline_resolution > 0.0) {
+      const auto transform = GetLaneCenterlines()->ComputeTransform(waypoint);
+      if (transform.has_value()) {
+        return *transform;
+      }
+    }
+    return _map.ComputeTransform(waypoint);
+  }
+
+  std::shared_ptr<const road::LaneCenterlines> Map::GetLaneCenterlines() const {
+    auto centerlines = _lane_centerlines.load();
+    if (centerlines == nullptr) {
+      std::lock_guard<std::mutex> lock(_lane_centerlines_mutex);
+      centerlines = _lane_centerlines.load();
+      if (centerlines == nullptr) {
+        const double resolution = _lane_centerline_resolution;
+        centerlines = std::make_shared<const road::LaneCenterlines>(
+            _map,
+            resolution > 0.0 ? resolution : 0.5);
+        _lane_centerlines = centerlines;
+      }
+    }
+    return centerlines;
+  }
+
   std::vector<road::element::LaneMarking> Map::CalculateCrossedLanes(
       const geom::Location &origin,
       const geom::Location &destination) const {
     return _map.CalculateCrossedLanes(origin, destination);
   }
 
+  std::vector<road::element::LaneMarking> Map::CalculateCrossedLanes(
+      road::LaneTracker &tracker,
+      const geom::Location &destination) const {
+    return _map.CalculateCrossedLanes(tracker, destination);
+  }
+
+  const road::RoutePlanner &Map::GetRoutePlanner() const {
+    std::call_once(_route_planner_flag, [this]() {
+      _route_planner = std::make_unique<road::RoutePlanner>(_map);
+    });
+    return *_route_planner;
+  }
+
+  const road::RouteHierarchy &Map::GetRouteHierarchy() const {
+    std::call_once(_route_hierarchy_flag, [this]() {
+      _route_hierarchy = std::make_unique<road::RouteHierarchy>(
+          detail::MapCache::LoadRouteHierarchy(GetOpenDrive(), GetRoutePlanner()));
+    });
+    return *_route_hierarchy;
+  }
+
+  Map::RouteList Map::TraceRoute(
+      const geom::Location &origin,
+      const geom::Location &destination,
+      const double distance,
+      const road::RoutePlanner::Algorithm algorithm) const {
+    return std::move(TraceRoutes({{origin, destination}}, distance, algorithm, 1u).front());
+  }
+
+  std::vector<Map::RouteList> Map::TraceRoutes(
+      const std::vector<std::pair<geom::Location, geom::Location>> &queries,
+      const double distance,
+      const road::RoutePlanner::Algorithm algorithm,
+      const size_t worker_threads) const {
+    const auto &planner = GetRoutePlanner();
+    const auto *hierarchy = (algorithm == road::RoutePlanner::Algorithm::ContractionHierarchy) ?
+        &GetRouteHierarchy() :
+        nullptr;
+    std::vector<RouteList> result(queries.size());
+    ProcessInChunks(queries.size(), worker_threads, [&](size_t begin, size_t end) {
+      // Queries without waypoint keep an empty route.
+      std::vector<size_t> indices;
+      std::vector<std::pair<road::element::Waypoint, road::element::Waypoint>> waypoints;
+      for (auto i = begin; i < end; ++i) {
+        const auto origin = _map.GetClosestWaypointOnRoad(queries[i].first);
+        const auto destination = _map.GetClosestWaypointOnRoad(queries[i].second);
+        if (origin.has_value() && destination.has_value()) {
+          indices.emplace_back(i);
+          waypoints.emplace_back(*origin, *destination);
+        }
+      }
+      const auto routes = planner.ComputeRoutes(_map, waypoints, algorithm, hierarchy);
+      for (auto i = 0u; i < routes.size(); ++i) {
+        if (routes[i].has_value()) {
+          result[indices[i]] = MakeRouteList(*routes[i], distance);
+        }
+      }
+    });
+    return result;
+  }
+
+  Map::RouteList Map::MakeRouteList(
+      const road::RoutePlanner::Route &route,
+      const double distance) const {
+    RouteList result;
+    const auto samples = road::RoutePlanner::SampleRoute(route, distance);
+    result.reserve(samples.size());
+    for (auto &&sample : samples) {
+      result.emplace_back(
+          SharedPtr<Waypoint>(new Waypoint{shared_from_this(), sample.first}),
+          sample.second);
+    }
+    return result;
+  }
+
   const geom::GeoLocation &Map::GetGeoReference() const {
     return _map.GetGeoReference();
   }
@@ -6,13 +6,21 @@
 
 #pragma once
 
+#include "carla/AtomicSharedPtr.h"
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
+#include "carla/road/LaneCenterlines.h"
 #include "carla/road/Map.h"
+#include "carla/road/RouteHierarchy.h"
+#include "carla/road/RoutePlanner.h"
+#include "carla/road/WaypointArrays.h"
 #include "carla/road/element/LaneMarking.h"
 #include "carla/rpc/MapInfo.h"
 #include "carla/road/Lane.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 
 namespace carla {
@@ -53,23 +61,125 @@ namespace client {
         bool project_to_road = true,
         uint32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
 
+    /// Batch version of GetWaypoint returning the compact road waypoints
+    /// instead of a Waypoint object per location. Locations without waypoint
+    /// are mapped to a waypoint with lane_id 0. The queries are split among
+    /// @a worker_threads threads, if zero use all hardware concurrency.
+    std::vector<road::element::Waypoint> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        uint32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving),
+        size_t worker_threads = 0u) const;
+
     using TopologyList = std::vector<std::pair<SharedPtr<Waypoint>, SharedPtr<Waypoint>>>;
 
     TopologyList GetTopology() const;
 
     std::vector<SharedPtr<Waypoint>> GenerateWaypoints(double distance) const;
 
+    /// Dense version of GenerateWaypoints, in the same order, returning the
+    /// waypoints and their transforms in structure-of-arrays layout instead of
+    /// a Waypoint object per sample. The roads are split among @a
+    /// worker_threads threads, if zero use all hardware concurrency.
+    road::WaypointArrays GenerateWaypointArrays(
+        double distance,
+        size_t worker_threads = 0u) const;
+
+    /// Batch version of Waypoint::GetNext, returning the waypoints at @a
+    /// distance from each of @a waypoints and their transforms. The ones
+    /// following the i-th waypoint are the elements offsets[i] to
+    /// offsets[i + 1] - 1 of the result; @a offsets is resized to one more
+    /// element than @a waypoints. Waypoints with lane_id 0 are skipped.
+    road::WaypointArrays GetNext(
+        const std::vector<road::element::Waypoint> &waypoints,
+        double distance,
+        std::vector<size_t> &offsets,
+        size_t worker_threads = 0u) const;
+
+    /// Set the distance in meters between the samples of the lane centerlines
+    /// ComputeTransform interpolates from, zero (default) to compute the
+    /// transforms exactly. The centerlines are sampled again on the next call
+    /// that uses them.
+    void SetLaneCenterlineResolution(double resolution);
+
+    double GetLaneCenterlineResolution() const {
+      return _lane_centerline_resolution;
+    }
+
+    /// Return the transform of @a waypoint, interpolated from
+    /// GetLaneCenterlines if a resolution is set (see
+    /// SetLaneCenterlineResolution), computed exactly otherwise.
+    geom::Transform ComputeTransform(road::element::Waypoint waypoint) const;
+
+    /// Return the lane centerlines sampled at the resolution set, or every 0.5
+    /// meters if none, built on the first call after the resolution changes.
+    std::shared_ptr<const road::LaneCenterlines> GetLaneCenterlines() const;
+
     std::vector<road::element::LaneMarking> CalculateCrossedLanes(
         const geom::Location &origin,
         const geom::Location &destination) const;
 
+    /// Same as above, from the last location of @a tracker, which is updated
+    /// to @a destination.
+    std::vector<road::element::LaneMarking> CalculateCrossedLanes(
+        road::LaneTracker &tracker,
+        const geom::Location &destination) const;
+
     const geom::GeoLocation &GetGeoReference() const;
 
+    /// Return the lane graph used to compute routes on this map, built on the
+    /// first call.
+    const road::RoutePlanner &GetRoutePlanner() const;
+
+    /// Return the contraction hierarchy used by
+    /// road::RoutePlanner::Algorithm::ContractionHierarchy. On the first call
+    /// it is loaded from the map cache, or built and stored in the cache.
+    const road::RouteHierarchy &GetRouteHierarchy() const;
+
+    using RouteList = std::vector<std::pair<SharedPtr<Waypoint>, road::RoutePlanner::Maneuver>>;
+
+    /// Compute the shortest route between the waypoints closest to @a origin
+    /// and @a destination, returning a waypoint every @a distance meters and
+    /// the maneuver to reach it. Empty if there is no route.
+    RouteList TraceRoute(
+        const geom::Location &origin,
+        const geom::Location &destination,
+        double distance,
+        road::RoutePlanner::Algorithm algorithm = road::RoutePlanner::Algorithm::AStar) const;
+
+    /// Batch version of TraceRoute, a route for each pair of origin and
+    /// destination in @a queries. The queries are split among @a
+    /// worker_threads threads, if zero use all hardware concurrency.
+    std::vector<RouteList> TraceRoutes(
+        const std::vector<std::pair<geom::Location, geom::Location>> &queries,
+        double distance,
+        road::RoutePlanner::Algorithm algorithm = road::RoutePlanner::Algorithm::ContractionHierarchy,
+        size_t worker_threads = 0u) const;
+
   private:
 
+    RouteList MakeRouteList(const road::RoutePlanner::Route &route, double distance) const;
+
     const rpc::MapInfo _description;
 
     const road::Map _map;
+
+    /// Resolution of the lane centerlines used by ComputeTransform, zero to
+    /// compute the transforms exactly.
+    std::atomic<double> _lane_centerline_resolution{0.0};
+
+    /// Guards building and resetting the lane centerlines.
+    mutable std::mutex _lane_centerlines_mutex;
+
+    mutable AtomicSharedPtr<const road::LaneCenterlines> _lane_centerlines;
+
+    mutable std::once_flag _route_planner_flag;
+
+    mutable std::unique_ptr<road::RoutePlanner> _route_planner;
+
+    mutable std::once_flag _route_hierarchy_flag;
+
+    mutable std::unique_ptr<road::RouteHierarchy> _route_hierarchy;
   };
 
 } // namespace client
@@ -14,7 +14,7 @@ namespace client {
   Waypoint::Waypoint(SharedPtr<const Map> parent, road::element::Waypoint waypoint)
     : _parent(std::move(parent)),
       _waypoint(std::move(waypoint)),
-      _transform(_parent->GetMap().ComputeTransform(_waypoint)),
+      _transform(_parent->ComputeTransform(_waypoint)),
       _mark_record(_parent->GetMap().GetMarkRecord(_waypoint)) {}
 
   Waypoint::~Waypoint() = default;
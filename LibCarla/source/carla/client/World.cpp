@@ -105,6 +105,18 @@ namespace client {
     _episode.Lock()->RemoveOnTickEvent(callback_id);
   }
 
+  void World::SetTickWorkerThreads(size_t worker_threads) {
+    _episode.Lock()->SetTickWorkerThreads(worker_threads);
+  }
+
+  size_t World::GetTickWorkerThreads() const {
+    return _episode.Lock()->GetTickWorkerThreads();
+  }
+
+  std::vector<TickCallbackStatistics> World::GetTickCallbackStatistics() const {
+    return _episode.Lock()->GetOnTickStatistics();
+  }
+
   uint64_t World::Tick() {
     return _episode.Lock()->Tick();
   }
@@ -12,6 +12,7 @@
 #include "carla/client/Timestamp.h"
 #include "carla/client/WorldSnapshot.h"
 #include "carla/client/detail/EpisodeProxy.h"
+#include "carla/client/detail/TickScheduler.h"
 #include "carla/geom/Transform.h"
 #include "carla/rpc/Actor.h"
 #include "carla/rpc/AttachmentType.h"
@@ -111,6 +112,21 @@ namespace client {
     /// Remove a callback registered with OnTick.
     void RemoveOnTick(size_t callback_id);
 
+    /// Call the callbacks registered with OnTick, and the client-side sensors,
+    /// in @a worker_threads threads instead of in the thread that receives
+    /// the tick, so a slow callback does not delay the others. Each callback
+    /// is still called once at a time and in order of frame. Zero (the
+    /// default) calls them one after the other in the receiving thread.
+    ///
+    /// @warning Do not call it from a tick callback.
+    void SetTickWorkerThreads(size_t worker_threads);
+
+    size_t GetTickWorkerThreads() const;
+
+    /// Return the number of calls and the time spent by each callback called
+    /// on every tick, including the client-side sensors.
+    std::vector<TickCallbackStatistics> GetTickCallbackStatistics() const;
+
     /// Signal the simulator to continue to next tick (only has effect on
     /// synchronous mode).
     ///
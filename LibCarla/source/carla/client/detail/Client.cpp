@@ -123,6 +123,10 @@ namespace detail {
     return _pimpl->CallAndWait<std::string>("version");
   }
 
+  streaming::detail::tcp::SessionStatistics Client::GetStreamingStatistics() {
+    return _pimpl->CallAndWait<streaming::detail::tcp::SessionStatistics>("get_streaming_statistics");
+  }
+
   void Client::LoadEpisode(std::string map_name) {
     // Await response, we need to be sure in this one.
     _pimpl->CallAndWait<void>("load_new_episode", std::move(map_name));
@@ -336,6 +340,10 @@ namespace detail {
     return _pimpl->CallAndWait<uint64_t>("tick_cue");
   }
 
+  void Client::RequestEpisodeKeyframe() {
+    _pimpl->AsyncCall("request_episode_keyframe");
+  }
+
 } // namespace detail
 } // namespace client
 } // namespace carla
@@ -21,6 +21,7 @@
 #include "carla/rpc/TrafficLightState.h"
 #include "carla/rpc/VehiclePhysicsControl.h"
 #include "carla/rpc/WeatherParameters.h"
+#include "carla/streaming/detail/tcp/SessionStatistics.h"
 
 #include <functional>
 #include <memory>
@@ -71,6 +72,8 @@ namespace detail {
 
     std::string GetServerVersion();
 
+    streaming::detail::tcp::SessionStatistics GetStreamingStatistics();
+
     void LoadEpisode(std::string map_name);
 
     rpc::EpisodeInfo GetEpisodeInfo();
@@ -209,6 +212,10 @@ namespace detail {
 
     uint64_t SendTickCue();
 
+    /// Ask the server to send the current state of the episode as a keyframe,
+    /// does not wait for it.
+    void RequestEpisodeKeyframe();
+
   private:
 
     class Pimpl;
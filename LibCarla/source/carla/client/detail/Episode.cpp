@@ -11,6 +11,7 @@
 #include "carla/client/detail/WalkerNavigation.h"
 #include "carla/sensor/Deserializer.h"
 
+#include <algorithm>
 #include <exception>
 
 namespace carla {
@@ -53,31 +54,11 @@ namespace detail {
       auto self = weak.lock();
       if (self != nullptr) {
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
-
-        auto next = std::make_shared<const EpisodeState>(CastData(*data));
-        auto prev = self->GetState();
-        do {
-          if (prev->GetFrame() >= next->GetFrame()) {
-            self->_on_tick_callbacks.Call(next);
-            return;
-          }
-        } while (!self->_state.compare_exchange(&prev, next));
-
-        if (next->GetEpisodeId() != prev->GetEpisodeId()) {
-          self->OnEpisodeStarted();
-        }
-
-        // Notify waiting threads and do the callbacks.
-        self->_snapshot.SetValue(next);
-
-        // Tick navigation.
-        auto navigation = self->_navigation.load();
-        if (navigation != nullptr) {
-          navigation->Tick(*next);
+        if (CastData(*data).IsDelta()) {
+          self->OnDeltaReceived(std::move(data));
+        } else {
+          self->OnStateReceived(std::make_shared<const EpisodeState>(std::move(data)));
         }
-
-        // Call user callbacks.
-        self->_on_tick_callbacks.Call(next);
       }
     });
   }
@@ -100,7 +81,21 @@ namespace detail {
       navigation = _navigation.load();
       if (navigation == nullptr) {
         auto new_navigation = std::make_shared<WalkerNavigation>(_client);
-        _navigation.compare_exchange(&navigation, new_navigation);
+        if (_navigation.compare_exchange(&navigation, new_navigation)) {
+          // Walkers are moved on each tick along with the other callbacks,
+          // skipping the ticks older than the current state.
+          std::weak_ptr<Episode> weak = shared_from_this();
+          _on_tick_callbacks.Push([weak](std::shared_ptr<const EpisodeState> state) {
+            auto self = weak.lock();
+            if (self == nullptr) {
+              return;
+            }
+            auto nav = self->_navigation.load();
+            if ((nav != nullptr) && (state->GetFrame() >= self->GetState()->GetFrame())) {
+              nav->Tick(*state);
+            }
+          });
+        }
       }
     } while (navigation == nullptr);
     return navigation;
@@ -114,6 +109,98 @@ namespace detail {
     return GetActorsById_Impl(_client, _actors, GetState()->GetActorIds());
   }
 
+  void Episode::OnStateReceived(std::shared_ptr<const EpisodeState> next) {
+    auto prev = GetState();
+    do {
+      if (prev->GetFrame() >= next->GetFrame()) {
+        _on_tick_callbacks.Call(next);
+        return;
+      }
+    } while (!_state.compare_exchange(&prev, next));
+
+    if (next->GetEpisodeId() != prev->GetEpisodeId()) {
+      OnEpisodeStarted();
+    }
+
+    // Notify waiting threads and do the callbacks.
+    _snapshot.SetValue(next);
+
+    // Call user callbacks and tick navigation.
+    _on_tick_callbacks.Call(next);
+
+    ApplyPendingDeltas();
+  }
+
+  void Episode::OnDeltaReceived(SharedPtr<sensor::SensorData> data) {
+    // Deltas kept waiting for their base, and deltas missing their base
+    // between two requests of a keyframe.
+    constexpr size_t max_pending_deltas = 16u;
+    std::shared_ptr<const EpisodeState> next;
+    {
+      std::lock_guard<std::mutex> lock(_pending_deltas_mutex);
+      const auto &delta = CastData(*data);
+      auto prev = GetState();
+      if ((prev->GetEpisodeId() == delta.GetEpisodeId()) &&
+          (prev->GetFrame() == delta.GetBaseFrame())) {
+        next = std::make_shared<const EpisodeState>(*prev, delta);
+      } else {
+        if (delta.GetBaseFrame() > prev->GetFrame()) {
+          // Messages may arrive out of order, keep it until its base arrives.
+          if (_pending_deltas.size() >= max_pending_deltas) {
+            _pending_deltas.erase(_pending_deltas.begin());
+          }
+          _pending_deltas.emplace_back(std::move(data));
+        }
+        // Otherwise its base is gone. Either way the base may never arrive
+        // (we subscribed mid-stream or it was dropped by the server), ask for
+        // a keyframe instead of waiting for the next scheduled one, which in
+        // synchronous mode never comes until we tick.
+        if ((_deltas_missing_base++ % max_pending_deltas) != 0u) {
+          return;
+        }
+      }
+    }
+    if (next != nullptr) {
+      OnStateReceived(std::move(next));
+    } else {
+      try {
+        _client.RequestEpisodeKeyframe();
+      } catch (const std::exception &e) {
+        log_error("exception requesting a keyframe of the episode:", e.what());
+      }
+    }
+  }
+
+  void Episode::ApplyPendingDeltas() {
+    std::shared_ptr<const EpisodeState> next;
+    {
+      std::lock_guard<std::mutex> lock(_pending_deltas_mutex);
+      // A newer state arrived, the next delta missing its base asks again.
+      _deltas_missing_base = 0u;
+      if (_pending_deltas.empty()) {
+        return;
+      }
+      auto prev = GetState();
+      _pending_deltas.erase(
+          std::remove_if(_pending_deltas.begin(), _pending_deltas.end(), [&](const auto &data) {
+            return CastData(*data).GetBaseFrame() < prev->GetFrame();
+          }),
+          _pending_deltas.end());
+      auto it = std::find_if(_pending_deltas.begin(), _pending_deltas.end(), [&](const auto &data) {
+        const auto &delta = CastData(*data);
+        return
+            (delta.GetEpisodeId() == prev->GetEpisodeId()) &&
+            (delta.GetBaseFrame() == prev->GetFrame());
+      });
+      if (it == _pending_deltas.end()) {
+        return;
+      }
+      next = std::make_shared<const EpisodeState>(*prev, CastData(**it));
+      _pending_deltas.erase(it);
+    }
+    OnStateReceived(std::move(next));
+  }
+
   void Episode::OnEpisodeStarted() {
     _actors.Clear();
     _on_tick_callbacks.Clear();
@@ -7,18 +7,21 @@
 #pragma once
 
 #include "carla/AtomicSharedPtr.h"
+#include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/RecurrentSharedFuture.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/WorldSnapshot.h"
 #include "carla/client/detail/CachedActorList.h"
-#include "carla/client/detail/CallbackList.h"
 #include "carla/client/detail/EpisodeState.h"
+#include "carla/client/detail/TickScheduler.h"
 #include "carla/rpc/EpisodeInfo.h"
 
+#include <mutex>
 #include <vector>
 
 namespace carla {
+namespace sensor { class SensorData; }
 namespace client {
 namespace detail {
 
@@ -79,12 +82,32 @@ namespace detail {
       _on_tick_callbacks.Remove(id);
     }
 
+    /// Number of threads the on-tick callbacks are called in, zero to call
+    /// them in the thread that receives the tick, see TickScheduler.
+    void SetTickWorkerThreads(size_t worker_threads) {
+      _on_tick_callbacks.SetWorkerThreads(worker_threads);
+    }
+
+    size_t GetTickWorkerThreads() const {
+      return _on_tick_callbacks.GetWorkerThreads();
+    }
+
+    std::vector<TickCallbackStatistics> GetOnTickStatistics() const {
+      return _on_tick_callbacks.GetStatistics();
+    }
+
   private:
 
     Episode(Client &client, const rpc::EpisodeInfo &info);
 
     void OnEpisodeStarted();
 
+    void OnStateReceived(std::shared_ptr<const EpisodeState> next);
+
+    void OnDeltaReceived(SharedPtr<sensor::SensorData> data);
+
+    void ApplyPendingDeltas();
+
     Client &_client;
 
     AtomicSharedPtr<const EpisodeState> _state;
@@ -93,10 +116,19 @@ namespace detail {
 
     CachedActorList _actors;
 
-    CallbackList<WorldSnapshot> _on_tick_callbacks;
+    TickScheduler _on_tick_callbacks;
 
     RecurrentSharedFuture<WorldSnapshot> _snapshot;
 
+    /// Delta-encoded states received before the state they apply to.
+    std::mutex _pending_deltas_mutex;
+
+    std::vector<SharedPtr<sensor::SensorData>> _pending_deltas;
+
+    /// Deltas that could not be applied since the last state received, a
+    /// keyframe is requested every few of them.
+    size_t _deltas_missing_base = 0u;
+
     const streaming::Token _token;
   };
 
@@ -6,31 +6,116 @@
 
 #include "carla/client/detail/EpisodeState.h"
 
+#include "carla/sensor/s11n/EpisodeStateDelta.h"
+
+#include <algorithm>
+
 namespace carla {
 namespace client {
 namespace detail {
 
-  EpisodeState::EpisodeState(const sensor::data::RawEpisodeState &state)
+  static auto &CastData(const sensor::SensorData &data) {
+    using target_t = const sensor::data::RawEpisodeState;
+    return static_cast<target_t &>(data);
+  }
+
+  static Timestamp MakeTimestamp(const sensor::data::RawEpisodeState &state) {
+    return {
+        state.GetFrame(),
+        state.GetGameTimeStamp(),
+        state.GetDeltaSeconds(),
+        state.GetPlatformTimeStamp()};
+  }
+
+  EpisodeState::EpisodeState(SharedPtr<sensor::SensorData> data)
+    : _episode_id(CastData(*data).GetEpisodeId()),
+      _timestamp(MakeTimestamp(CastData(*data))),
+      _data(std::move(data)) {
+    const auto &state = CastData(*_data);
+    DEBUG_ASSERT(!state.IsDelta());
+    _begin = state.data();
+    _end = _begin + state.size();
+    BuildIndex();
+  }
+
+  EpisodeState::EpisodeState(
+      const EpisodeState &previous,
+      const sensor::data::RawEpisodeState &state)
     : _episode_id(state.GetEpisodeId()),
-      _timestamp(
-          state.GetFrame(),
-          state.GetGameTimeStamp(),
-          state.GetDeltaSeconds(),
-          state.GetPlatformTimeStamp()) {
-    _actors.reserve(state.size());
-    for (auto &&actor : state) {
-      DEBUG_ONLY(auto result = )
-      _actors.emplace(
-          actor.id,
-          ActorSnapshot{
-              actor.id,
-              actor.transform,
-              actor.velocity,
-              actor.angular_velocity,
-              actor.acceleration,
-              actor.state});
-      DEBUG_ASSERT(result.second);
+      _timestamp(MakeTimestamp(state)),
+      _storage(previous._begin, previous._end),
+      _index(previous._index) {
+    DEBUG_ASSERT(state.IsDelta());
+    DEBUG_ASSERT(previous.GetFrame() == state.GetBaseFrame());
+    _begin = _storage.data();
+    _end = _begin + _storage.size();
+    const auto number_of_previous_actors = _storage.size();
+    std::vector<size_t> removed;
+    sensor::s11n::EpisodeStateDelta::Decode(
+        state.GetDeltaBegin(),
+        state.GetDeltaEnd(),
+        [&](ActorId id) {
+          const auto position = FindPosition(id);
+          DEBUG_ASSERT(position < size());
+          removed.emplace_back(position);
+        },
+        [&](ActorId id) -> ActorDynamicState & {
+          const auto position = FindPosition(id);
+          if (position < size()) {
+            return _storage[position];
+          }
+          // New actors are not in the index yet.
+          auto it = std::find_if(
+              _storage.begin() + number_of_previous_actors,
+              _storage.end(),
+              [id](const ActorDynamicState &actor) { return actor.id == id; });
+          if (it != _storage.end()) {
+            return *it;
+          }
+          _storage.emplace_back(ActorDynamicState{});
+          _storage.back().id = id;
+          return _storage.back();
+        });
+    if (!removed.empty()) {
+      std::sort(removed.begin(), removed.end());
+      auto removed_it = removed.begin();
+      size_t position = 0u;
+      _storage.erase(
+          std::remove_if(_storage.begin(), _storage.end(), [&](const ActorDynamicState &) {
+            const bool remove = (removed_it != removed.end()) && (*removed_it == position);
+            if (remove) {
+              ++removed_it;
+            }
+            ++position;
+            return remove;
+          }),
+          _storage.end());
     }
+    _begin = _storage.data();
+    _end = _begin + _storage.size();
+    if (!removed.empty() || (_storage.size() != number_of_previous_actors)) {
+      BuildIndex();
+    }
+  }
+
+  void EpisodeState::BuildIndex() {
+    _index.clear();
+    _index.reserve(size());
+    for (auto it = _begin; it != _end; ++it) {
+      _index.emplace_back(IndexEntry{it->id, static_cast<uint32_t>(it - _begin)});
+    }
+    // The simulator usually sends the actors already sorted.
+    if (!std::is_sorted(_index.begin(), _index.end())) {
+      std::sort(_index.begin(), _index.end());
+    }
+    DEBUG_ASSERT(std::adjacent_find(_index.begin(), _index.end(), [](auto &&lhs, auto &&rhs) {
+      return lhs.id == rhs.id;
+    }) == _index.end());
+  }
+
+  size_t EpisodeState::FindPosition(const ActorId id) const {
+    auto it = std::lower_bound(_index.begin(), _index.end(), IndexEntry{id, 0u});
+    return ((it != _index.end()) && (it->id == id)) ? it->position : size();
   }
 
 } // namespace detail
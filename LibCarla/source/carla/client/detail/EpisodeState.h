@@ -6,31 +6,43 @@
 
 #pragma once
 
-#include "carla/Iterator.h"
 #include "carla/ListView.h"
+#include "carla/Memory.h"
 #include "carla/NonCopyable.h"
 #include "carla/client/ActorSnapshot.h"
 #include "carla/client/Timestamp.h"
 #include "carla/sensor/data/RawEpisodeState.h"
 
+#include <boost/iterator/transform_iterator.hpp>
 #include <boost/optional.hpp>
 
 #include <memory>
-#include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace client {
 namespace detail {
 
   /// Represents the state of all the actors of an episode at a given frame.
+  ///
+  /// The actors are kept as received, contiguous in the buffer of the
+  /// message, with an index sorted by id on the side. Iteration follows the
+  /// order of the message.
   class EpisodeState
     : std::enable_shared_from_this<EpisodeState>,
       private NonCopyable {
+    using ActorDynamicState = sensor::data::ActorDynamicState;
   public:
 
     explicit EpisodeState(uint64_t episode_id) : _episode_id(episode_id) {}
 
-    explicit EpisodeState(const sensor::data::RawEpisodeState &state);
+    /// Keeps @a data, a full sensor::data::RawEpisodeState, and reads the
+    /// actors directly from its buffer.
+    explicit EpisodeState(SharedPtr<sensor::SensorData> data);
+
+    /// Apply the delta-encoded @a state on top of @a previous, which must be
+    /// the state at the base frame of the delta.
+    EpisodeState(const EpisodeState &previous, const sensor::data::RawEpisodeState &state);
 
     auto GetEpisodeId() const {
       return _episode_id;
@@ -45,7 +57,7 @@ namespace detail {
     }
 
     bool ContainsActorSnapshot(ActorId actor_id) const {
-      return _actors.find(actor_id) != _actors.end();
+      return Find(actor_id) != nullptr;
     }
 
     ActorSnapshot GetActorSnapshot(ActorId id) const {
@@ -62,29 +74,67 @@ namespace detail {
 
     auto GetActorIds() const {
       return MakeListView(
-          iterator::make_map_keys_const_iterator(_actors.begin()),
-          iterator::make_map_keys_const_iterator(_actors.end()));
+          boost::make_transform_iterator(_begin, GetId{}),
+          boost::make_transform_iterator(_end, GetId{}));
     }
 
     size_t size() const {
-      return _actors.size();
+      return static_cast<size_t>(_end - _begin);
     }
 
     auto begin() const {
-      return iterator::make_map_values_const_iterator(_actors.begin());
+      return boost::make_transform_iterator(_begin, MakeActorSnapshot{});
     }
 
     auto end() const {
-      return iterator::make_map_values_const_iterator(_actors.end());
+      return boost::make_transform_iterator(_end, MakeActorSnapshot{});
     }
 
   private:
 
+    struct GetId {
+      ActorId operator()(const ActorDynamicState &actor) const {
+        return actor.id;
+      }
+    };
+
+    struct MakeActorSnapshot {
+      ActorSnapshot operator()(const ActorDynamicState &actor) const {
+        return {
+            actor.id,
+            actor.transform,
+            actor.velocity,
+            actor.angular_velocity,
+            actor.acceleration,
+            actor.state};
+      }
+    };
+
+    struct IndexEntry {
+      ActorId id;
+      uint32_t position;
+
+      bool operator<(const IndexEntry &rhs) const {
+        return id < rhs.id;
+      }
+    };
+
+    /// Rebuild the index from the actors in [_begin, _end).
+    void BuildIndex();
+
+    /// Position of the actor @a id in [_begin, _end), or size() if missing.
+    size_t FindPosition(ActorId id) const;
+
+    const ActorDynamicState *Find(ActorId id) const {
+      const auto position = FindPosition(id);
+      return position < size() ? _begin + position : nullptr;
+    }
+
     template <typename T>
     void CopyActorSnapshotIfPresent(ActorId id, T &value) const {
-      auto it = _actors.find(id);
-      if (it != _actors.end()) {
-        value = it->second;
+      auto actor = Find(id);
+      if (actor != nullptr) {
+        value = MakeActorSnapshot{}(*actor);
       }
     }
 
@@ -92,7 +142,18 @@ namespace detail {
 
     const Timestamp _timestamp;
 
-    std::unordered_map<ActorId, ActorSnapshot> _actors;
+    /// Message the actors point to, if received as a full state.
+    SharedPtr<sensor::SensorData> _data;
+
+    /// Actors, if reconstructed from a delta.
+    std::vector<ActorDynamicState> _storage;
+
+    const ActorDynamicState *_begin = nullptr;
+
+    const ActorDynamicState *_end = nullptr;
+
+    /// Sorted by id.
+    std::vector<IndexEntry> _index;
   };
 
 } // namespace detail
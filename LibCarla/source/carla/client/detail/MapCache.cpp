@@ -0,0 +1,138 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/MapCache.h"
+
+#include "carla/Logging.h"
+#include "carla/opendrive/OpenDriveParser.h"
+#include "carla/road/MapSerializer.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  namespace fs = boost::filesystem;
+  namespace bip = boost::interprocess;
+
+  static fs::path GetCacheFilePath(const std::string &folder, uint64_t hash, const char *extension) {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << hash << extension;
+    return fs::path(folder) / name.str();
+  }
+
+  /// Memory-map the file at @a path and pass its contents to @a deserialize.
+  template <typename DeserializeT>
+  static auto ReadFromCache(const fs::path &path, DeserializeT &&deserialize)
+      -> decltype(deserialize(nullptr, 0u)) {
+    boost::system::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec || (size == 0u)) {
+      return {};
+    }
+    try {
+      bip::file_mapping file(path.string().c_str(), bip::read_only);
+      bip::mapped_region region(file, bip::read_only);
+      return deserialize(
+          static_cast<const unsigned char *>(region.get_address()),
+          region.get_size());
+    } catch (const bip::interprocess_exception &e) {
+      log_warning("unable to read cache file", path.string(), ':', e.what());
+      return {};
+    }
+  }
+
+  static void WriteToCache(const fs::path &path, const std::vector<unsigned char> &buffer) {
+    boost::system::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    if (ec) {
+      log_warning("unable to create map cache folder", path.parent_path().string(), ':', ec.message());
+      return;
+    }
+    // Write to a temporary file and rename it afterwards, other clients never
+    // see a partially written file.
+    const auto temp = fs::unique_path(path.string() + ".%%%%-%%%%-%%%%.tmp", ec);
+    if (ec) {
+      return;
+    }
+    {
+      std::ofstream file(temp.string(), std::ios::binary);
+      file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+      if (!file) {
+        log_warning("unable to write cache file", temp.string());
+        file.close();
+        fs::remove(temp, ec);
+        return;
+      }
+    }
+    fs::rename(temp, path, ec);
+    if (ec) {
+      fs::remove(temp, ec);
+    }
+  }
+
+  std::string MapCache::GetFolder() {
+    const char *folder = std::getenv("CARLA_MAP_CACHE_FOLDER");
+    if (folder != nullptr) {
+      return folder;
+    }
+    boost::system::error_code ec;
+    const auto temp = fs::temp_directory_path(ec);
+    if (ec) {
+      return {};
+    }
+    return (temp / "carla" / "map_cache").string();
+  }
+
+  boost::optional<road::Map> MapCache::Load(const std::string &opendrive) {
+    const auto folder = GetFolder();
+    if (folder.empty()) {
+      return opendrive::OpenDriveParser::Load(opendrive);
+    }
+    const auto hash = road::MapSerializer::ComputeHash(opendrive);
+    const auto path = GetCacheFilePath(folder, hash, ".bin");
+    auto map = ReadFromCache(path, [hash](const unsigned char *data, size_t size) {
+      return road::MapSerializer::Deserialize(data, size, hash);
+    });
+    if (!map.has_value()) {
+      map = opendrive::OpenDriveParser::Load(opendrive);
+      if (map.has_value()) {
+        WriteToCache(path, road::MapSerializer::Serialize(*map, hash));
+      }
+    }
+    return map;
+  }
+
+  road::RouteHierarchy MapCache::LoadRouteHierarchy(
+      const std::string &opendrive,
+      const road::RoutePlanner &planner) {
+    const auto folder = GetFolder();
+    if (folder.empty()) {
+      return road::RouteHierarchy(planner);
+    }
+    const auto hash = road::MapSerializer::ComputeHash(opendrive);
+    const auto path = GetCacheFilePath(folder, hash, ".routes.bin");
+    auto hierarchy = ReadFromCache(path, [&planner, hash](const unsigned char *data, size_t size) {
+      return road::RouteHierarchy::Deserialize(planner, data, size, hash);
+    });
+    if (!hierarchy.has_value()) {
+      hierarchy = road::RouteHierarchy(planner);
+      WriteToCache(path, hierarchy->Serialize(hash));
+    }
+    return std::move(*hierarchy);
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
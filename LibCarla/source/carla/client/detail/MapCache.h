@@ -0,0 +1,55 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/Map.h"
+#include "carla/road/RouteHierarchy.h"
+#include "carla/road/RoutePlanner.h"
+
+#include <boost/optional.hpp>
+
+#include <string>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  /// Keeps on disk the maps generated from OpenDRIVE files, serialized with
+  /// road::MapSerializer, so clients connecting to the same map do not need
+  /// to parse the OpenDRIVE file again.
+  ///
+  /// Each map is stored in a file named after the hash of its OpenDRIVE
+  /// contents; cache files are replaced atomically so several clients can
+  /// share the same folder. The route hierarchies of the maps, see
+  /// road::RouteHierarchy, are stored next to them.
+  ///
+  /// @warning Using this file requires linking against boost_filesystem.
+  class MapCache {
+  public:
+
+    /// Folder where maps are cached. Defaults to "carla/map_cache" inside the
+    /// temporary directory of the system, it can be changed with the
+    /// environment variable CARLA_MAP_CACHE_FOLDER. Setting that variable to
+    /// an empty string disables the cache.
+    static std::string GetFolder();
+
+    /// Return the map described by @a opendrive. The map is loaded from the
+    /// cache if available, otherwise the OpenDRIVE is parsed and the result
+    /// stored in the cache for the next time.
+    static boost::optional<road::Map> Load(const std::string &opendrive);
+
+    /// Return the route hierarchy of @a planner, built from the map described
+    /// by @a opendrive. The hierarchy is loaded from the cache if available,
+    /// otherwise it is built and stored in the cache for the next time.
+    static road::RouteHierarchy LoadRouteHierarchy(
+        const std::string &opendrive,
+        const road::RoutePlanner &planner);
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -18,6 +18,7 @@
 #include "carla/client/detail/ActorFactory.h"
 #include "carla/sensor/Deserializer.h"
 
+#include <chrono>
 #include <exception>
 #include <thread>
 
@@ -43,8 +44,15 @@ namespace detail {
     }
   }
 
-  static void SynchronizeFrame(uint64_t frame, const Episode &episode) {
+  /// Wait until the state of @a frame has been received, throws
+  /// TimeoutException after the network timeout of @a client.
+  static void SynchronizeFrame(uint64_t frame, const Episode &episode, const Client &client) {
+    const auto timeout = client.GetTimeout();
+    const auto deadline = std::chrono::steady_clock::now() + timeout.to_chrono();
     while (frame > episode.GetState()->GetTimestamp().frame) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        throw_exception(TimeoutException(client.GetEndpoint(), timeout));
+      }
       std::this_thread::yield();
     }
   }
@@ -118,7 +126,7 @@ namespace detail {
   uint64_t Simulator::Tick() {
     DEBUG_ASSERT(_episode != nullptr);
     const auto frame = _client.SendTickCue();
-    SynchronizeFrame(frame, *_episode);
+    SynchronizeFrame(frame, *_episode, _client);
     RELEASE_ASSERT(frame == _episode->GetState()->GetTimestamp().frame);
     return frame;
   }
@@ -143,7 +151,7 @@ namespace detail {
           "recommended to set 'fixed_delta_seconds' when running on synchronous mode.");
     }
     const auto frame = _client.SetEpisodeSettings(settings);
-    SynchronizeFrame(frame, *_episode);
+    SynchronizeFrame(frame, *_episode, _client);
     return frame;
   }
 
@@ -132,6 +132,10 @@ namespace detail {
       return _client.GetServerVersion();
     }
 
+    streaming::detail::tcp::SessionStatistics GetStreamingStatistics() {
+      return _client.GetStreamingStatistics();
+    }
+
     /// @}
     // =========================================================================
     /// @name Tick
@@ -150,6 +154,21 @@ namespace detail {
       _episode->RemoveOnTickEvent(id);
     }
 
+    void SetTickWorkerThreads(size_t worker_threads) {
+      DEBUG_ASSERT(_episode != nullptr);
+      _episode->SetTickWorkerThreads(worker_threads);
+    }
+
+    size_t GetTickWorkerThreads() const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetTickWorkerThreads();
+    }
+
+    std::vector<TickCallbackStatistics> GetOnTickStatistics() const {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->GetOnTickStatistics();
+    }
+
     uint64_t Tick();
 
     /// @}
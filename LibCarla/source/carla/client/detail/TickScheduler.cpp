@@ -0,0 +1,233 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/TickScheduler.h"
+
+#include "carla/Logging.h"
+#include "carla/StopWatch.h"
+#include "carla/ThreadPool.h"
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  // ===========================================================================
+  // -- TickScheduler::Entry ---------------------------------------------------
+  // ===========================================================================
+
+  struct TickScheduler::Entry {
+    Entry(size_t id, CallbackType &&callback_)
+      : callback(std::move(callback_)) {
+      statistics.id = id;
+    }
+
+    const CallbackType callback;
+
+    std::atomic_bool removed{false};
+
+    std::mutex mutex;
+
+    /// Newest tick not yet passed to the callback, if any.
+    InputType pending;
+
+    /// Frame of the newest tick received, ticks may arrive out of order.
+    boost::optional<uint64_t> newest_frame;
+
+    /// Whether a worker thread is running the pending ticks.
+    bool scheduled = false;
+
+    TickCallbackStatistics statistics;
+  };
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  template <typename EntryT, typename InputT>
+  static void Invoke(EntryT &entry, const InputT &input) {
+    StopWatch stop_watch;
+    bool failed = true;
+    try {
+      entry.callback(input);
+      failed = false;
+    } catch (const std::exception &e) {
+      log_error("exception in tick callback", entry.statistics.id, ':', e.what());
+    } catch (...) {
+      log_error("unknown exception in tick callback", entry.statistics.id);
+    }
+    const auto elapsed = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    std::lock_guard<std::mutex> lock(entry.mutex);
+    auto &statistics = entry.statistics;
+    ++statistics.calls;
+    if (failed) {
+      ++statistics.exceptions;
+    }
+    statistics.last_frame = input->GetFrame();
+    statistics.last_microseconds = elapsed;
+    statistics.max_microseconds = std::max(statistics.max_microseconds, elapsed);
+    statistics.total_microseconds += elapsed;
+  }
+
+  // ===========================================================================
+  // -- TickScheduler ----------------------------------------------------------
+  // ===========================================================================
+
+  TickScheduler::TickScheduler(const size_t worker_threads) {
+    SetWorkerThreads(worker_threads);
+  }
+
+  TickScheduler::~TickScheduler() {
+    std::lock_guard<std::mutex> lock(_pool_mutex);
+    _pool.reset();
+  }
+
+  void TickScheduler::SetWorkerThreads(const size_t worker_threads) {
+    std::unique_ptr<ThreadPool> previous;
+    {
+      std::lock_guard<std::mutex> lock(_pool_mutex);
+      if (worker_threads == _worker_threads) {
+        return;
+      }
+      previous = std::move(_pool);
+      if (worker_threads > 0u) {
+        _pool = std::make_unique<ThreadPool>();
+        _pool->AsyncRun(worker_threads);
+      }
+      _worker_threads = worker_threads;
+    }
+    if (previous == nullptr) {
+      return;
+    }
+    // Joins the previous threads; the ticks they did not get to run are still
+    // pending.
+    previous.reset();
+    for (const auto &item : *_list.Load()) {
+      bool reschedule;
+      {
+        std::lock_guard<std::mutex> lock(item.entry->mutex);
+        reschedule = item.entry->scheduled && (item.entry->pending != nullptr);
+        if (!reschedule) {
+          item.entry->scheduled = false;
+        }
+      }
+      if (reschedule) {
+        Post(item.entry);
+      }
+    }
+  }
+
+  size_t TickScheduler::GetWorkerThreads() const {
+    std::lock_guard<std::mutex> lock(_pool_mutex);
+    return _worker_threads;
+  }
+
+  void TickScheduler::Call(const InputType &input) {
+    DEBUG_ASSERT(input != nullptr);
+    auto list = _list.Load();
+    if (GetWorkerThreads() == 0u) {
+      for (const auto &item : *list) {
+        Invoke(*item.entry, input);
+      }
+      return;
+    }
+    for (const auto &item : *list) {
+      auto &entry = *item.entry;
+      bool post = false;
+      {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        const auto frame = input->GetFrame();
+        if (entry.newest_frame.has_value() && (frame <= *entry.newest_frame)) {
+          ++entry.statistics.dropped;
+          continue;
+        }
+        if (entry.pending != nullptr) {
+          ++entry.statistics.dropped;
+        }
+        entry.pending = input;
+        entry.newest_frame = frame;
+        if (!entry.scheduled) {
+          entry.scheduled = true;
+          post = true;
+        }
+      }
+      if (post) {
+        Post(item.entry);
+      }
+    }
+  }
+
+  size_t TickScheduler::Push(CallbackType &&callback) {
+    auto id = ++_counter;
+    DEBUG_ASSERT(id != 0u);
+    _list.Push(Item{id, std::make_shared<Entry>(id, std::move(callback))});
+    return id;
+  }
+
+  void TickScheduler::Remove(const size_t id) {
+    for (const auto &item : *_list.Load()) {
+      if (item.id == id) {
+        item.entry->removed = true;
+      }
+    }
+    _list.DeleteByValue(id);
+  }
+
+  void TickScheduler::Clear() {
+    for (const auto &item : *_list.Load()) {
+      item.entry->removed = true;
+    }
+    _list.Clear();
+  }
+
+  std::vector<TickCallbackStatistics> TickScheduler::GetStatistics() const {
+    auto list = _list.Load();
+    std::vector<TickCallbackStatistics> result;
+    result.reserve(list->size());
+    for (const auto &item : *list) {
+      std::lock_guard<std::mutex> lock(item.entry->mutex);
+      result.emplace_back(item.entry->statistics);
+      result.back().pending = (item.entry->pending != nullptr) ? 1u : 0u;
+    }
+    return result;
+  }
+
+  void TickScheduler::RunPending(Entry &entry) {
+    for (;;) {
+      InputType input;
+      {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        if (entry.removed || (entry.pending == nullptr)) {
+          entry.pending = nullptr;
+          entry.scheduled = false;
+          return;
+        }
+        input = std::move(entry.pending);
+        entry.pending = nullptr;
+      }
+      Invoke(entry, input);
+    }
+  }
+
+  void TickScheduler::Post(std::shared_ptr<Entry> entry) {
+    {
+      std::lock_guard<std::mutex> lock(_pool_mutex);
+      if (_pool != nullptr) {
+        _pool->Post([entry=std::move(entry)]() { RunPending(*entry); });
+        return;
+      }
+    }
+    // The worker threads were removed in the meantime.
+    RunPending(*entry);
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -0,0 +1,128 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/AtomicList.h"
+#include "carla/NonCopyable.h"
+#include "carla/client/detail/EpisodeState.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+
+  class ThreadPool;
+
+namespace client {
+
+  /// Calls and time spent by a callback registered to be called on every
+  /// world tick.
+  struct TickCallbackStatistics {
+    size_t id = 0u;
+    /// Number of calls completed.
+    size_t calls = 0u;
+    /// Number of ticks received and not yet passed to the callback, at most
+    /// one.
+    size_t pending = 0u;
+    /// Number of ticks never passed to the callback because a newer one was
+    /// received before it could be called.
+    size_t dropped = 0u;
+    /// Number of calls that threw an exception.
+    size_t exceptions = 0u;
+    /// Frame of the last call completed.
+    uint64_t last_frame = 0u;
+    size_t last_microseconds = 0u;
+    size_t max_microseconds = 0u;
+    size_t total_microseconds = 0u;
+  };
+
+namespace detail {
+
+  /// Calls the callbacks registered to be called on every world tick.
+  ///
+  /// Without worker threads, the callbacks are called one after the other in
+  /// the thread that received the tick. With worker threads, each callback is
+  /// called in a pool of threads shared by all the callbacks, so a slow
+  /// callback does not delay the others; calls to the same callback never
+  /// overlap and their frames always increase. A callback that falls behind
+  /// is only called with the newest tick received, the older ones it has not
+  /// been called with yet are dropped.
+  class TickScheduler : private NonCopyable {
+  public:
+
+    using InputType = std::shared_ptr<const EpisodeState>;
+
+    using CallbackType = std::function<void(InputType)>;
+
+    explicit TickScheduler(size_t worker_threads = 0u);
+
+    ~TickScheduler();
+
+    /// Change the number of worker threads, zero to call the callbacks in the
+    /// thread that received the tick. Ticks queued in the previous worker
+    /// threads are moved to the new ones.
+    ///
+    /// @warning Blocks until the callbacks running in the previous worker
+    /// threads return, do not call it from a callback.
+    void SetWorkerThreads(size_t worker_threads);
+
+    size_t GetWorkerThreads() const;
+
+    void Call(const InputType &input);
+
+    size_t Push(CallbackType &&callback);
+
+    /// Remove a callback, its pending tick is discarded.
+    void Remove(size_t id);
+
+    void Clear();
+
+    std::vector<TickCallbackStatistics> GetStatistics() const;
+
+  private:
+
+    struct Entry;
+
+    struct Item {
+      size_t id;
+      std::shared_ptr<Entry> entry;
+
+      friend bool operator==(const Item &lhs, const Item &rhs) {
+        return lhs.id == rhs.id;
+      }
+
+      friend bool operator==(const Item &lhs, size_t rhs) {
+        return lhs.id == rhs;
+      }
+
+      friend bool operator==(size_t lhs, const Item &rhs) {
+        return lhs == rhs.id;
+      }
+    };
+
+    /// Run the pending tick of @a entry until none is left.
+    static void RunPending(Entry &entry);
+
+    void Post(std::shared_ptr<Entry> entry);
+
+    std::atomic_size_t _counter{0u};
+
+    AtomicList<Item> _list;
+
+    mutable std::mutex _pool_mutex;
+
+    std::unique_ptr<ThreadPool> _pool;
+
+    size_t _worker_threads = 0u;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -0,0 +1,383 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/ColumnarRecording.h"
+
+#include "carla/BinaryStream.h"
+#include "carla/Exception.h"
+#include "carla/recorder/ForEachRange.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace carla {
+namespace recorder {
+
+  constexpr uint32_t ActorColumns::NO_FRAME;
+
+  constexpr size_t ColumnarRecording::DEFAULT_FRAMES_PER_CHUNK;
+
+  /// "CRCL" in little-endian.
+  static constexpr uint32_t MAGIC = 0x4c435243u;
+
+  static constexpr uint32_t FORMAT_VERSION = 1u;
+
+  /// Offset of the actor table and magic number.
+  static constexpr size_t FOOTER_SIZE = sizeof(uint64_t) + sizeof(uint32_t);
+
+  /// Frames read at once from the recording.
+  static constexpr size_t FRAMES_PER_RANGE = 64u;
+
+  // ===========================================================================
+  // -- Columns ----------------------------------------------------------------
+  // ===========================================================================
+
+  static void WriteColumns(BinaryWriter &out, const PositionColumns &columns) {
+    out.WriteCount(columns.size());
+    out.WriteArray(columns.frame);
+    out.WriteArray(columns.location);
+    out.WriteArray(columns.rotation);
+  }
+
+  static void ReadColumns(BinaryReader &in, PositionColumns &columns) {
+    const auto count = in.ReadCount();
+    in.ReadArray(count, columns.frame);
+    in.ReadArray(count, columns.location);
+    in.ReadArray(count, columns.rotation);
+  }
+
+  static void WriteColumns(BinaryWriter &out, const VehicleControlColumns &columns) {
+    out.WriteCount(columns.size());
+    out.WriteArray(columns.frame);
+    out.WriteArray(columns.steering);
+    out.WriteArray(columns.throttle);
+    out.WriteArray(columns.brake);
+    out.WriteArray(columns.handbrake);
+    out.WriteArray(columns.gear);
+  }
+
+  static void ReadColumns(BinaryReader &in, VehicleControlColumns &columns) {
+    const auto count = in.ReadCount();
+    in.ReadArray(count, columns.frame);
+    in.ReadArray(count, columns.steering);
+    in.ReadArray(count, columns.throttle);
+    in.ReadArray(count, columns.brake);
+    in.ReadArray(count, columns.handbrake);
+    in.ReadArray(count, columns.gear);
+  }
+
+  static void WriteColumns(BinaryWriter &out, const WalkerColumns &columns) {
+    out.WriteCount(columns.size());
+    out.WriteArray(columns.frame);
+    out.WriteArray(columns.speed);
+  }
+
+  static void ReadColumns(BinaryReader &in, WalkerColumns &columns) {
+    const auto count = in.ReadCount();
+    in.ReadArray(count, columns.frame);
+    in.ReadArray(count, columns.speed);
+  }
+
+  static void WriteColumns(BinaryWriter &out, const TrafficLightColumns &columns) {
+    out.WriteCount(columns.size());
+    out.WriteArray(columns.frame);
+    out.WriteArray(columns.state);
+    out.WriteArray(columns.is_frozen);
+    out.WriteArray(columns.elapsed_time);
+  }
+
+  static void ReadColumns(BinaryReader &in, TrafficLightColumns &columns) {
+    const auto count = in.ReadCount();
+    in.ReadArray(count, columns.frame);
+    in.ReadArray(count, columns.state);
+    in.ReadArray(count, columns.is_frozen);
+    in.ReadArray(count, columns.elapsed_time);
+  }
+
+  static bool AreValidFrames(const std::vector<uint32_t> &frames, const size_t number_of_frames) {
+    return std::all_of(frames.begin(), frames.end(), [=](uint32_t frame) { return frame < number_of_frames; });
+  }
+
+  // ===========================================================================
+  // -- Export -----------------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    /// Writes the chunks of a columnar file as the frames arrive.
+    class ChunkWriter {
+    public:
+
+      ChunkWriter(const std::string &path, const Info &info, const size_t frames_per_chunk)
+        : _path(path),
+          _file(path, std::ios::binary),
+          _frames_per_chunk(frames_per_chunk) {
+        BinaryWriter out;
+        out.Write(MAGIC);
+        out.Write(FORMAT_VERSION);
+        out.Write(info.version);
+        out.Write(static_cast<int64_t>(info.date));
+        out.Write(info.map);
+        out.WriteCount(frames_per_chunk);
+        Write(out);
+      }
+
+      void Add(const FrameRange &range) {
+        for (auto i = 0u; i < range.frames.size(); ++i) {
+          const auto frame = static_cast<uint32_t>(range.first + i);
+          _frames.emplace_back(range.frames[i]);
+          for (auto &event : range.actors_added.GetFrame(i)) {
+            auto &actor = _actors[event.database_id];
+            actor.id = event.database_id;
+            actor.type = event.type;
+            actor.type_id = event.description.id;
+            actor.added_frame = frame;
+          }
+          for (auto &event : range.actors_removed.GetFrame(i)) {
+            auto &actor = _actors[event.database_id];
+            actor.id = event.database_id;
+            actor.removed_frame = frame;
+          }
+          for (auto &position : range.positions.GetFrame(i)) {
+            _chunk[position.database_id].positions.emplace_back(frame, position);
+          }
+          for (auto &animation : range.vehicle_animations.GetFrame(i)) {
+            _chunk[animation.database_id].vehicle_controls.emplace_back(frame, animation);
+          }
+          for (auto &animation : range.walker_animations.GetFrame(i)) {
+            _chunk[animation.database_id].walker.emplace_back(frame, animation);
+          }
+          for (auto &light : range.traffic_lights.GetFrame(i)) {
+            _chunk[light.database_id].traffic_light.emplace_back(frame, light);
+          }
+          if (_frames.size() >= _frames_per_chunk) {
+            Flush(frame + 1u);
+          }
+        }
+      }
+
+      /// Write the last chunk and the actor table.
+      void Close(const size_t number_of_frames) {
+        Flush(number_of_frames);
+        std::vector<uint32_t> ids;
+        ids.reserve(_actors.size());
+        for (auto &item : _actors) {
+          ids.emplace_back(item.first);
+        }
+        std::sort(ids.begin(), ids.end());
+
+        BinaryWriter out;
+        out.WriteCount(ids.size());
+        for (auto id : ids) {
+          const auto &actor = _actors[id];
+          out.Write(id);
+          out.Write(actor.type);
+          out.Write(actor.type_id);
+          out.Write(actor.added_frame);
+          out.Write(actor.removed_frame);
+        }
+        out.Write(static_cast<uint64_t>(_offset));
+        out.Write(MAGIC);
+        Write(out);
+        _file.close();
+        if (!_file) {
+          throw_exception(std::runtime_error(_path + ": cannot write columnar recording"));
+        }
+      }
+
+    private:
+
+      /// Write the frames buffered, @a end is the position after the last one.
+      void Flush(const size_t end) {
+        if (_frames.size() == 0u) {
+          return;
+        }
+        std::vector<uint32_t> ids;
+        ids.reserve(_chunk.size());
+        for (auto &item : _chunk) {
+          ids.emplace_back(item.first);
+          // Actors with samples but never added are listed too.
+          _actors[item.first].id = item.first;
+        }
+        std::sort(ids.begin(), ids.end());
+
+        BinaryWriter out;
+        out.WriteCount(end - _frames.size());
+        out.WriteCount(_frames.size());
+        out.WriteArray(_frames.id);
+        out.WriteArray(_frames.elapsed);
+        out.WriteArray(_frames.duration);
+        out.WriteCount(ids.size());
+        for (auto id : ids) {
+          const auto &columns = _chunk[id];
+          out.Write(id);
+          WriteColumns(out, columns.positions);
+          WriteColumns(out, columns.vehicle_controls);
+          WriteColumns(out, columns.walker);
+          WriteColumns(out, columns.traffic_light);
+        }
+        Write(out);
+        _frames.clear();
+        _chunk.clear();
+      }
+
+      void Write(BinaryWriter &out) {
+        const auto &buffer = out.buffer();
+        _file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        if (!_file) {
+          throw_exception(std::runtime_error(_path + ": cannot write columnar recording"));
+        }
+        _offset += buffer.size();
+      }
+
+      const std::string &_path;
+
+      std::ofstream _file;
+
+      const size_t _frames_per_chunk;
+
+      size_t _offset = 0u;
+
+      FrameColumns _frames;
+
+      /// Samples of the current chunk.
+      std::unordered_map<uint32_t, ActorColumns> _chunk;
+
+      /// Types of the actors, without samples.
+      std::unordered_map<uint32_t, ActorColumns> _actors;
+    };
+
+  } // namespace
+
+  void ColumnarRecording::Export(
+      const Recording &recording,
+      const std::string &path,
+      const size_t frames_per_chunk,
+      const size_t worker_threads) {
+    constexpr uint32_t packets =
+        PacketMask(PacketId::EventAdd) |
+        PacketMask(PacketId::EventDel) |
+        PacketMask(PacketId::Position) |
+        PacketMask(PacketId::State) |
+        PacketMask(PacketId::AnimVehicle) |
+        PacketMask(PacketId::AnimWalker);
+    ChunkWriter writer(path, recording.GetInfo(), std::max(frames_per_chunk, size_t(1u)));
+    ForEachRange(recording, FRAMES_PER_RANGE, packets, worker_threads, [&](FrameRange range) {
+      writer.Add(range);
+    });
+    writer.Close(recording.GetNumberOfFrames());
+  }
+
+  // ===========================================================================
+  // -- Load -------------------------------------------------------------------
+  // ===========================================================================
+
+  ColumnarRecording::ColumnarRecording(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      throw_exception(std::runtime_error(path + ": cannot open columnar recording"));
+    }
+    const std::vector<unsigned char> data{
+        std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>()};
+    auto fail = [&]() {
+      throw_exception(std::runtime_error(path + " is not a valid columnar recording"));
+    };
+
+    if (data.size() < FOOTER_SIZE) {
+      fail();
+    }
+    BinaryReader footer(data.data() + data.size() - FOOTER_SIZE, FOOTER_SIZE);
+    const auto table_offset = footer.Read<uint64_t>();
+    if ((footer.Read<uint32_t>() != MAGIC) || (table_offset > data.size() - FOOTER_SIZE)) {
+      fail();
+    }
+
+    // Header and chunks.
+    BinaryReader in(data.data(), static_cast<size_t>(table_offset));
+    if ((in.Read<uint32_t>() != MAGIC) || (in.Read<uint32_t>() != FORMAT_VERSION)) {
+      fail();
+    }
+    _info.version = in.Read<uint16_t>();
+    _info.date = static_cast<std::time_t>(in.Read<int64_t>());
+    _info.map = in.ReadString();
+    in.Read<uint32_t>();
+    std::unordered_map<uint32_t, ActorColumns> actors;
+    while ((in.Remaining() > 0u) && !in.Failed()) {
+      if (in.Read<uint32_t>() != _frames.size()) {
+        // Chunks must follow each other.
+        in.Fail();
+      }
+      const auto count = in.ReadCount();
+      in.ReadArray(count, _frames.id);
+      in.ReadArray(count, _frames.elapsed);
+      in.ReadArray(count, _frames.duration);
+      const auto number_of_actors = in.ReadCount();
+      for (auto i = 0u; (i < number_of_actors) && !in.Failed(); ++i) {
+        auto &actor = actors[in.Read<uint32_t>()];
+        ReadColumns(in, actor.positions);
+        ReadColumns(in, actor.vehicle_controls);
+        ReadColumns(in, actor.walker);
+        ReadColumns(in, actor.traffic_light);
+      }
+      ++_number_of_chunks;
+    }
+    if (in.Failed()) {
+      fail();
+    }
+
+    // Actor table.
+    BinaryReader table(data.data() + table_offset, data.size() - FOOTER_SIZE - table_offset);
+    const auto number_of_actors = table.ReadCount();
+    _actors.reserve(number_of_actors);
+    size_t actors_with_samples = 0u;
+    for (auto i = 0u; (i < number_of_actors) && !table.Failed(); ++i) {
+      const auto id = table.Read<uint32_t>();
+      auto it = actors.find(id);
+      if (it != actors.end()) {
+        _actors.emplace_back(std::move(it->second));
+        ++actors_with_samples;
+      } else {
+        _actors.emplace_back();
+      }
+      auto &actor = _actors.back();
+      actor.id = id;
+      actor.type = table.Read<ActorType>();
+      actor.type_id = table.ReadString();
+      actor.added_frame = table.Read<uint32_t>();
+      actor.removed_frame = table.Read<uint32_t>();
+    }
+    const auto number_of_frames = _frames.size();
+    const bool valid = !table.Failed() &&
+        (_frames.elapsed.size() == number_of_frames) &&
+        (_frames.duration.size() == number_of_frames) &&
+        std::is_sorted(_actors.begin(), _actors.end(), [](const auto &lhs, const auto &rhs) {
+          return lhs.id < rhs.id;
+        }) &&
+        std::all_of(_actors.begin(), _actors.end(), [=](const ActorColumns &actor) {
+          return AreValidFrames(actor.positions.frame, number_of_frames) &&
+                 AreValidFrames(actor.vehicle_controls.frame, number_of_frames) &&
+                 AreValidFrames(actor.walker.frame, number_of_frames) &&
+                 AreValidFrames(actor.traffic_light.frame, number_of_frames);
+        });
+    // Every actor with samples must be in the table.
+    if (!valid || (actors_with_samples != actors.size())) {
+      fail();
+    }
+  }
+
+  const ActorColumns *ColumnarRecording::GetActor(const uint32_t id) const {
+    auto it = std::lower_bound(_actors.begin(), _actors.end(), id, [](const auto &actor, uint32_t value) {
+      return actor.id < value;
+    });
+    return ((it != _actors.end()) && (it->id == id)) ? &*it : nullptr;
+  }
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,82 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/recorder/Columns.h"
+#include "carla/recorder/Recording.h"
+
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// A recording converted to time series, one per actor, for analytics that
+  /// scan many frames of a few fields.
+  ///
+  /// The file is written in chunks of consecutive frames, each chunk holds
+  /// the frame times and the columns of every actor with samples in those
+  /// frames; the actor types follow the last chunk. Export streams the
+  /// recording, holding a single chunk in memory. Loading concatenates the
+  /// chunks into one contiguous time series per actor.
+  ///
+  /// Database ids are assumed unique within the recording, as the simulator
+  /// does not reuse them.
+  class ColumnarRecording {
+  public:
+
+    static constexpr size_t DEFAULT_FRAMES_PER_CHUNK = 1024u;
+
+    /// Convert @a recording into a columnar file at @a path. The frames are
+    /// read by @a worker_threads threads (0 for one per core).
+    ///
+    /// @throw std::runtime_error if the file cannot be written or the
+    /// recording is corrupt.
+    static void Export(
+        const Recording &recording,
+        const std::string &path,
+        size_t frames_per_chunk = DEFAULT_FRAMES_PER_CHUNK,
+        size_t worker_threads = 0u);
+
+    /// Load the columnar file at @a path.
+    ///
+    /// @throw std::runtime_error if it is not a valid columnar file.
+    explicit ColumnarRecording(const std::string &path);
+
+    const Info &GetInfo() const {
+      return _info;
+    }
+
+    const FrameColumns &GetFrames() const {
+      return _frames;
+    }
+
+    /// Actors sorted by id.
+    const std::vector<ActorColumns> &GetActors() const {
+      return _actors;
+    }
+
+    /// Return nullptr if there is no actor with @a id.
+    const ActorColumns *GetActor(uint32_t id) const;
+
+    size_t GetNumberOfChunks() const {
+      return _number_of_chunks;
+    }
+
+  private:
+
+    Info _info;
+
+    FrameColumns _frames;
+
+    std::vector<ActorColumns> _actors;
+
+    size_t _number_of_chunks = 0u;
+  };
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,247 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/recorder/Packets.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// The columns below store each field in its own contiguous array, the
+  /// i-th element of every array belongs to the i-th sample. The "frame"
+  /// column is the position of the sample's frame in the recording, an index
+  /// into FrameColumns.
+
+  namespace detail {
+
+    template <typename T>
+    inline void Append(std::vector<T> &dst, const std::vector<T> &src) {
+      dst.insert(dst.end(), src.begin(), src.end());
+    }
+
+  } // namespace detail
+
+  struct FrameColumns {
+
+    std::vector<uint64_t> id;
+
+    /// Seconds since the start of the recording.
+    std::vector<double> elapsed;
+
+    /// Seconds until the next frame.
+    std::vector<double> duration;
+
+    size_t size() const {
+      return id.size();
+    }
+
+    void clear() {
+      id.clear();
+      elapsed.clear();
+      duration.clear();
+    }
+
+    void emplace_back(const Frame &frame) {
+      id.emplace_back(frame.id);
+      elapsed.emplace_back(frame.elapsed);
+      duration.emplace_back(frame.duration);
+    }
+
+    void append(const FrameColumns &other) {
+      detail::Append(id, other.id);
+      detail::Append(elapsed, other.elapsed);
+      detail::Append(duration, other.duration);
+    }
+  };
+
+  struct PositionColumns {
+
+    std::vector<uint32_t> frame;
+
+    std::vector<geom::Location> location;
+
+    std::vector<geom::Rotation> rotation;
+
+    size_t size() const {
+      return frame.size();
+    }
+
+    void clear() {
+      frame.clear();
+      location.clear();
+      rotation.clear();
+    }
+
+    void emplace_back(uint32_t frame_index, const Position &position) {
+      frame.emplace_back(frame_index);
+      location.emplace_back(position.transform.location);
+      rotation.emplace_back(position.transform.rotation);
+    }
+
+    void append(const PositionColumns &other) {
+      detail::Append(frame, other.frame);
+      detail::Append(location, other.location);
+      detail::Append(rotation, other.rotation);
+    }
+  };
+
+  struct VehicleControlColumns {
+
+    std::vector<uint32_t> frame;
+
+    std::vector<float> steering;
+
+    std::vector<float> throttle;
+
+    std::vector<float> brake;
+
+    std::vector<uint8_t> handbrake;
+
+    std::vector<int32_t> gear;
+
+    size_t size() const {
+      return frame.size();
+    }
+
+    void clear() {
+      frame.clear();
+      steering.clear();
+      throttle.clear();
+      brake.clear();
+      handbrake.clear();
+      gear.clear();
+    }
+
+    void emplace_back(uint32_t frame_index, const VehicleAnimation &animation) {
+      frame.emplace_back(frame_index);
+      steering.emplace_back(animation.steering);
+      throttle.emplace_back(animation.throttle);
+      brake.emplace_back(animation.brake);
+      handbrake.emplace_back(animation.handbrake ? 1u : 0u);
+      gear.emplace_back(animation.gear);
+    }
+
+    void append(const VehicleControlColumns &other) {
+      detail::Append(frame, other.frame);
+      detail::Append(steering, other.steering);
+      detail::Append(throttle, other.throttle);
+      detail::Append(brake, other.brake);
+      detail::Append(handbrake, other.handbrake);
+      detail::Append(gear, other.gear);
+    }
+  };
+
+  struct WalkerColumns {
+
+    std::vector<uint32_t> frame;
+
+    std::vector<float> speed;
+
+    size_t size() const {
+      return frame.size();
+    }
+
+    void clear() {
+      frame.clear();
+      speed.clear();
+    }
+
+    void emplace_back(uint32_t frame_index, const WalkerAnimation &animation) {
+      frame.emplace_back(frame_index);
+      speed.emplace_back(animation.speed);
+    }
+
+    void append(const WalkerColumns &other) {
+      detail::Append(frame, other.frame);
+      detail::Append(speed, other.speed);
+    }
+  };
+
+  struct TrafficLightColumns {
+
+    std::vector<uint32_t> frame;
+
+    std::vector<uint8_t> state;
+
+    std::vector<uint8_t> is_frozen;
+
+    std::vector<float> elapsed_time;
+
+    size_t size() const {
+      return frame.size();
+    }
+
+    void clear() {
+      frame.clear();
+      state.clear();
+      is_frozen.clear();
+      elapsed_time.clear();
+    }
+
+    void emplace_back(uint32_t frame_index, const TrafficLightState &light) {
+      frame.emplace_back(frame_index);
+      state.emplace_back(light.state);
+      is_frozen.emplace_back(light.is_frozen ? 1u : 0u);
+      elapsed_time.emplace_back(light.elapsed_time);
+    }
+
+    void append(const TrafficLightColumns &other) {
+      detail::Append(frame, other.frame);
+      detail::Append(state, other.state);
+      detail::Append(is_frozen, other.is_frozen);
+      detail::Append(elapsed_time, other.elapsed_time);
+    }
+  };
+
+  /// Everything recorded of an actor, as time series.
+  struct ActorColumns {
+
+    /// Frame of the actors that were never added or removed.
+    static constexpr uint32_t NO_FRAME = std::numeric_limits<uint32_t>::max();
+
+    uint32_t id = 0u;
+
+    ActorType type = ActorType::Other;
+
+    std::string type_id;
+
+    /// Frame the actor was added.
+    uint32_t added_frame = NO_FRAME;
+
+    /// Frame the actor was removed.
+    uint32_t removed_frame = NO_FRAME;
+
+    PositionColumns positions;
+
+    VehicleControlColumns vehicle_controls;
+
+    WalkerColumns walker;
+
+    TrafficLightColumns traffic_light;
+
+    void clear() {
+      positions.clear();
+      vehicle_controls.clear();
+      walker.clear();
+      traffic_light.clear();
+    }
+
+    /// Append the samples of @a other.
+    void append(const ActorColumns &other) {
+      positions.append(other.positions);
+      vehicle_controls.append(other.vehicle_controls);
+      walker.append(other.walker);
+      traffic_light.append(other.traffic_light);
+    }
+  };
+
+} // namespace recorder
+} // namespace carla
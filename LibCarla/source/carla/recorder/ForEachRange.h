@@ -0,0 +1,141 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/ThreadGroup.h"
+#include "carla/recorder/Recording.h"
+
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// Read the frames of @a recording in ranges of @a frames_per_range frames,
+  /// several ranges in parallel, and call @a callback with each range in the
+  /// order of the frames. Only the @a packets are read, see
+  /// Recording::ReadFrames.
+  ///
+  /// The ranges are read by @a worker_threads threads while @a callback runs
+  /// in the calling thread. At most two ranges per worker are read ahead of
+  /// the one passed to @a callback, which bounds the memory used.
+  template <typename FunctorT>
+  inline void ForEachRange(
+      const Recording &recording,
+      const size_t frames_per_range,
+      const uint32_t packets,
+      size_t worker_threads,
+      FunctorT &&callback) {
+    const size_t size = recording.GetNumberOfFrames();
+    const size_t number_of_ranges = (size + frames_per_range - 1u) / frames_per_range;
+    if (worker_threads == 0u) {
+      worker_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    worker_threads = std::max(std::min(worker_threads, number_of_ranges), size_t(1u));
+
+    auto read_range = [&](const size_t range) {
+      const auto begin = range * frames_per_range;
+      return recording.ReadFrames(begin, std::min(begin + frames_per_range, size), packets);
+    };
+
+    if (worker_threads == 1u) {
+      for (auto range = 0u; range < number_of_ranges; ++range) {
+        callback(read_range(range));
+      }
+      return;
+    }
+
+    // Ranges read and not yet consumed, range i goes in queue[i % capacity].
+    const size_t capacity = 2u * worker_threads;
+    std::vector<boost::optional<FrameRange>> queue(capacity);
+    std::mutex mutex;
+    std::condition_variable read_condition;
+    std::condition_variable consumed_condition;
+    size_t next = 0u;
+    size_t consumed = 0u;
+    bool stop = false;
+    std::exception_ptr exception;
+
+    auto worker = [&]() {
+      for (;;) {
+        size_t range;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          consumed_condition.wait(lock, [&]() {
+            return stop || (next >= number_of_ranges) || (next < consumed + capacity);
+          });
+          if (stop || (next >= number_of_ranges)) {
+            return;
+          }
+          range = next++;
+        }
+        try {
+          auto frames = read_range(range);
+          std::lock_guard<std::mutex> lock(mutex);
+          queue[range % capacity] = std::move(frames);
+        } catch (...) {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!exception) {
+              exception = std::current_exception();
+            }
+            stop = true;
+          }
+          read_condition.notify_one();
+          consumed_condition.notify_all();
+          return;
+        }
+        read_condition.notify_one();
+      }
+    };
+
+    auto stop_workers = [&]() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      consumed_condition.notify_all();
+    };
+
+    ThreadGroup workers;
+    workers.CreateThreads(worker_threads, worker);
+    try {
+      while (consumed < number_of_ranges) {
+        FrameRange frames;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          auto &slot = queue[consumed % capacity];
+          read_condition.wait(lock, [&]() { return slot.has_value() || stop; });
+          if (!slot.has_value()) {
+            break;
+          }
+          frames = std::move(*slot);
+          slot.reset();
+          ++consumed;
+        }
+        consumed_condition.notify_one();
+        callback(std::move(frames));
+      }
+    } catch (...) {
+      stop_workers();
+      throw;
+    }
+    stop_workers();
+    workers.JoinAll();
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+} // namespace recorder
+} // namespace carla
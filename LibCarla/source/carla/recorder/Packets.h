@@ -0,0 +1,125 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Transform.h"
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// Types of the packets of a recording, see "recorder_binary_file_format.md".
+  enum class PacketId : uint8_t {
+    FrameStart = 0u,
+    FrameEnd,
+    EventAdd,
+    EventDel,
+    EventParent,
+    Collision,
+    Position,
+    State,
+    AnimVehicle,
+    AnimWalker,
+    Keyframe,
+    FrameIndex,
+    Block,
+
+    SIZE
+  };
+
+  /// Type of the actors as stored in the recording.
+  enum class ActorType : uint8_t {
+    Other = 0u,
+    Vehicle,
+    Walker,
+    TrafficLight
+  };
+
+  /// Header of the recording.
+  struct Info {
+    uint16_t version = 0u;
+    std::string magic;
+    std::time_t date = 0;
+    std::string map;
+  };
+
+  struct Frame {
+    uint64_t id = 0u;
+    /// Seconds until the next frame, negative for the last one.
+    double duration = 0.0;
+    /// Seconds since the start of the recording.
+    double elapsed = 0.0;
+  };
+
+  struct ActorAttribute {
+    uint8_t type = 0u;
+    std::string id;
+    std::string value;
+  };
+
+  struct ActorDescription {
+    uint32_t uid = 0u;
+    std::string id;
+    std::vector<ActorAttribute> attributes;
+  };
+
+  struct EventAdd {
+    uint32_t database_id = 0u;
+    ActorType type = ActorType::Other;
+    geom::Transform transform;
+    ActorDescription description;
+  };
+
+  struct EventDel {
+    uint32_t database_id = 0u;
+  };
+
+  struct EventParent {
+    uint32_t database_id = 0u;
+    uint32_t parent_id = 0u;
+  };
+
+  struct Collision {
+    uint32_t id = 0u;
+    uint32_t actor1 = 0u;
+    uint32_t actor2 = 0u;
+    bool is_actor1_hero = false;
+    bool is_actor2_hero = false;
+  };
+
+  struct Position {
+    uint32_t database_id = 0u;
+    geom::Transform transform;
+  };
+
+  struct TrafficLightState {
+    uint32_t database_id = 0u;
+    bool is_frozen = false;
+    float elapsed_time = 0.0f;
+    uint8_t state = 0u;
+  };
+
+  struct VehicleAnimation {
+    uint32_t database_id = 0u;
+    float steering = 0.0f;
+    float throttle = 0.0f;
+    float brake = 0.0f;
+    bool handbrake = false;
+    int32_t gear = 0;
+  };
+
+  struct WalkerAnimation {
+    uint32_t database_id = 0u;
+    float speed = 0.0f;
+  };
+
+} // namespace recorder
+} // namespace carla
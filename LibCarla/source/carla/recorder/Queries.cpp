@@ -0,0 +1,258 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/Queries.h"
+
+#include "carla/recorder/ForEachRange.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace carla {
+namespace recorder {
+
+  /// Categories of the queries by actor type: other, vehicle, walker and
+  /// traffic light.
+  static char GetCategory(const ActorType type) {
+    static constexpr char categories[] = {'o', 'v', 'w', 't'};
+    const auto index = static_cast<size_t>(type);
+    return index < sizeof(categories) ? categories[index] : 'o';
+  }
+
+  /// Sort by decreasing duration, then by time and id.
+  static void SortByDuration(std::vector<BlockedActorInfo> &blocked) {
+    std::sort(blocked.begin(), blocked.end(), [](const auto &lhs, const auto &rhs) {
+      if (lhs.duration != rhs.duration) {
+        return lhs.duration > rhs.duration;
+      }
+      return (lhs.time != rhs.time) ? (lhs.time < rhs.time) : (lhs.actor_id < rhs.actor_id);
+    });
+  }
+
+  static bool PassesFilter(const char filter, const char category, const bool is_hero) {
+    return (filter == 'a') || (filter == category) || ((filter == 'h') && is_hero);
+  }
+
+  // ===========================================================================
+  // -- Summary ----------------------------------------------------------------
+  // ===========================================================================
+
+  RecordingSummary Queries::Summary(const Recording &recording, const size_t worker_threads) {
+    RecordingSummary summary;
+    summary.info = recording.GetInfo();
+    summary.frames = recording.GetNumberOfFrames();
+    summary.keyframes = recording.GetNumberOfKeyframes();
+    summary.has_index = recording.HasIndex();
+    // Only the frames are needed, the records are counted.
+    ForEachRange(recording, Queries::FRAMES_PER_RANGE, 0u, worker_threads, [&](FrameRange range) {
+      for (auto i = 0u; i < summary.count.size(); ++i) {
+        summary.count[i] += range.count[i];
+      }
+      if (!range.frames.empty()) {
+        summary.duration = range.frames.back().elapsed;
+      }
+    });
+    summary.count[static_cast<size_t>(PacketId::Keyframe)] = summary.keyframes;
+    return summary;
+  }
+
+  // ===========================================================================
+  // -- Collisions -------------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    struct ActorInfo {
+      ActorType type = ActorType::Other;
+      std::string type_id;
+      geom::Location last_location;
+      double time = 0.0;
+      double duration = 0.0;
+    };
+
+    struct PairHash {
+      size_t operator()(const std::pair<uint32_t, uint32_t> &pair) const {
+        return (static_cast<size_t>(pair.first) << 32u) ^ pair.second;
+      }
+    };
+
+  } // namespace
+
+  std::vector<CollisionInfo> Queries::Collisions(
+      const Recording &recording,
+      const char category1,
+      const char category2,
+      const size_t worker_threads) {
+    constexpr uint32_t packets =
+        PacketMask(PacketId::EventAdd) |
+        PacketMask(PacketId::EventDel) |
+        PacketMask(PacketId::Collision);
+
+    std::vector<CollisionInfo> result;
+    std::unordered_map<uint32_t, ActorInfo> actors;
+    // Collisions of the previous frame, to report only those that start.
+    std::unordered_set<std::pair<uint32_t, uint32_t>, PairHash> previous, current;
+
+    ForEachRange(recording, Queries::FRAMES_PER_RANGE, packets, worker_threads, [&](FrameRange range) {
+      for (auto i = 0u; i < range.frames.size(); ++i) {
+        const auto &frame = range.frames[i];
+        std::swap(previous, current);
+        current.clear();
+        for (auto &event : range.actors_added.GetFrame(i)) {
+          auto &actor = actors[event.database_id];
+          actor.type = event.type;
+          actor.type_id = event.description.id;
+        }
+        for (auto &event : range.actors_removed.GetFrame(i)) {
+          actors.erase(event.database_id);
+        }
+        for (auto &collision : range.collisions.GetFrame(i)) {
+          const auto &actor1 = actors[collision.actor1];
+          const auto &actor2 = actors[collision.actor2];
+          const auto type1 = GetCategory(actor1.type);
+          const auto type2 = GetCategory(actor2.type);
+          if (!PassesFilter(category1, type1, collision.is_actor1_hero) ||
+              !PassesFilter(category2, type2, collision.is_actor2_hero)) {
+            continue;
+          }
+          const auto pair = std::make_pair(collision.actor1, collision.actor2);
+          if (previous.count(pair) == 0u) {
+            CollisionInfo info;
+            info.time = frame.elapsed;
+            info.frame = frame.id;
+            info.actor1 = collision.actor1;
+            info.category1 = type1;
+            info.type_id1 = actor1.type_id;
+            info.actor2 = collision.actor2;
+            info.category2 = type2;
+            info.type_id2 = actor2.type_id;
+            result.emplace_back(std::move(info));
+          }
+          current.insert(pair);
+        }
+      }
+    });
+    return result;
+  }
+
+  // ===========================================================================
+  // -- BlockedActors ----------------------------------------------------------
+  // ===========================================================================
+
+  std::vector<BlockedActorInfo> Queries::BlockedActors(
+      const Recording &recording,
+      const double min_time,
+      const double min_distance,
+      const size_t worker_threads) {
+    constexpr uint32_t packets =
+        PacketMask(PacketId::EventAdd) |
+        PacketMask(PacketId::EventDel) |
+        PacketMask(PacketId::Position);
+
+    std::vector<BlockedActorInfo> result;
+    std::unordered_map<uint32_t, ActorInfo> actors;
+
+    auto report = [&](const uint32_t id, const ActorInfo &actor) {
+      if (actor.duration >= min_time) {
+        result.emplace_back(BlockedActorInfo{actor.time, id, actor.type_id, actor.duration});
+      }
+    };
+
+    ForEachRange(recording, Queries::FRAMES_PER_RANGE, packets, worker_threads, [&](FrameRange range) {
+      for (auto i = 0u; i < range.frames.size(); ++i) {
+        const auto &frame = range.frames[i];
+        for (auto &event : range.actors_added.GetFrame(i)) {
+          auto &actor = actors[event.database_id];
+          actor = ActorInfo{};
+          actor.type = event.type;
+          actor.type_id = event.description.id;
+        }
+        for (auto &event : range.actors_removed.GetFrame(i)) {
+          actors.erase(event.database_id);
+        }
+        for (auto &position : range.positions.GetFrame(i)) {
+          auto &actor = actors[position.database_id];
+          if (actor.last_location.Distance(position.transform.location) < min_distance) {
+            // The actor is stopped.
+            if (actor.duration == 0.0) {
+              actor.time = frame.elapsed;
+            }
+            actor.duration += frame.duration;
+          } else {
+            // The actor moves again.
+            report(position.database_id, actor);
+            actor.duration = 0.0;
+            actor.last_location = position.transform.location;
+          }
+        }
+      }
+    });
+
+    // Actors that did not move again.
+    for (auto &actor : actors) {
+      report(actor.first, actor.second);
+    }
+
+    SortByDuration(result);
+    return result;
+  }
+
+  std::vector<BlockedActorInfo> Queries::BlockedActors(
+      const ColumnarRecording &recording,
+      const double min_time,
+      const double min_distance) {
+    const auto &elapsed = recording.GetFrames().elapsed;
+    const auto &durations = recording.GetFrames().duration;
+    std::vector<BlockedActorInfo> result;
+
+    for (const auto &actor : recording.GetActors()) {
+      const auto &frames = actor.positions.frame;
+      const auto &locations = actor.positions.location;
+      const size_t size = locations.size();
+      geom::Location anchor;
+      double time = 0.0;
+      double duration = 0.0;
+      auto report = [&]() {
+        if (duration >= min_time) {
+          result.emplace_back(BlockedActorInfo{time, actor.id, actor.type_id, duration});
+        }
+      };
+
+      size_t i = 0u;
+      while (i < size) {
+        // Skip the samples close to the anchor, the actor is stopped.
+        const size_t stopped = i;
+        while ((i < size) && (anchor.Distance(locations[i]) < min_distance)) {
+          ++i;
+        }
+        for (auto j = stopped; j < i; ++j) {
+          if (duration == 0.0) {
+            time = elapsed[frames[j]];
+          }
+          duration += durations[frames[j]];
+        }
+        if (i < size) {
+          // The actor moves again.
+          report();
+          duration = 0.0;
+          anchor = locations[i];
+          ++i;
+        }
+      }
+
+      // Actors removed are forgotten, as in the simulator's query.
+      if (actor.removed_frame == ActorColumns::NO_FRAME) {
+        report();
+      }
+    }
+
+    SortByDuration(result);
+    return result;
+  }
+
+} // namespace recorder
+} // namespace carla
@@ -0,0 +1,108 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/recorder/ColumnarRecording.h"
+#include "carla/recorder/Recording.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  struct RecordingSummary {
+    Info info;
+
+    size_t frames = 0u;
+
+    /// Seconds.
+    double duration = 0.0;
+
+    size_t keyframes = 0u;
+
+    bool has_index = false;
+
+    /// Number of records of each type of packet.
+    std::array<uint64_t, static_cast<size_t>(PacketId::SIZE)> count{};
+  };
+
+  struct CollisionInfo {
+    /// Seconds since the start of the recording.
+    double time = 0.0;
+
+    uint64_t frame = 0u;
+
+    uint32_t actor1 = 0u;
+
+    /// Category of the actor, see Queries::Collisions.
+    char category1 = 'o';
+
+    std::string type_id1;
+
+    uint32_t actor2 = 0u;
+
+    char category2 = 'o';
+
+    std::string type_id2;
+  };
+
+  struct BlockedActorInfo {
+    /// Seconds since the start of the recording when the actor stopped.
+    double time = 0.0;
+
+    uint32_t actor_id = 0u;
+
+    std::string type_id;
+
+    /// Seconds the actor was stopped.
+    double duration = 0.0;
+  };
+
+  /// Queries over a whole recording, the structured counterpart of the
+  /// simulator's "show_recorder_*" queries.
+  ///
+  /// The frames are read and decompressed in ranges by @a worker_threads
+  /// threads (0 for one per core), and the results are gathered in the order
+  /// of the frames.
+  class Queries {
+  public:
+
+    /// Number of frames each worker reads at once.
+    static constexpr size_t FRAMES_PER_RANGE = 64u;
+
+    static RecordingSummary Summary(const Recording &recording, size_t worker_threads = 0u);
+
+    /// Collisions between actors of @a category1 and @a category2, each being
+    /// 'o' (other), 'v' (vehicle), 'w' (walker), 't' (traffic light), 'h'
+    /// (hero) or 'a' (any). A collision lasting several frames is reported
+    /// only in the frame it starts.
+    static std::vector<CollisionInfo> Collisions(
+        const Recording &recording,
+        char category1 = 'a',
+        char category2 = 'a',
+        size_t worker_threads = 0u);
+
+    /// Actors that moved less than @a min_distance (meters) for at least
+    /// @a min_time seconds, sorted by decreasing duration, then by time.
+    static std::vector<BlockedActorInfo> BlockedActors(
+        const Recording &recording,
+        double min_time = 30.0,
+        double min_distance = 1.0,
+        size_t worker_threads = 0u);
+
+    /// Same as above, scanning the positions of each actor of a recording
+    /// exported with ColumnarRecording::Export.
+    static std::vector<BlockedActorInfo> BlockedActors(
+        const ColumnarRecording &recording,
+        double min_time = 30.0,
+        double min_distance = 1.0);
+  };
+
+} // namespace recorder
+} // namespace carla
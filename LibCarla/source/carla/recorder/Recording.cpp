@@ -0,0 +1,469 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/recorder/Recording.h"
+
+#include "carla/Exception.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <zlib.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace carla {
+namespace recorder {
+
+  namespace ipc = boost::interprocess;
+
+  /// Size of the header of every packet: its id and the size of its data.
+  static constexpr size_t PACKET_HEADER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
+
+  /// Size of the footer at the end of a file holding a frame index: offset
+  /// of the index, size of the recording and magic string.
+  static constexpr size_t INDEX_FOOTER_SIZE = 3u * sizeof(uint64_t);
+
+  static constexpr char INDEX_MAGIC[] = "CRINDEX1";
+
+  static constexpr char RECORDING_MAGIC[] = "CARLA_RECORDER";
+
+  /// The simulator records in centimeters.
+  static constexpr float TO_METERS = 1e-2f;
+
+  /// Compression of the blocks of compressed recordings.
+  static constexpr uint8_t BLOCK_COMPRESSION_ZLIB = 1u;
+
+  struct Recording::Mapping {
+    Mapping(const std::string &path)
+      : file(path.c_str(), ipc::read_only),
+        region(file, ipc::read_only) {}
+
+    ipc::file_mapping file;
+
+    ipc::mapped_region region;
+  };
+
+  // ===========================================================================
+  // -- PacketReader -----------------------------------------------------------
+  // ===========================================================================
+
+  /// Reads the records of a span of bytes, throwing if they go past its end.
+  class PacketReader {
+  public:
+
+    PacketReader(const unsigned char *begin, const unsigned char *end)
+      : _it(begin),
+        _end(end) {}
+
+    size_t GetRemaining() const {
+      return static_cast<size_t>(_end - _it);
+    }
+
+    const unsigned char *GetPosition() const {
+      return _it;
+    }
+
+    const unsigned char *Take(const size_t size) {
+      if (size > GetRemaining()) {
+        throw_exception(std::runtime_error("recorder packet out of bounds"));
+      }
+      const auto *result = _it;
+      _it += size;
+      return result;
+    }
+
+    /// Take the data of the next packet.
+    PacketReader TakePacket(const size_t size) {
+      const auto *data = Take(size);
+      return PacketReader{data, data + size};
+    }
+
+    template <typename T>
+    T Read() {
+      T value;
+      std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+      return value;
+    }
+
+    std::string ReadString() {
+      const auto length = Read<uint16_t>();
+      return std::string(reinterpret_cast<const char *>(Take(length)), length);
+    }
+
+    geom::Location ReadLocation() {
+      const auto x = Read<float>();
+      const auto y = Read<float>();
+      const auto z = Read<float>();
+      return {TO_METERS * x, TO_METERS * y, TO_METERS * z};
+    }
+
+    /// Rotations are stored as roll, pitch and yaw.
+    geom::Rotation ReadRotation() {
+      const auto roll = Read<float>();
+      const auto pitch = Read<float>();
+      const auto yaw = Read<float>();
+      return {pitch, yaw, roll};
+    }
+
+  private:
+
+    const unsigned char *_it;
+
+    const unsigned char *_end;
+  };
+
+  // ===========================================================================
+  // -- Records ----------------------------------------------------------------
+  // ===========================================================================
+
+  static void ReadRecord(PacketReader &reader, EventAdd &event) {
+    event.database_id = reader.Read<uint32_t>();
+    event.type = static_cast<ActorType>(reader.Read<uint8_t>());
+    event.transform.location = reader.ReadLocation();
+    event.transform.rotation = reader.ReadRotation();
+    event.description.uid = reader.Read<uint32_t>();
+    event.description.id = reader.ReadString();
+    const auto total = reader.Read<uint16_t>();
+    event.description.attributes.resize(total);
+    for (auto &attribute : event.description.attributes) {
+      attribute.type = reader.Read<uint8_t>();
+      attribute.id = reader.ReadString();
+      attribute.value = reader.ReadString();
+    }
+  }
+
+  static void ReadRecord(PacketReader &reader, EventDel &event) {
+    event.database_id = reader.Read<uint32_t>();
+  }
+
+  static void ReadRecord(PacketReader &reader, EventParent &event) {
+    event.database_id = reader.Read<uint32_t>();
+    event.parent_id = reader.Read<uint32_t>();
+  }
+
+  static void ReadRecord(PacketReader &reader, Collision &collision) {
+    collision.id = reader.Read<uint32_t>();
+    collision.actor1 = reader.Read<uint32_t>();
+    collision.actor2 = reader.Read<uint32_t>();
+    collision.is_actor1_hero = reader.Read<uint8_t>() != 0u;
+    collision.is_actor2_hero = reader.Read<uint8_t>() != 0u;
+  }
+
+  static void ReadRecord(PacketReader &reader, Position &position) {
+    position.database_id = reader.Read<uint32_t>();
+    position.transform.location = reader.ReadLocation();
+    position.transform.rotation = reader.ReadRotation();
+  }
+
+  static void ReadRecord(PacketReader &reader, TrafficLightState &state) {
+    state.database_id = reader.Read<uint32_t>();
+    state.is_frozen = reader.Read<uint8_t>() != 0u;
+    state.elapsed_time = reader.Read<float>();
+    state.state = reader.Read<uint8_t>();
+  }
+
+  static void ReadRecord(PacketReader &reader, VehicleAnimation &animation) {
+    animation.database_id = reader.Read<uint32_t>();
+    animation.steering = reader.Read<float>();
+    animation.throttle = reader.Read<float>();
+    animation.brake = reader.Read<float>();
+    animation.handbrake = reader.Read<uint8_t>() != 0u;
+    animation.gear = reader.Read<int32_t>();
+  }
+
+  static void ReadRecord(PacketReader &reader, WalkerAnimation &animation) {
+    animation.database_id = reader.Read<uint32_t>();
+    animation.speed = reader.Read<float>();
+  }
+
+  /// Read the records of a packet, or only count them if @a read is false.
+  template <typename T>
+  static void ReadRecords(PacketReader &reader, const bool read, FrameRecords<T> &out, uint64_t &count) {
+    const auto total = reader.Read<uint16_t>();
+    count += total;
+    if (read) {
+      out.records.reserve(out.records.size() + total);
+      for (auto i = 0u; i < total; ++i) {
+        T record;
+        ReadRecord(reader, record);
+        out.records.emplace_back(std::move(record));
+      }
+    }
+  }
+
+  /// Call @a callback for each list of records of @a range.
+  template <typename FunctorT>
+  static void ForEachRecords(FrameRange &range, FunctorT &&callback) {
+    callback(range.actors_added);
+    callback(range.actors_removed);
+    callback(range.parents);
+    callback(range.collisions);
+    callback(range.positions);
+    callback(range.traffic_lights);
+    callback(range.vehicle_animations);
+    callback(range.walker_animations);
+  }
+
+  static void Decompress(PacketReader &reader, std::vector<unsigned char> &out) {
+    const auto compression = reader.Read<uint8_t>();
+    const auto raw_size = reader.Read<uint32_t>();
+    if (compression != BLOCK_COMPRESSION_ZLIB) {
+      throw_exception(std::runtime_error("unknown compression of recorder block"));
+    }
+    out.resize(raw_size);
+    const auto size = reader.GetRemaining();
+    uLongf result_size = raw_size;
+    const auto result = uncompress(out.data(), &result_size, reader.Take(size), static_cast<uLong>(size));
+    if ((result != Z_OK) || (result_size != raw_size)) {
+      throw_exception(std::runtime_error("cannot decompress recorder block"));
+    }
+  }
+
+  /// Read all the packets of @a reader into @a range.
+  static void ReadPackets(
+      PacketReader reader,
+      const uint32_t packets,
+      FrameRange &range,
+      std::vector<unsigned char> &block,
+      const bool is_block = false) {
+    auto count = [&](PacketId id) -> uint64_t & {
+      return range.count[static_cast<size_t>(id)];
+    };
+    while (reader.GetRemaining() > 0u) {
+      const auto id = static_cast<PacketId>(reader.Read<uint8_t>());
+      const auto size = reader.Read<uint32_t>();
+      auto data = reader.TakePacket(size);
+      const bool read = (id < PacketId::SIZE) && ((packets & PacketMask(id)) != 0u);
+      switch (id) {
+        case PacketId::FrameStart: {
+          Frame frame;
+          frame.id = data.Read<uint64_t>();
+          frame.duration = data.Read<double>();
+          frame.elapsed = data.Read<double>();
+          ++count(id);
+          ForEachRecords(range, [](auto &records) { records.begin.emplace_back(records.records.size()); });
+          range.frames.emplace_back(frame);
+          break;
+        }
+        case PacketId::EventAdd:
+          ReadRecords(data, read, range.actors_added, count(id));
+          break;
+        case PacketId::EventDel:
+          ReadRecords(data, read, range.actors_removed, count(id));
+          break;
+        case PacketId::EventParent:
+          ReadRecords(data, read, range.parents, count(id));
+          break;
+        case PacketId::Collision:
+          ReadRecords(data, read, range.collisions, count(id));
+          break;
+        case PacketId::Position:
+          ReadRecords(data, read, range.positions, count(id));
+          break;
+        case PacketId::State:
+          ReadRecords(data, read, range.traffic_lights, count(id));
+          break;
+        case PacketId::AnimVehicle:
+          ReadRecords(data, read, range.vehicle_animations, count(id));
+          break;
+        case PacketId::AnimWalker:
+          ReadRecords(data, read, range.walker_animations, count(id));
+          break;
+        case PacketId::Block:
+          if (is_block) {
+            throw_exception(std::runtime_error("recorder block inside another block"));
+          }
+          Decompress(data, block);
+          ReadPackets(PacketReader{block.data(), block.data() + block.size()}, packets, range, block, true);
+          break;
+        default:
+          // Frame end, keyframes, frame index, and packets unknown to this
+          // version.
+          break;
+      }
+    }
+  }
+
+  // ===========================================================================
+  // -- Recording --------------------------------------------------------------
+  // ===========================================================================
+
+  Recording::Recording(std::string path)
+    : _path(std::move(path)) {
+    try {
+      _mapping = std::make_unique<Mapping>(_path);
+    } catch (const std::exception &e) {
+      throw_exception(std::runtime_error(_path + ": cannot open recording, " + e.what()));
+    }
+    _data = static_cast<const unsigned char *>(_mapping->region.get_address());
+    _size = _mapping->region.get_size();
+    ReadInfo();
+    if (!ReadIndex()) {
+      ScanFrames();
+    }
+  }
+
+  Recording::~Recording() = default;
+
+  double Recording::GetDuration() const {
+    if (_duration >= 0.0) {
+      return _duration;
+    }
+    if (_frame_offsets.empty()) {
+      return 0.0;
+    }
+    const auto last = ReadFrames(_frame_offsets.size() - 1u, _frame_offsets.size(), 0u);
+    return last.frames.empty() ? 0.0 : last.frames.back().elapsed;
+  }
+
+  FrameRange Recording::ReadFrames(const size_t begin, const size_t end, const uint32_t packets) const {
+    if ((begin > end) || (end > _frame_offsets.size())) {
+      throw_exception(std::out_of_range("invalid range of recorded frames"));
+    }
+    FrameRange range;
+    range.first = begin;
+    if (begin < end) {
+      const auto from = _frame_offsets[begin];
+      const auto to = (end < _frame_offsets.size()) ? _frame_offsets[end] : _end;
+      if ((from > to) || (to > _size)) {
+        throw_exception(std::runtime_error(_path + ": invalid offsets of recorded frames"));
+      }
+      std::vector<unsigned char> block;
+      try {
+        ReadPackets(PacketReader{_data + from, _data + to}, packets, range, block);
+      } catch (const std::runtime_error &e) {
+        throw_exception(std::runtime_error(_path + ": " + e.what()));
+      }
+    }
+    ForEachRecords(range, [](auto &records) { records.begin.emplace_back(records.records.size()); });
+    return range;
+  }
+
+  void Recording::ReadInfo() {
+    PacketReader reader{_data, _data + _size};
+    try {
+      _info.version = reader.Read<uint16_t>();
+      _info.magic = reader.ReadString();
+      _info.date = static_cast<std::time_t>(reader.Read<int64_t>());
+      _info.map = reader.ReadString();
+    } catch (const std::runtime_error &) {
+      _info.magic.clear();
+    }
+    if (_info.magic != RECORDING_MAGIC) {
+      throw_exception(std::runtime_error(_path + " is not a CARLA recording"));
+    }
+    _begin = static_cast<size_t>(reader.GetPosition() - _data);
+    _end = _size;
+  }
+
+  /// Read the frame index at the end of @a data, if it belongs to a recording
+  /// of @a recording_size bytes. Return the offset of the index.
+  static bool ReadIndexData(
+      const unsigned char *data,
+      const size_t size,
+      const size_t recording_size,
+      std::vector<size_t> &frame_offsets,
+      double &duration,
+      size_t &number_of_keyframes,
+      size_t &index_offset) {
+    if (size < INDEX_FOOTER_SIZE) {
+      return false;
+    }
+    PacketReader footer{data + size - INDEX_FOOTER_SIZE, data + size};
+    index_offset = footer.Read<uint64_t>();
+    const auto footer_recording_size = footer.Read<uint64_t>();
+    if ((std::memcmp(footer.Take(sizeof(uint64_t)), INDEX_MAGIC, sizeof(uint64_t)) != 0) ||
+        (footer_recording_size != recording_size) ||
+        (index_offset > size - INDEX_FOOTER_SIZE)) {
+      return false;
+    }
+    try {
+      PacketReader reader{data + index_offset, data + size - INDEX_FOOTER_SIZE};
+      if (static_cast<PacketId>(reader.Read<uint8_t>()) != PacketId::FrameIndex) {
+        return false;
+      }
+      reader.Read<uint32_t>();
+      const auto total = reader.Read<uint32_t>();
+      frame_offsets.clear();
+      frame_offsets.reserve(total);
+      duration = 0.0;
+      for (auto i = 0u; i < total; ++i) {
+        reader.Read<uint64_t>();
+        duration = reader.Read<double>();
+        frame_offsets.emplace_back(static_cast<size_t>(reader.Read<uint64_t>()));
+      }
+      number_of_keyframes = reader.Read<uint32_t>();
+    } catch (const std::runtime_error &) {
+      frame_offsets.clear();
+      return false;
+    }
+    return true;
+  }
+
+  bool Recording::ReadIndex() {
+    size_t index_offset = 0u;
+    // Index at the end of the recording.
+    if (ReadIndexData(_data, _size, _size, _frame_offsets, _duration, _number_of_keyframes, index_offset)) {
+      _end = index_offset;
+    } else {
+      // Index built by the simulator for an older recording.
+      std::ifstream file(_path + ".index", std::ios::binary);
+      const std::vector<unsigned char> data{
+          std::istreambuf_iterator<char>(file),
+          std::istreambuf_iterator<char>()};
+      if (!ReadIndexData(data.data(), data.size(), _size, _frame_offsets, _duration, _number_of_keyframes, index_offset)) {
+        _duration = -1.0;
+        _number_of_keyframes = 0u;
+        return false;
+      }
+    }
+    // A corrupt index would make ReadFrames read past the mapping, the frames
+    // must be in order and inside the recording.
+    size_t previous = 0u;
+    for (const auto offset : _frame_offsets) {
+      if ((offset < _begin) || (offset + PACKET_HEADER_SIZE > _end) ||
+          ((previous != 0u) && (offset <= previous))) {
+        _frame_offsets.clear();
+        _duration = -1.0;
+        _number_of_keyframes = 0u;
+        _end = _size;
+        return false;
+      }
+      previous = offset;
+    }
+    _has_index = true;
+    return true;
+  }
+
+  void Recording::ScanFrames() {
+    _frame_offsets.clear();
+    _number_of_keyframes = 0u;
+    auto offset = _begin;
+    while (offset + PACKET_HEADER_SIZE <= _size) {
+      const auto id = static_cast<PacketId>(_data[offset]);
+      uint32_t size;
+      std::memcpy(&size, _data + offset + sizeof(uint8_t), sizeof(uint32_t));
+      const auto next = offset + PACKET_HEADER_SIZE + size;
+      if ((next > _size) || (id == PacketId::FrameIndex)) {
+        // Unfinished recording, or the end of the packets.
+        break;
+      }
+      if ((id == PacketId::FrameStart) || (id == PacketId::Block)) {
+        _frame_offsets.emplace_back(offset);
+      } else if (id == PacketId::Keyframe) {
+        ++_number_of_keyframes;
+      }
+      offset = next;
+    }
+    _end = offset;
+  }
+
+} // namespace recorder
+} // namespace carla
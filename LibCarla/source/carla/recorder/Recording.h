@@ -0,0 +1,157 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/ListView.h"
+#include "carla/NonCopyable.h"
+#include "carla/recorder/Packets.h"
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace recorder {
+
+  /// Bit of the packets of type @a id in a mask of packets.
+  constexpr uint32_t PacketMask(const PacketId id) {
+    return 1u << static_cast<uint32_t>(id);
+  }
+
+  /// Mask with every type of packet.
+  constexpr uint32_t AllPackets = ~0u;
+
+  /// Records of one type of packet of several consecutive frames, stored one
+  /// after the other. The records of frame @a i of the range are in [begin[i],
+  /// begin[i + 1]).
+  template <typename T>
+  struct FrameRecords {
+    std::vector<T> records;
+
+    std::vector<size_t> begin;
+
+    auto GetFrame(const size_t i) const {
+      return MakeListView(records.begin() + begin[i], records.begin() + begin[i + 1u]);
+    }
+  };
+
+  /// Packets of a range of consecutive frames of a recording.
+  struct FrameRange {
+    /// Position in the recording of the first frame of the range.
+    size_t first = 0u;
+
+    std::vector<Frame> frames;
+
+    FrameRecords<EventAdd> actors_added;
+
+    FrameRecords<EventDel> actors_removed;
+
+    FrameRecords<EventParent> parents;
+
+    FrameRecords<Collision> collisions;
+
+    FrameRecords<Position> positions;
+
+    FrameRecords<TrafficLightState> traffic_lights;
+
+    FrameRecords<VehicleAnimation> vehicle_animations;
+
+    FrameRecords<WalkerAnimation> walker_animations;
+
+    /// Number of records of each type of packet in the range, including the
+    /// types that were not read. Keyframes are not counted, they are written
+    /// before the frame they belong to, see Recording::GetNumberOfKeyframes.
+    std::array<uint64_t, static_cast<size_t>(PacketId::SIZE)> count{};
+  };
+
+  /// Read-only view of a recording file (".log") made by the simulator
+  /// recorder, independent of the simulator.
+  ///
+  /// The file is memory-mapped, frames are located with the index at the end
+  /// of the file, or by walking the packet headers for recordings without one.
+  /// Compressed frames are decompressed when read. Reading frames is
+  /// thread-safe.
+  class Recording : private NonCopyable {
+  public:
+
+    /// Open the recording at @a path.
+    ///
+    /// @throw std::runtime_error if it is not a CARLA recording.
+    explicit Recording(std::string path);
+
+    ~Recording();
+
+    const std::string &GetPath() const {
+      return _path;
+    }
+
+    const Info &GetInfo() const {
+      return _info;
+    }
+
+    /// Whether the recording has an index of its frames.
+    bool HasIndex() const {
+      return _has_index;
+    }
+
+    size_t GetNumberOfFrames() const {
+      return _frame_offsets.size();
+    }
+
+    size_t GetNumberOfKeyframes() const {
+      return _number_of_keyframes;
+    }
+
+    /// Total time recorded in seconds.
+    double GetDuration() const;
+
+    /// Read the frames [begin, end), skipping the records of the packets not
+    /// in @a packets (a mask made of PacketMask values).
+    ///
+    /// @throw std::runtime_error if the frames are corrupt.
+    FrameRange ReadFrames(size_t begin, size_t end, uint32_t packets = AllPackets) const;
+
+  private:
+
+    void ReadInfo();
+
+    bool ReadIndex();
+
+    void ScanFrames();
+
+    struct Mapping;
+
+    const std::string _path;
+
+    std::unique_ptr<Mapping> _mapping;
+
+    const unsigned char *_data = nullptr;
+
+    size_t _size = 0u;
+
+    /// Offset of the first packet.
+    size_t _begin = 0u;
+
+    /// Offset after the last packet of the last frame.
+    size_t _end = 0u;
+
+    Info _info;
+
+    bool _has_index = false;
+
+    /// Offset of each frame start packet, or of the block containing it.
+    std::vector<size_t> _frame_offsets;
+
+    /// Elapsed time of the last frame, if known from the index.
+    double _duration = -1.0;
+
+    size_t _number_of_keyframes = 0u;
+  };
+
+} // namespace recorder
+} // namespace carla
@@ -17,6 +17,8 @@
 namespace carla {
 namespace road {
 
+  class MapSerializer;
+
   class InformationSet : private MovableNonCopyable {
   public:
 
@@ -46,6 +48,8 @@ namespace road {
 
   private:
 
+    friend MapSerializer;
+
     RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set;
   };
 
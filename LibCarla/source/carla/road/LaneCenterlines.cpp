@@ -0,0 +1,122 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/LaneCenterlines.h"
+
+#include "carla/Debug.h"
+#include "carla/road/Map.h"
+
+#include <boost/container_hash/hash.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace carla {
+namespace road {
+
+  /// Tolerance, in steps, for waypoints slightly before the first or after
+  /// the last sample of a lane.
+  static constexpr double STEP_TOLERANCE = 1e-6;
+
+  /// Difference between two angles in degrees wrapped to [-180, 180].
+  static float AngleDifference(const float lhs, const float rhs) {
+    float delta = std::fmod(lhs - rhs, 360.0f);
+    if (delta > 180.0f) {
+      delta -= 360.0f;
+    } else if (delta < -180.0f) {
+      delta += 360.0f;
+    }
+    return delta;
+  }
+
+  size_t LaneCenterlines::LaneKeyHash::operator()(const LaneKey &key) const {
+    size_t seed = 0u;
+    boost::hash_combine(seed, key.road_id);
+    boost::hash_combine(seed, key.section_id);
+    boost::hash_combine(seed, key.lane_id);
+    return seed;
+  }
+
+  LaneCenterlines::LaneCenterlines(const Map &map, const double resolution)
+    : _resolution(resolution) {
+    RELEASE_ASSERT(resolution > 0.0);
+    for (const auto &road_pair : map.GetMap().GetRoads()) {
+      const auto &road = road_pair.second;
+      for (const auto &section : road.GetLaneSections()) {
+        for (const auto &lane_pair : section.GetLanes()) {
+          const auto &lane = lane_pair.second;
+          if (lane.GetId() == 0) {
+            continue;
+          }
+          const double begin = std::max(lane.GetDistance(), 0.0);
+          const double end = std::max(std::min(lane.GetDistance() + lane.GetLength(), road.GetLength()), begin);
+          const auto steps = std::max(static_cast<uint32_t>(std::ceil((end - begin) / resolution)), 1u);
+          const double step = (end - begin) / steps;
+
+          LaneSamples samples{begin, step > 0.0 ? 1.0 / step : 0.0, static_cast<uint32_t>(_samples.size()), steps + 1u};
+          element::Waypoint waypoint{road.GetId(), section.GetId(), lane.GetId(), begin};
+          for (auto i = 0u; i <= steps; ++i) {
+            // Compute the last one from end to avoid rounding past the road.
+            waypoint.s = (i == steps) ? end : begin + i * step;
+            const auto transform = map.ComputeTransform(waypoint);
+            _samples.emplace_back(Sample{transform.location, transform.rotation.pitch, transform.rotation.yaw});
+          }
+
+          // Measure the error where it is usually the largest, halfway between
+          // samples.
+          if (step > 0.0) {
+            for (auto i = 0u; i < steps; ++i) {
+              waypoint.s = begin + (i + 0.5) * step;
+              const auto expected = map.ComputeTransform(waypoint);
+              const auto result = Interpolate(samples, waypoint.s);
+              _max_location_error = std::max(_max_location_error, expected.location.Distance(result.location));
+              _max_rotation_error = std::max({
+                  _max_rotation_error,
+                  std::abs(AngleDifference(expected.rotation.pitch, result.rotation.pitch)),
+                  std::abs(AngleDifference(expected.rotation.yaw, result.rotation.yaw))});
+            }
+          }
+
+          _lanes.emplace(LaneKey{road.GetId(), section.GetId(), lane.GetId()}, samples);
+        }
+      }
+    }
+  }
+
+  boost::optional<geom::Transform> LaneCenterlines::ComputeTransform(const element::Waypoint waypoint) const {
+    const auto it = _lanes.find(LaneKey{waypoint.road_id, waypoint.section_id, waypoint.lane_id});
+    if (it == _lanes.end()) {
+      return boost::none;
+    }
+    const auto &lane = it->second;
+    const double position = (waypoint.s - lane.s) * lane.inverse_step;
+    if ((position < -STEP_TOLERANCE) || (position > (lane.count - 1u) + STEP_TOLERANCE)) {
+      return boost::none;
+    }
+    return Interpolate(lane, waypoint.s);
+  }
+
+  geom::Transform LaneCenterlines::Interpolate(const LaneSamples &lane, const double s) const {
+    // Every lane has at least two samples.
+    DEBUG_ASSERT(lane.count > 1u);
+    const double position = std::max((s - lane.s) * lane.inverse_step, 0.0);
+    const auto index = std::min(static_cast<uint32_t>(position), lane.count - 2u);
+    const auto &a = _samples[lane.first + index];
+    const auto &b = _samples[lane.first + index + 1u];
+    const auto t = static_cast<float>(std::min(position - index, 1.0));
+    geom::Location location = b.location - a.location;
+    location *= t;
+    location += a.location;
+    return geom::Transform{
+        location,
+        geom::Rotation{
+            a.pitch + t * AngleDifference(b.pitch, a.pitch),
+            a.yaw + t * AngleDifference(b.yaw, a.yaw),
+            0.0f}};
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,117 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Transform.h"
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class Map;
+
+  /// Centerline of every lane of a Map sampled at a fixed resolution, used to
+  /// interpolate the transform of a waypoint instead of evaluating the road
+  /// geometry and the lane offset and width polynomials in
+  /// Map::ComputeTransform.
+  ///
+  /// Each lane is sampled uniformly along s, with a step no greater than the
+  /// resolution, and the samples of all the lanes are stored in a single
+  /// array. While building, the exact transform is compared against the
+  /// interpolated one at the middle of each step and the maximum differences
+  /// are kept. These are measured values, not bounds: the error elsewhere in
+  /// a step is usually, but not necessarily, smaller.
+  class LaneCenterlines : private MovableNonCopyable {
+  public:
+
+    LaneCenterlines() = default;
+
+    /// Sample the centerlines of all the lanes of @a map, with a distance of
+    /// at most @a resolution meters between samples.
+    explicit LaneCenterlines(const Map &map, double resolution = 0.5);
+
+    /// Interpolate the transform of @a waypoint, same conventions as
+    /// Map::ComputeTransform. Empty if the lane of @a waypoint was not
+    /// sampled, or its s lies outside the lane.
+    boost::optional<geom::Transform> ComputeTransform(element::Waypoint waypoint) const;
+
+    double GetResolution() const {
+      return _resolution;
+    }
+
+    size_t GetNumberOfSamples() const {
+      return _samples.size();
+    }
+
+    /// Maximum distance, in meters, between the exact and the interpolated
+    /// location found while building.
+    float GetMaxLocationError() const {
+      return _max_location_error;
+    }
+
+    /// Maximum difference, in degrees, between the exact and the interpolated
+    /// pitch or yaw found while building.
+    float GetMaxRotationError() const {
+      return _max_rotation_error;
+    }
+
+  private:
+
+    struct LaneKey {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+
+      bool operator==(const LaneKey &rhs) const {
+        return road_id == rhs.road_id && section_id == rhs.section_id && lane_id == rhs.lane_id;
+      }
+    };
+
+    struct LaneKeyHash {
+      size_t operator()(const LaneKey &key) const;
+    };
+
+    /// Samples of a lane, _samples[first] to _samples[first + count - 1]
+    /// placed at s, s + step, ..., s + (count - 1) * step.
+    struct LaneSamples {
+      double s;
+      double inverse_step;
+      uint32_t first;
+      uint32_t count;
+    };
+
+    /// Roll is always zero, so only pitch and yaw are stored.
+    struct Sample {
+      geom::Location location;
+      float pitch;
+      float yaw;
+    };
+
+    geom::Transform Interpolate(const LaneSamples &lane, double s) const;
+
+    double _resolution = 0.0;
+
+    float _max_location_error = 0.0f;
+
+    float _max_rotation_error = 0.0f;
+
+    std::unordered_map<LaneKey, LaneSamples, LaneKeyHash> _lanes;
+
+    std::vector<Sample> _samples;
+  };
+
+} // namespace road
+} // namespace carla
@@ -20,6 +20,7 @@ namespace road {
 
   class Road;
   class MapBuilder;
+  class MapSerializer;
 
   class LaneSection : private MovableNonCopyable {
   public:
@@ -48,6 +49,8 @@ namespace road {
 
     friend MapBuilder;
 
+    friend MapSerializer;
+
     const SectionId _id = 0u;
 
     const double _s = 0.0;
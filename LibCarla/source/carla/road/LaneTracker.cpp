@@ -0,0 +1,161 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/LaneTracker.h"
+
+#include "carla/Debug.h"
+#include "carla/geom/Math.h"
+#include "carla/road/Map.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  using namespace carla::road::element;
+
+  /// Locations closer than this to either end of a road are not accepted on
+  /// it, same margin Map::GetClosestWaypointOnRoad clamps to.
+  static constexpr double MARGIN = 50.0 * std::numeric_limits<double>::epsilon();
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  /// Same check as Map::GetWaypoint.
+  static bool IsOnLane(const Map &map, const Waypoint &waypoint, const geom::Location &location) {
+    const auto distance = geom::Math::Distance2D(map.ComputeTransform(waypoint).location, location);
+    return distance < map.GetLaneWidth(waypoint) * 0.5;
+  }
+
+  /// Locate @a location on the lanes of @a road, only if it lies within one
+  /// of them and not past either end of the road. If @a accept_offroad, a
+  /// location outside the lanes of @a lane_type is accepted (as off-road)
+  /// while it still lies within a lane of any other type, e.g. a shoulder.
+  static boost::optional<LaneTracker::Position> LocateOnRoad(
+      const Map &map,
+      const Road &road,
+      const geom::Location &location,
+      uint32_t lane_type,
+      bool accept_offroad) {
+    // Unreal's Y axis hack
+    const auto pos_inverted_y = geom::Location(location.x, -location.y, location.z);
+
+    const auto nearest = road.GetNearestPoint(pos_inverted_y);
+    if ((nearest.first <= MARGIN) || (nearest.first >= road.GetLength() - MARGIN)) {
+      return boost::none;
+    }
+
+    const auto nearest_lane = road.GetNearestLane(nearest.first, pos_inverted_y, lane_type);
+    if (nearest_lane.first == nullptr) {
+      return boost::none;
+    }
+
+    const auto &lane = road.GetLaneByDistance(nearest.first, nearest_lane.first->GetId());
+    const auto lane_section = lane.GetLaneSection();
+    RELEASE_ASSERT(lane_section != nullptr);
+
+    const Waypoint waypoint{road.GetId(), lane_section->GetId(), lane.GetId(), nearest.first};
+    if (IsOnLane(map, waypoint, location)) {
+      return LaneTracker::Position{waypoint, false};
+    }
+    if (!accept_offroad) {
+      return boost::none;
+    }
+
+    const auto nearest_any_lane = road.GetNearestLane(
+        nearest.first,
+        pos_inverted_y,
+        static_cast<uint32_t>(Lane::LaneType::Any));
+    if (nearest_any_lane.first == nullptr) {
+      return boost::none;
+    }
+    const auto &any_lane = road.GetLaneByDistance(nearest.first, nearest_any_lane.first->GetId());
+    RELEASE_ASSERT(any_lane.GetLaneSection() != nullptr);
+    const Waypoint any_waypoint{
+        road.GetId(),
+        any_lane.GetLaneSection()->GetId(),
+        any_lane.GetId(),
+        nearest.first};
+    if (!IsOnLane(map, any_waypoint, location)) {
+      return boost::none;
+    }
+    return LaneTracker::Position{waypoint, true};
+  }
+
+  // ===========================================================================
+  // -- LaneTracker ------------------------------------------------------------
+  // ===========================================================================
+
+  boost::optional<LaneTracker::Position> LaneTracker::Locate(
+      const Map &map,
+      const geom::Location &location,
+      const uint32_t lane_type) {
+    const auto waypoint = map.GetClosestWaypointOnRoad(location, lane_type);
+    if (!waypoint.has_value()) {
+      return boost::none;
+    }
+    return Position{*waypoint, !IsOnLane(map, *waypoint, location)};
+  }
+
+  boost::optional<LaneTracker::Position> LaneTracker::Update(
+      const Map &map,
+      const geom::Location &location,
+      const uint32_t lane_type) {
+    auto position = LocateNearby(map, location, lane_type);
+    if (position.has_value()) {
+      ++_local_hits;
+    } else {
+      position = Locate(map, location, lane_type);
+      ++_global_searches;
+    }
+    _position = position;
+    _location = location;
+    return position;
+  }
+
+  boost::optional<LaneTracker::Position> LaneTracker::LocateNearby(
+      const Map &map,
+      const geom::Location &location,
+      const uint32_t lane_type) const {
+    if (!_position.has_value()) {
+      return boost::none;
+    }
+    const auto &last = _position->waypoint;
+    const auto &data = map.GetMap();
+
+    // The lanes of the last road, then the roads its lane continues into.
+    // Off-road locations are only accepted on the last road, the ones past
+    // its ends may be on roads that are not connected to it.
+    auto position = LocateOnRoad(map, data.GetRoad(last.road_id), location, lane_type, true);
+    if (position.has_value()) {
+      return position;
+    }
+    std::vector<RoadId> visited{last.road_id};
+    auto search = [&](const std::vector<Waypoint> &waypoints) -> boost::optional<Position> {
+      for (const auto &waypoint : waypoints) {
+        if (std::find(visited.begin(), visited.end(), waypoint.road_id) != visited.end()) {
+          continue;
+        }
+        visited.emplace_back(waypoint.road_id);
+        auto result = LocateOnRoad(map, data.GetRoad(waypoint.road_id), location, lane_type, false);
+        if (result.has_value()) {
+          return result;
+        }
+      }
+      return boost::none;
+    };
+    position = search(map.GetSuccessors(last));
+    if (!position.has_value()) {
+      position = search(map.GetPredecessors(last));
+    }
+    return position;
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,100 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Location.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+
+namespace carla {
+namespace road {
+
+  class Map;
+
+  /// Follows the lane of a moving location, e.g. a corner of a vehicle, along
+  /// consecutive updates. The road of the last lane found and the roads
+  /// connected to that lane are checked first; the map-wide search of
+  /// Map::GetClosestWaypointOnRoad is only used on the first update, when the
+  /// location is not on any of these roads, or when it is off-road.
+  ///
+  /// A location is accepted on a nearby road only if it lies within the width
+  /// of one of its lanes and not past either end of the road; on the last
+  /// road, lanes of any type count, e.g. a location on the shoulder is
+  /// accepted as off-road. The result is then the same as the map-wide search
+  /// except where roads overlap (junctions).
+  class LaneTracker {
+  public:
+
+    /// Closest lane to a location.
+    struct Position {
+      /// Same as Map::GetClosestWaypointOnRoad.
+      element::Waypoint waypoint;
+      /// Whether the location is outside the lane of waypoint, i.e. whether
+      /// Map::GetWaypoint fails.
+      bool is_offroad;
+    };
+
+    /// Locate @a location on @a map searching the whole map. Empty if the map
+    /// has no lane of @a lane_type.
+    static boost::optional<Position> Locate(
+        const Map &map,
+        const geom::Location &location,
+        uint32_t lane_type);
+
+    /// Locate @a location on @a map starting at the last position, and make
+    /// it the tracked location.
+    boost::optional<Position> Update(
+        const Map &map,
+        const geom::Location &location,
+        uint32_t lane_type);
+
+    /// Forget the last position, the next update searches the whole map.
+    void Reset() {
+      _position.reset();
+    }
+
+    /// Position of the last update.
+    const boost::optional<Position> &GetPosition() const {
+      return _position;
+    }
+
+    /// Location of the last update.
+    const geom::Location &GetLocation() const {
+      return _location;
+    }
+
+    /// Number of updates resolved without searching the whole map.
+    size_t GetLocalHits() const {
+      return _local_hits;
+    }
+
+    /// Number of updates that searched the whole map.
+    size_t GetGlobalSearches() const {
+      return _global_searches;
+    }
+
+  private:
+
+    boost::optional<Position> LocateNearby(
+        const Map &map,
+        const geom::Location &location,
+        uint32_t lane_type) const;
+
+    boost::optional<Position> _position;
+
+    geom::Location _location;
+
+    size_t _local_hits = 0u;
+
+    size_t _global_searches = 0u;
+  };
+
+} // namespace road
+} // namespace carla
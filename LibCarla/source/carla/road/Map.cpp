@@ -14,7 +14,10 @@
 #include "carla/road/element/RoadInfoLaneOffset.h"
 #include "carla/geom/Math.h"
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
+#include <tuple>
 
 namespace carla {
 namespace road {
@@ -29,18 +32,6 @@ namespace road {
   // -- Static local methods ---------------------------------------------------
   // ===========================================================================
 
-  template <typename T>
-  static std::vector<T> ConcatVectors(std::vector<T> dst, std::vector<T> src) {
-    if (src.size() > dst.size()) {
-      return ConcatVectors(src, dst);
-    }
-    dst.insert(
-        dst.end(),
-        std::make_move_iterator(src.begin()),
-        std::make_move_iterator(src.end()));
-    return dst;
-  }
-
   static double GetDistanceAtStartOfLane(const Lane &lane) {
     if (lane.GetId() <= 0) {
       return lane.GetDistance() + 10.0 * EPSILON;
@@ -142,60 +133,40 @@ namespace road {
   boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
       const geom::Location &pos,
       uint32_t lane_type) const {
-    // max_nearests represents the max nearests roads
-    // where we will search for nearests lanes
-    constexpr size_t max_nearests = 50u;
-    // in case that map has less than max_nearests lanes,
-    // we will use the maximum lanes
-    const size_t max_nearest_allowed = std::min(_data.GetRoadCount(), max_nearests);
-
     // Unreal's Y axis hack
     const auto pos_inverted_y = geom::Location(pos.x, -pos.y, pos.z);
 
-    double nearest_dist[max_nearests];
-    std::fill(nearest_dist, nearest_dist + max_nearest_allowed,
-        std::numeric_limits<double>::max());
-
-    RoadId ids[max_nearests];
-    std::fill(ids, ids + max_nearest_allowed, 0);
-
-    double dists[max_nearests];
-    std::fill(dists, dists + max_nearest_allowed, 0.0);
-
-    for (const auto &road_pair : _data.GetRoads()) {
-      const auto road = &road_pair.second;
-      const auto current_dist = road->GetNearestPoint(pos_inverted_y);
-
-      for (size_t i = 0u; i < max_nearest_allowed; ++i) {
-        if (current_dist.second < nearest_dist[i]) {
-          // reorder nearest_dist
-          for (size_t j = max_nearest_allowed - 1u; j > i; --j) {
-            DEBUG_ASSERT(j > 0u);
-            nearest_dist[j] = nearest_dist[j - 1];
-            ids[j] = ids[j - 1];
-            dists[j] = dists[j - 1];
-          }
-          nearest_dist[i] = current_dist.second;
-          ids[i] = road->GetId();
-          dists[i] = current_dist.first;
-          break;
-        }
-      }
-    }
-
-    // search for the nearest lane in nearest_dist
+    // visit the roads in order of distance to their bounding boxes, which
+    // contain their lanes, until no other road can have a nearer lane
     Waypoint waypoint;
     auto nearest_lane_dist = std::numeric_limits<double>::max();
-    for (size_t i = 0u; i < max_nearest_allowed; ++i) {
-      auto lane_dist = _data.GetRoad(ids[i]).GetNearestLane(dists[i], pos_inverted_y, lane_type);
-
-      if (lane_dist.second < nearest_lane_dist) {
+    const auto map_min_height = _spatial_index.GetMinHeight(pos_inverted_y);
+    _spatial_index.ForEachRoadByDistance(pos_inverted_y, [&](RoadId road_id, double min_dist, double min_height) {
+      if (std::hypot(min_dist, map_min_height) > nearest_lane_dist) {
+        return false;
+      }
+      // the lanes of this road are too high or too low
+      if (std::hypot(min_dist, min_height) > nearest_lane_dist) {
+        return true;
+      }
+      const auto &road = _data.GetRoad(road_id);
+      const auto nearest_point = road.GetNearestPoint(pos_inverted_y);
+      const auto lane_dist = road.GetNearestLane(nearest_point.first, pos_inverted_y, lane_type);
+      if (lane_dist.first == nullptr) {
+        return true;
+      }
+      // ties are broken by road and lane id, so the result does not depend on
+      // the order of the roads in the map
+      const auto lane_id = lane_dist.first->GetId();
+      if (std::tie(lane_dist.second, road_id, lane_id) <
+          std::tie(nearest_lane_dist, waypoint.road_id, waypoint.lane_id)) {
         nearest_lane_dist = lane_dist.second;
-        waypoint.lane_id = lane_dist.first->GetId();
-        waypoint.road_id = ids[i];
-        waypoint.s = dists[i];
+        waypoint.lane_id = lane_id;
+        waypoint.road_id = road_id;
+        waypoint.s = nearest_point.first;
       }
-    }
+      return true;
+    });
 
     if (nearest_lane_dist == std::numeric_limits<double>::max()) {
       return boost::optional<Waypoint>{};
@@ -239,6 +210,21 @@ namespace road {
     return boost::optional<Waypoint>{};
   }
 
+  std::vector<Waypoint> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      const bool project_to_road,
+      const uint32_t lane_type) const {
+    std::vector<Waypoint> result;
+    result.reserve(locations.size());
+    for (const auto &location : locations) {
+      const auto waypoint = project_to_road ?
+          GetClosestWaypointOnRoad(location, lane_type) :
+          GetWaypoint(location, lane_type);
+      result.emplace_back(waypoint.has_value() ? *waypoint : Waypoint{});
+    }
+    return result;
+  }
+
   geom::Transform Map::ComputeTransform(Waypoint waypoint) const {
     // lane_id can't be 0
     RELEASE_ASSERT(waypoint.lane_id != 0);
@@ -363,6 +349,12 @@ namespace road {
     return LaneCrossingCalculator::Calculate(*this, origin, destination);
   }
 
+  std::vector<LaneMarking> Map::CalculateCrossedLanes(
+      LaneTracker &tracker,
+      const geom::Location &destination) const {
+    return LaneCrossingCalculator::Calculate(*this, tracker, destination);
+  }
+
   // ===========================================================================
   // -- Map: Waypoint generation -----------------------------------------------
   // ===========================================================================
@@ -403,11 +395,18 @@ namespace road {
     return result;
   }
 
-  std::vector<Waypoint> Map::GetNext(
+  /// Append to @a result the waypoints at @a distance that a vehicle at @a
+  /// waypoint could drive to. The waypoints of every successor are appended
+  /// to the same vector instead of concatenating a new vector at each level of
+  /// the recursion; they are rotated in place to keep the order GetNext has
+  /// always returned, the larger of the two partial results first.
+  static void AppendNext(
+      const Map &map,
       const Waypoint waypoint,
-      const double distance) const {
+      const double distance,
+      std::vector<Waypoint> &result) {
     RELEASE_ASSERT(distance > 0.0);
-    const auto &lane = GetLane(waypoint);
+    const auto &lane = map.GetLane(waypoint);
     const bool forward = (waypoint.lane_id <= 0);
     const double signed_distance = forward ? distance : -distance;
     const double relative_s = waypoint.s - lane.GetDistance() + EPSILON;
@@ -417,25 +416,46 @@ namespace road {
     // If after subtracting the distance we are still in the same lane, return
     // same waypoint with the extra distance.
     if (distance <= remaining_lane_length) {
-      Waypoint result = waypoint;
-      result.s += signed_distance;
-      result.s += forward ? -EPSILON : EPSILON;
-      RELEASE_ASSERT(result.s > 0.0);
-      return { result };
+      Waypoint next = waypoint;
+      next.s += signed_distance;
+      next.s += forward ? -EPSILON : EPSILON;
+      RELEASE_ASSERT(next.s > 0.0);
+      result.emplace_back(next);
+      return;
     }
 
     // If we run out of remaining_lane_length we have to go to the successors.
-    std::vector<Waypoint> result;
-    for (const auto &successor : GetSuccessors(waypoint)) {
+    const auto begin = result.size();
+    for (const auto &successor : map.GetSuccessors(waypoint)) {
       DEBUG_ASSERT(
           successor.road_id != waypoint.road_id ||
           successor.section_id != waypoint.section_id ||
           successor.lane_id != waypoint.lane_id);
-      result = ConcatVectors(result, GetNext(successor, distance - remaining_lane_length));
+      const auto middle = result.size();
+      AppendNext(map, successor, distance - remaining_lane_length, result);
+      if (result.size() - middle > middle - begin) {
+        std::rotate(result.begin() + begin, result.begin() + middle, result.end());
+      }
     }
+  }
+
+  std::vector<Waypoint> Map::GetNext(
+      const Waypoint waypoint,
+      const double distance) const {
+    std::vector<Waypoint> result;
+    AppendNext(*this, waypoint, distance, result);
     return result;
   }
 
+  void Map::GetNext(
+      const Waypoint waypoint,
+      const double distance,
+      WaypointArrays &result) const {
+    for (const auto &next : GetNext(waypoint, distance)) {
+      result.emplace_back(next, ComputeTransform(next));
+    }
+  }
+
   boost::optional<Waypoint> Map::GetRight(Waypoint waypoint) const {
     RELEASE_ASSERT(waypoint.lane_id != 0);
     if (waypoint.lane_id > 0) {
@@ -472,6 +492,27 @@ namespace road {
     return result;
   }
 
+  void Map::GenerateWaypoints(
+      const RoadId road_id,
+      const double distance,
+      WaypointArrays &result) const {
+    RELEASE_ASSERT(distance > 0.0);
+    const auto &road = _data.GetRoad(road_id);
+    for (double s = EPSILON; s < (road.GetLength() - EPSILON); s += distance) {
+      ForEachDrivableLaneAt(road, s, [&](auto &&waypoint) {
+        result.emplace_back(waypoint, ComputeTransform(waypoint));
+      });
+    }
+  }
+
+  WaypointArrays Map::GenerateWaypointArrays(const double distance) const {
+    WaypointArrays result;
+    for (const auto &pair : _data.GetRoads()) {
+      GenerateWaypoints(pair.first, distance, result);
+    }
+    return result;
+  }
+
   std::vector<Waypoint> Map::GenerateWaypointsOnRoadEntries() const {
     std::vector<Waypoint> result;
     for (const auto &pair : _data.GetRoads()) {
@@ -8,8 +8,11 @@
 
 #include "carla/NonCopyable.h"
 #include "carla/geom/Transform.h"
+#include "carla/road/LaneTracker.h"
 #include "carla/road/MapData.h"
 #include "carla/road/RoadTypes.h"
+#include "carla/road/SpatialIndex.h"
+#include "carla/road/WaypointArrays.h"
 #include "carla/road/element/LaneMarking.h"
 #include "carla/road/element/RoadInfoMarkRecord.h"
 #include "carla/road/element/Waypoint.h"
@@ -30,7 +33,9 @@ namespace road {
     /// -- Constructor ---------------------------------------------------------
     /// ========================================================================
 
-    Map(MapData m) : _data(std::move(m)) {}
+    Map(MapData m)
+      : _data(std::move(m)),
+        _spatial_index(_data) {}
 
     /// ========================================================================
     /// -- Georeference --------------------------------------------------------
@@ -52,6 +57,15 @@ namespace road {
         const geom::Location &location,
         uint32_t lane_type = static_cast<uint32_t>(Lane::LaneType::Driving)) const;
 
+    /// Batch version of GetClosestWaypointOnRoad, or of GetWaypoint if @a
+    /// project_to_road is false. The i-th waypoint returned corresponds to the
+    /// i-th location; locations without waypoint are mapped to a default
+    /// constructed waypoint, with lane_id 0, which never identifies a lane.
+    std::vector<Waypoint> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        bool project_to_road = true,
+        uint32_t lane_type = static_cast<uint32_t>(Lane::LaneType::Driving)) const;
+
     geom::Transform ComputeTransform(Waypoint waypoint) const;
 
     /// ========================================================================
@@ -75,6 +89,13 @@ namespace road {
         const geom::Location &origin,
         const geom::Location &destination) const;
 
+    /// Same as above, from the last location of @a tracker, which is updated
+    /// to @a destination. Locating @a destination starts at the lane of the
+    /// last location, see LaneTracker.
+    std::vector<element::LaneMarking> CalculateCrossedLanes(
+        LaneTracker &tracker,
+        const geom::Location &destination) const;
+
     /// ========================================================================
     /// -- Waypoint generation -------------------------------------------------
     /// ========================================================================
@@ -89,6 +110,10 @@ namespace road {
     /// waypoint could drive to.
     std::vector<Waypoint> GetNext(Waypoint waypoint, double distance) const;
 
+    /// Same as above, appending the waypoints and their transforms to @a
+    /// result instead of returning a new vector.
+    void GetNext(Waypoint waypoint, double distance, WaypointArrays &result) const;
+
     /// Return a waypoint at the lane of @a waypoint's right lane.
     boost::optional<Waypoint> GetRight(Waypoint waypoint) const;
 
@@ -98,6 +123,15 @@ namespace road {
     /// Generate all the waypoints in @a map separated by @a approx_distance.
     std::vector<Waypoint> GenerateWaypoints(double approx_distance) const;
 
+    /// Generate the waypoints of the road @a road_id separated by @a
+    /// approx_distance, appending them and their transforms to @a result.
+    void GenerateWaypoints(RoadId road_id, double approx_distance, WaypointArrays &result) const;
+
+    /// Same as GenerateWaypoints, in the same order, but also computing the
+    /// transform of each waypoint and returning them in
+    /// structure-of-arrays layout.
+    WaypointArrays GenerateWaypointArrays(double approx_distance) const;
+
     /// Generate waypoints on each @a lane at the start of each @a road
     std::vector<Waypoint> GenerateWaypointsOnRoadEntries() const;
 
@@ -105,6 +139,10 @@ namespace road {
     /// map. The waypoints are placed at the entrance of each lane.
     std::vector<std::pair<Waypoint, Waypoint>> GenerateTopology() const;
 
+    const MapData &GetMap() const {
+      return _data;
+    }
+
 #ifdef LIBCARLA_WITH_GTEST
     MapData &GetMap() {
       return _data;
@@ -114,6 +152,8 @@ namespace road {
 private:
 
     MapData _data;
+
+    SpatialIndex _spatial_index;
   };
 
 } // namespace road
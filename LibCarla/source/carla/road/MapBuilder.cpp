@@ -361,15 +361,26 @@ namespace road {
   }
 
   void MapBuilder::AddRoadGeometrySpiral(
-      carla::road::Road * /*road*/,
-      const double /*s*/,
-      const double /*x*/,
-      const double /*y*/,
-      const double /*hdg*/,
-      const double /*length*/,
-      const double /*curvStart*/,
-      const double /*curvEnd*/) {
-    throw_exception(std::runtime_error("geometry spiral not supported"));
+      carla::road::Road *road,
+      const double s,
+      const double x,
+      const double y,
+      const double hdg,
+      const double length,
+      const double curvStart,
+      const double curvEnd) {
+    DEBUG_ASSERT(road != nullptr);
+    const geom::Location location(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    auto spiral_geometry = std::make_unique<GeometrySpiral>(
+        s,
+        length,
+        hdg,
+        location,
+        curvStart,
+        curvEnd);
+
+    _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
+        std::move(spiral_geometry))));
   }
 
   void MapBuilder::AddRoadGeometryPoly3(
@@ -71,6 +71,8 @@ namespace road {
 
     friend class MapBuilder;
 
+    friend class MapSerializer;
+
     MapData() = default;
 
     geom::GeoLocation _geo_reference;
@@ -0,0 +1,787 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/MapSerializer.h"
+
+#include "carla/BinaryStream.h"
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+#include "carla/road/element/RoadInfoElevation.h"
+#include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoLaneAccess.h"
+#include "carla/road/element/RoadInfoLaneBorder.h"
+#include "carla/road/element/RoadInfoLaneHeight.h"
+#include "carla/road/element/RoadInfoLaneMaterial.h"
+#include "carla/road/element/RoadInfoLaneOffset.h"
+#include "carla/road/element/RoadInfoLaneRule.h"
+#include "carla/road/element/RoadInfoLaneVisibility.h"
+#include "carla/road/element/RoadInfoLaneWidth.h"
+#include "carla/road/element/RoadInfoMarkRecord.h"
+#include "carla/road/element/RoadInfoMarkTypeLine.h"
+#include "carla/road/element/RoadInfoSpeed.h"
+#include "carla/road/element/RoadInfoVisitor.h"
+
+#include <iterator>
+#include <limits>
+#include <memory>
+
+namespace carla {
+namespace road {
+
+  using namespace carla::road::element;
+
+  /// "CMAP" in little-endian, a big-endian reader will see a different value
+  /// and discard the data.
+  static constexpr uint32_t MAGIC = 0x50414d43u;
+
+  /// Identifies the type of each serialized RoadInfo.
+  enum class InfoType : uint8_t {
+    Elevation,
+    Geometry,
+    LaneAccess,
+    LaneBorder,
+    LaneHeight,
+    LaneMaterial,
+    LaneOffset,
+    LaneRule,
+    LaneVisibility,
+    LaneWidth,
+    MarkRecord,
+    Speed
+  };
+
+  // ===========================================================================
+  // -- Serialization ----------------------------------------------------------
+  // ===========================================================================
+
+  static void WritePolynomial(BinaryWriter &out, const geom::CubicPolynomial &polynomial) {
+    // The coefficients are stored already shifted by the start offset.
+    out.Write(polynomial.GetA());
+    out.Write(polynomial.GetB());
+    out.Write(polynomial.GetC());
+    out.Write(polynomial.GetD());
+  }
+
+  static void WriteGeometry(BinaryWriter &out, const Geometry &geometry) {
+    out.Write(geometry.GetType());
+    out.Write(geometry.GetStartOffset());
+    out.Write(geometry.GetLength());
+    out.Write(geometry.GetHeading());
+    const auto &start = geometry.GetStartPosition();
+    out.Write(start.x);
+    out.Write(start.y);
+    out.Write(start.z);
+    switch (geometry.GetType()) {
+      case GeometryType::ARC:
+        out.Write(static_cast<const GeometryArc &>(geometry).GetCurvature());
+        break;
+      case GeometryType::SPIRAL: {
+        const auto &spiral = static_cast<const GeometrySpiral &>(geometry);
+        out.Write(spiral.GetCurveStart());
+        out.Write(spiral.GetCurveEnd());
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  /// Writes every visited RoadInfo preceded by its type and distance.
+  class InfoWriter final : public RoadInfoVisitor {
+  public:
+
+    explicit InfoWriter(BinaryWriter &out) : _out(out) {}
+
+    /// Number of infos written so far.
+    uint32_t count() const {
+      return _count;
+    }
+
+    void Visit(RoadInfoElevation &info) final {
+      Begin(InfoType::Elevation, info);
+      WritePolynomial(_out, info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoGeometry &info) final {
+      Begin(InfoType::Geometry, info);
+      WriteGeometry(_out, info.GetGeometry());
+    }
+
+    void Visit(RoadInfoLaneAccess &info) final {
+      Begin(InfoType::LaneAccess, info);
+      _out.Write(info.GetRestriction());
+    }
+
+    void Visit(RoadInfoLaneBorder &info) final {
+      Begin(InfoType::LaneBorder, info);
+      WritePolynomial(_out, info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoLaneHeight &info) final {
+      Begin(InfoType::LaneHeight, info);
+      _out.Write(info.GetInner());
+      _out.Write(info.GetOuter());
+    }
+
+    void Visit(RoadInfoLaneMaterial &info) final {
+      Begin(InfoType::LaneMaterial, info);
+      _out.Write(info.GetSurface());
+      _out.Write(info.GetFriction());
+      _out.Write(info.GetRoughness());
+    }
+
+    void Visit(RoadInfoLaneOffset &info) final {
+      Begin(InfoType::LaneOffset, info);
+      WritePolynomial(_out, info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoLaneRule &info) final {
+      Begin(InfoType::LaneRule, info);
+      _out.Write(info.GetValue());
+    }
+
+    void Visit(RoadInfoLaneVisibility &info) final {
+      Begin(InfoType::LaneVisibility, info);
+      _out.Write(info.GetForward());
+      _out.Write(info.GetBack());
+      _out.Write(info.GetLeft());
+      _out.Write(info.GetRight());
+    }
+
+    void Visit(RoadInfoLaneWidth &info) final {
+      Begin(InfoType::LaneWidth, info);
+      WritePolynomial(_out, info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoMarkRecord &info) final {
+      Begin(InfoType::MarkRecord, info);
+      _out.Write(info.GetRoadMarkId());
+      _out.Write(info.GetType());
+      _out.Write(info.GetWeight());
+      _out.Write(info.GetColor());
+      _out.Write(info.GetMaterial());
+      _out.Write(info.GetWidth());
+      _out.Write(info.GetLaneChange());
+      _out.Write(info.GetHeight());
+      _out.Write(info.GetTypeName());
+      _out.Write(info.GetTypeWidth());
+      const auto &lines = info.GetLines();
+      _out.WriteCount(lines.size());
+      for (const auto &line : lines) {
+        DEBUG_ASSERT(line != nullptr);
+        _out.Write(line->GetDistance());
+        _out.Write(line->GetRoadMarkId());
+        _out.Write(line->GetLength());
+        _out.Write(line->GetSpace());
+        _out.Write(line->GetTOffset());
+        _out.Write(line->GetRule());
+        _out.Write(line->GetWidth());
+      }
+    }
+
+    void Visit(RoadInfoSpeed &info) final {
+      Begin(InfoType::Speed, info);
+      _out.Write(info.GetSpeed());
+    }
+
+  private:
+
+    void Begin(InfoType type, const RoadInfo &info) {
+      _out.Write(type);
+      _out.Write(info.GetDistance());
+      ++_count;
+    }
+
+    BinaryWriter &_out;
+
+    uint32_t _count = 0u;
+  };
+
+  static void WriteLaneRef(BinaryWriter &out, const Lane *lane) {
+    DEBUG_ASSERT(lane != nullptr);
+    DEBUG_ASSERT(lane->GetLaneSection() != nullptr);
+    out.Write(lane->GetRoad()->GetId());
+    out.Write(lane->GetLaneSection()->GetId());
+    out.Write(lane->GetId());
+  }
+
+  // ===========================================================================
+  // -- Deserialization --------------------------------------------------------
+  // ===========================================================================
+
+  static geom::CubicPolynomial ReadPolynomial(BinaryReader &in) {
+    const auto a = in.Read<double>();
+    const auto b = in.Read<double>();
+    const auto c = in.Read<double>();
+    const auto d = in.Read<double>();
+    return {a, b, c, d};
+  }
+
+  static std::unique_ptr<Geometry> ReadGeometry(BinaryReader &in) {
+    const auto type = in.Read<GeometryType>();
+    const auto s = in.Read<double>();
+    const auto length = in.Read<double>();
+    const auto heading = in.Read<double>();
+    const auto x = in.Read<float>();
+    const auto y = in.Read<float>();
+    const auto z = in.Read<float>();
+    const geom::Location start(x, y, z);
+    switch (type) {
+      case GeometryType::LINE:
+        return std::make_unique<GeometryLine>(s, length, heading, start);
+      case GeometryType::ARC: {
+        const auto curvature = in.Read<double>();
+        return std::make_unique<GeometryArc>(s, length, heading, start, curvature);
+      }
+      case GeometryType::SPIRAL: {
+        const auto curve_start = in.Read<double>();
+        const auto curve_end = in.Read<double>();
+        return std::make_unique<GeometrySpiral>(s, length, heading, start, curve_start, curve_end);
+      }
+      default:
+        in.Fail();
+        return nullptr;
+    }
+  }
+
+  static std::unique_ptr<RoadInfo> ReadInfo(BinaryReader &in) {
+    const auto type = in.Read<InfoType>();
+    const auto s = in.Read<double>();
+    switch (type) {
+      case InfoType::Elevation:
+        return std::make_unique<RoadInfoElevation>(s, ReadPolynomial(in));
+      case InfoType::Geometry: {
+        auto geometry = ReadGeometry(in);
+        if (geometry == nullptr) {
+          return nullptr;
+        }
+        return std::make_unique<RoadInfoGeometry>(s, std::move(geometry));
+      }
+      case InfoType::LaneAccess:
+        return std::make_unique<RoadInfoLaneAccess>(s, in.ReadString());
+      case InfoType::LaneBorder:
+        return std::make_unique<RoadInfoLaneBorder>(s, ReadPolynomial(in));
+      case InfoType::LaneHeight: {
+        const auto inner = in.Read<double>();
+        const auto outer = in.Read<double>();
+        return std::make_unique<RoadInfoLaneHeight>(s, inner, outer);
+      }
+      case InfoType::LaneMaterial: {
+        auto surface = in.ReadString();
+        const auto friction = in.Read<double>();
+        const auto roughness = in.Read<double>();
+        return std::make_unique<RoadInfoLaneMaterial>(s, std::move(surface), friction, roughness);
+      }
+      case InfoType::LaneOffset:
+        return std::make_unique<RoadInfoLaneOffset>(s, ReadPolynomial(in));
+      case InfoType::LaneRule:
+        return std::make_unique<RoadInfoLaneRule>(s, in.ReadString());
+      case InfoType::LaneVisibility: {
+        const auto forward = in.Read<double>();
+        const auto back = in.Read<double>();
+        const auto left = in.Read<double>();
+        const auto right = in.Read<double>();
+        return std::make_unique<RoadInfoLaneVisibility>(s, forward, back, left, right);
+      }
+      case InfoType::LaneWidth:
+        return std::make_unique<RoadInfoLaneWidth>(s, ReadPolynomial(in));
+      case InfoType::MarkRecord: {
+        const auto road_mark_id = in.Read<int>();
+        auto mark_type = in.ReadString();
+        auto weight = in.ReadString();
+        auto color = in.ReadString();
+        auto material = in.ReadString();
+        const auto width = in.Read<double>();
+        const auto lane_change = in.Read<RoadInfoMarkRecord::LaneChange>();
+        const auto height = in.Read<double>();
+        auto type_name = in.ReadString();
+        const auto type_width = in.Read<double>();
+        auto record = std::make_unique<RoadInfoMarkRecord>(
+            s,
+            road_mark_id,
+            std::move(mark_type),
+            std::move(weight),
+            std::move(color),
+            std::move(material),
+            width,
+            lane_change,
+            height,
+            std::move(type_name),
+            type_width);
+        const auto line_count = in.ReadCount();
+        for (auto i = 0u; i < line_count; ++i) {
+          const auto line_s = in.Read<double>();
+          const auto line_mark_id = in.Read<int>();
+          const auto length = in.Read<double>();
+          const auto space = in.Read<double>();
+          const auto t_offset = in.Read<double>();
+          auto rule = in.ReadString();
+          const auto line_width = in.Read<double>();
+          record->GetLines().emplace_back(std::make_unique<RoadInfoMarkTypeLine>(
+              line_s, line_mark_id, length, space, t_offset, std::move(rule), line_width));
+        }
+        return record;
+      }
+      case InfoType::Speed:
+        return std::make_unique<RoadInfoSpeed>(s, in.Read<double>());
+      default:
+        in.Fail();
+        return nullptr;
+    }
+  }
+
+  static std::vector<std::unique_ptr<RoadInfo>> ReadInfos(BinaryReader &in) {
+    std::vector<std::unique_ptr<RoadInfo>> infos;
+    const auto count = in.ReadCount();
+    infos.reserve(count);
+    for (auto i = 0u; (i < count) && !in.Failed(); ++i) {
+      auto info = ReadInfo(in);
+      if (info != nullptr) {
+        infos.emplace_back(std::move(info));
+      }
+    }
+    return infos;
+  }
+
+  static std::vector<general::Validity> ReadValidities(BinaryReader &in) {
+    std::vector<general::Validity> validities;
+    const auto count = in.ReadCount();
+    for (auto i = 0u; i < count; ++i) {
+      const auto parent_id = in.Read<uint32_t>();
+      const auto from_lane = in.Read<LaneId>();
+      const auto to_lane = in.Read<LaneId>();
+      validities.emplace_back(parent_id, from_lane, to_lane);
+    }
+    return validities;
+  }
+
+  /// Identifies a lane while the map is being deserialized, the pointers are
+  /// resolved once every road has been read.
+  struct LaneRef {
+    RoadId road_id;
+    SectionId section_id;
+    LaneId lane_id;
+  };
+
+  static std::vector<LaneRef> ReadLaneRefs(BinaryReader &in) {
+    std::vector<LaneRef> refs;
+    const auto count = in.ReadCount();
+    refs.reserve(count);
+    for (auto i = 0u; i < count; ++i) {
+      const auto road_id = in.Read<RoadId>();
+      const auto section_id = in.Read<SectionId>();
+      const auto lane_id = in.Read<LaneId>();
+      refs.push_back(LaneRef{road_id, section_id, lane_id});
+    }
+    return refs;
+  }
+
+  static std::vector<RoadId> ReadRoadIds(BinaryReader &in) {
+    std::vector<RoadId> ids;
+    const auto count = in.ReadCount();
+    ids.reserve(count);
+    for (auto i = 0u; i < count; ++i) {
+      ids.push_back(in.Read<RoadId>());
+    }
+    return ids;
+  }
+
+  // ===========================================================================
+  // -- MapSerializer ----------------------------------------------------------
+  // ===========================================================================
+
+  constexpr uint32_t MapSerializer::FORMAT_VERSION;
+
+  uint64_t MapSerializer::ComputeHash(const std::string &opendrive) {
+    return ComputeFnv1aHash(reinterpret_cast<const unsigned char *>(opendrive.data()), opendrive.size());
+  }
+
+  std::vector<unsigned char> MapSerializer::Serialize(
+      const Map &map,
+      const uint64_t source_hash) {
+    const MapData &data = map.GetMap();
+    BinaryWriter out;
+
+    // Header, the checksum is patched at the end.
+    out.Write(MAGIC);
+    out.Write(FORMAT_VERSION);
+    out.Write(source_hash);
+    const size_t checksum_offset = out.size();
+    out.Write(uint64_t(0u));
+    const size_t header_size = out.size();
+
+    const auto &geo_reference = data.GetGeoReference();
+    out.Write(geo_reference.latitude);
+    out.Write(geo_reference.longitude);
+    out.Write(geo_reference.altitude);
+
+    const auto write_infos = [&out](const InformationSet &info_set) {
+      const size_t count_offset = out.size();
+      out.Write(uint32_t(0u));
+      InfoWriter writer(out);
+      for (const auto &info : info_set._road_set.GetAll()) {
+        DEBUG_ASSERT(info != nullptr);
+        info->AcceptVisitor(writer);
+      }
+      // Infos of types without a serialized representation are skipped.
+      out.Patch(count_offset, writer.count());
+    };
+
+    const auto write_validities = [&out](const std::vector<general::Validity> &validities) {
+      out.WriteCount(validities.size());
+      for (const auto &validity : validities) {
+        out.Write(validity._parent_id);
+        out.Write(validity._from_lane);
+        out.Write(validity._to_lane);
+      }
+    };
+
+    out.WriteCount(data._roads.size());
+    for (const auto &pair : data._roads) {
+      const Road &road = pair.second;
+      out.Write(road._id);
+      out.Write(road._name);
+      out.Write(road._length);
+      out.Write(road._is_junction);
+      out.Write(road._junction_id);
+      out.Write(road._successor);
+      out.Write(road._predecessor);
+      write_infos(road._info);
+
+      // Lane sections are written in order of increasing s.
+      out.WriteCount(static_cast<size_t>(
+          std::distance(road._lane_sections.begin(), road._lane_sections.end())));
+      for (const auto &section_pair : road._lane_sections) {
+        const LaneSection &section = section_pair.second;
+        out.Write(section._id);
+        out.Write(section._s);
+        WritePolynomial(out, section._lane_offset);
+        out.WriteCount(section._lanes.size());
+        for (const auto &lane_pair : section._lanes) {
+          const Lane &lane = lane_pair.second;
+          out.Write(lane._id);
+          out.Write(lane._type);
+          out.Write(lane._level);
+          out.Write(lane._successor);
+          out.Write(lane._predecessor);
+          write_infos(lane._info);
+          out.WriteCount(lane._next_lanes.size());
+          for (const auto *next : lane._next_lanes) {
+            WriteLaneRef(out, next);
+          }
+          out.WriteCount(lane._prev_lanes.size());
+          for (const auto *prev : lane._prev_lanes) {
+            WriteLaneRef(out, prev);
+          }
+        }
+      }
+
+      out.WriteCount(road._nexts.size());
+      for (const auto *next : road._nexts) {
+        out.Write(next->GetId());
+      }
+      out.WriteCount(road._prevs.size());
+      for (const auto *prev : road._prevs) {
+        out.Write(prev->GetId());
+      }
+
+      out.WriteCount(road._signals.size());
+      for (const auto &signal_pair : road._signals) {
+        const auto &signal = signal_pair.second;
+        out.Write(signal_pair.first);
+        out.Write(signal._road_id);
+        out.Write(signal._signal_id);
+        out.Write(signal._s);
+        out.Write(signal._t);
+        out.Write(signal._name);
+        out.Write(signal._dynamic);
+        out.Write(signal._orientation);
+        out.Write(signal._zOffset);
+        out.Write(signal._country);
+        out.Write(signal._type);
+        out.Write(signal._subtype);
+        out.Write(signal._value);
+        out.Write(signal._unit);
+        out.Write(signal._height);
+        out.Write(signal._width);
+        out.Write(signal._text);
+        out.Write(signal._hOffset);
+        out.Write(signal._pitch);
+        out.Write(signal._roll);
+        write_validities(signal._validities);
+        out.WriteCount(signal._dependencies.size());
+        for (const auto &dependency : signal._dependencies) {
+          out.Write(dependency._road_id);
+          out.Write(dependency._signal_id);
+          out.Write(dependency._dependency_id);
+          out.Write(dependency._type);
+        }
+      }
+
+      out.WriteCount(road._sign_ref.size());
+      for (const auto &reference_pair : road._sign_ref) {
+        const auto &reference = reference_pair.second;
+        out.Write(reference_pair.first);
+        out.Write(reference._road_id);
+        out.Write(reference._signal_id);
+        out.Write(reference._s);
+        out.Write(reference._t);
+        out.Write(reference._orientation);
+        write_validities(reference._validities);
+      }
+    }
+
+    out.WriteCount(data._junctions.size());
+    for (const auto &pair : data._junctions) {
+      const Junction &junction = pair.second;
+      out.Write(junction._id);
+      out.Write(junction._name);
+      out.WriteCount(junction._connections.size());
+      for (const auto &connection_pair : junction._connections) {
+        const auto &connection = connection_pair.second;
+        out.Write(connection.id);
+        out.Write(connection.incoming_road);
+        out.Write(connection.connecting_road);
+        out.WriteCount(connection.lane_links.size());
+        for (const auto &link : connection.lane_links) {
+          out.Write(link.from);
+          out.Write(link.to);
+        }
+      }
+    }
+
+    auto &buffer = out.buffer();
+    out.Patch(checksum_offset, ComputeFnv1aHash(buffer.data() + header_size, buffer.size() - header_size));
+    return std::move(buffer);
+  }
+
+  boost::optional<Map> MapSerializer::Deserialize(
+      const unsigned char *data,
+      const size_t size,
+      const uint64_t source_hash) {
+    DEBUG_ASSERT(data != nullptr);
+    BinaryReader in(data, size);
+
+    if ((in.Read<uint32_t>() != MAGIC) ||
+        (in.Read<uint32_t>() != FORMAT_VERSION) ||
+        (in.Read<uint64_t>() != source_hash)) {
+      return {};
+    }
+    const auto checksum = in.Read<uint64_t>();
+    if (in.Failed() || (checksum != ComputeFnv1aHash(data + (size - in.Remaining()), in.Remaining()))) {
+      log_warning("serialized map is corrupted");
+      return {};
+    }
+
+    MapData map_data;
+    map_data._geo_reference.latitude = in.Read<double>();
+    map_data._geo_reference.longitude = in.Read<double>();
+    map_data._geo_reference.altitude = in.Read<double>();
+
+    struct PendingLinks {
+      Lane *lane;
+      std::vector<LaneRef> next_lanes;
+      std::vector<LaneRef> prev_lanes;
+    };
+    std::vector<PendingLinks> pending_lanes;
+
+    struct PendingRoads {
+      Road *road;
+      std::vector<RoadId> nexts;
+      std::vector<RoadId> prevs;
+    };
+    std::vector<PendingRoads> pending_roads;
+
+    const auto road_count = in.ReadCount();
+    map_data._roads.reserve(road_count);
+    pending_roads.reserve(road_count);
+    for (auto i = 0u; (i < road_count) && !in.Failed(); ++i) {
+      const auto road_id = in.Read<RoadId>();
+      auto result = map_data._roads.emplace(road_id, Road());
+      if (!result.second) {
+        in.Fail();
+        break;
+      }
+      Road &road = result.first->second;
+      road._map_data = &map_data;
+      road._id = road_id;
+      road._name = in.ReadString();
+      road._length = in.Read<double>();
+      road._is_junction = in.ReadBool();
+      road._junction_id = in.Read<JuncId>();
+      road._successor = in.Read<RoadId>();
+      road._predecessor = in.Read<RoadId>();
+      road._info = InformationSet(ReadInfos(in));
+
+      const auto section_count = in.ReadCount();
+      for (auto j = 0u; j < section_count; ++j) {
+        const auto section_id = in.Read<SectionId>();
+        const auto s = in.Read<double>();
+        LaneSection &section = road._lane_sections.Emplace(section_id, s);
+        section._road = &road;
+        section._lane_offset = ReadPolynomial(in);
+        const auto lane_count = in.ReadCount();
+        for (auto k = 0u; k < lane_count; ++k) {
+          const auto lane_id = in.Read<LaneId>();
+          Lane &lane = section._lanes.emplace(lane_id, Lane()).first->second;
+          lane._id = lane_id;
+          lane._lane_section = &section;
+          lane._type = in.Read<Lane::LaneType>();
+          lane._level = in.ReadBool();
+          lane._successor = in.Read<LaneId>();
+          lane._predecessor = in.Read<LaneId>();
+          lane._info = InformationSet(ReadInfos(in));
+          auto next_lanes = ReadLaneRefs(in);
+          auto prev_lanes = ReadLaneRefs(in);
+          pending_lanes.push_back(PendingLinks{&lane, std::move(next_lanes), std::move(prev_lanes)});
+        }
+      }
+
+      auto nexts = ReadRoadIds(in);
+      auto prevs = ReadRoadIds(in);
+      pending_roads.push_back(PendingRoads{&road, std::move(nexts), std::move(prevs)});
+
+      const auto signal_count = in.ReadCount();
+      for (auto j = 0u; j < signal_count; ++j) {
+        const auto key = in.Read<SignId>();
+        const auto signal_road_id = in.Read<RoadId>();
+        const auto signal_id = in.Read<SignId>();
+        const auto s = in.Read<double>();
+        const auto t = in.Read<double>();
+        auto name = in.ReadString();
+        auto dynamic = in.ReadString();
+        auto orientation = in.ReadString();
+        const auto z_offset = in.Read<double>();
+        auto country = in.ReadString();
+        auto type = in.ReadString();
+        auto subtype = in.ReadString();
+        const auto value = in.Read<double>();
+        auto unit = in.ReadString();
+        const auto height = in.Read<double>();
+        const auto width = in.Read<double>();
+        auto text = in.ReadString();
+        const auto h_offset = in.Read<double>();
+        const auto pitch = in.Read<double>();
+        const auto roll = in.Read<double>();
+        auto &signal = road._signals.emplace(key, signal::Signal(
+            signal_road_id, signal_id, s, t, name, dynamic, orientation, z_offset,
+            country, type, subtype, value, unit, height, width, text, h_offset,
+            pitch, roll)).first->second;
+        signal._validities = ReadValidities(in);
+        const auto dependency_count = in.ReadCount();
+        for (auto k = 0u; k < dependency_count; ++k) {
+          const auto dependency_road_id = in.Read<RoadId>();
+          const auto dependency_signal_id = in.Read<SignId>();
+          const auto dependency_id = in.Read<uint32_t>();
+          auto dependency_type = in.ReadString();
+          signal.AddDependency(signal::SignalDependency(
+              dependency_road_id,
+              dependency_signal_id,
+              dependency_id,
+              std::move(dependency_type)));
+        }
+      }
+
+      const auto reference_count = in.ReadCount();
+      for (auto j = 0u; j < reference_count; ++j) {
+        const auto key = in.Read<SignRefId>();
+        const auto reference_road_id = in.Read<RoadId>();
+        const auto signal_id = in.Read<SignId>();
+        const auto s = in.Read<double>();
+        const auto t = in.Read<double>();
+        auto orientation = in.ReadString();
+        auto &reference = road._sign_ref.emplace(key, signal::SignalReference(
+            reference_road_id, signal_id, s, t, std::move(orientation))).first->second;
+        reference._validities = ReadValidities(in);
+      }
+    }
+
+    const auto junction_count = in.ReadCount();
+    for (auto i = 0u; (i < junction_count) && !in.Failed(); ++i) {
+      const auto junction_id = in.Read<JuncId>();
+      auto name = in.ReadString();
+      auto &junction = map_data._junctions.emplace(
+          junction_id,
+          Junction(junction_id, std::move(name))).first->second;
+      const auto connection_count = in.ReadCount();
+      for (auto j = 0u; j < connection_count; ++j) {
+        const auto connection_id = in.Read<ConId>();
+        const auto incoming_road = in.Read<RoadId>();
+        const auto connecting_road = in.Read<RoadId>();
+        auto &connection = junction._connections.emplace(
+            connection_id,
+            Junction::Connection(connection_id, incoming_road, connecting_road)).first->second;
+        const auto link_count = in.ReadCount();
+        for (auto k = 0u; k < link_count; ++k) {
+          const auto from = in.Read<LaneId>();
+          const auto to = in.Read<LaneId>();
+          connection.AddLaneLink(from, to);
+        }
+      }
+    }
+
+    if (in.Failed() || (in.Remaining() != 0u)) {
+      log_warning("serialized map is corrupted");
+      return {};
+    }
+
+    // Now that every lane exists, convert the references back to pointers.
+    const auto find_lane = [&map_data](const LaneRef &ref) -> Lane * {
+      auto road = map_data._roads.find(ref.road_id);
+      if (road == map_data._roads.end()) {
+        return nullptr;
+      }
+      for (auto &section : road->second._lane_sections) {
+        if (section.second._id == ref.section_id) {
+          auto lane = section.second._lanes.find(ref.lane_id);
+          return lane != section.second._lanes.end() ? &lane->second : nullptr;
+        }
+      }
+      return nullptr;
+    };
+    const auto resolve_lanes = [&](const std::vector<LaneRef> &refs, std::vector<Lane *> &lanes) {
+      lanes.reserve(refs.size());
+      for (const auto &ref : refs) {
+        auto *lane = find_lane(ref);
+        if (lane == nullptr) {
+          return false;
+        }
+        lanes.push_back(lane);
+      }
+      return true;
+    };
+    for (auto &pending : pending_lanes) {
+      if (!resolve_lanes(pending.next_lanes, pending.lane->_next_lanes) ||
+          !resolve_lanes(pending.prev_lanes, pending.lane->_prev_lanes)) {
+        log_warning("serialized map contains links to missing lanes");
+        return {};
+      }
+    }
+
+    const auto resolve_roads = [&map_data](const std::vector<RoadId> &ids, std::vector<Road *> &roads) {
+      roads.reserve(ids.size());
+      for (const auto id : ids) {
+        auto road = map_data._roads.find(id);
+        if (road == map_data._roads.end()) {
+          return false;
+        }
+        roads.push_back(&road->second);
+      }
+      return true;
+    };
+    for (auto &pending : pending_roads) {
+      if (!resolve_roads(pending.nexts, pending.road->_nexts) ||
+          !resolve_roads(pending.prevs, pending.road->_prevs)) {
+        log_warning("serialized map contains links to missing roads");
+        return {};
+      }
+    }
+
+    return Map{std::move(map_data)};
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,59 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/Map.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// Converts a road::Map to a compact binary representation and back, so
+  /// maps can be cached on disk and loaded without parsing the OpenDRIVE file
+  /// again.
+  ///
+  /// The binary starts with a header containing a magic number, the format
+  /// version, the hash of the OpenDRIVE source it was built from and a
+  /// checksum of the rest of the data. The topology of the map (successor and
+  /// predecessor lanes and roads) is stored as well, so loading does not need
+  /// to recompute it.
+  ///
+  /// The data is read in a single pass from a contiguous block of memory, so
+  /// it can be loaded directly from a memory-mapped file.
+  class MapSerializer {
+  public:
+
+    /// Version of the binary format, increment it every time the layout
+    /// changes so outdated caches are discarded.
+    static constexpr uint32_t FORMAT_VERSION = 1u;
+
+    /// Hash of the contents of an OpenDRIVE file, used to check whether a
+    /// serialized map corresponds to a given source.
+    static uint64_t ComputeHash(const std::string &opendrive);
+
+    /// Serialize @a map tagging it with the @a source_hash of the OpenDRIVE
+    /// it was parsed from.
+    static std::vector<unsigned char> Serialize(
+        const Map &map,
+        uint64_t source_hash);
+
+    /// Deserialize a map previously generated with Serialize. Return an empty
+    /// optional if @a data is not compatible with this version, it does not
+    /// match @a source_hash, or it is corrupted.
+    static boost::optional<Map> Deserialize(
+        const unsigned char *data,
+        size_t size,
+        uint64_t source_hash);
+  };
+
+} // namespace road
+} // namespace carla
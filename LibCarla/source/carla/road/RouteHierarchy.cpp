@@ -0,0 +1,443 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/RouteHierarchy.h"
+
+#include "carla/BinaryStream.h"
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace carla {
+namespace road {
+
+  /// "CRCH" in little-endian, a big-endian reader will see a different value
+  /// and discard the data.
+  static constexpr uint32_t MAGIC = 0x48435243u;
+
+  static constexpr double INF = std::numeric_limits<double>::infinity();
+
+  /// Maximum number of nodes settled by a witness search. A search cut short
+  /// only adds shortcuts that might not be needed, the hierarchy is still
+  /// correct.
+  static constexpr size_t WITNESS_SEARCH_LIMIT = 500u;
+
+  // ===========================================================================
+  // -- RouteHierarchy::Contraction --------------------------------------------
+  // ===========================================================================
+
+  /// Graph of the nodes not contracted yet, with the arcs between them.
+  class RouteHierarchy::Contraction {
+  public:
+
+    Contraction(std::vector<Arc> &arcs, size_t size)
+      : _arcs(arcs),
+        _out(size),
+        _in(size),
+        _contracted(size, false),
+        _contracted_neighbours(size, 0u),
+        _level(size, 0u),
+        _distance(size, INF) {
+      for (auto i = 0u; i < _arcs.size(); ++i) {
+        const auto &arc = _arcs[i];
+        if (arc.source != arc.target) {
+          _out[arc.source].emplace_back(i);
+          _in[arc.target].emplace_back(i);
+        }
+      }
+    }
+
+    /// Higher values are contracted later.
+    int ComputePriority(uint32_t node) {
+      const auto removed = RemoveContractedArcs(node);
+      const auto shortcuts = AddShortcuts(node, false);
+      return 2 * static_cast<int>(shortcuts) - static_cast<int>(removed) +
+             static_cast<int>(_contracted_neighbours[node]) + static_cast<int>(_level[node]);
+    }
+
+    /// Contract @a node, returning its arcs to the nodes not contracted yet,
+    /// outgoing and incoming.
+    std::pair<std::vector<uint32_t>, std::vector<uint32_t>> Contract(uint32_t node) {
+      RemoveContractedArcs(node);
+      AddShortcuts(node, true);
+      _contracted[node] = true;
+      for (const auto arc : _out[node]) {
+        const auto target = _arcs[arc].target;
+        ++_contracted_neighbours[target];
+        _level[target] = std::max(_level[target], _level[node] + 1u);
+      }
+      for (const auto arc : _in[node]) {
+        const auto source = _arcs[arc].source;
+        ++_contracted_neighbours[source];
+        _level[source] = std::max(_level[source], _level[node] + 1u);
+      }
+      auto result = std::make_pair(std::move(_out[node]), std::move(_in[node]));
+      _out[node].clear();
+      _in[node].clear();
+      return result;
+    }
+
+  private:
+
+    struct QueueItem {
+      double cost;
+      uint32_t node;
+
+      friend bool operator>(const QueueItem &lhs, const QueueItem &rhs) {
+        return lhs.cost > rhs.cost;
+      }
+    };
+
+    /// Return the number of arcs left.
+    size_t RemoveContractedArcs(uint32_t node) {
+      auto &out = _out[node];
+      out.erase(std::remove_if(out.begin(), out.end(), [this](uint32_t arc) {
+        return _contracted[_arcs[arc].target];
+      }), out.end());
+      auto &in = _in[node];
+      in.erase(std::remove_if(in.begin(), in.end(), [this](uint32_t arc) {
+        return _contracted[_arcs[arc].source];
+      }), in.end());
+      return out.size() + in.size();
+    }
+
+    /// Shortest distances from @a source without going through @a excluded,
+    /// up to @a max_cost.
+    void WitnessSearch(uint32_t source, uint32_t excluded, double max_cost) {
+      for (const auto node : _touched) {
+        _distance[node] = INF;
+      }
+      _touched.clear();
+      std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+      _distance[source] = 0.0;
+      _touched.emplace_back(source);
+      queue.push(QueueItem{0.0, source});
+      size_t settled = 0u;
+      while (!queue.empty() && (settled < WITNESS_SEARCH_LIMIT)) {
+        const auto item = queue.top();
+        queue.pop();
+        if (item.cost > _distance[item.node]) {
+          continue;
+        }
+        if (item.cost > max_cost) {
+          break;
+        }
+        ++settled;
+        for (const auto arc : _out[item.node]) {
+          const auto target = _arcs[arc].target;
+          if ((target == excluded) || _contracted[target]) {
+            continue;
+          }
+          const double cost = item.cost + _arcs[arc].cost;
+          if (cost < _distance[target]) {
+            if (_distance[target] == INF) {
+              _touched.emplace_back(target);
+            }
+            _distance[target] = cost;
+            queue.push(QueueItem{cost, target});
+          }
+        }
+      }
+    }
+
+    /// Count the shortcuts needed to contract @a node, and add them if @a
+    /// add is true.
+    size_t AddShortcuts(uint32_t node, bool add) {
+      size_t count = 0u;
+      // Copy, adding shortcuts may modify the lists of the neighbours.
+      const auto in = _in[node];
+      const auto out = _out[node];
+      for (const auto first : in) {
+        const auto source = _arcs[first].source;
+        double max_cost = -1.0;
+        for (const auto second : out) {
+          if (_arcs[second].target != source) {
+            max_cost = std::max(max_cost, _arcs[first].cost + _arcs[second].cost);
+          }
+        }
+        if (max_cost < 0.0) {
+          continue;
+        }
+        WitnessSearch(source, node, max_cost);
+        for (const auto second : out) {
+          const auto target = _arcs[second].target;
+          const double cost = _arcs[first].cost + _arcs[second].cost;
+          if ((target == source) || (_distance[target] <= cost)) {
+            continue;
+          }
+          ++count;
+          if (add) {
+            AddShortcut(first, second, cost);
+          }
+        }
+      }
+      return count;
+    }
+
+    void AddShortcut(uint32_t first, uint32_t second, double cost) {
+      const auto source = _arcs[first].source;
+      const auto target = _arcs[second].target;
+      // Replace a longer arc between the same nodes.
+      auto &out = _out[source];
+      auto it = std::find_if(out.begin(), out.end(), [&](uint32_t arc) {
+        return _arcs[arc].target == target;
+      });
+      if ((it != out.end()) && (_arcs[*it].cost <= cost)) {
+        return;
+      }
+      const auto index = static_cast<uint32_t>(_arcs.size());
+      _arcs.emplace_back(Arc{source, target, cost, RoutePlanner::Maneuver::LaneFollow, first, second});
+      if (it != out.end()) {
+        const auto previous = *it;
+        *it = index;
+        auto &in = _in[target];
+        std::replace(in.begin(), in.end(), previous, index);
+      } else {
+        out.emplace_back(index);
+        _in[target].emplace_back(index);
+      }
+    }
+
+    std::vector<Arc> &_arcs;
+
+    std::vector<std::vector<uint32_t>> _out;
+
+    std::vector<std::vector<uint32_t>> _in;
+
+    std::vector<bool> _contracted;
+
+    std::vector<uint32_t> _contracted_neighbours;
+
+    std::vector<uint32_t> _level;
+
+    /// Distances of the last witness search, only the touched nodes are
+    /// reset.
+    std::vector<double> _distance;
+
+    std::vector<uint32_t> _touched;
+  };
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  /// Compressed adjacency of @a lists.
+  static void MakeCompressed(
+      const std::vector<std::vector<uint32_t>> &lists,
+      std::vector<uint32_t> &offsets,
+      std::vector<uint32_t> &values) {
+    offsets.clear();
+    values.clear();
+    offsets.reserve(lists.size() + 1u);
+    offsets.emplace_back(0u);
+    for (const auto &list : lists) {
+      values.insert(values.end(), list.begin(), list.end());
+      offsets.emplace_back(static_cast<uint32_t>(values.size()));
+    }
+  }
+
+  /// Links to the targets of @a arcs, or to the sources if @a to_target is
+  /// false.
+  template <typename ArcT, typename LinkT>
+  static void MakeLinks(
+      const std::vector<ArcT> &all_arcs,
+      const std::vector<uint32_t> &arcs,
+      const bool to_target,
+      std::vector<LinkT> &links) {
+    links.clear();
+    links.reserve(arcs.size());
+    for (const auto index : arcs) {
+      const auto &arc = all_arcs[index];
+      links.emplace_back(LinkT{arc.cost, to_target ? arc.target : arc.source, index});
+    }
+  }
+
+  // ===========================================================================
+  // -- RouteHierarchy ---------------------------------------------------------
+  // ===========================================================================
+
+  constexpr uint32_t RouteHierarchy::FORMAT_VERSION;
+
+  constexpr uint32_t RouteHierarchy::NONE;
+
+  RouteHierarchy::RouteHierarchy(const RoutePlanner &planner)
+    : _graph_hash(planner.ComputeGraphHash()),
+      _number_of_edges(planner._edges.size()) {
+    const auto size = planner._nodes.size();
+    _arcs.reserve(2u * _number_of_edges);
+    for (auto i = 0u; i < size; ++i) {
+      for (auto j = planner._offsets[i]; j < planner._offsets[i + 1u]; ++j) {
+        const auto &edge = planner._edges[j];
+        _arcs.emplace_back(Arc{i, edge.target, edge.cost, edge.maneuver, NONE, NONE});
+      }
+    }
+
+    // Contract first the nodes adding the fewest shortcuts, priorities are
+    // updated lazily when the node reaches the top of the queue.
+    Contraction contraction(_arcs, size);
+    using Item = std::pair<int, uint32_t>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    for (auto i = 0u; i < size; ++i) {
+      queue.emplace(contraction.ComputePriority(i), i);
+    }
+    std::vector<std::vector<uint32_t>> up(size);
+    std::vector<std::vector<uint32_t>> down(size);
+    while (!queue.empty()) {
+      const auto node = queue.top().second;
+      queue.pop();
+      const auto priority = contraction.ComputePriority(node);
+      if (!queue.empty() && (priority > queue.top().first)) {
+        queue.emplace(priority, node);
+        continue;
+      }
+      auto arcs = contraction.Contract(node);
+      up[node] = std::move(arcs.first);
+      down[node] = std::move(arcs.second);
+    }
+    std::vector<uint32_t> up_arcs;
+    std::vector<uint32_t> down_arcs;
+    MakeCompressed(up, _up_offsets, up_arcs);
+    MakeCompressed(down, _down_offsets, down_arcs);
+    MakeLinks(_arcs, up_arcs, true, _up_links);
+    MakeLinks(_arcs, down_arcs, false, _down_links);
+  }
+
+  std::vector<unsigned char> RouteHierarchy::Serialize(const uint64_t source_hash) const {
+    BinaryWriter out;
+
+    // Header, the checksum is patched at the end.
+    out.Write(MAGIC);
+    out.Write(FORMAT_VERSION);
+    out.Write(source_hash);
+    out.Write(_graph_hash);
+    const size_t checksum_offset = out.size();
+    out.Write(uint64_t(0u));
+    const size_t header_size = out.size();
+
+    // The edges of the planner are not stored, only the shortcuts.
+    out.WriteCount(_number_of_edges);
+    out.WriteCount(_arcs.size() - _number_of_edges);
+    for (auto i = _number_of_edges; i < _arcs.size(); ++i) {
+      const auto &arc = _arcs[i];
+      out.Write(arc.source);
+      out.Write(arc.target);
+      out.Write(arc.cost);
+      out.Write(arc.first);
+      out.Write(arc.second);
+    }
+    // Only the arc indices of the links are stored.
+    for (const auto *offsets : {&_up_offsets, &_down_offsets}) {
+      out.WriteCount(offsets->size());
+      for (const auto value : *offsets) {
+        out.Write(value);
+      }
+    }
+    for (const auto *links : {&_up_links, &_down_links}) {
+      out.WriteCount(links->size());
+      for (const auto &link : *links) {
+        out.Write(link.arc);
+      }
+    }
+
+    auto &buffer = out.buffer();
+    out.Patch(checksum_offset, ComputeFnv1aHash(buffer.data() + header_size, buffer.size() - header_size));
+    return std::move(buffer);
+  }
+
+  boost::optional<RouteHierarchy> RouteHierarchy::Deserialize(
+      const RoutePlanner &planner,
+      const unsigned char *data,
+      const size_t size,
+      const uint64_t source_hash) {
+    DEBUG_ASSERT(data != nullptr);
+    BinaryReader in(data, size);
+
+    if ((in.Read<uint32_t>() != MAGIC) ||
+        (in.Read<uint32_t>() != FORMAT_VERSION) ||
+        (in.Read<uint64_t>() != source_hash) ||
+        (in.Read<uint64_t>() != planner.ComputeGraphHash())) {
+      return {};
+    }
+    const auto checksum = in.Read<uint64_t>();
+    if (in.Failed() || (checksum != ComputeFnv1aHash(data + (size - in.Remaining()), in.Remaining()))) {
+      log_warning("serialized route hierarchy is corrupted");
+      return {};
+    }
+
+    const auto number_of_nodes = planner._nodes.size();
+    RouteHierarchy result;
+    result._graph_hash = planner.ComputeGraphHash();
+    result._number_of_edges = planner._edges.size();
+    if (in.ReadCount() != result._number_of_edges) {
+      in.Fail();
+    }
+    const auto shortcut_count = in.ReadCount();
+    result._arcs.reserve(result._number_of_edges + shortcut_count);
+    for (auto i = 0u; i < number_of_nodes; ++i) {
+      for (auto j = planner._offsets[i]; j < planner._offsets[i + 1u]; ++j) {
+        const auto &edge = planner._edges[j];
+        result._arcs.emplace_back(Arc{i, edge.target, edge.cost, edge.maneuver, NONE, NONE});
+      }
+    }
+    for (auto i = 0u; (i < shortcut_count) && !in.Failed(); ++i) {
+      Arc arc;
+      arc.source = in.Read<uint32_t>();
+      arc.target = in.Read<uint32_t>();
+      arc.cost = in.Read<double>();
+      arc.maneuver = RoutePlanner::Maneuver::LaneFollow;
+      arc.first = in.Read<uint32_t>();
+      arc.second = in.Read<uint32_t>();
+      // Shortcuts only replace arcs created before them.
+      if ((arc.source >= number_of_nodes) ||
+          (arc.target >= number_of_nodes) ||
+          (arc.first >= result._arcs.size()) ||
+          (arc.second >= result._arcs.size())) {
+        in.Fail();
+        break;
+      }
+      result._arcs.emplace_back(arc);
+    }
+    std::vector<uint32_t> up_arcs;
+    std::vector<uint32_t> down_arcs;
+    for (auto *values : {&result._up_offsets, &result._down_offsets, &up_arcs, &down_arcs}) {
+      const auto count = in.ReadCount();
+      values->reserve(count);
+      for (auto i = 0u; (i < count) && !in.Failed(); ++i) {
+        values->emplace_back(in.Read<uint32_t>());
+      }
+    }
+
+    if (in.Failed() || (in.Remaining() != 0u)) {
+      log_warning("serialized route hierarchy is corrupted");
+      return {};
+    }
+
+    // Check the ranges used by the queries.
+    const auto is_valid = [&](const std::vector<uint32_t> &offsets, const std::vector<uint32_t> &arcs) {
+      return (offsets.size() == number_of_nodes + 1u) &&
+             (offsets.front() == 0u) &&
+             (offsets.back() == arcs.size()) &&
+             std::is_sorted(offsets.begin(), offsets.end()) &&
+             std::all_of(arcs.begin(), arcs.end(), [&](uint32_t arc) {
+               return arc < result._arcs.size();
+             });
+    };
+    if (!is_valid(result._up_offsets, up_arcs) ||
+        !is_valid(result._down_offsets, down_arcs)) {
+      log_warning("serialized route hierarchy is corrupted");
+      return {};
+    }
+    MakeLinks(result._arcs, up_arcs, true, result._up_links);
+    MakeLinks(result._arcs, down_arcs, false, result._down_links);
+    return result;
+  }
+
+} // namespace road
+} // namespace carla
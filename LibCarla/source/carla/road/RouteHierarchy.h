@@ -0,0 +1,120 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/road/RoutePlanner.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// Contraction hierarchy of the lane graph of a RoutePlanner, used by
+  /// RoutePlanner::Algorithm::ContractionHierarchy to answer route queries
+  /// visiting only a small fraction of the lanes.
+  ///
+  /// The lanes are contracted one by one in order of importance, adding a
+  /// shortcut between the neighbours of each contracted lane wherever the
+  /// lane was part of their shortest connection. A query then only follows
+  /// connections to more important lanes, forward from the origin and
+  /// backward from the destination, and expands the shortcuts of the route
+  /// found.
+  ///
+  /// Building the hierarchy is considerably slower than building the planner,
+  /// so it can be serialized to be cached on disk. The serialized hierarchy
+  /// is tagged with the hash of the OpenDRIVE source and of the lane graph it
+  /// was built from, same header layout as MapSerializer.
+  class RouteHierarchy : private MovableNonCopyable {
+  public:
+
+    /// Version of the binary format, increment it every time the layout
+    /// changes so outdated caches are discarded.
+    static constexpr uint32_t FORMAT_VERSION = 1u;
+
+    RouteHierarchy() = default;
+
+    /// Contract the lane graph of @a planner. The hierarchy can only be used
+    /// with this planner, or with another one built from the same map.
+    explicit RouteHierarchy(const RoutePlanner &planner);
+
+    /// Serialize the hierarchy tagging it with the @a source_hash of the
+    /// OpenDRIVE it was built from, see MapSerializer::ComputeHash.
+    std::vector<unsigned char> Serialize(uint64_t source_hash) const;
+
+    /// Deserialize a hierarchy previously generated with Serialize. Return an
+    /// empty optional if @a data is not compatible with this version, it does
+    /// not match @a source_hash or the graph of @a planner, or it is
+    /// corrupted.
+    static boost::optional<RouteHierarchy> Deserialize(
+        const RoutePlanner &planner,
+        const unsigned char *data,
+        size_t size,
+        uint64_t source_hash);
+
+    /// Number of shortcuts added to the connections of the planner.
+    size_t GetNumberOfShortcuts() const {
+      return _arcs.size() - _number_of_edges;
+    }
+
+  private:
+
+    friend class RoutePlanner;
+
+    class Contraction;
+
+    static constexpr uint32_t NONE = ~0u;
+
+    /// A connection of the planner graph, or a shortcut replacing the arcs
+    /// @a first and @a second.
+    struct Arc {
+      uint32_t source;
+      uint32_t target;
+      double cost;
+      RoutePlanner::Maneuver maneuver;
+      uint32_t first;
+      uint32_t second;
+
+      bool IsShortcut() const {
+        return first != NONE;
+      }
+    };
+
+    /// Hash of the graph of the planner the hierarchy was built from.
+    uint64_t _graph_hash = 0u;
+
+    /// The first arcs are the edges of the planner, in the same order.
+    size_t _number_of_edges = 0u;
+
+    std::vector<Arc> _arcs;
+
+    /// Arc between a node and a more important node, with a copy of the
+    /// other node and the cost so the queries do not need to look up the arc.
+    struct Link {
+      double cost;
+      uint32_t node;
+      uint32_t arc;
+    };
+
+    /// Arcs from the i-th node to more important nodes are
+    /// _up_links[_up_offsets[i]] to _up_links[_up_offsets[i + 1] - 1].
+    std::vector<uint32_t> _up_offsets;
+
+    std::vector<Link> _up_links;
+
+    /// Same as above for the arcs reaching the i-th node from more important
+    /// nodes.
+    std::vector<uint32_t> _down_offsets;
+
+    std::vector<Link> _down_links;
+  };
+
+} // namespace road
+} // namespace carla
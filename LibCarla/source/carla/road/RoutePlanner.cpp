@@ -0,0 +1,856 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/RoutePlanner.h"
+
+#include "carla/BinaryStream.h"
+#include "carla/Debug.h"
+#include "carla/geom/Math.h"
+#include "carla/road/Map.h"
+#include "carla/road/RouteHierarchy.h"
+#include "carla/road/element/RoadInfoMarkRecord.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <tuple>
+
+namespace carla {
+namespace road {
+
+  using namespace carla::road::element;
+
+  /// Distance along the road between the points sampled to measure the
+  /// length of a lane [meters].
+  static constexpr double SAMPLING_STEP = 2.0;
+
+  /// Waypoints are kept this far from the ends of their lane section, same as
+  /// the waypoints generated by Map.
+  static constexpr double EPSILON = 100.0 * std::numeric_limits<double>::epsilon();
+
+  static constexpr double INF = std::numeric_limits<double>::infinity();
+
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  static auto MakeKey(RoadId road_id, SectionId section_id, LaneId lane_id) {
+    return std::make_tuple(road_id, section_id, lane_id);
+  }
+
+  /// Lane changes allowed at @a waypoint, same as client::Waypoint::GetLaneChange.
+  static uint8_t GetLaneChange(const Map &map, const Waypoint &waypoint) {
+    constexpr auto RIGHT = static_cast<uint8_t>(LaneMarking::LaneChange::Right);
+    constexpr auto LEFT = static_cast<uint8_t>(LaneMarking::LaneChange::Left);
+    constexpr auto BOTH = static_cast<uint8_t>(LaneMarking::LaneChange::Both);
+    const auto to_flags = [=](const RoadInfoMarkRecord *record) {
+      return record != nullptr ? static_cast<uint8_t>(record->GetLaneChange()) : BOTH;
+    };
+    // The flags of the lanes going backward are relative to the road.
+    const auto swap = [=](uint8_t flags) -> uint8_t {
+      return flags == RIGHT ? LEFT : (flags == LEFT ? RIGHT : flags);
+    };
+    const auto marks = map.GetMarkRecord(waypoint);
+    auto right = to_flags(marks.first);
+    auto left = to_flags(marks.second);
+    if (waypoint.lane_id > 0) {
+      right = swap(right);
+    }
+    if (((waypoint.lane_id > 0) ? waypoint.lane_id - 1 : waypoint.lane_id + 1) > 0) {
+      left = swap(left);
+    }
+    return static_cast<uint8_t>((right & RIGHT) | (left & LEFT));
+  }
+
+  // ===========================================================================
+  // -- RoutePlanner -----------------------------------------------------------
+  // ===========================================================================
+
+  RoutePlanner::RoutePlanner(const Map &map, const double lane_change_cost) {
+    // Nodes.
+    for (const auto &pair : map.GetMap().GetRoads()) {
+      const auto &road = pair.second;
+      for (const auto &lane_section : road.GetLaneSections()) {
+        for (const auto &lane_pair : lane_section.GetLanes()) {
+          const auto &lane = lane_pair.second;
+          if ((lane.GetId() == 0) ||
+              ((static_cast<uint32_t>(lane.GetType()) & static_cast<uint32_t>(Lane::LaneType::Driving)) == 0u)) {
+            continue;
+          }
+          Node node;
+          node.road_id = road.GetId();
+          node.section_id = lane_section.GetId();
+          node.lane_id = lane.GetId();
+          node.s_begin = lane.GetDistance();
+          node.s_end = std::min(lane.GetDistance() + lane.GetLength(), road.GetLength());
+          _nodes.emplace_back(node);
+        }
+      }
+    }
+    std::sort(_nodes.begin(), _nodes.end(), [](const Node &lhs, const Node &rhs) {
+      return MakeKey(lhs.road_id, lhs.section_id, lhs.lane_id) <
+             MakeKey(rhs.road_id, rhs.section_id, rhs.lane_id);
+    });
+
+    // Lane lengths, sampling the lane center.
+    for (auto &node : _nodes) {
+      const double length = node.s_end - node.s_begin;
+      const auto steps = std::max<size_t>(1u, static_cast<size_t>(std::ceil(length / SAMPLING_STEP)));
+      node.first_sample = static_cast<uint32_t>(_samples.size());
+      node.number_of_samples = static_cast<uint32_t>(steps + 1u);
+      const double entry_s = GetEntryS(node);
+      const double sign = (node.lane_id <= 0) ? 1.0 : -1.0;
+      geom::Location previous;
+      double distance = 0.0;
+      for (auto i = 0u; i <= steps; ++i) {
+        const double relative_s = length * static_cast<double>(i) / static_cast<double>(steps);
+        const auto location = map.ComputeTransform(MakeWaypoint(node, entry_s + sign * relative_s)).location;
+        if (i == 0u) {
+          node.entry = location;
+        } else {
+          distance += geom::Math::Distance(previous, location);
+        }
+        previous = location;
+        _samples.emplace_back(Sample{relative_s, distance});
+      }
+      node.length = distance;
+    }
+
+    // Edges. Costs are never shorter than the straight line between the lane
+    // entries, to keep the A* heuristic consistent.
+    std::vector<std::vector<Edge>> edges(_nodes.size());
+    for (auto i = 0u; i < _nodes.size(); ++i) {
+      const auto &node = _nodes[i];
+      const auto middle = MakeWaypoint(node, 0.5 * (node.s_begin + node.s_end));
+      auto connect = [&](NodeId target, Maneuver maneuver, double cost) {
+        const double straight = geom::Math::Distance(node.entry, _nodes[target].entry);
+        edges[i].emplace_back(Edge{target, maneuver, std::max(cost, straight)});
+      };
+      for (const auto *next_lane : map.GetLane(middle).GetNextLanes()) {
+        RELEASE_ASSERT(next_lane != nullptr);
+        const auto target = FindNode(Waypoint{
+            next_lane->GetRoad()->GetId(),
+            next_lane->GetLaneSection()->GetId(),
+            next_lane->GetId(),
+            0.0});
+        if (target.has_value()) {
+          connect(*target, Maneuver::LaneFollow, node.length);
+        }
+      }
+      const auto lane_change = GetLaneChange(map, middle);
+      auto connect_neighbour = [&](const boost::optional<Waypoint> &neighbour, LaneMarking::LaneChange flag, Maneuver maneuver) {
+        if (!neighbour.has_value() ||
+            ((neighbour->lane_id > 0) != (node.lane_id > 0)) ||
+            ((lane_change & static_cast<uint8_t>(flag)) == 0u)) {
+          return;
+        }
+        const auto target = FindNode(*neighbour);
+        if (target.has_value()) {
+          connect(*target, maneuver, lane_change_cost);
+        }
+      };
+      connect_neighbour(map.GetLeft(middle), LaneMarking::LaneChange::Left, Maneuver::ChangeLaneLeft);
+      connect_neighbour(map.GetRight(middle), LaneMarking::LaneChange::Right, Maneuver::ChangeLaneRight);
+    }
+
+    // Compressed adjacency, forward and reversed.
+    _offsets.reserve(_nodes.size() + 1u);
+    _offsets.emplace_back(0u);
+    std::vector<uint32_t> in_degree(_nodes.size(), 0u);
+    for (auto &&node_edges : edges) {
+      for (auto &&edge : node_edges) {
+        _edges.emplace_back(edge);
+        ++in_degree[edge.target];
+      }
+      _offsets.emplace_back(static_cast<uint32_t>(_edges.size()));
+    }
+    _reverse_offsets.reserve(_nodes.size() + 1u);
+    _reverse_offsets.emplace_back(0u);
+    for (auto count : in_degree) {
+      _reverse_offsets.emplace_back(_reverse_offsets.back() + count);
+    }
+    _reverse_edges.resize(_edges.size());
+    std::vector<uint32_t> position(_reverse_offsets.begin(), _reverse_offsets.end() - 1);
+    for (auto i = 0u; i < _nodes.size(); ++i) {
+      for (auto j = _offsets[i]; j < _offsets[i + 1u]; ++j) {
+        const auto &edge = _edges[j];
+        _reverse_edges[position[edge.target]++] = Edge{i, edge.maneuver, edge.cost};
+      }
+    }
+  }
+
+  // ===========================================================================
+  // -- RoutePlanner::Search ---------------------------------------------------
+  // ===========================================================================
+
+  /// The search starts at the origin and at the lanes it can change to right
+  /// there, which are not graph nodes since the route enters them halfway.
+  /// Graph nodes are only entered at the start of their lane, so the route
+  /// cost is the cost of the start plus the edges, and the destination is
+  /// reached from the start of its lane or directly from a start on its lane.
+  struct RoutePlanner::Search {
+    struct Start {
+      NodeId node;
+      /// Cost of the lane changes from the origin.
+      double cost;
+      /// Index of the previous start, NONE for the origin.
+      uint32_t previous;
+      Maneuver maneuver;
+    };
+
+    std::vector<Start> starts;
+
+    NodeId destination;
+    /// Lane center length from the start of the destination lane to the
+    /// destination.
+    double destination_offset;
+    /// Location of the destination, for the A* heuristic.
+    geom::Location target;
+    /// Cost of driving from the i-th start to the end of its lane.
+    std::vector<double> remaining;
+    /// Cost of driving from the i-th start to the destination without leaving
+    /// the lane, infinite if the destination is not ahead on its lane.
+    std::vector<double> direct;
+    /// Cost of the route found.
+    double cost = INF;
+  };
+
+  // ===========================================================================
+  // -- RoutePlanner::Workspace ------------------------------------------------
+  // ===========================================================================
+
+  /// Per node state of the searches. Only the nodes touched by a search are
+  /// reset afterwards, so a batch of queries allocates it once and the
+  /// queries visiting a few nodes do not pay for the size of the graph.
+  struct RoutePlanner::Workspace {
+    explicit Workspace(size_t size)
+      : forward_cost(size, INF),
+        backward_cost(size, INF),
+        parent(size, {NONE, Maneuver::LaneFollow}),
+        next(size, {NONE, Maneuver::LaneFollow}),
+        arc(size, NONE) {}
+
+    /// Must be called before changing the costs of @a node.
+    void Touch(NodeId node) {
+      if ((forward_cost[node] == INF) && (backward_cost[node] == INF)) {
+        touched.emplace_back(node);
+      }
+    }
+
+    void Reset() {
+      for (auto node : touched) {
+        forward_cost[node] = INF;
+        backward_cost[node] = INF;
+        parent[node] = {NONE, Maneuver::LaneFollow};
+        next[node] = {NONE, Maneuver::LaneFollow};
+        arc[node] = NONE;
+      }
+      touched.clear();
+    }
+
+    std::vector<double> forward_cost;
+    std::vector<double> backward_cost;
+    /// Previous node in the forward search, values from the number of nodes
+    /// on refer to the starts.
+    std::vector<std::pair<uint32_t, Maneuver>> parent;
+    /// Next node in the backward search, or arc of the hierarchy in
+    /// ContractionHierarchy.
+    std::vector<std::pair<uint32_t, Maneuver>> next;
+    /// Arc of the hierarchy reaching the node in the forward search.
+    std::vector<uint32_t> arc;
+    std::vector<NodeId> touched;
+  };
+
+  namespace {
+
+    /// Entry of the priority queues.
+    struct QueueItem {
+      double priority;
+      double cost;
+      uint32_t node;
+
+      friend bool operator>(const QueueItem &lhs, const QueueItem &rhs) {
+        return lhs.priority > rhs.priority;
+      }
+    };
+
+    using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+  } // namespace
+
+  /// Relative distance along the road from the start of the lane of @a node.
+  template <typename NodeT>
+  static double GetRelativeS(const NodeT &node, double s) {
+    return (node.lane_id <= 0) ? s - node.s_begin : node.s_end - s;
+  }
+
+  boost::optional<RoutePlanner::Route> RoutePlanner::ComputeRoute(
+      const Map &map,
+      const Waypoint origin,
+      const Waypoint destination,
+      const Algorithm algorithm,
+      const RouteHierarchy *hierarchy) const {
+    Workspace workspace(_nodes.size());
+    return ComputeRoute(map, origin, destination, algorithm, hierarchy, workspace);
+  }
+
+  std::vector<boost::optional<RoutePlanner::Route>> RoutePlanner::ComputeRoutes(
+      const Map &map,
+      const std::vector<std::pair<Waypoint, Waypoint>> &queries,
+      const Algorithm algorithm,
+      const RouteHierarchy *hierarchy) const {
+    std::vector<boost::optional<Route>> result;
+    result.reserve(queries.size());
+    Workspace workspace(_nodes.size());
+    for (const auto &query : queries) {
+      result.emplace_back(ComputeRoute(map, query.first, query.second, algorithm, hierarchy, workspace));
+    }
+    return result;
+  }
+
+  boost::optional<RoutePlanner::Route> RoutePlanner::ComputeRoute(
+      const Map &map,
+      const Waypoint &origin,
+      const Waypoint &destination,
+      const Algorithm algorithm,
+      const RouteHierarchy *hierarchy,
+      Workspace &workspace) const {
+    RELEASE_ASSERT((algorithm != Algorithm::ContractionHierarchy) || (hierarchy != nullptr));
+    DEBUG_ASSERT((hierarchy == nullptr) || (hierarchy->_up_offsets.size() == _nodes.size() + 1u));
+    const auto origin_node = FindNode(origin);
+    const auto destination_node = FindNode(destination);
+    if (!origin_node.has_value() || !destination_node.has_value()) {
+      return boost::none;
+    }
+
+    Search search;
+    search.destination = *destination_node;
+    search.destination_offset = DistanceOnLane(_nodes[search.destination], destination.s);
+    search.target = map.ComputeTransform(destination).location;
+
+    // Starts, following the lane changes out of the origin lane. The lanes
+    // going in the same direction in a section are side by side, so each is
+    // reached only once.
+    search.starts.emplace_back(Search::Start{*origin_node, 0.0, NONE, Maneuver::LaneFollow});
+    for (auto i = 0u; i < search.starts.size(); ++i) {
+      const auto start = search.starts[i];
+      for (auto j = _offsets[start.node]; j < _offsets[start.node + 1u]; ++j) {
+        const auto &edge = _edges[j];
+        if (edge.maneuver == Maneuver::LaneFollow) {
+          continue;
+        }
+        const double cost = start.cost + edge.cost;
+        auto it = std::find_if(search.starts.begin(), search.starts.end(), [&](const Search::Start &item) {
+          return item.node == edge.target;
+        });
+        if (it == search.starts.end()) {
+          search.starts.emplace_back(Search::Start{edge.target, cost, i, edge.maneuver});
+        }
+      }
+    }
+    const double origin_relative_s = GetRelativeS(_nodes[*origin_node], origin.s);
+    for (const auto &start : search.starts) {
+      const auto &node = _nodes[start.node];
+      const double traveled = DistanceOnLane(node, origin.s);
+      search.remaining.emplace_back(start.cost + std::max(0.0, node.length - traveled));
+      const bool ahead =
+          (start.node == search.destination) &&
+          (GetRelativeS(node, destination.s) >= origin_relative_s);
+      search.direct.emplace_back(ahead ?
+          start.cost + std::max(0.0, search.destination_offset - traveled) :
+          INF);
+    }
+
+    boost::optional<Path> path;
+    switch (algorithm) {
+      case Algorithm::AStar:
+        path = AStar(search, workspace);
+        break;
+      case Algorithm::BidirectionalDijkstra:
+        path = BidirectionalDijkstra(search, workspace);
+        break;
+      case Algorithm::ContractionHierarchy:
+        path = ContractionHierarchy(search, workspace, *hierarchy);
+        break;
+    }
+    workspace.Reset();
+    if (!path.has_value()) {
+      return boost::none;
+    }
+    DEBUG_ASSERT(!path->empty());
+    DEBUG_ASSERT(path->front().first == *origin_node);
+    DEBUG_ASSERT(path->back().first == search.destination);
+
+    // Lane changes happen where the previous segment started, since they
+    // connect lanes of the same lane section.
+    Route route;
+    route.cost = search.cost;
+    route.segments.reserve(path->size());
+    double begin_s = origin.s;
+    for (auto i = 0u; i < path->size(); ++i) {
+      const auto &node = _nodes[(*path)[i].first];
+      const auto maneuver = (*path)[i].second;
+      if ((i > 0u) && (maneuver == Maneuver::LaneFollow)) {
+        begin_s = GetEntryS(node);
+      }
+      double end_s;
+      if (i + 1u == path->size()) {
+        end_s = destination.s;
+      } else if ((*path)[i + 1u].second != Maneuver::LaneFollow) {
+        end_s = begin_s;
+      } else {
+        end_s = (node.lane_id <= 0) ? node.s_end : node.s_begin;
+      }
+      const auto begin = MakeWaypoint(node, begin_s);
+      const auto end = MakeWaypoint(node, end_s);
+      const double length = std::max(0.0, DistanceOnLane(node, end.s) - DistanceOnLane(node, begin.s));
+      route.segments.emplace_back(Segment{begin, end.s, length, maneuver});
+    }
+    return route;
+  }
+
+  std::vector<std::pair<Waypoint, RoutePlanner::Maneuver>> RoutePlanner::SampleRoute(
+      const Route &route,
+      const double distance) {
+    RELEASE_ASSERT(distance > 0.0);
+    std::vector<std::pair<Waypoint, Maneuver>> result;
+    for (const auto &segment : route.segments) {
+      result.emplace_back(segment.waypoint, segment.maneuver);
+      if (segment.length > 0.0) {
+        const auto steps = static_cast<size_t>(std::ceil(segment.length / distance));
+        const double step = (segment.end_s - segment.waypoint.s) / static_cast<double>(steps);
+        for (auto i = 1u; i < steps; ++i) {
+          auto waypoint = segment.waypoint;
+          waypoint.s += step * static_cast<double>(i);
+          result.emplace_back(waypoint, Maneuver::LaneFollow);
+        }
+      }
+    }
+    if (!route.segments.empty() && (route.segments.back().length > 0.0)) {
+      auto waypoint = route.segments.back().waypoint;
+      waypoint.s = route.segments.back().end_s;
+      result.emplace_back(waypoint, Maneuver::LaneFollow);
+    }
+    return result;
+  }
+
+  boost::optional<RoutePlanner::NodeId> RoutePlanner::FindNode(const Waypoint &waypoint) const {
+    const auto key = MakeKey(waypoint.road_id, waypoint.section_id, waypoint.lane_id);
+    const auto it = std::lower_bound(_nodes.begin(), _nodes.end(), key, [](const Node &node, const decltype(key) &value) {
+      return MakeKey(node.road_id, node.section_id, node.lane_id) < value;
+    });
+    if ((it == _nodes.end()) || (MakeKey(it->road_id, it->section_id, it->lane_id) != key)) {
+      return boost::none;
+    }
+    return static_cast<NodeId>(it - _nodes.begin());
+  }
+
+  double RoutePlanner::DistanceOnLane(const Node &node, const double s) const {
+    const double length = node.s_end - node.s_begin;
+    const double relative_s = std::min(length, std::max(0.0,
+        (node.lane_id <= 0) ? s - node.s_begin : node.s_end - s));
+    const auto begin = _samples.begin() + node.first_sample;
+    const auto end = begin + node.number_of_samples;
+    auto it = std::lower_bound(begin, end, relative_s, [](const Sample &sample, double value) {
+      return sample.relative_s < value;
+    });
+    if (it == begin) {
+      return 0.0;
+    }
+    if (it == end) {
+      return (end - 1)->distance;
+    }
+    const auto &previous = *(it - 1);
+    const double t = (relative_s - previous.relative_s) / (it->relative_s - previous.relative_s);
+    return previous.distance + t * (it->distance - previous.distance);
+  }
+
+  Waypoint RoutePlanner::MakeWaypoint(const Node &node, const double s) {
+    const double margin = std::min(EPSILON, 0.5 * (node.s_end - node.s_begin));
+    return Waypoint{
+        node.road_id,
+        node.section_id,
+        node.lane_id,
+        std::min(node.s_end - margin, std::max(node.s_begin + margin, s))};
+  }
+
+  double RoutePlanner::GetEntryS(const Node &node) {
+    return (node.lane_id <= 0) ? node.s_begin : node.s_end;
+  }
+
+  uint64_t RoutePlanner::ComputeGraphHash() const {
+    BinaryWriter out;
+    out.WriteCount(_nodes.size());
+    for (const auto &node : _nodes) {
+      out.Write(node.road_id);
+      out.Write(node.section_id);
+      out.Write(node.lane_id);
+    }
+    out.Write(_offsets.back());
+    for (const auto offset : _offsets) {
+      out.Write(offset);
+    }
+    for (const auto &edge : _edges) {
+      out.Write(edge.target);
+      out.Write(edge.maneuver);
+      out.Write(edge.cost);
+    }
+    return ComputeFnv1aHash(out.buffer().data(), out.size());
+  }
+
+  RoutePlanner::Path RoutePlanner::MakePath(
+      const Search &search,
+      const std::vector<std::pair<NodeId, Maneuver>> &parent,
+      uint32_t node) const {
+    Path path;
+    while (node < _nodes.size()) {
+      path.emplace_back(node, parent[node].second);
+      node = parent[node].first;
+    }
+    DEBUG_ASSERT(node != NONE);
+    for (auto i = node - static_cast<uint32_t>(_nodes.size()); i != NONE; i = search.starts[i].previous) {
+      path.emplace_back(search.starts[i].node, search.starts[i].maneuver);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+  }
+
+  boost::optional<RoutePlanner::Path> RoutePlanner::AStar(Search &search, Workspace &workspace) const {
+    const auto size = static_cast<uint32_t>(_nodes.size());
+    const auto heuristic = [&](NodeId node) {
+      return static_cast<double>(geom::Math::Distance(_nodes[node].entry, search.target));
+    };
+    auto &cost = workspace.forward_cost;
+    auto &parent = workspace.parent;
+
+    // Candidates to reach the destination are queued as NONE with their exact
+    // cost, the search ends when the best one is at the top.
+    double best = INF;
+    std::pair<uint32_t, Maneuver> best_parent{NONE, Maneuver::LaneFollow};
+    bool best_is_direct = false;
+    Queue queue;
+
+    auto reach = [&](uint32_t from, const Edge &edge, double next_cost) {
+      if (edge.target == search.destination) {
+        const double total = next_cost + search.destination_offset;
+        if (total < best) {
+          best = total;
+          best_parent = {from, edge.maneuver};
+          best_is_direct = false;
+          queue.push(QueueItem{total, total, NONE});
+        }
+      }
+      if (next_cost < cost[edge.target]) {
+        workspace.Touch(edge.target);
+        cost[edge.target] = next_cost;
+        parent[edge.target] = {from, edge.maneuver};
+        queue.push(QueueItem{next_cost + heuristic(edge.target), next_cost, edge.target});
+      }
+    };
+
+    for (auto i = 0u; i < search.starts.size(); ++i) {
+      if (search.direct[i] < best) {
+        best = search.direct[i];
+        best_parent = {size + i, Maneuver::LaneFollow};
+        best_is_direct = true;
+        queue.push(QueueItem{best, best, NONE});
+      }
+      const auto node = search.starts[i].node;
+      for (auto j = _offsets[node]; j < _offsets[node + 1u]; ++j) {
+        if (_edges[j].maneuver == Maneuver::LaneFollow) {
+          reach(size + i, _edges[j], search.remaining[i]);
+        }
+      }
+    }
+
+    while (!queue.empty()) {
+      const auto item = queue.top();
+      queue.pop();
+      if (item.node == NONE) {
+        break;
+      }
+      if (item.cost > cost[item.node]) {
+        continue;
+      }
+      for (auto i = _offsets[item.node]; i < _offsets[item.node + 1u]; ++i) {
+        reach(item.node, _edges[i], item.cost + _edges[i].cost);
+      }
+    }
+
+    if (best == INF) {
+      return boost::none;
+    }
+    search.cost = best;
+    if (best_is_direct) {
+      return MakePath(search, parent, best_parent.first);
+    }
+    auto path = MakePath(search, parent, best_parent.first);
+    path.emplace_back(search.destination, best_parent.second);
+    return path;
+  }
+
+  boost::optional<RoutePlanner::Path> RoutePlanner::BidirectionalDijkstra(Search &search, Workspace &workspace) const {
+    const auto size = static_cast<uint32_t>(_nodes.size());
+    auto &forward_cost = workspace.forward_cost;
+    auto &backward_cost = workspace.backward_cost;
+    auto &parent = workspace.parent;
+    auto &next = workspace.next;
+
+    double best = INF;
+    uint32_t meeting = NONE;
+    auto meet = [&](NodeId node) {
+      const double total = forward_cost[node] + backward_cost[node];
+      if (total < best) {
+        best = total;
+        meeting = node;
+      }
+    };
+
+    Queue forward;
+    Queue backward;
+    auto reach = [&](uint32_t from, const Edge &edge, double cost) {
+      if (cost < forward_cost[edge.target]) {
+        workspace.Touch(edge.target);
+        forward_cost[edge.target] = cost;
+        parent[edge.target] = {from, edge.maneuver};
+        forward.push(QueueItem{cost, cost, edge.target});
+        meet(edge.target);
+      }
+    };
+
+    workspace.Touch(search.destination);
+    backward_cost[search.destination] = search.destination_offset;
+    backward.push(QueueItem{search.destination_offset, search.destination_offset, search.destination});
+    for (auto i = 0u; i < search.starts.size(); ++i) {
+      if (search.direct[i] < best) {
+        best = search.direct[i];
+        meeting = size + i;
+      }
+      const auto node = search.starts[i].node;
+      for (auto j = _offsets[node]; j < _offsets[node + 1u]; ++j) {
+        if (_edges[j].maneuver == Maneuver::LaneFollow) {
+          reach(size + i, _edges[j], search.remaining[i]);
+        }
+      }
+    }
+
+    auto drop_stale = [](Queue &queue, const std::vector<double> &cost) {
+      while (!queue.empty() && (queue.top().cost > cost[queue.top().node])) {
+        queue.pop();
+      }
+    };
+
+    for (;;) {
+      drop_stale(forward, forward_cost);
+      drop_stale(backward, backward_cost);
+      if (forward.empty() || backward.empty() ||
+          (forward.top().priority + backward.top().priority >= best)) {
+        break;
+      }
+      if (forward.size() <= backward.size()) {
+        const auto item = forward.top();
+        forward.pop();
+        for (auto i = _offsets[item.node]; i < _offsets[item.node + 1u]; ++i) {
+          reach(item.node, _edges[i], item.cost + _edges[i].cost);
+        }
+      } else {
+        const auto item = backward.top();
+        backward.pop();
+        for (auto i = _reverse_offsets[item.node]; i < _reverse_offsets[item.node + 1u]; ++i) {
+          const auto &edge = _reverse_edges[i];
+          const double cost = item.cost + edge.cost;
+          if (cost < backward_cost[edge.target]) {
+            workspace.Touch(edge.target);
+            backward_cost[edge.target] = cost;
+            next[edge.target] = {item.node, edge.maneuver};
+            backward.push(QueueItem{cost, cost, edge.target});
+            meet(edge.target);
+          }
+        }
+      }
+    }
+
+    if (best == INF) {
+      return boost::none;
+    }
+    search.cost = best;
+    auto path = MakePath(search, parent, meeting);
+    if (meeting < size) {
+      for (auto node = meeting; next[node].first != NONE; node = next[node].first) {
+        path.emplace_back(next[node]);
+      }
+    }
+    return path;
+  }
+
+  boost::optional<RoutePlanner::Path> RoutePlanner::ContractionHierarchy(
+      Search &search,
+      Workspace &workspace,
+      const RouteHierarchy &hierarchy) const {
+    const auto size = static_cast<uint32_t>(_nodes.size());
+    const auto &arcs = hierarchy._arcs;
+    auto &forward_cost = workspace.forward_cost;
+    auto &backward_cost = workspace.backward_cost;
+    // Previous node in the forward search, values from size on refer to the
+    // starts, and arc used to reach the node.
+    auto &parent = workspace.parent;
+    auto &forward_arc = workspace.arc;
+    // Arc used to reach the node in the backward search.
+    auto &backward_arc = workspace.next;
+
+    double best = INF;
+    uint32_t meeting = NONE;
+    auto meet = [&](NodeId node) {
+      const double total = forward_cost[node] + backward_cost[node];
+      if (total < best) {
+        best = total;
+        meeting = node;
+      }
+    };
+
+    Queue forward;
+    Queue backward;
+    auto reach_forward = [&](uint32_t from, NodeId target, uint32_t arc, double cost) {
+      if (cost < forward_cost[target]) {
+        workspace.Touch(target);
+        forward_cost[target] = cost;
+        parent[target] = {from, Maneuver::LaneFollow};
+        forward_arc[target] = arc;
+        forward.push(QueueItem{cost, cost, target});
+        meet(target);
+      }
+    };
+
+    // The starts follow the edges of the planner, which are the first arcs of
+    // the hierarchy, then only arcs to more important nodes are followed in
+    // both directions.
+    workspace.Touch(search.destination);
+    backward_cost[search.destination] = search.destination_offset;
+    backward.push(QueueItem{search.destination_offset, search.destination_offset, search.destination});
+    for (auto i = 0u; i < search.starts.size(); ++i) {
+      if (search.direct[i] < best) {
+        best = search.direct[i];
+        meeting = size + i;
+      }
+      const auto node = search.starts[i].node;
+      for (auto j = _offsets[node]; j < _offsets[node + 1u]; ++j) {
+        if (_edges[j].maneuver == Maneuver::LaneFollow) {
+          reach_forward(size + i, _edges[j].target, j, search.remaining[i]);
+        }
+      }
+    }
+
+    // The searches cannot stop when they meet, a shorter route may go through
+    // a more important node; each one stops when its queue has no cost below
+    // the best route found.
+    auto drop_settled = [&best](Queue &queue, const std::vector<double> &cost) {
+      while (!queue.empty() && (queue.top().cost > cost[queue.top().node])) {
+        queue.pop();
+      }
+      if (!queue.empty() && (queue.top().cost >= best)) {
+        queue = Queue{};
+      }
+    };
+
+    // A node reached with a higher cost than through a more important node
+    // already visited is not on a shortest route, do not expand it.
+    using Link = RouteHierarchy::Link;
+    auto is_stalled = [&](
+        NodeId node,
+        double cost,
+        const std::vector<double> &costs,
+        const std::vector<uint32_t> &offsets,
+        const std::vector<Link> &links) {
+      for (auto i = offsets[node]; i < offsets[node + 1u]; ++i) {
+        if (costs[links[i].node] + links[i].cost < cost) {
+          return true;
+        }
+      }
+      return false;
+    };
+
+    for (;;) {
+      drop_settled(forward, forward_cost);
+      drop_settled(backward, backward_cost);
+      if (forward.empty() && backward.empty()) {
+        break;
+      }
+      if (!forward.empty() && (backward.empty() || (forward.size() <= backward.size()))) {
+        const auto item = forward.top();
+        forward.pop();
+        if (is_stalled(item.node, item.cost, forward_cost, hierarchy._down_offsets, hierarchy._down_links)) {
+          continue;
+        }
+        for (auto i = hierarchy._up_offsets[item.node]; i < hierarchy._up_offsets[item.node + 1u]; ++i) {
+          const auto &link = hierarchy._up_links[i];
+          reach_forward(item.node, link.node, link.arc, item.cost + link.cost);
+        }
+      } else {
+        const auto item = backward.top();
+        backward.pop();
+        if (is_stalled(item.node, item.cost, backward_cost, hierarchy._up_offsets, hierarchy._up_links)) {
+          continue;
+        }
+        for (auto i = hierarchy._down_offsets[item.node]; i < hierarchy._down_offsets[item.node + 1u]; ++i) {
+          const auto &link = hierarchy._down_links[i];
+          const double cost = item.cost + link.cost;
+          if (cost < backward_cost[link.node]) {
+            workspace.Touch(link.node);
+            backward_cost[link.node] = cost;
+            backward_arc[link.node] = {link.arc, Maneuver::LaneFollow};
+            backward.push(QueueItem{cost, cost, link.node});
+            meet(link.node);
+          }
+        }
+      }
+    }
+
+    if (best == INF) {
+      return boost::none;
+    }
+    search.cost = best;
+
+    // Expand the shortcuts of the arcs from the start to the meeting node and
+    // from there to the destination.
+    std::vector<uint32_t> pending;
+    auto expand = [&](uint32_t arc, Path &path) {
+      pending.emplace_back(arc);
+      while (!pending.empty()) {
+        const auto &item = arcs[pending.back()];
+        pending.pop_back();
+        if (item.IsShortcut()) {
+          pending.emplace_back(item.second);
+          pending.emplace_back(item.first);
+        } else {
+          path.emplace_back(item.target, item.maneuver);
+        }
+      }
+    };
+    std::vector<uint32_t> forward_arcs;
+    auto node = meeting;
+    while (node < size) {
+      forward_arcs.emplace_back(forward_arc[node]);
+      node = parent[node].first;
+    }
+    auto path = MakePath(search, parent, node);
+    for (auto it = forward_arcs.rbegin(); it != forward_arcs.rend(); ++it) {
+      expand(*it, path);
+    }
+    if (meeting < size) {
+      for (node = meeting; node != search.destination; node = arcs[backward_arc[node].first].target) {
+        DEBUG_ASSERT(backward_arc[node].first != NONE);
+        expand(backward_arc[node].first, path);
+      }
+    }
+    return path;
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,217 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class Map;
+  class RouteHierarchy;
+
+  /// Lane-level graph of the drivable lanes of a Map, used to compute the
+  /// shortest route between two waypoints. It is built once per map and can
+  /// be queried concurrently from any number of threads.
+  ///
+  /// Each node is a drivable lane of a lane section. A lane is connected to
+  /// the lanes it continues into, with the length of the lane as cost, and to
+  /// the neighbour lanes in the same direction where the lane markings allow
+  /// changing lanes. Lengths are measured along the center of the lanes, so
+  /// the straight-line distance to the destination is a consistent A*
+  /// heuristic.
+  ///
+  /// For applications computing many routes on the same map, a RouteHierarchy
+  /// can be built once from the planner to speed up the queries.
+  class RoutePlanner : private MovableNonCopyable {
+  public:
+
+    enum class Maneuver : uint8_t {
+      LaneFollow,
+      ChangeLaneLeft,
+      ChangeLaneRight
+    };
+
+    enum class Algorithm : uint8_t {
+      AStar,
+      BidirectionalDijkstra,
+      /// Requires a RouteHierarchy built from this planner.
+      ContractionHierarchy
+    };
+
+    /// A stretch of the route driven on a single lane.
+    struct Segment {
+      /// Where the route enters the lane.
+      element::Waypoint waypoint;
+      /// Distance along the road (s) where the route leaves the lane.
+      double end_s;
+      /// Distance driven on the lane [meters].
+      double length;
+      /// How the lane is entered from the previous segment.
+      Maneuver maneuver;
+    };
+
+    struct Route {
+      std::vector<Segment> segments;
+      /// Length of the route, including the cost of the lane changes.
+      double cost;
+    };
+
+    RoutePlanner() = default;
+
+    /// Build the graph of @a map. Changing lanes costs at least @a
+    /// lane_change_cost meters.
+    explicit RoutePlanner(const Map &map, double lane_change_cost = 0.0);
+
+    /// Compute the shortest route from @a origin to @a destination, both
+    /// waypoints of @a map on drivable lanes. Empty if there is no route or
+    /// either waypoint is not on a drivable lane.
+    ///
+    /// @a hierarchy is only used, and required, by
+    /// Algorithm::ContractionHierarchy.
+    boost::optional<Route> ComputeRoute(
+        const Map &map,
+        element::Waypoint origin,
+        element::Waypoint destination,
+        Algorithm algorithm = Algorithm::AStar,
+        const RouteHierarchy *hierarchy = nullptr) const;
+
+    /// Batch version of ComputeRoute, a route for each pair of origin and
+    /// destination in @a queries. Faster than computing the routes one by
+    /// one, the memory used by the searches is allocated only once.
+    std::vector<boost::optional<Route>> ComputeRoutes(
+        const Map &map,
+        const std::vector<std::pair<element::Waypoint, element::Waypoint>> &queries,
+        Algorithm algorithm = Algorithm::AStar,
+        const RouteHierarchy *hierarchy = nullptr) const;
+
+    /// Return the waypoints of @a route separated approximately by @a
+    /// distance, and the maneuver to reach each of them. The last waypoint is
+    /// the destination.
+    static std::vector<std::pair<element::Waypoint, Maneuver>> SampleRoute(
+        const Route &route,
+        double distance);
+
+    /// Number of lanes in the graph.
+    size_t GetNumberOfLanes() const {
+      return _nodes.size();
+    }
+
+    /// Number of connections between lanes in the graph.
+    size_t GetNumberOfConnections() const {
+      return _edges.size();
+    }
+
+  private:
+
+    friend class RouteHierarchy;
+
+    using NodeId = uint32_t;
+
+    struct Node {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+      /// Range of the lane section along the road (s).
+      double s_begin;
+      double s_end;
+      /// Length of the lane center.
+      double length;
+      /// Location where the lane starts in the driving direction.
+      geom::Location entry;
+      /// Lane center length sampled along the lane, see DistanceOnLane.
+      uint32_t first_sample;
+      uint32_t number_of_samples;
+    };
+
+    struct Sample {
+      /// Distance along the road from the start of the lane in the driving
+      /// direction.
+      double relative_s;
+      /// Lane center length from the start of the lane.
+      double distance;
+    };
+
+    struct Edge {
+      NodeId target;
+      Maneuver maneuver;
+      double cost;
+    };
+
+    struct Search;
+
+    struct Workspace;
+
+    /// Lanes of a route and the maneuver to enter each of them.
+    using Path = std::vector<std::pair<NodeId, Maneuver>>;
+
+    boost::optional<NodeId> FindNode(const element::Waypoint &waypoint) const;
+
+    /// Lane center length from the start of @a node to @a s.
+    double DistanceOnLane(const Node &node, double s) const;
+
+    /// Waypoint at @a s on the lane of @a node.
+    static element::Waypoint MakeWaypoint(const Node &node, double s);
+
+    /// Distance along the road where the lane of @a node starts in the driving
+    /// direction.
+    static double GetEntryS(const Node &node);
+
+    /// Path from a start to @a node following @a parent, where values from
+    /// the number of nodes on refer to the starts of @a search.
+    Path MakePath(
+        const Search &search,
+        const std::vector<std::pair<uint32_t, Maneuver>> &parent,
+        uint32_t node) const;
+
+    /// Hash of the nodes and edges, identifies the graph a RouteHierarchy
+    /// was built from.
+    uint64_t ComputeGraphHash() const;
+
+    boost::optional<Route> ComputeRoute(
+        const Map &map,
+        const element::Waypoint &origin,
+        const element::Waypoint &destination,
+        Algorithm algorithm,
+        const RouteHierarchy *hierarchy,
+        Workspace &workspace) const;
+
+    boost::optional<Path> AStar(Search &search, Workspace &workspace) const;
+
+    boost::optional<Path> BidirectionalDijkstra(Search &search, Workspace &workspace) const;
+
+    boost::optional<Path> ContractionHierarchy(
+        Search &search,
+        Workspace &workspace,
+        const RouteHierarchy &hierarchy) const;
+
+    /// Sorted by road, section and lane id.
+    std::vector<Node> _nodes;
+
+    std::vector<Sample> _samples;
+
+    /// Outgoing edges of the i-th node are [_offsets[i], _offsets[i + 1]).
+    std::vector<uint32_t> _offsets;
+
+    std::vector<Edge> _edges;
+
+    /// Same as above with the edges reversed, target is the source node.
+    std::vector<uint32_t> _reverse_offsets;
+
+    std::vector<Edge> _reverse_edges;
+  };
+
+} // namespace road
+} // namespace carla
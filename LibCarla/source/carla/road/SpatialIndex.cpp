@@ -0,0 +1,203 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/SpatialIndex.h"
+
+#include "carla/Debug.h"
+#include "carla/road/MapData.h"
+#include "carla/road/element/Geometry.h"
+#include "carla/road/element/RoadInfoElevation.h"
+#include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoLaneOffset.h"
+#include "carla/road/element/RoadInfoLaneWidth.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+namespace carla {
+namespace road {
+
+  namespace bg = boost::geometry;
+
+  using namespace carla::road::element;
+
+  /// Distance between the points sampled along a geometry to compute its
+  /// bounding box [meters].
+  static constexpr double SAMPLING_STEP = 2.0;
+
+  /// Extra margin added to every bounding box to absorb the single precision
+  /// errors of Geometry::DistanceTo [meters].
+  static constexpr double BOX_MARGIN = 0.1;
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  static double GetMaxCurvature(const Geometry &geometry) {
+    switch (geometry.GetType()) {
+      case GeometryType::ARC:
+        return std::abs(static_cast<const GeometryArc &>(geometry).GetCurvature());
+      case GeometryType::SPIRAL: {
+        const auto &spiral = static_cast<const GeometrySpiral &>(geometry);
+        return std::max(std::abs(spiral.GetCurveStart()), std::abs(spiral.GetCurveEnd()));
+      }
+      default:
+        return 0.0;
+    }
+  }
+
+  struct GeometryExtent {
+    /// Maximum distance between the reference line and the outer border of
+    /// the lanes, plus the lane offset.
+    double width = 0.0;
+    double min_z = std::numeric_limits<double>::max();
+    double max_z = std::numeric_limits<double>::lowest();
+  };
+
+  /// Width and elevation range of @a road, sampled along @a geometry.
+  static GeometryExtent ComputeExtent(const Road &road, const RoadInfoGeometry &geometry) {
+    const double start = geometry.GetDistance();
+    const double length = geometry.GetGeometry().GetLength();
+    const auto samples = static_cast<size_t>(std::ceil(length / SAMPLING_STEP));
+    GeometryExtent extent;
+    for (auto i = 0u; i <= samples; ++i) {
+      const double s = samples == 0u ?
+          start :
+          start + length * static_cast<double>(i) / static_cast<double>(samples);
+      double left = 0.0;
+      double right = 0.0;
+      for (const auto &lane : road.GetLanesAt(s)) {
+        const auto *info = lane.second->GetInfo<RoadInfoLaneWidth>(s);
+        if ((lane.first != 0) && (info != nullptr)) {
+          (lane.first < 0 ? right : left) += std::abs(info->GetPolynomial().Evaluate(s));
+        }
+      }
+      const auto *offset = road.GetInfo<RoadInfoLaneOffset>(s);
+      const double lane_offset =
+          offset != nullptr ? std::abs(offset->GetPolynomial().Evaluate(s)) : 0.0;
+      extent.width = std::max(extent.width, lane_offset + std::max(left, right));
+      const auto *elevation = road.GetInfo<RoadInfoElevation>(s);
+      const double z = elevation != nullptr ? elevation->GetPolynomial().Evaluate(s) : 0.0;
+      extent.min_z = std::min(extent.min_z, z);
+      extent.max_z = std::max(extent.max_z, z);
+    }
+    return extent;
+  }
+
+  /// Compute a box containing the whole @a geometry by sampling it. The box is
+  /// enlarged by the maximum separation between the curve and the chords
+  /// joining the samples (the sagitta, curvature * step^2 / 8), and by
+  /// @a width.
+  template <typename BoxT, typename PointT>
+  static BoxT ComputeBoundingBox(const Geometry &geometry, const double width) {
+    const auto &start = geometry.GetStartPosition();
+    BoxT box{PointT{start.x, start.y}, PointT{start.x, start.y}};
+    const double length = geometry.GetLength();
+    double margin = BOX_MARGIN + width;
+    if (length > 0.0) {
+      const auto samples = static_cast<size_t>(std::ceil(length / SAMPLING_STEP));
+      const double step = length / static_cast<double>(samples);
+      for (auto i = 0u; i <= samples; ++i) {
+        const auto location = geometry.PosFromDist(static_cast<double>(i) * step).location;
+        bg::expand(box, PointT{location.x, location.y});
+      }
+      margin += GetMaxCurvature(geometry) * step * step / 8.0;
+    }
+    auto &min_corner = box.min_corner();
+    auto &max_corner = box.max_corner();
+    min_corner.template set<0>(min_corner.template get<0>() - margin);
+    min_corner.template set<1>(min_corner.template get<1>() - margin);
+    max_corner.template set<0>(max_corner.template get<0>() + margin);
+    max_corner.template set<1>(max_corner.template get<1>() + margin);
+    return box;
+  }
+
+  // ===========================================================================
+  // -- SpatialIndex -----------------------------------------------------------
+  // ===========================================================================
+
+  SpatialIndex::SpatialIndex(const MapData &data) {
+    std::vector<Value> values;
+    double map_min_z = std::numeric_limits<double>::max();
+    double map_max_z = std::numeric_limits<double>::lowest();
+    for (const auto &pair : data.GetRoads()) {
+      const auto &road = pair.second;
+      const auto first = values.size();
+      RoadEntry entry{road.GetId(), static_cast<uint32_t>(_number_of_roads), 0.0f, 0.0f};
+      double min_z = std::numeric_limits<double>::max();
+      double max_z = std::numeric_limits<double>::lowest();
+      for (const auto *info : road.GetInfos<RoadInfoGeometry>()) {
+        DEBUG_ASSERT(info != nullptr);
+        const auto extent = ComputeExtent(road, *info);
+        min_z = std::min(min_z, extent.min_z);
+        max_z = std::max(max_z, extent.max_z);
+        values.emplace_back(
+            ComputeBoundingBox<Box, Point>(info->GetGeometry(), extent.width),
+            entry);
+      }
+      // The lanes may be at any height of the road.
+      for (auto i = first; i < values.size(); ++i) {
+        values[i].second.min_z = static_cast<float>(min_z - BOX_MARGIN);
+        values[i].second.max_z = static_cast<float>(max_z + BOX_MARGIN);
+      }
+      if (first < values.size()) {
+        map_min_z = std::min(map_min_z, min_z - BOX_MARGIN);
+        map_max_z = std::max(map_max_z, max_z + BOX_MARGIN);
+      }
+      ++_number_of_roads;
+    }
+    if (map_min_z <= map_max_z) {
+      _min_z = map_min_z;
+      _max_z = map_max_z;
+    }
+    // The range constructor uses the packing algorithm, which produces a
+    // better tree than inserting the values one by one.
+    _rtree = decltype(_rtree)(values.begin(), values.end());
+  }
+
+  std::vector<SpatialIndex::NearestRoad> SpatialIndex::GetNearestRoads(
+      const MapData &data,
+      const geom::Location &location,
+      const size_t count) const {
+    std::vector<NearestRoad> result;
+    if ((count == 0u) || _rtree.empty()) {
+      return result;
+    }
+    result.reserve(count + 1u);
+
+    // Roads at the same distance are sorted by id, so the result does not
+    // depend on the order of the roads in the map.
+    const auto is_closer = [](const NearestRoad &lhs, const NearestRoad &rhs) {
+      return std::tie(lhs.distance, lhs.road_id) < std::tie(rhs.distance, rhs.road_id);
+    };
+
+    // Roads are visited in order of increasing distance to their boxes, once
+    // this bound is greater than the distance to the worst candidate, no
+    // other road can make it into the result.
+    ForEachRoadByDistance(location, [&](const RoadId road_id, const double min_distance, double) {
+      if (result.size() == count && min_distance > result.back().distance) {
+        return false;
+      }
+      const auto nearest = data.GetRoad(road_id).GetNearestPoint(location);
+      const NearestRoad candidate{road_id, nearest.first, nearest.second};
+      if (result.size() == count && !is_closer(candidate, result.back())) {
+        return true;
+      }
+      result.insert(
+          std::upper_bound(result.begin(), result.end(), candidate, is_closer),
+          candidate);
+      if (result.size() > count) {
+        result.pop_back();
+      }
+      return true;
+    });
+    return result;
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,128 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/road/RoadTypes.h"
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class MapData;
+
+  /// R-tree over the bounding boxes of the reference line geometries of every
+  /// road in a MapData. It is built once when the map is loaded and used to
+  /// find the roads closest to a given location without visiting every road.
+  ///
+  /// The boxes are enlarged by the width of the road, so they also contain the
+  /// centers of its lanes.
+  class SpatialIndex : private MovableNonCopyable {
+  public:
+
+    struct NearestRoad {
+      RoadId road_id;
+      /// Distance along the road (s) of the nearest point on its reference
+      /// line.
+      double s;
+      /// Euclidean distance from the query location to that point.
+      double distance;
+    };
+
+    SpatialIndex() = default;
+
+    explicit SpatialIndex(const MapData &data);
+
+    /// Return the @a count roads of @a data whose reference line is closest to
+    /// @a location (OpenDRIVE coordinates), sorted by increasing distance and
+    /// then by id.
+    ///
+    /// The result is the same as evaluating Road::GetNearestPoint on every
+    /// road and keeping the @a count best ones, but roads whose bounding boxes
+    /// are farther than the current candidates are never evaluated.
+    std::vector<NearestRoad> GetNearestRoads(
+        const MapData &data,
+        const geom::Location &location,
+        size_t count) const;
+
+    /// Call @a callback(road_id, min_distance, min_height) once for each
+    /// road, in order of increasing @a min_distance, until it returns false.
+    /// @a min_distance is a lower bound of the horizontal distance from
+    /// @a location to the reference line and to the lane centers of the road,
+    /// and @a min_height a lower bound of the vertical distance to its lane
+    /// centers.
+    template <typename FunctorT>
+    void ForEachRoadByDistance(const geom::Location &location, FunctorT &&callback) const {
+      namespace bg = boost::geometry;
+      namespace bgi = boost::geometry::index;
+      const Point point{location.x, location.y};
+      std::vector<bool> visited(_number_of_roads, false);
+      for (auto it = _rtree.qbegin(bgi::nearest(point, static_cast<unsigned>(_rtree.size())));
+          it != _rtree.qend();
+          ++it) {
+        const auto &entry = it->second;
+        if (visited[entry.index]) {
+          continue;
+        }
+        visited[entry.index] = true;
+        const float min_height = std::max({0.0f, entry.min_z - location.z, location.z - entry.max_z});
+        if (!callback(
+                entry.road_id,
+                static_cast<double>(bg::distance(point, it->first)),
+                static_cast<double>(min_height))) {
+          break;
+        }
+      }
+    }
+
+    /// Lower bound of the vertical distance from @a location to the lane
+    /// centers of every road.
+    double GetMinHeight(const geom::Location &location) const {
+      return std::max({0.0, _min_z - location.z, location.z - _max_z});
+    }
+
+    /// Number of geometries in the index.
+    size_t size() const {
+      return _rtree.size();
+    }
+
+  private:
+
+    using Point = boost::geometry::model::point<double, 2, boost::geometry::cs::cartesian>;
+
+    using Box = boost::geometry::model::box<Point>;
+
+    struct RoadEntry {
+      RoadId road_id;
+      /// Position of the road in the index, to mark the roads visited.
+      uint32_t index;
+      /// Elevation range of the road.
+      float min_z;
+      float max_z;
+    };
+
+    using Value = std::pair<Box, RoadEntry>;
+
+    boost::geometry::index::rtree<Value, boost::geometry::index::rstar<16>> _rtree;
+
+    size_t _number_of_roads = 0u;
+
+    /// Elevation range of the whole map.
+    double _min_z = 0.0;
+
+    double _max_z = 0.0;
+  };
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,100 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Rotation.h"
+#include "carla/geom/Transform.h"
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// Waypoints and their transforms in structure-of-arrays layout, each field
+  /// is stored in its own contiguous array and the i-th element of every
+  /// array belongs to the i-th waypoint. Meant for dense sampling of the map,
+  /// where a Waypoint object per sample is too expensive.
+  struct WaypointArrays {
+
+    std::vector<RoadId> road_id;
+
+    std::vector<SectionId> section_id;
+
+    std::vector<LaneId> lane_id;
+
+    std::vector<double> s;
+
+    std::vector<geom::Location> location;
+
+    std::vector<geom::Rotation> rotation;
+
+    size_t size() const {
+      return s.size();
+    }
+
+    bool empty() const {
+      return s.empty();
+    }
+
+    void reserve(size_t count) {
+      road_id.reserve(count);
+      section_id.reserve(count);
+      lane_id.reserve(count);
+      s.reserve(count);
+      location.reserve(count);
+      rotation.reserve(count);
+    }
+
+    void clear() {
+      road_id.clear();
+      section_id.clear();
+      lane_id.clear();
+      s.clear();
+      location.clear();
+      rotation.clear();
+    }
+
+    void emplace_back(const element::Waypoint &waypoint, const geom::Transform &transform) {
+      road_id.emplace_back(waypoint.road_id);
+      section_id.emplace_back(waypoint.section_id);
+      lane_id.emplace_back(waypoint.lane_id);
+      s.emplace_back(waypoint.s);
+      location.emplace_back(transform.location);
+      rotation.emplace_back(transform.rotation);
+    }
+
+    /// Append all the elements of @a other.
+    void append(const WaypointArrays &other) {
+      Append(road_id, other.road_id);
+      Append(section_id, other.section_id);
+      Append(lane_id, other.lane_id);
+      Append(s, other.s);
+      Append(location, other.location);
+      Append(rotation, other.rotation);
+    }
+
+    element::Waypoint GetWaypoint(size_t index) const {
+      return element::Waypoint{road_id[index], section_id[index], lane_id[index], s[index]};
+    }
+
+    geom::Transform GetTransform(size_t index) const {
+      return geom::Transform{location[index], rotation[index]};
+    }
+
+  private:
+
+    template <typename T>
+    static void Append(std::vector<T> &dst, const std::vector<T> &src) {
+      dst.insert(dst.end(), src.begin(), src.end());
+    }
+  };
+
+} // namespace road
+} // namespace carla
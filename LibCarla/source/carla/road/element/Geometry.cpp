@@ -7,14 +7,14 @@
 #include "carla/road/element/Geometry.h"
 
 #include "carla/Debug.h"
-#include "carla/Exception.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
 
 #include <cephes/fresnel.h>
 
+#include <algorithm>
 #include <cmath>
-#include <stdexcept>
+#include <limits>
 
 namespace carla {
 namespace road {
@@ -52,32 +52,182 @@ namespace element {
     return p;
   }
 
-  DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
-    // not working yet with negative values
-    dist = geom::Math::Clamp(dist, 0.0, _length);
-    DEBUG_ASSERT(_length > 0.0);
-    DEBUG_ASSERT(std::fabs(_curve_end) > 1e-15);
-    const double radius = 1.0 / _curve_end;
-    const double extra_norm = 1.0 / std::sqrt(geom::Math::Pi<double>() / 2.0);
-    const double norm = 1.0 / std::sqrt(2.0 * radius * _length);
-    const double length = dist * norm;
+  // ===========================================================================
+  // -- GeometrySpiral ---------------------------------------------------------
+  // ===========================================================================
+
+  /// Distance between the points of the polyline used to seed DistanceTo
+  /// [meters].
+  static constexpr double SPIRAL_POLYLINE_STEP = 2.0;
+
+  /// Integration step used for spirals whose curvature barely changes, for
+  /// which the Fresnel integrals cannot be evaluated accurately [meters].
+  static constexpr double SPIRAL_INTEGRATION_STEP = 1.0;
+
+  /// Largest Fresnel integral argument for which cephes' fresnl is still
+  /// accurate enough.
+  static constexpr double SPIRAL_MAX_FRESNEL_ARGUMENT = 1e3;
+
+  /// Returns the integrals from 0 to @a sigma of cos(c * u^2 / 2) (first) and
+  /// sin(c * u^2 / 2) (second), for any sign of @a c.
+  static std::pair<double, double> ScaledFresnel(double sigma, double c) {
+    const double scale = std::sqrt(geom::Math::Pi<double>() / std::abs(c));
     double S, C;
-    fresnl(length * extra_norm, &S, &C);
-    S /= (norm * extra_norm);
-    C /= (norm * extra_norm);
-    DirectedPoint p(_start_position, _heading);
-    const double cos_a = std::cos(p.tangent);
-    const double sin_a = std::sin(p.tangent);
-    p.location.x += static_cast<float>(C * cos_a - S * sin_a);
-    p.location.y += static_cast<float>(S * cos_a + C * sin_a);
-    p.tangent += length * length;
+    fresnl(sigma / scale, &S, &C);
+    return {scale * C, (c < 0.0 ? -scale : scale) * S};
+  }
+
+  GeometrySpiral::GeometrySpiral(
+      double start_offset,
+      double length,
+      double heading,
+      const geom::Location &start_pos,
+      double curv_s,
+      double curv_e)
+    : Geometry(GeometryType::SPIRAL, start_offset, length, heading, start_pos),
+      _curve_start(curv_s),
+      _curve_end(curv_e),
+      _polyline_step(0.0) {
+    const auto segments = _length > 0.0 ?
+        static_cast<size_t>(std::ceil(_length / SPIRAL_POLYLINE_STEP)) :
+        0u;
+    _polyline_step = segments > 0u ? _length / static_cast<double>(segments) : 0.0;
+    _polyline.reserve(segments + 1u);
+    double unused_heading;
+    for (size_t i = 0u; i <= segments; ++i) {
+      _polyline.emplace_back(Evaluate(static_cast<double>(i) * _polyline_step, unused_heading));
+    }
+  }
 
+  GeometrySpiral::Point2D GeometrySpiral::Evaluate(double dist, double &heading) const {
+    // The curvature changes linearly, k(s) = k0 + c * s, so the heading is
+    // h(s) = h0 + k0 * s + c * s^2 / 2.
+    const double k0 = _curve_start;
+    const double c = _length > 0.0 ? (_curve_end - _curve_start) / _length : 0.0;
+    heading = _heading + k0 * dist + 0.5 * c * dist * dist;
+
+    Point2D p{_start_position.x, _start_position.y};
+
+    // Parametrize by sigma = s + k0 / c, the distance to the point of the
+    // clothoid where the curvature is zero, to evaluate the position using the
+    // Fresnel integrals.
+    const double sigma0 = c != 0.0 ? k0 / c : 0.0;
+    const double sigma1 = sigma0 + dist;
+    const double max_argument =
+        std::max(std::abs(sigma0), std::abs(sigma1)) * std::sqrt(std::abs(c) / geom::Math::Pi<double>());
+
+    if ((c != 0.0) && (max_argument < SPIRAL_MAX_FRESNEL_ARGUMENT)) {
+      const double phi = _heading - 0.5 * k0 * sigma0;
+      const auto f0 = ScaledFresnel(sigma0, c);
+      const auto f1 = ScaledFresnel(sigma1, c);
+      const double dC = f1.first - f0.first;
+      const double dS = f1.second - f0.second;
+      const double cos_phi = std::cos(phi);
+      const double sin_phi = std::sin(phi);
+      p.x += dC * cos_phi - dS * sin_phi;
+      p.y += dC * sin_phi + dS * cos_phi;
+    } else {
+      // Almost constant curvature, integrate the heading with Simpson's rule.
+      const auto half_steps = std::max<size_t>(
+          1u,
+          static_cast<size_t>(std::ceil(dist / (2.0 * SPIRAL_INTEGRATION_STEP))));
+      const double h = dist / static_cast<double>(2u * half_steps);
+      double sum_x = 0.0;
+      double sum_y = 0.0;
+      for (size_t i = 0u; i <= 2u * half_steps; ++i) {
+        const double s = static_cast<double>(i) * h;
+        const double angle = _heading + k0 * s + 0.5 * c * s * s;
+        const double weight = (i == 0u || i == 2u * half_steps) ? 1.0 : (i % 2u == 1u ? 4.0 : 2.0);
+        sum_x += weight * std::cos(angle);
+        sum_y += weight * std::sin(angle);
+      }
+      p.x += sum_x * h / 3.0;
+      p.y += sum_y * h / 3.0;
+    }
     return p;
   }
 
-  /// @todo
-  std::pair<float, float> GeometrySpiral::DistanceTo(const geom::Location &) const {
-    throw_exception(std::runtime_error("not implemented"));
+  DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
+    dist = geom::Math::Clamp(dist, 0.0, _length);
+    double heading;
+    const auto point = Evaluate(dist, heading);
+    return DirectedPoint(
+        static_cast<float>(point.x),
+        static_cast<float>(point.y),
+        _start_position.z,
+        heading);
+  }
+
+  std::pair<float, float> GeometrySpiral::DistanceTo(const geom::Location &p) const {
+    DEBUG_ASSERT(!_polyline.empty());
+    const double px = p.x;
+    const double py = p.y;
+
+    // Find the nearest segment of the polyline to use its projection as
+    // starting guess.
+    size_t nearest_segment = 0u;
+    double seed = 0.0;
+    double min_dist_sq = std::numeric_limits<double>::max();
+    for (size_t i = 0u; i + 1u < _polyline.size(); ++i) {
+      const auto &v = _polyline[i];
+      const auto &w = _polyline[i + 1u];
+      const double dx = w.x - v.x;
+      const double dy = w.y - v.y;
+      const double l2 = dx * dx + dy * dy;
+      const double t = l2 > 0.0 ?
+          geom::Math::Clamp(((px - v.x) * dx + (py - v.y) * dy) / l2) :
+          0.0;
+      const double ex = v.x + t * dx - px;
+      const double ey = v.y + t * dy - py;
+      const double dist_sq = ex * ex + ey * ey;
+      if (dist_sq < min_dist_sq) {
+        min_dist_sq = dist_sq;
+        nearest_segment = i;
+        seed = (static_cast<double>(i) + t) * _polyline_step;
+      }
+    }
+
+    // The nearest point is a zero of f(s) = (P(s) - p) . T(s), the derivative
+    // of half the squared distance. Refine the guess with Newton's method,
+    // falling back to bisection whenever the step leaves the bracket around
+    // the nearest segment.
+    const double k0 = _curve_start;
+    const double c = _length > 0.0 ? (_curve_end - _curve_start) / _length : 0.0;
+    double lower = std::max(0.0, (static_cast<double>(nearest_segment) - 1.0) * _polyline_step);
+    double upper = std::min(_length, (static_cast<double>(nearest_segment) + 2.0) * _polyline_step);
+    double s = geom::Math::Clamp(seed, lower, upper);
+    auto distance_squared_at = [&](double dist, double &f, double &df) {
+      double heading;
+      const auto point = Evaluate(dist, heading);
+      const double dx = point.x - px;
+      const double dy = point.y - py;
+      const double cos_h = std::cos(heading);
+      const double sin_h = std::sin(heading);
+      f = dx * cos_h + dy * sin_h;
+      df = 1.0 + (k0 + c * dist) * (dy * cos_h - dx * sin_h);
+      return dx * dx + dy * dy;
+    };
+    for (auto i = 0u; i < 16u; ++i) {
+      double f, df;
+      distance_squared_at(s, f, df);
+      if (f > 0.0) {
+        upper = s;
+      } else {
+        lower = s;
+      }
+      double next = df > 0.0 ? s - f / df : 0.5 * (lower + upper);
+      if (next <= lower || next >= upper) {
+        next = 0.5 * (lower + upper);
+      }
+      if (std::abs(next - s) < 1e-6) {
+        break;
+      }
+      s = next;
+    }
+    double f, df;
+    const double dist_sq = distance_squared_at(s, f, df);
+
+    return std::make_pair(static_cast<float>(s), static_cast<float>(std::sqrt(dist_sq)));
   }
 
 } // namespace element
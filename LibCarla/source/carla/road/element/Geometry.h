@@ -9,6 +9,9 @@
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
 
+#include <utility>
+#include <vector>
+
 namespace carla {
 namespace road {
 namespace element {
@@ -58,7 +61,7 @@ namespace element {
       return _heading;
     }
 
-    const geom::Location &GetStartPosition() {
+    const geom::Location &GetStartPosition() const {
       return _start_position;
     }
 
@@ -167,27 +170,44 @@ namespace element {
         double heading,
         const geom::Location &start_pos,
         double curv_s,
-        double curv_e)
-      : Geometry(GeometryType::SPIRAL, start_offset, length, heading, start_pos),
-        _curve_start(curv_s),
-        _curve_end(curv_e) {}
+        double curv_e);
 
-    double GetCurveStart() {
+    double GetCurveStart() const {
       return _curve_start;
     }
 
-    double GetCurveEnd() {
+    double GetCurveEnd() const {
       return _curve_end;
     }
 
     DirectedPoint PosFromDist(double dist) const override;
 
-    std::pair<float, float> DistanceTo(const geom::Location &) const override;
+    /// Returns a pair containing:
+    /// - @b first:  distance to the nearest point in this spiral from the
+    ///              beginning of the shape.
+    /// - @b second: Euclidean distance from the nearest point in this spiral
+    ///              to p.
+    ///   @param p point to calculate the distance
+    std::pair<float, float> DistanceTo(const geom::Location &p) const override;
 
   private:
 
+    struct Point2D {
+      double x;
+      double y;
+    };
+
+    /// Position and heading [radians] at @a dist from the start of the
+    /// spiral, computed in double precision.
+    Point2D Evaluate(double dist, double &heading) const;
+
     double _curve_start;
     double _curve_end;
+
+    /// Points sampled every _polyline_step meters along the spiral, used as
+    /// starting guess for DistanceTo.
+    std::vector<Point2D> _polyline;
+    double _polyline_step;
   };
 
 } // namespace element
@@ -53,44 +53,62 @@ namespace element {
     return {};
   }
 
-  static bool IsOffRoad(const Map &map, const geom::Location &location) {
-    return !map.GetWaypoint(location, FLAGS).has_value();
+  /// Follow the lane of @a w0 into the section of @a w1, if the lane
+  /// continues there, e.g. when the origin and the destination are at both
+  /// sides of the boundary between two roads.
+  static boost::optional<Waypoint> FollowLaneToSection(
+      const Map &map,
+      const Waypoint &w0,
+      const Waypoint &w1) {
+    auto is_at_section = [&](const Waypoint &w) {
+      return (w.road_id == w1.road_id) && (w.section_id == w1.section_id);
+    };
+    for (const auto &waypoints : {map.GetSuccessors(w0), map.GetPredecessors(w0)}) {
+      for (const auto &w : waypoints) {
+        if (is_at_section(w)) {
+          return Waypoint{w1.road_id, w1.section_id, w.lane_id, w1.s};
+        }
+      }
+    }
+    return boost::none;
   }
 
-  std::vector<LaneMarking> LaneCrossingCalculator::Calculate(
+  static std::vector<LaneMarking> CalculateAtPositions(
       const Map &map,
       const geom::Location &origin,
-      const geom::Location &destination) {
-    auto w0 = map.GetClosestWaypointOnRoad(origin, FLAGS);
-    auto w1 = map.GetClosestWaypointOnRoad(destination, FLAGS);
+      const geom::Location &destination,
+      const LaneTracker::Position &p0,
+      const LaneTracker::Position &p1) {
+    auto w0 = p0.waypoint;
+    const auto &w1 = p1.waypoint;
 
-    if (!w0.has_value() || !w1.has_value()) {
+    if (map.IsJunction(w0.road_id) || map.IsJunction(w1.road_id)) {
       return {};
     }
 
-    if (w0->road_id != w1->road_id || w0->section_id != w1->section_id) {
-      /// @todo This case should also be handled.
-      return {};
-    }
-
-    if (map.IsJunction(w0->road_id) || map.IsJunction(w1->road_id)) {
-      return {};
-    }
-
-    const auto w0_is_offroad = IsOffRoad(map, origin);
-    const auto w1_is_offroad = IsOffRoad(map, destination);
+    const auto w0_is_offroad = p0.is_offroad;
+    const auto w1_is_offroad = p1.is_offroad;
 
     if (w0_is_offroad && w1_is_offroad) {
       // outside the road
       return {};
     }
 
-    if ((w0->lane_id == w1->lane_id) && !w0_is_offroad && !w1_is_offroad) {
+    if (w0.road_id != w1.road_id || w0.section_id != w1.section_id) {
+      // compare the lanes at the section of the destination
+      const auto w0_at_section = FollowLaneToSection(map, w0, w1);
+      if (!w0_at_section.has_value()) {
+        return {};
+      }
+      w0 = *w0_at_section;
+    }
+
+    if ((w0.lane_id == w1.lane_id) && !w0_is_offroad && !w1_is_offroad) {
       // both at the same lane and inside the road
       return {};
     }
 
-    const auto transform = map.ComputeTransform(*w0);
+    const auto transform = map.ComputeTransform(w0);
     geom::Vector3D orig_vec = transform.GetForwardVector();
     geom::Vector3D dest_vec = (destination - origin).MakeUnitVector();
 
@@ -100,12 +118,41 @@ namespace element {
 
     return CrossingAtSameSection(
         map,
-        &*w0,
-        &*w1,
+        &w0,
+        &w1,
         w0_is_offroad,
         dest_is_at_right);
   }
 
+  std::vector<LaneMarking> LaneCrossingCalculator::Calculate(
+      const Map &map,
+      const geom::Location &origin,
+      const geom::Location &destination) {
+    const auto p0 = LaneTracker::Locate(map, origin, FLAGS);
+    const auto p1 = LaneTracker::Locate(map, destination, FLAGS);
+
+    if (!p0.has_value() || !p1.has_value()) {
+      return {};
+    }
+
+    return CalculateAtPositions(map, origin, destination, *p0, *p1);
+  }
+
+  std::vector<LaneMarking> LaneCrossingCalculator::Calculate(
+      const Map &map,
+      LaneTracker &tracker,
+      const geom::Location &destination) {
+    const auto p0 = tracker.GetPosition();
+    const auto origin = tracker.GetLocation();
+    const auto p1 = tracker.Update(map, destination, FLAGS);
+
+    if (!p0.has_value() || !p1.has_value()) {
+      return {};
+    }
+
+    return CalculateAtPositions(map, origin, destination, *p0, *p1);
+  }
+
 } // namespace element
 } // namespace road
 } // namespace carla
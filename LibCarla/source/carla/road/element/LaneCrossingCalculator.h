@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "carla/road/LaneTracker.h"
 #include "carla/road/element/LaneMarking.h"
 
 #include <vector>
@@ -25,6 +26,13 @@ namespace element {
         const Map &map,
         const geom::Location &origin,
         const geom::Location &destination);
+
+    /// Same as above, from the last location of @a tracker. @a tracker is
+    /// updated to @a destination; nothing is crossed on its first update.
+    static std::vector<LaneMarking> Calculate(
+        const Map &map,
+        LaneTracker &tracker,
+        const geom::Location &destination);
   };
 
 } // namespace element
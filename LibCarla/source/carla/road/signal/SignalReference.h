@@ -14,6 +14,9 @@
 
 namespace carla {
 namespace road {
+
+  class MapSerializer;
+
 namespace signal {
 
   class SignalReference : private MovableNonCopyable {
@@ -37,6 +40,8 @@ namespace signal {
 
   private:
 
+    friend road::MapSerializer;
+
 #if defined(__clang__)
 #  pragma clang diagnostic push
 #  pragma clang diagnostic ignored "-Wunused-private-field"
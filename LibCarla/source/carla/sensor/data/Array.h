@@ -123,7 +123,7 @@ namespace data {
 
   protected:
 
-    explicit Array(size_t offset, RawData data)
+    explicit Array(size_t offset, RawData &&data)
       : SensorData(data),
         _data(std::move(data)) {
       SetOffset(offset);
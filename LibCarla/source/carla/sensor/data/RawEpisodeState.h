@@ -24,9 +24,14 @@ namespace data {
 
     friend Serializer;
 
-    explicit RawEpisodeState(RawData data)
-      : Super(std::move(data)) {
-      Super::SetOffset(Serializer::header_offset);
+    explicit RawEpisodeState(RawData &&data)
+      : Super(GetArrayOffset(data), std::move(data)) {}
+
+    /// Delta-encoded messages are not an array of actors, leave it empty.
+    static size_t GetArrayOffset(const RawData &data) {
+      return Serializer::DeserializeHeader(data).encoding == Serializer::Encoding::Delta ?
+          data.size() :
+          Serializer::header_offset;
     }
 
   private:
@@ -58,6 +63,27 @@ namespace data {
     double GetDeltaSeconds() const {
       return GetHeader().delta_seconds;
     }
+
+    /// Whether this message contains only the changes since a previous
+    /// message. If so, this array is empty, use EpisodeStateDelta to decode
+    /// [GetDeltaBegin(), GetDeltaEnd()) on top of the state at GetBaseFrame().
+    bool IsDelta() const {
+      return GetHeader().encoding == Serializer::Encoding::Delta;
+    }
+
+    /// Frame of the state this delta applies to.
+    uint64_t GetBaseFrame() const {
+      return Serializer::DeserializeDeltaHeader(Super::GetRawData()).base_frame;
+    }
+
+    const unsigned char *GetDeltaBegin() const {
+      DEBUG_ASSERT(IsDelta());
+      return Super::GetRawData().begin() + Serializer::header_offset;
+    }
+
+    const unsigned char *GetDeltaEnd() const {
+      return Super::GetRawData().end();
+    }
   };
 
 } // namespace data
@@ -0,0 +1,304 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/EpisodeStateDelta.h"
+
+#include <cmath>
+#include <limits>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  constexpr float EpisodeStateDelta::LOCATION_STEP;
+  constexpr float EpisodeStateDelta::ROTATION_STEP;
+  constexpr float EpisodeStateDelta::VELOCITY_STEP;
+  constexpr float EpisodeStateDelta::ANGULAR_VELOCITY_STEP;
+  constexpr float EpisodeStateDelta::ACCELERATION_STEP;
+  constexpr size_t EpisodeStateDelta::max_update_size;
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  using Delta = EpisodeStateDelta;
+  using Serializer = EpisodeStateSerializer;
+
+  static bool FitsInInt16(long long value) {
+    return
+        (value >= std::numeric_limits<int16_t>::min()) &&
+        (value <= std::numeric_limits<int16_t>::max());
+  }
+
+  static long long Quantize(float value, float step) {
+    return std::llround(value / step);
+  }
+
+  /// Angles wrap around, any angle fits in an int16.
+  static int16_t QuantizeAngle(float degrees) {
+    const auto turns = static_cast<uint64_t>(Quantize(degrees, Delta::ROTATION_STEP));
+    return static_cast<int16_t>(static_cast<uint16_t>(turns & 0xFFFFu));
+  }
+
+  struct QuantizedVector {
+    long long x, y, z;
+
+    bool operator==(const QuantizedVector &rhs) const {
+      return (x == rhs.x) && (y == rhs.y) && (z == rhs.z);
+    }
+
+    bool operator!=(const QuantizedVector &rhs) const {
+      return !(*this == rhs);
+    }
+
+    bool FitsInInt16() const {
+      return s11n::FitsInInt16(x) && s11n::FitsInInt16(y) && s11n::FitsInInt16(z);
+    }
+  };
+
+  static QuantizedVector Quantize(const geom::Vector3D &value, float step) {
+    return {Quantize(value.x, step), Quantize(value.y, step), Quantize(value.z, step)};
+  }
+
+  template <typename T>
+  static void Write(unsigned char *&it, const T &value) {
+    std::memcpy(it, &value, sizeof(T));
+    it += sizeof(T);
+  }
+
+  static void WriteInt16(unsigned char *&it, long long value) {
+    DEBUG_ASSERT(FitsInInt16(value));
+    Write(it, static_cast<int16_t>(value));
+  }
+
+  static void WriteVector(
+      unsigned char *&it,
+      bool wide,
+      const geom::Vector3D &value,
+      const QuantizedVector &quantized) {
+    if (wide) {
+      Write(it, value.x);
+      Write(it, value.y);
+      Write(it, value.z);
+    } else {
+      WriteInt16(it, quantized.x);
+      WriteInt16(it, quantized.y);
+      WriteInt16(it, quantized.z);
+    }
+  }
+
+  /// Write the update of @a actor relative to @a reference, returns the mask
+  /// of the fields written. Nothing is written if the mask is zero.
+  static uint8_t WriteUpdate(
+      unsigned char *&it,
+      const data::ActorDynamicState &actor,
+      const data::ActorDynamicState &reference,
+      const bool is_new) {
+    uint8_t mask = 0u;
+    auto begin = it;
+    it += sizeof(ActorId) + sizeof(uint8_t);
+
+    // Location.
+    {
+      const geom::Location location = actor.transform.location;
+      const geom::Location previous = reference.transform.location;
+      const QuantizedVector offset = Quantize(location - previous, Delta::LOCATION_STEP);
+      if (is_new || !offset.FitsInInt16()) {
+        mask |= Delta::LocationFull;
+        Write(it, location.x);
+        Write(it, location.y);
+        Write(it, location.z);
+      } else if (offset != QuantizedVector{0, 0, 0}) {
+        mask |= Delta::LocationOffset;
+        WriteInt16(it, offset.x);
+        WriteInt16(it, offset.y);
+        WriteInt16(it, offset.z);
+      }
+    }
+
+    // Rotation.
+    {
+      const geom::Rotation rotation = actor.transform.rotation;
+      const geom::Rotation previous = reference.transform.rotation;
+      const int16_t pitch = QuantizeAngle(rotation.pitch);
+      const int16_t yaw = QuantizeAngle(rotation.yaw);
+      const int16_t roll = QuantizeAngle(rotation.roll);
+      if (is_new ||
+          (pitch != QuantizeAngle(previous.pitch)) ||
+          (yaw != QuantizeAngle(previous.yaw)) ||
+          (roll != QuantizeAngle(previous.roll))) {
+        mask |= Delta::Rotation;
+        Write(it, pitch);
+        Write(it, yaw);
+        Write(it, roll);
+      }
+    }
+
+    // Velocity, angular velocity and acceleration.
+    {
+      const geom::Vector3D values[] = {
+          actor.velocity, actor.angular_velocity, actor.acceleration};
+      const geom::Vector3D previous[] = {
+          reference.velocity, reference.angular_velocity, reference.acceleration};
+      const float steps[] = {
+          Delta::VELOCITY_STEP, Delta::ANGULAR_VELOCITY_STEP, Delta::ACCELERATION_STEP};
+      const uint8_t flags[] = {
+          Delta::Velocity, Delta::AngularVelocity, Delta::Acceleration};
+      QuantizedVector quantized[3u];
+      uint8_t vector_mask = 0u;
+      bool wide = false;
+      for (auto i = 0u; i < 3u; ++i) {
+        quantized[i] = Quantize(values[i], steps[i]);
+        if (is_new || (quantized[i] != Quantize(previous[i], steps[i]))) {
+          vector_mask |= flags[i];
+          wide = wide || !quantized[i].FitsInInt16();
+        }
+      }
+      for (auto i = 0u; i < 3u; ++i) {
+        if (vector_mask & flags[i]) {
+          WriteVector(it, wide, values[i], quantized[i]);
+        }
+      }
+      mask |= vector_mask;
+      if (wide) {
+        mask |= Delta::WideVectors;
+      }
+    }
+
+    // Type dependent state.
+    if (is_new || (std::memcmp(&actor.state, &reference.state, sizeof(actor.state)) != 0)) {
+      mask |= Delta::State;
+      std::memcpy(it, &actor.state, sizeof(actor.state));
+      it += sizeof(actor.state);
+    }
+
+    if (mask == 0u) {
+      it = begin;
+    } else {
+      Write(begin, actor.id);
+      Write(begin, mask);
+    }
+    return mask;
+  }
+
+  // ===========================================================================
+  // -- EpisodeStateDeltaEncoder -----------------------------------------------
+  // ===========================================================================
+
+  Buffer EpisodeStateDeltaEncoder::Serialize(
+      Buffer &&buffer,
+      Serializer::Header header,
+      const uint64_t frame,
+      const std::vector<ActorDynamicState> &actors) {
+    // Always clear the request, even if a keyframe is due anyway.
+    const bool keyframe_requested = _keyframe_requested.exchange(false);
+    const bool needs_keyframe =
+        keyframe_requested ||
+        !_has_reference ||
+        (header.episode_id != _episode_id) ||
+        (_messages_since_keyframe + 1u >= _keyframe_interval);
+    const uint64_t base_frame = _frame;
+    _episode_id = header.episode_id;
+    _frame = frame;
+    if (needs_keyframe) {
+      return SerializeKeyframe(std::move(buffer), header, actors);
+    }
+
+    // Mark the actors seen, the ones not marked have been removed.
+    _scratch.clear();
+    _scratch.reserve(actors.size());
+    for (auto &&actor : actors) {
+      auto it = _reference.find(actor.id);
+      if (it != _reference.end()) {
+        it->second.frame = frame;
+        _scratch.emplace_back(&it->second);
+      } else {
+        _scratch.emplace_back(nullptr);
+      }
+    }
+
+    buffer.reset(
+        sizeof(Serializer::Header) +
+        sizeof(Serializer::DeltaHeader) +
+        sizeof(ActorId) * _reference.size() +
+        Delta::max_update_size * actors.size());
+    auto it = buffer.begin();
+    header.encoding = Serializer::Encoding::Delta;
+    Write(it, header);
+    auto delta_header_position = it;
+    it += sizeof(Serializer::DeltaHeader);
+
+    Serializer::DeltaHeader delta_header;
+    delta_header.base_frame = base_frame;
+    delta_header.number_of_removed_actors = 0u;
+    delta_header.number_of_updated_actors = 0u;
+
+    for (auto ref = _reference.begin(); ref != _reference.end();) {
+      if (ref->second.frame != frame) {
+        Write(it, ref->first);
+        ++delta_header.number_of_removed_actors;
+        ref = _reference.erase(ref);
+      } else {
+        ++ref;
+      }
+    }
+
+    for (auto i = 0u; i < actors.size(); ++i) {
+      const auto &actor = actors[i];
+      auto *reference = _scratch[i];
+      const bool is_new = (reference == nullptr);
+      if (is_new) {
+        // Every field of a new actor is written, its reference is overwritten.
+        reference = &_reference.emplace(actor.id, Reference{ActorDynamicState{}, frame}).first->second;
+      }
+      const auto update_begin = it;
+      const auto mask = WriteUpdate(it, actor, reference->state, is_new);
+      if (mask != 0u) {
+        ++delta_header.number_of_updated_actors;
+        // Update the reference exactly as the clients will do.
+        Delta::ApplyUpdate(
+            mask,
+            update_begin + sizeof(ActorId) + sizeof(uint8_t),
+            reference->state);
+      }
+    }
+
+    Write(delta_header_position, delta_header);
+    const auto size = static_cast<size_t>(it - buffer.begin());
+    const auto keyframe_size =
+        sizeof(Serializer::Header) +
+        sizeof(ActorDynamicState) * actors.size();
+    if (size >= keyframe_size) {
+      return SerializeKeyframe(std::move(buffer), header, actors);
+    }
+    buffer.reset(size);
+    ++_messages_since_keyframe;
+    return std::move(buffer);
+  }
+
+  Buffer EpisodeStateDeltaEncoder::SerializeKeyframe(
+      Buffer &&buffer,
+      Serializer::Header header,
+      const std::vector<ActorDynamicState> &actors) {
+    buffer.reset(sizeof(Serializer::Header) + sizeof(ActorDynamicState) * actors.size());
+    auto it = buffer.begin();
+    header.encoding = Serializer::Encoding::Full;
+    Write(it, header);
+    _reference.clear();
+    _reference.reserve(actors.size());
+    for (auto &&actor : actors) {
+      Write(it, actor);
+      _reference.emplace(actor.id, Reference{actor, _frame});
+    }
+    DEBUG_ASSERT(it == buffer.end());
+    _has_reference = true;
+    _messages_since_keyframe = 0u;
+    return std::move(buffer);
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,256 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/Debug.h"
+#include "carla/NonCopyable.h"
+#include "carla/sensor/data/ActorDynamicState.h"
+#include "carla/sensor/s11n/EpisodeStateSerializer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  /// Format of the delta-encoded episode state messages.
+  ///
+  /// After the EpisodeStateSerializer::DeltaHeader come the ids of the actors
+  /// removed, then the actors updated. Each update is the actor id, a mask of
+  /// Field flags and the fields present in the order of the flags. Actors and
+  /// fields that did not change are not sent.
+  ///
+  /// Fields are quantized. Location is sent as an offset from the previous
+  /// location, the rest as absolute values, so the error does not accumulate.
+  class EpisodeStateDelta {
+  public:
+
+    using ActorDynamicState = data::ActorDynamicState;
+
+    enum Field : uint8_t {
+      /// 3 x int16, offset from the previous location in LOCATION_STEP units.
+      LocationOffset  = 1u << 0u,
+      /// 3 x float, for new actors and offsets that do not fit in an int16.
+      LocationFull    = 1u << 1u,
+      /// 3 x int16, pitch, yaw and roll in ROTATION_STEP units.
+      Rotation        = 1u << 2u,
+      Velocity        = 1u << 3u,
+      AngularVelocity = 1u << 4u,
+      Acceleration    = 1u << 5u,
+      /// The type dependent state, as is.
+      State           = 1u << 6u,
+      /// The vector fields present are 3 x float instead of 3 x int16 in
+      /// their step units, used when a value does not fit in an int16.
+      WideVectors     = 1u << 7u
+    };
+
+    /// @name Quantization steps
+    /// @{
+
+    /// Meters.
+    static constexpr float LOCATION_STEP = 1e-3f;
+
+    /// Degrees, 1/65536 of a turn.
+    static constexpr float ROTATION_STEP = 360.0f / 65536.0f;
+
+    /// Meters per second.
+    static constexpr float VELOCITY_STEP = 1e-2f;
+
+    /// Degrees per second.
+    static constexpr float ANGULAR_VELOCITY_STEP = 1e-1f;
+
+    /// Meters per second squared.
+    static constexpr float ACCELERATION_STEP = 1e-2f;
+
+    /// @}
+
+    /// Maximum size in bytes of the update of a single actor.
+    static constexpr size_t max_update_size =
+        sizeof(ActorId) +
+        sizeof(uint8_t) +
+        3u * sizeof(float) +       // location
+        3u * sizeof(int16_t) +     // rotation
+        3u * 3u * sizeof(float) +  // velocity, angular velocity, acceleration
+        sizeof(ActorDynamicState::TypeDependentState);
+
+    /// Apply the update of a single actor, the bytes after its id and mask,
+    /// to @a target, which holds the previous state of the actor. Returns the
+    /// position past the update.
+    ///
+    /// @a target can be any type with the fields of ActorDynamicState.
+    template <typename T>
+    static const unsigned char *ApplyUpdate(
+        const uint8_t mask,
+        const unsigned char *it,
+        T &target) {
+      if (mask & LocationOffset) {
+        auto location = target.transform.location;
+        location.x += static_cast<float>(Read<int16_t>(it)) * LOCATION_STEP;
+        location.y += static_cast<float>(Read<int16_t>(it)) * LOCATION_STEP;
+        location.z += static_cast<float>(Read<int16_t>(it)) * LOCATION_STEP;
+        target.transform.location = location;
+      } else if (mask & LocationFull) {
+        auto location = target.transform.location;
+        location.x = Read<float>(it);
+        location.y = Read<float>(it);
+        location.z = Read<float>(it);
+        target.transform.location = location;
+      }
+      if (mask & Rotation) {
+        auto rotation = target.transform.rotation;
+        rotation.pitch = static_cast<float>(Read<int16_t>(it)) * ROTATION_STEP;
+        rotation.yaw = static_cast<float>(Read<int16_t>(it)) * ROTATION_STEP;
+        rotation.roll = static_cast<float>(Read<int16_t>(it)) * ROTATION_STEP;
+        target.transform.rotation = rotation;
+      }
+      const bool wide = (mask & WideVectors) != 0u;
+      if (mask & Velocity) {
+        target.velocity = ReadVector(wide, VELOCITY_STEP, it);
+      }
+      if (mask & AngularVelocity) {
+        target.angular_velocity = ReadVector(wide, ANGULAR_VELOCITY_STEP, it);
+      }
+      if (mask & Acceleration) {
+        target.acceleration = ReadVector(wide, ACCELERATION_STEP, it);
+      }
+      if (mask & State) {
+        std::memcpy(&target.state, it, sizeof(target.state));
+        it += sizeof(target.state);
+      }
+      return it;
+    }
+
+    /// Decode the actors of a delta message, [@a begin, @a end) being the
+    /// bytes after the header. Calls @a remove(id) for every actor removed
+    /// and @a find_or_add(id) for every actor updated, which must return a
+    /// reference to the previous state of the actor.
+    template <typename RemoveF, typename FindOrAddF>
+    static void Decode(
+        const unsigned char *begin,
+        const unsigned char *DEBUG_ONLY(end),
+        RemoveF &&remove,
+        FindOrAddF &&find_or_add) {
+      using Serializer = EpisodeStateSerializer;
+      auto it = begin;
+      const auto header = Read<Serializer::DeltaHeader>(it);
+      for (auto i = 0u; i < header.number_of_removed_actors; ++i) {
+        remove(Read<ActorId>(it));
+      }
+      for (auto i = 0u; i < header.number_of_updated_actors; ++i) {
+        const auto id = Read<ActorId>(it);
+        const auto mask = Read<uint8_t>(it);
+        it = ApplyUpdate(mask, it, find_or_add(id));
+      }
+      DEBUG_ASSERT(it == end);
+    }
+
+    template <typename T>
+    static T Read(const unsigned char *&it) {
+      T value;
+      std::memcpy(&value, it, sizeof(T));
+      it += sizeof(T);
+      return value;
+    }
+
+  private:
+
+    static geom::Vector3D ReadVector(bool wide, float step, const unsigned char *&it) {
+      geom::Vector3D result;
+      if (wide) {
+        result.x = Read<float>(it);
+        result.y = Read<float>(it);
+        result.z = Read<float>(it);
+      } else {
+        result.x = static_cast<float>(Read<int16_t>(it)) * step;
+        result.y = static_cast<float>(Read<int16_t>(it)) * step;
+        result.z = static_cast<float>(Read<int16_t>(it)) * step;
+      }
+      return result;
+    }
+  };
+
+  /// Serializes the state of the episode as keyframes, full messages as
+  /// written without delta encoding, and deltas from the previous message.
+  ///
+  /// Every @a keyframe_interval messages, whenever a delta would not be
+  /// smaller, and after RequestKeyframe, a keyframe is sent so clients that
+  /// missed a message or just connected can catch up.
+  class EpisodeStateDeltaEncoder : private NonCopyable {
+  public:
+
+    using ActorDynamicState = data::ActorDynamicState;
+
+    explicit EpisodeStateDeltaEncoder(uint32_t keyframe_interval = 30u)
+      : _keyframe_interval(keyframe_interval) {}
+
+    void SetKeyframeInterval(uint32_t keyframe_interval) {
+      _keyframe_interval = keyframe_interval;
+    }
+
+    uint32_t GetKeyframeInterval() const {
+      return _keyframe_interval;
+    }
+
+    /// Make the next message a keyframe.
+    void Reset() {
+      _reference.clear();
+      _has_reference = false;
+    }
+
+    /// Make the next message a keyframe. Unlike Reset, it can be called from
+    /// any thread, e.g. when a client subscribes to the stream.
+    void RequestKeyframe() {
+      _keyframe_requested = true;
+    }
+
+    /// Write into @a buffer the state of @a actors at @a frame, the encoding
+    /// of @a header is overwritten.
+    Buffer Serialize(
+        Buffer &&buffer,
+        EpisodeStateSerializer::Header header,
+        uint64_t frame,
+        const std::vector<ActorDynamicState> &actors);
+
+  private:
+
+    Buffer SerializeKeyframe(
+        Buffer &&buffer,
+        EpisodeStateSerializer::Header header,
+        const std::vector<ActorDynamicState> &actors);
+
+    struct Reference {
+      /// State of the actor as reconstructed by the clients.
+      ActorDynamicState state;
+      /// Last frame the actor was seen.
+      uint64_t frame;
+    };
+
+    uint32_t _keyframe_interval;
+
+    uint32_t _messages_since_keyframe = 0u;
+
+    bool _has_reference = false;
+
+    std::atomic_bool _keyframe_requested{false};
+
+    uint64_t _episode_id = 0u;
+
+    uint64_t _frame = 0u;
+
+    std::unordered_map<ActorId, Reference> _reference;
+
+    std::vector<Reference *> _scratch;
+  };
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -27,11 +27,30 @@ namespace s11n {
   class EpisodeStateSerializer {
   public:
 
+    /// How the actors follow the header in a message.
+    enum class Encoding : uint8_t {
+      /// An array with the ActorDynamicState of every actor.
+      Full,
+      /// Only the changes since a previous message, see EpisodeStateDelta.
+      Delta
+    };
+
 #pragma pack(push, 1)
     struct Header {
       uint64_t episode_id;
       double platform_timestamp;
       float delta_seconds;
+      Encoding encoding;
+    };
+#pragma pack(pop)
+
+#pragma pack(push, 1)
+    /// Follows the Header in delta-encoded messages.
+    struct DeltaHeader {
+      /// Frame of the message this delta applies to.
+      uint64_t base_frame;
+      uint32_t number_of_removed_actors;
+      uint32_t number_of_updated_actors;
     };
 #pragma pack(pop)
 
@@ -41,6 +60,11 @@ namespace s11n {
       return *reinterpret_cast<const Header *>(message.begin());
     }
 
+    static const DeltaHeader &DeserializeDeltaHeader(const RawData &message) {
+      DEBUG_ASSERT(DeserializeHeader(message).encoding == Encoding::Delta);
+      return *reinterpret_cast<const DeltaHeader *>(message.begin() + header_offset);
+    }
+
     template <typename SensorT>
     static Buffer Serialize(const SensorT &, Buffer &&buffer) {
       return std::move(buffer);
@@ -19,6 +19,8 @@ namespace streaming {
 
   using stream_token = detail::token_type;
 
+  using ClientOptions = detail::tcp::ClientOptions;
+
   /// A client able to subscribe to multiple streams.
   class Client {
     using underlying_client = low_level::Client<detail::tcp::Client>;
@@ -29,6 +31,9 @@ namespace streaming {
     explicit Client(const std::string &fallback_address)
       : _client(fallback_address) {}
 
+    Client(const std::string &fallback_address, const ClientOptions &options)
+      : _client(fallback_address, options) {}
+
     ~Client() {
       _service.Stop();
     }
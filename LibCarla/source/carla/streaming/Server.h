@@ -15,6 +15,10 @@
 namespace carla {
 namespace streaming {
 
+  using SendQueueOptions = detail::tcp::SendQueueOptions;
+  using SendQueuePolicy = detail::tcp::SendQueuePolicy;
+  using SessionStatistics = detail::tcp::SessionStatistics;
+
   /// A streaming server. Each new stream has a token associated, this token can
   /// be used by a client to subscribe to the stream.
   class Server {
@@ -48,6 +52,17 @@ namespace streaming {
       _server.SetTimeout(timeout);
     }
 
+    /// Set the limits and policy of the send queue of the sessions opened
+    /// from now on.
+    void SetSendQueueOptions(const SendQueueOptions &options) {
+      _server.SetSendQueueOptions(options);
+    }
+
+    /// Traffic counters summed over every session of this server.
+    SessionStatistics GetStatistics() const {
+      return _server.GetStatistics();
+    }
+
     Stream MakeStream() {
       return _server.MakeStream();
     }
@@ -6,8 +6,12 @@
 
 #pragma once
 
+#include "carla/AtomicSharedPtr.h"
 #include "carla/streaming/detail/StreamStateBase.h"
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
 #include <mutex>
 #include <vector>
 
@@ -17,7 +21,11 @@ namespace detail {
 
   /// A stream state that can hold any number of sessions.
   ///
-  /// @todo Lacking some optimization.
+  /// The list of sessions is immutable and published through an atomic
+  /// shared pointer, connecting or disconnecting a session replaces the whole
+  /// list (copy-on-write). This way writing, which happens on every frame,
+  /// does not need to lock any mutex; only modifications of the list, which
+  /// are rare, are serialized.
   class MultiStreamState final : public StreamStateBase {
   public:
 
@@ -25,39 +33,76 @@ namespace detail {
 
     template <typename... Buffers>
     void Write(Buffers &&... buffers) {
+      auto sessions = _sessions.load();
+      if ((sessions == nullptr) || sessions->empty()) {
+        return;
+      }
+      // The same message is shared by all the sessions.
       auto message = Session::MakeMessage(std::move(buffers)...);
-      std::lock_guard<std::mutex> lock(_mutex);
-      for (auto &session : _sessions) {
-        if (session != nullptr) {
-          session->Write(message);
-        }
+      for (auto &session : *sessions) {
+        DEBUG_ASSERT(session != nullptr);
+        session->Write(message);
       }
     }
 
+    /// Set a function to be called, from the thread connecting the session,
+    /// every time a new session connects; after the session has been added,
+    /// so it receives the next message written.
+    void SetOnConnectCallback(std::function<void()> callback) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _on_connect = std::move(callback);
+    }
+
   private:
 
+    using SessionList = std::vector<std::shared_ptr<Session>>;
+
     void ConnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
-      std::lock_guard<std::mutex> lock(_mutex);
-      _sessions.emplace_back(std::move(session));
+      std::function<void()> on_connect;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto sessions = _sessions.load();
+        auto new_sessions = sessions != nullptr ?
+            std::make_shared<SessionList>(*sessions) :
+            std::make_shared<SessionList>();
+        new_sessions->emplace_back(std::move(session));
+        _sessions = std::move(new_sessions);
+        on_connect = _on_connect;
+      }
+      if (on_connect) {
+        on_connect();
+      }
     }
 
     void DisconnectSession(std::shared_ptr<Session> session) final {
-      std::lock_guard<std::mutex> lock(_mutex);
       DEBUG_ASSERT(session != nullptr);
-      _sessions.erase(
-          std::remove(_sessions.begin(), _sessions.end(), session),
-          _sessions.end());
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto sessions = _sessions.load();
+      if (sessions == nullptr) {
+        return;
+      }
+      auto new_sessions = std::make_shared<SessionList>();
+      new_sessions->reserve(sessions->size());
+      std::copy_if(
+          sessions->begin(),
+          sessions->end(),
+          std::back_inserter(*new_sessions),
+          [&](const auto &item) { return item != session; });
+      _sessions = std::move(new_sessions);
     }
 
     void ClearSessions() final {
       std::lock_guard<std::mutex> lock(_mutex);
-      _sessions.clear();
+      _sessions = nullptr;
     }
 
+    /// Serializes modifications of the list, never taken when writing.
     std::mutex _mutex;
 
-    std::vector<std::shared_ptr<Session>> _sessions;
+    AtomicSharedPtr<const SessionList> _sessions;
+
+    std::function<void()> _on_connect;
   };
 
 } // namespace detail
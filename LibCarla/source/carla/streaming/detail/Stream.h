@@ -11,6 +11,7 @@
 #include "carla/streaming/Token.h"
 
 #include <memory>
+#include <utility>
 
 namespace carla {
 namespace streaming {
@@ -61,6 +62,13 @@ namespace detail {
       return *this;
     }
 
+    /// Call @a callback every time a client subscribes to this stream. Only
+    /// available for streams that accept several clients (MultiStream).
+    template <typename FunctorT>
+    void SetOnConnectCallback(FunctorT &&callback) {
+      _shared_state->SetOnConnectCallback(std::forward<FunctorT>(callback));
+    }
+
   private:
 
     friend class detail::Dispatcher;
@@ -16,6 +16,8 @@
 #include <boost/asio/read.hpp>
 #include <boost/asio/write.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <exception>
 
 namespace carla {
@@ -23,42 +25,6 @@ namespace streaming {
 namespace detail {
 namespace tcp {
 
-  // ===========================================================================
-  // -- IncomingMessage --------------------------------------------------------
-  // ===========================================================================
-
-  /// Helper for reading incoming TCP messages. Allocates the whole message in
-  /// a single buffer.
-  class IncomingMessage {
-  public:
-
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
-
-    boost::asio::mutable_buffer size_as_buffer() {
-      return boost::asio::buffer(&_size, sizeof(_size));
-    }
-
-    boost::asio::mutable_buffer buffer() {
-      DEBUG_ASSERT(_size > 0u);
-      _message.reset(_size);
-      return _message.buffer();
-    }
-
-    auto size() const {
-      return _size;
-    }
-
-    auto pop() {
-      return std::move(_message);
-    }
-
-  private:
-
-    message_size_type _size = 0u;
-
-    Buffer _message;
-  };
-
   // ===========================================================================
   // -- Client -----------------------------------------------------------------
   // ===========================================================================
@@ -66,15 +32,18 @@ namespace tcp {
   Client::Client(
       boost::asio::io_context &io_context,
       const token_type &token,
-      callback_function_type callback)
+      callback_function_type callback,
+      const options_type &options)
     : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(
           std::string("tcp client ") + std::to_string(token.get_stream_id())),
       _token(token),
+      _options(options),
       _callback(std::move(callback)),
       _socket(io_context),
       _strand(io_context),
       _connection_timer(io_context),
-      _buffer_pool(std::make_shared<BufferPool>()) {
+      _buffer_pool(std::make_shared<BufferPool>()),
+      _read_buffer(std::max(_options.read_buffer_size, 2u * sizeof(message_size_type))) {
     if (!_token.protocol_is_tcp()) {
       throw_exception(std::invalid_argument("invalid token, only TCP tokens supported"));
     }
@@ -94,11 +63,35 @@ namespace tcp {
       if (_socket.is_open()) {
         _socket.close();
       }
+      _read_begin = 0u;
+      _read_end = 0u;
 
       DEBUG_ASSERT(_token.is_valid());
       DEBUG_ASSERT(_token.protocol_is_tcp());
       const auto ep = _token.to_tcp_endpoint();
 
+      // Open the socket before connecting, the size of the receive buffer
+      // must be set before the connection is established.
+      error_code error;
+      _socket.open(ep.protocol(), error);
+      if (error) {
+        log_info("streaming client: failed to open socket:", error.message());
+        Reconnect();
+        return;
+      }
+      _socket.set_option(boost::asio::ip::tcp::no_delay(_options.no_delay), error);
+      if (error) {
+        log_info("streaming client: failed to set TCP_NODELAY:", error.message());
+      }
+      if (_options.receive_buffer_size > 0) {
+        _socket.set_option(
+            boost::asio::socket_base::receive_buffer_size(_options.receive_buffer_size),
+            error);
+        if (error) {
+          log_info("streaming client: failed to set SO_RCVBUF:", error.message());
+        }
+      }
+
       auto handle_connect = [this, self, ep](error_code ec) {
         if (!ec) {
           if (_done) {
@@ -163,18 +156,22 @@ namespace tcp {
 
       log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      // Move the bytes not consumed yet to the front to make room for the
+      // next read.
+      if (_read_begin > 0u) {
+        std::memmove(
+            _read_buffer.data(),
+            _read_buffer.data() + _read_begin,
+            _read_end - _read_begin);
+        _read_end -= _read_begin;
+        _read_begin = 0u;
+      }
+      DEBUG_ASSERT(_read_end < _read_buffer.size());
 
-      auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
-        DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
+      auto handle_read = [this, self](boost::system::error_code ec, size_t bytes) {
+        DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read", bytes, "bytes"));
         if (!ec) {
-          DEBUG_ASSERT_EQ(bytes, message->size());
-          DEBUG_ASSERT_NE(bytes, 0u);
-          // Move the buffer to the callback function and start reading the next
-          // piece of data.
-          log_debug("streaming client: success reading data, calling the callback");
-          _strand.context().post([self, message]() { self->_callback(message->pop()); });
-          ReadData();
+          HandleReadData(bytes);
         } else {
           // As usual, if anything fails start over from the very top.
           log_info("streaming client: failed to read data:", ec.message());
@@ -182,34 +179,102 @@ namespace tcp {
         }
       };
 
-      auto handle_read_header = [this, self, message, handle_read_data](
-          boost::system::error_code ec,
-          size_t DEBUG_ONLY(bytes)) {
-        DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_header", bytes, "bytes"));
-        if (!ec && (message->size() > 0u)) {
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type));
-          if (_done) {
-            return;
-          }
-          // Now that we know the size of the coming buffer, we can allocate our
-          // buffer and start putting data into it.
-          boost::asio::async_read(
-              _socket,
-              message->buffer(),
-              _strand.wrap(handle_read_data));
-        } else {
-          log_info("streaming client: failed to read header:", ec.message());
-          DEBUG_ONLY(log_debug("size  = ", message->size()));
-          DEBUG_ONLY(log_debug("bytes = ", bytes));
-          Connect();
+      // Read whatever is available, possibly several messages at once.
+      _socket.async_read_some(
+          boost::asio::buffer(
+              _read_buffer.data() + _read_end,
+              _read_buffer.size() - _read_end),
+          _strand.wrap(handle_read));
+    });
+  }
+
+  void Client::HandleReadData(const size_t bytes) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (_done) {
+      return;
+    }
+    _read_end += bytes;
+    DEBUG_ASSERT(_read_end <= _read_buffer.size());
+
+    std::vector<Buffer> messages;
+    while ((_read_end - _read_begin) >= sizeof(message_size_type)) {
+      message_size_type size;
+      std::memcpy(&size, _read_buffer.data() + _read_begin, sizeof(size));
+      if (size == 0u) {
+        log_info("streaming client: failed to read header: empty message");
+        Dispatch(std::move(messages));
+        Connect();
+        return;
+      }
+      const size_t available = _read_end - _read_begin - sizeof(message_size_type);
+      if (available < size) {
+        if (sizeof(message_size_type) + size > _read_buffer.size()) {
+          // Too big for the read buffer, read the rest of it directly into
+          // the message.
+          Dispatch(std::move(messages));
+          ReadLargeMessage(size);
+          return;
         }
-      };
+        // Incomplete, wait for the rest.
+        break;
+      }
+      _read_begin += sizeof(message_size_type);
+      auto message = _buffer_pool->Pop(size);
+      message.copy_from(_read_buffer.data() + _read_begin, size);
+      _read_begin += size;
+      messages.emplace_back(std::move(message));
+    }
+    if (_read_begin == _read_end) {
+      _read_begin = 0u;
+      _read_end = 0u;
+    }
+    Dispatch(std::move(messages));
+    ReadData();
+  }
+
+  void Client::ReadLargeMessage(const message_size_type size) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    auto self = shared_from_this();
+
+    // Copy the part of the message already received.
+    _read_begin += sizeof(message_size_type);
+    const auto received = static_cast<message_size_type>(_read_end - _read_begin);
+    DEBUG_ASSERT(received < size);
+    auto message = std::make_shared<Buffer>(_buffer_pool->Pop(size));
+    std::memcpy(message->data(), _read_buffer.data() + _read_begin, received);
+    _read_begin = 0u;
+    _read_end = 0u;
+
+    auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
+      DEBUG_ONLY(log_debug("streaming client: Client::ReadLargeMessage.handle_read_data", bytes, "bytes"));
+      if (!ec) {
+        log_debug("streaming client: success reading data, calling the callback");
+        _strand.context().post([self, message]() { self->_callback(std::move(*message)); });
+        ReadData();
+      } else {
+        log_info("streaming client: failed to read data:", ec.message());
+        Connect();
+      }
+    };
+
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(message->data() + received, size - received),
+        _strand.wrap(handle_read_data));
+  }
 
-      // Read the size of the buffer that is coming.
-      boost::asio::async_read(
-          _socket,
-          message->size_as_buffer(),
-          _strand.wrap(handle_read_header));
+  void Client::Dispatch(std::vector<Buffer> messages) {
+    if (messages.empty()) {
+      return;
+    }
+    log_debug("streaming client: success reading", messages.size(), "messages, calling the callback");
+    // A single task per batch, the callback is invoked in the same order the
+    // messages arrived.
+    auto batch = std::make_shared<std::vector<Buffer>>(std::move(messages));
+    _strand.context().post([self=shared_from_this(), batch]() {
+      for (auto &message : *batch) {
+        self->_callback(std::move(message));
+      }
     });
   }
 
@@ -20,6 +20,7 @@
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace carla {
 
@@ -29,6 +30,21 @@ namespace streaming {
 namespace detail {
 namespace tcp {
 
+  /// Options applied to the socket of each streaming client.
+  struct ClientOptions {
+    /// Disable Nagle's algorithm (TCP_NODELAY).
+    bool no_delay = true;
+
+    /// Size of the kernel receive buffer of the socket (SO_RCVBUF) in bytes,
+    /// zero keeps the system default.
+    int receive_buffer_size = 0;
+
+    /// Size of the buffer the client reads into. Messages that fit in it are
+    /// framed in batches from a single read; bigger messages are read directly
+    /// into their own buffer.
+    size_t read_buffer_size = 64u * 1024u;
+  };
+
   /// A client that connects to a single stream.
   ///
   /// @warning This client should be stopped before releasing the shared pointer
@@ -42,11 +58,13 @@ namespace tcp {
     using endpoint = boost::asio::ip::tcp::endpoint;
     using protocol_type = endpoint::protocol_type;
     using callback_function_type = std::function<void (Buffer)>;
+    using options_type = ClientOptions;
 
     Client(
         boost::asio::io_context &io_context,
         const token_type &token,
-        callback_function_type callback);
+        callback_function_type callback,
+        const options_type &options = options_type{});
 
     ~Client();
 
@@ -64,8 +82,20 @@ namespace tcp {
 
     void ReadData();
 
+    /// Extract every complete message available in the read buffer.
+    void HandleReadData(size_t bytes);
+
+    /// Read the rest of a message that does not fit in the read buffer
+    /// directly into its own buffer.
+    void ReadLargeMessage(message_size_type size);
+
+    /// Invoke the callback on each of @a messages, in order.
+    void Dispatch(std::vector<Buffer> messages);
+
     const token_type _token;
 
+    const options_type _options;
+
     callback_function_type _callback;
 
     boost::asio::ip::tcp::socket _socket;
@@ -76,6 +106,14 @@ namespace tcp {
 
     std::shared_ptr<BufferPool> _buffer_pool;
 
+    /// Bytes received from the socket, the range [_read_begin, _read_end) has
+    /// not been consumed yet.
+    std::vector<unsigned char> _read_buffer;
+
+    size_t _read_begin = 0u;
+
+    size_t _read_end = 0u;
+
     std::atomic_bool _done{false};
   };
 
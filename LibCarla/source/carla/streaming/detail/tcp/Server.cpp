@@ -8,6 +8,7 @@
 
 #include "carla/Logging.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace carla {
@@ -20,6 +21,18 @@ namespace tcp {
       _acceptor(_io_context, std::move(ep)),
       _timeout(time_duration::seconds(10u)) {}
 
+  SessionStatistics Server::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto result = _closed_sessions_statistics;
+    for (const auto &weak : _sessions) {
+      const auto session = weak.lock();
+      if (session != nullptr) {
+        result += session->GetStatistics();
+      }
+    }
+    return result;
+  }
+
   void Server::OpenSession(
       time_duration timeout,
       ServerSession::callback_function_type on_opened,
@@ -28,9 +41,28 @@ namespace tcp {
 
     auto session = std::make_shared<ServerSession>(_io_context, timeout);
 
-    auto handle_query = [on_opened, on_closed, session](const error_code &ec) {
+    auto handle_query = [this, on_opened, on_closed, session](const error_code &ec) {
       if (!ec) {
-        session->Open(std::move(on_opened), std::move(on_closed));
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          session->_queue_options = _send_queue_options;
+          _sessions.emplace_back(session);
+        }
+        // Keep the counters of the session once it is closed.
+        auto on_session_closed = [this, on_closed](std::shared_ptr<ServerSession> closed) {
+          {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed_sessions_statistics += closed->GetStatistics();
+            _sessions.erase(
+                std::remove_if(_sessions.begin(), _sessions.end(), [&](const auto &weak) {
+                  const auto current = weak.lock();
+                  return (current == nullptr) || (current == closed);
+                }),
+                _sessions.end());
+          }
+          on_closed(std::move(closed));
+        };
+        session->Open(std::move(on_opened), std::move(on_session_closed));
       } else {
         log_error("tcp accept error:", ec.message());
       }
@@ -14,6 +14,9 @@
 #include <boost/asio/ip/tcp.hpp>
 
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -40,6 +43,18 @@ namespace tcp {
       _timeout = timeout;
     }
 
+    /// Set the limits and policy of the send queue of each session. Applies
+    /// only to sessions accepted from now on. By default sessions discard new
+    /// messages while busy.
+    void SetSendQueueOptions(const SendQueueOptions &options) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _send_queue_options = options;
+    }
+
+    /// Traffic counters summed over every session of this server, including
+    /// the sessions already closed.
+    SessionStatistics GetStatistics() const;
+
     /// Start listening for connections. On each new connection, @a
     /// on_session_opened is called, and @a on_session_closed when the session
     /// is closed.
@@ -65,6 +80,14 @@ namespace tcp {
     boost::asio::ip::tcp::acceptor _acceptor;
 
     std::atomic<time_duration> _timeout;
+
+    mutable std::mutex _mutex;
+
+    SendQueueOptions _send_queue_options;
+
+    std::vector<std::weak_ptr<ServerSession>> _sessions;
+
+    SessionStatistics _closed_sessions_statistics;
   };
 
 } // namespace tcp
@@ -66,40 +66,123 @@ namespace tcp {
   void ServerSession::Write(std::shared_ptr<const Message> message) {
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
-    _strand.post([=]() {
-      if (!_socket.is_open()) {
+    {
+      std::unique_lock<std::mutex> lock(_queue_mutex);
+      if (!PushMessage(lock, message)) {
         return;
       }
-      if (_is_writing) {
+    }
+    auto self = shared_from_this();
+    _strand.post([this, self, message]() { WriteNow(message); });
+  }
+
+  void ServerSession::Close() {
+    _strand.post([self=shared_from_this()]() { self->CloseNow(); });
+  }
+
+  SessionStatistics ServerSession::GetStatistics() const {
+    std::lock_guard<std::mutex> lock(_queue_mutex);
+    return _statistics;
+  }
+
+  bool ServerSession::PushMessage(
+      std::unique_lock<std::mutex> &lock,
+      const std::shared_ptr<const Message> &message) {
+    if (_is_closed) {
+      return false;
+    }
+    if (!_is_writing) {
+      _is_writing = true;
+      return true;
+    }
+    const auto size = message->size();
+    auto fits = [&]() {
+      return
+          (_queue.size() < _queue_options.max_messages) &&
+          ((_queue_options.max_bytes == 0u) ||
+           (_statistics.queued_bytes + size <= _queue_options.max_bytes));
+    };
+    if (!fits()) {
+      switch (_queue_options.policy) {
+        case SendQueuePolicy::DropOldest:
+          while (!_queue.empty() && !fits()) {
+            const auto dropped = _queue.front()->size();
+            _queue.pop_front();
+            --_statistics.queued_messages;
+            _statistics.queued_bytes -= dropped;
+            ++_statistics.dropped_messages;
+            _statistics.dropped_bytes += dropped;
+          }
+          break;
+        case SendQueuePolicy::BlockTick:
+          _queue_condition.wait_for(lock, _queue_options.block_timeout.to_chrono(), [&]() {
+            return _is_closed || !_is_writing || fits();
+          });
+          if (_is_closed) {
+            return false;
+          }
+          if (!_is_writing) {
+            _is_writing = true;
+            return true;
+          }
+          break;
+        case SendQueuePolicy::DropNewest:
+          break;
+      }
+      if (!fits()) {
         log_debug("session", _session_id, ": connection too slow: message discarded");
-        return;
+        ++_statistics.dropped_messages;
+        _statistics.dropped_bytes += size;
+        return false;
       }
-      _is_writing = true;
+    }
+    _queue.emplace_back(message);
+    ++_statistics.queued_messages;
+    _statistics.queued_bytes += size;
+    return false;
+  }
 
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
-        _is_writing = false;
-        if (ec) {
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow();
+  void ServerSession::WriteNow(std::shared_ptr<const Message> message) {
+    DEBUG_ASSERT(_strand.running_in_this_thread());
+    if (!_socket.is_open()) {
+      return;
+    }
+
+    auto handle_sent = [this, self=shared_from_this(), message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+      if (ec) {
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        CloseNow();
+        return;
+      }
+      DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+      DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+      std::shared_ptr<const Message> next;
+      {
+        std::lock_guard<std::mutex> lock(_queue_mutex);
+        ++_statistics.sent_messages;
+        _statistics.sent_bytes += message->size();
+        if (_queue.empty()) {
+          _is_writing = false;
         } else {
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+          next = std::move(_queue.front());
+          _queue.pop_front();
+          --_statistics.queued_messages;
+          _statistics.queued_bytes -= next->size();
         }
-      };
-
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+      }
+      _queue_condition.notify_all();
+      if (next != nullptr) {
+        WriteNow(std::move(next));
+      }
+    };
 
-      _deadline.expires_from_now(_timeout);
-      boost::asio::async_write(
-          _socket,
-          message->GetBufferSequence(),
-          _strand.wrap(handle_sent));
-    });
-  }
+    log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
 
-  void ServerSession::Close() {
-    _strand.post([self=shared_from_this()]() { self->CloseNow(); });
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        message->GetBufferSequence(),
+        _strand.wrap(handle_sent));
   }
 
   void ServerSession::StartTimer() {
@@ -123,6 +206,21 @@ namespace tcp {
     if (_socket.is_open()) {
       _socket.close();
     }
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (!_is_closed) {
+        _is_closed = true;
+        _statistics.dropped_messages += _statistics.queued_messages;
+        _statistics.dropped_bytes += _statistics.queued_bytes;
+        _statistics.queued_messages = 0u;
+        _statistics.queued_bytes = 0u;
+        _queue.clear();
+        log_debug(
+            "session", _session_id, ": sent", _statistics.sent_messages,
+            "messages, dropped", _statistics.dropped_messages);
+      }
+    }
+    _queue_condition.notify_all();
     _strand.context().post([self=shared_from_this()]() {
       DEBUG_ASSERT(self->_on_closed);
       self->_on_closed(self);
@@ -12,23 +12,67 @@
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/streaming/detail/Types.h"
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/tcp/SessionStatistics.h"
 
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
 
 namespace carla {
 namespace streaming {
 namespace detail {
 namespace tcp {
 
+  /// What a session does with a new message when its send queue is full.
+  enum class SendQueuePolicy : uint8_t {
+    /// Discard the new message (latency first).
+    DropNewest,
+    /// Discard the oldest queued messages to make room for the new one.
+    DropOldest,
+    /// Block the writer, usually the simulation tick, until there is room in
+    /// the queue or the block time-out expires.
+    BlockTick
+  };
+
+  /// Limits of the outbound queue of each session. The message being written
+  /// to the socket does not count towards the limits. The default values keep
+  /// no queue at all, messages arriving while the session is still writing
+  /// are discarded.
+  struct SendQueueOptions {
+    /// Maximum number of messages waiting to be sent.
+    size_t max_messages = 0u;
+
+    /// Maximum number of bytes waiting to be sent, zero means no limit.
+    size_t max_bytes = 0u;
+
+    SendQueuePolicy policy = SendQueuePolicy::DropNewest;
+
+    /// Maximum time a writer waits for room in the queue with
+    /// SendQueuePolicy::BlockTick, the message is discarded afterwards.
+    time_duration block_timeout = time_duration::seconds(1u);
+
+    /// Options for a queue without limits, no message is ever discarded.
+    static SendQueueOptions Unbounded() {
+      SendQueueOptions options;
+      options.max_messages = std::numeric_limits<size_t>::max();
+      return options;
+    }
+  };
+
   /// A TCP server session. When a session opens, it reads from the socket a
   /// stream id object and passes itself to the callback functor. The session
   /// closes itself after @a timeout of inactivity is met.
+  ///
+  /// Messages written while the previous one is still being sent are kept in
+  /// a queue bounded as specified by the SendQueueOptions of the server.
   class ServerSession
     : public std::enable_shared_from_this<ServerSession>,
       private profiler::LifetimeProfiled,
@@ -62,7 +106,9 @@ namespace tcp {
       return std::make_shared<const Message>(std::move(buffers)...);
     }
 
-    /// Writes some data to the socket.
+    /// Writes some data to the socket. If the session is busy the message is
+    /// queued, what happens when the queue is full depends on the
+    /// SendQueuePolicy of this session.
     void Write(std::shared_ptr<const Message> message);
 
     /// Writes some data to the socket.
@@ -74,8 +120,20 @@ namespace tcp {
     /// Post a job to close the session.
     void Close();
 
+    /// Snapshot of the traffic counters of this session.
+    SessionStatistics GetStatistics() const;
+
   private:
 
+    /// Add @a message to the queue applying the queue policy. Return true if
+    /// the session was idle and the caller has to send @a message right away.
+    bool PushMessage(
+        std::unique_lock<std::mutex> &lock,
+        const std::shared_ptr<const Message> &message);
+
+    /// Must be called from within the strand.
+    void WriteNow(std::shared_ptr<const Message> message);
+
     void StartTimer();
 
     void CloseNow();
@@ -96,7 +154,19 @@ namespace tcp {
 
     callback_function_type _on_closed;
 
+    SendQueueOptions _queue_options;
+
+    mutable std::mutex _queue_mutex;
+
+    std::condition_variable _queue_condition;
+
+    std::deque<std::shared_ptr<const Message>> _queue;
+
+    SessionStatistics _statistics;
+
     bool _is_writing = false;
+
+    bool _is_closed = false;
   };
 
 } // namespace tcp
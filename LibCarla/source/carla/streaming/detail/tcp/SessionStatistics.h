@@ -0,0 +1,55 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// Counters of the outbound traffic of a session, or of every session of a
+  /// server.
+  struct SessionStatistics {
+    /// Messages (and bytes) currently waiting in the queue.
+    uint64_t queued_messages = 0u;
+    uint64_t queued_bytes = 0u;
+
+    /// Messages (and bytes) successfully written to the socket.
+    uint64_t sent_messages = 0u;
+    uint64_t sent_bytes = 0u;
+
+    /// Messages (and bytes) discarded because the queue was full.
+    uint64_t dropped_messages = 0u;
+    uint64_t dropped_bytes = 0u;
+
+    SessionStatistics &operator+=(const SessionStatistics &rhs) {
+      queued_messages += rhs.queued_messages;
+      queued_bytes += rhs.queued_bytes;
+      sent_messages += rhs.sent_messages;
+      sent_bytes += rhs.sent_bytes;
+      dropped_messages += rhs.dropped_messages;
+      dropped_bytes += rhs.dropped_bytes;
+      return *this;
+    }
+
+    MSGPACK_DEFINE_ARRAY(
+        queued_messages,
+        queued_bytes,
+        sent_messages,
+        sent_bytes,
+        dropped_messages,
+        dropped_bytes);
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -29,13 +29,19 @@ namespace low_level {
 
     using underlying_client = T;
     using protocol_type = typename underlying_client::protocol_type;
+    using options_type = typename underlying_client::options_type;
     using token_type = carla::streaming::detail::token_type;
 
-    explicit Client(boost::asio::ip::address fallback_address)
-      : _fallback_address(std::move(fallback_address)) {}
+    explicit Client(
+        boost::asio::ip::address fallback_address,
+        const options_type &options = options_type{})
+      : _fallback_address(std::move(fallback_address)),
+        _options(options) {}
 
-    explicit Client(const std::string &fallback_address)
-      : Client(carla::streaming::make_address(fallback_address)) {}
+    explicit Client(
+        const std::string &fallback_address,
+        const options_type &options = options_type{})
+      : Client(carla::streaming::make_address(fallback_address), options) {}
 
     explicit Client()
       : Client(carla::streaming::make_localhost_address()) {}
@@ -60,7 +66,8 @@ namespace low_level {
       auto client = std::make_shared<underlying_client>(
           io_context,
           token,
-          std::forward<Functor>(callback));
+          std::forward<Functor>(callback),
+          _options);
       client->Connect();
       _clients.emplace(token.get_stream_id(), std::move(client));
     }
@@ -77,6 +84,8 @@ namespace low_level {
 
     boost::asio::ip::address _fallback_address;
 
+    const options_type _options;
+
     std::unordered_map<
         detail::stream_id_type,
         std::shared_ptr<underlying_client>> _clients;
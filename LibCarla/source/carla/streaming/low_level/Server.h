@@ -60,6 +60,15 @@ namespace low_level {
       _server.SetTimeout(timeout);
     }
 
+    template <typename OptionsT>
+    void SetSendQueueOptions(const OptionsT &options) {
+      _server.SetSendQueueOptions(options);
+    }
+
+    auto GetStatistics() const {
+      return _server.GetStatistics();
+    }
+
     Stream MakeStream() {
       return _dispatcher.MakeStream();
     }
@@ -0,0 +1,165 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Recorder.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#include <zlib.h>
+
+#include <fstream>
+#include <stdexcept>
+
+namespace util {
+
+  using namespace carla::recorder;
+
+  namespace {
+
+    class Bytes {
+    public:
+
+      template <typename T>
+      Bytes &Write(const T &value) {
+        data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        return *this;
+      }
+
+      Bytes &WriteString(const std::string &str) {
+        Write(static_cast<uint16_t>(str.size()));
+        data.append(str);
+        return *this;
+      }
+
+      Bytes &WriteTransform(const carla::geom::Transform &transform) {
+        const auto &location = transform.location;
+        const auto &rotation = transform.rotation;
+        Write(100.0f * location.x).Write(100.0f * location.y).Write(100.0f * location.z);
+        return Write(rotation.roll).Write(rotation.pitch).Write(rotation.yaw);
+      }
+
+      Bytes &WritePacket(PacketId id, const Bytes &packet) {
+        Write(static_cast<uint8_t>(id));
+        Write(static_cast<uint32_t>(packet.data.size()));
+        data.append(packet.data);
+        return *this;
+      }
+
+      template <typename T, typename FunctorT>
+      Bytes &WritePacket(PacketId id, const std::vector<T> &records, FunctorT &&write_record) {
+        Bytes packet;
+        packet.Write(static_cast<uint16_t>(records.size()));
+        for (auto &record : records) {
+          write_record(packet, record);
+        }
+        return WritePacket(id, packet);
+      }
+
+      std::string data;
+    };
+
+  } // namespace
+
+  std::string Recorder::Make(
+      const std::vector<Frame> &frames,
+      const double delta_seconds,
+      const bool compress,
+      const bool with_index) {
+    Bytes file;
+    file.Write(uint16_t(1u)).WriteString("CARLA_RECORDER").Write(int64_t(1234)).WriteString("Town01");
+
+    Bytes index;
+    index.Write(static_cast<uint32_t>(frames.size()));
+    uint32_t keyframes = 0u;
+    for (auto i = 0u; i < frames.size(); ++i) {
+      const auto &frame = frames[i];
+      const double elapsed = delta_seconds * static_cast<double>(i);
+      if (frame.keyframe) {
+        file.WritePacket(PacketId::Keyframe, Bytes{}.Write(uint32_t(0u)));
+        ++keyframes;
+      }
+      index.Write(uint64_t(i)).Write(elapsed).Write(static_cast<uint64_t>(file.data.size()));
+
+      Bytes packets;
+      packets.WritePacket(PacketId::FrameStart, Bytes{}.Write(uint64_t(i)).Write(delta_seconds).Write(elapsed));
+      packets.WritePacket(PacketId::EventAdd, frame.added, [](Bytes &out, const Actor &actor) {
+        out.Write(actor.id).Write(static_cast<uint8_t>(actor.type)).WriteTransform({});
+        out.Write(uint32_t(7u)).WriteString(actor.type_id);
+        out.Write(uint16_t(1u)).Write(uint8_t(0u)).WriteString("role_name").WriteString("test");
+      });
+      packets.WritePacket(PacketId::EventDel, frame.removed, [](Bytes &out, uint32_t id) {
+        out.Write(id);
+      });
+      packets.WritePacket(PacketId::EventParent, Bytes{}.Write(uint16_t(0u)));
+      packets.WritePacket(PacketId::Collision, frame.collisions, [](Bytes &out, const Collision &collision) {
+        out.Write(collision.id).Write(collision.actor1).Write(collision.actor2);
+        out.Write(collision.is_actor1_hero).Write(collision.is_actor2_hero);
+      });
+      packets.WritePacket(PacketId::Position, frame.positions, [](Bytes &out, const Position &position) {
+        out.Write(position.database_id).WriteTransform(position.transform);
+      });
+      packets.WritePacket(PacketId::State, frame.traffic_lights, [](Bytes &out, const TrafficLightState &light) {
+        out.Write(light.database_id).Write(light.is_frozen).Write(light.elapsed_time).Write(light.state);
+      });
+      packets.WritePacket(PacketId::AnimVehicle, frame.vehicle_animations, [](Bytes &out, const VehicleAnimation &animation) {
+        out.Write(animation.database_id).Write(animation.steering).Write(animation.throttle);
+        out.Write(animation.brake).Write(animation.handbrake).Write(animation.gear);
+      });
+      packets.WritePacket(PacketId::AnimWalker, frame.walker_animations, [](Bytes &out, const WalkerAnimation &animation) {
+        out.Write(animation.database_id).Write(animation.speed);
+      });
+      packets.WritePacket(PacketId::FrameEnd, Bytes{});
+
+      if (compress) {
+        std::string compressed(compressBound(static_cast<uLong>(packets.data.size())), '\0');
+        uLongf size = static_cast<uLongf>(compressed.size());
+        if (compress2(
+                reinterpret_cast<Bytef *>(&compressed[0u]), &size,
+                reinterpret_cast<const Bytef *>(packets.data.data()),
+                static_cast<uLong>(packets.data.size()),
+                Z_BEST_SPEED) != Z_OK) {
+          throw std::runtime_error("cannot compress recorder block");
+        }
+        compressed.resize(size);
+        Bytes block;
+        block.Write(uint8_t(1u)).Write(static_cast<uint32_t>(packets.data.size()));
+        block.data.append(compressed);
+        file.WritePacket(PacketId::Block, block);
+      } else {
+        file.data.append(packets.data);
+      }
+    }
+    if (with_index) {
+      index.Write(keyframes);
+      for (auto i = 0u; i < keyframes; ++i) {
+        index.Write(uint64_t(0u)).Write(uint64_t(0u));
+      }
+      // Packet header, index, and footer.
+      const auto index_offset = static_cast<uint64_t>(file.data.size());
+      const auto recording_size = index_offset + 5u + index.data.size() + 24u;
+      index.Write(index_offset).Write(static_cast<uint64_t>(recording_size));
+      index.data.append("CRINDEX1", 8u);
+      file.WritePacket(PacketId::FrameIndex, index);
+    }
+    return file.data;
+  }
+
+  TemporaryFile::TemporaryFile(const std::string &extension)
+    : _path(boost::filesystem::temp_directory_path() /
+            boost::filesystem::unique_path("carla-test-%%%%-%%%%" + extension)) {}
+
+  TemporaryFile::TemporaryFile(const std::string &extension, const std::string &data)
+    : TemporaryFile(extension) {
+    std::ofstream file(GetPath(), std::ios::binary);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+  }
+
+  TemporaryFile::~TemporaryFile() {
+    boost::system::error_code error;
+    boost::filesystem::remove(_path, error);
+  }
+
+} // namespace util
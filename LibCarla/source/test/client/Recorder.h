@@ -0,0 +1,72 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <carla/recorder/Packets.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <string>
+#include <vector>
+
+namespace util {
+
+  /// Helper for writing recordings with the layout of the simulator recorder.
+  class Recorder {
+  public:
+
+    struct Actor {
+      uint32_t id;
+      carla::recorder::ActorType type;
+      std::string type_id;
+    };
+
+    struct Frame {
+      std::vector<Actor> added;
+      std::vector<uint32_t> removed;
+      std::vector<carla::recorder::Collision> collisions;
+      /// In meters, written in centimeters.
+      std::vector<carla::recorder::Position> positions;
+      std::vector<carla::recorder::TrafficLightState> traffic_lights;
+      std::vector<carla::recorder::VehicleAnimation> vehicle_animations;
+      std::vector<carla::recorder::WalkerAnimation> walker_animations;
+      /// Write a keyframe packet before the frame.
+      bool keyframe = false;
+    };
+
+    /// Make a recording of @a frames taken every @a delta_seconds, each one
+    /// in a zlib compressed block if @a compress, with the frame index at the
+    /// end if @a with_index.
+    static std::string Make(
+        const std::vector<Frame> &frames,
+        double delta_seconds,
+        bool compress,
+        bool with_index);
+  };
+
+  /// Unique path in the temporary folder, the file is removed on
+  /// destruction.
+  class TemporaryFile {
+  public:
+
+    explicit TemporaryFile(const std::string &extension);
+
+    /// Write @a data into a new temporary file.
+    TemporaryFile(const std::string &extension, const std::string &data);
+
+    ~TemporaryFile();
+
+    std::string GetPath() const {
+      return _path.string();
+    }
+
+  private:
+
+    const boost::filesystem::path _path;
+  };
+
+} // namespace util
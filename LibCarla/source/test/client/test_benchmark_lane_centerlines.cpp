@@ -0,0 +1,64 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/LaneCenterlines.h>
+
+using namespace carla::road;
+using namespace carla::road::element;
+using namespace carla::opendrive;
+
+static void benchmark_lane_centerlines(const double resolution) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+
+    carla::StopWatch build_timer;
+    const LaneCenterlines centerlines(map, resolution);
+    build_timer.Stop();
+
+    const auto waypoints = map.GenerateWaypoints(0.3);
+    ASSERT_FALSE(waypoints.empty());
+
+    // Accumulate the results so the calls are not optimized away.
+    float checksum = 0.0f;
+    carla::StopWatch exact_timer;
+    for (const auto &waypoint : waypoints) {
+      checksum += map.ComputeTransform(waypoint).location.x;
+    }
+    exact_timer.Stop();
+    carla::StopWatch interpolated_timer;
+    for (const auto &waypoint : waypoints) {
+      checksum -= centerlines.ComputeTransform(waypoint)->location.x;
+    }
+    interpolated_timer.Stop();
+
+    auto per_call = [&](const carla::StopWatch &timer) {
+      return 1e3 * static_cast<double>(timer.GetElapsedTime<std::chrono::microseconds>()) /
+             static_cast<double>(waypoints.size());
+    };
+    carla::logging::log(
+        "Benchmark:", file, waypoints.size(), "transforms, resolution", resolution, "m,",
+        centerlines.GetNumberOfSamples(), "samples built in", build_timer.GetElapsedTime(), "ms");
+    carla::logging::log(
+        "  exact", per_call(exact_timer), "ns, interpolated", per_call(interpolated_timer),
+        "ns per transform; max error", centerlines.GetMaxLocationError(), "m,",
+        centerlines.GetMaxRotationError(), "deg; checksum", checksum);
+  }
+}
+
+TEST(benchmark_lane_centerlines, resolution_0_5) {
+  benchmark_lane_centerlines(0.5);
+}
+
+TEST(benchmark_lane_centerlines, resolution_2_0) {
+  benchmark_lane_centerlines(2.0);
+}
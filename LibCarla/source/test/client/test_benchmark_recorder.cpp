@@ -0,0 +1,113 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+#include "Recorder.h"
+
+#include <carla/StopWatch.h>
+#include <carla/recorder/ColumnarRecording.h>
+#include <carla/recorder/Queries.h>
+
+#include <algorithm>
+#include <thread>
+
+using namespace carla::recorder;
+using namespace util;
+
+/// Vehicles driving along x at random speeds, stopping now and then for a
+/// random number of frames.
+static std::vector<Recorder::Frame> MakeTraffic(
+    const uint32_t number_of_actors,
+    const size_t number_of_frames,
+    const double delta_seconds) {
+  std::vector<Recorder::Frame> frames(number_of_frames);
+  for (auto id = 1u; id <= number_of_actors; ++id) {
+    frames[0u].added.push_back({id, ActorType::Vehicle, "vehicle.test.car"});
+  }
+  std::vector<float> x(number_of_actors, 0.0f);
+  std::vector<size_t> stopped_until(number_of_actors, 0u);
+  for (auto i = 0u; i < number_of_frames; ++i) {
+    auto &frame = frames[i];
+    frame.keyframe = (i % 1000u == 0u);
+    for (auto j = 0u; j < number_of_actors; ++j) {
+      if (i >= stopped_until[j]) {
+        if (Random::Uniform(0.0, 1.0) < 0.002) {
+          const auto seconds = Random::Uniform(5.0, 120.0);
+          stopped_until[j] = i + static_cast<size_t>(seconds / delta_seconds);
+        } else {
+          x[j] += static_cast<float>(Random::Uniform(0.0, 20.0) * delta_seconds);
+        }
+      }
+      const auto id = j + 1u;
+      const carla::geom::Location location{x[j], 4.0f * static_cast<float>(j), 0.5f};
+      frame.positions.push_back({id, carla::geom::Transform{location}});
+      frame.vehicle_animations.push_back({id, 0.0f, 0.5f, 0.0f, false, 1});
+    }
+  }
+  return frames;
+}
+
+static void benchmark_recorder(const uint32_t number_of_actors, const size_t number_of_frames) {
+  constexpr double delta_seconds = 0.05;
+  const TemporaryFile file(".log", Recorder::Make(
+      MakeTraffic(number_of_actors, number_of_frames, delta_seconds),
+      delta_seconds,
+      true,
+      true));
+  const Recording recording(file.GetPath());
+
+  auto query = [&](size_t worker_threads, double &milliseconds) {
+    carla::StopWatch stop_watch;
+    auto blocked = Queries::BlockedActors(recording, 30.0, 1.0, worker_threads);
+    milliseconds = static_cast<double>(stop_watch.GetElapsedTime());
+    return blocked;
+  };
+  // At least 4 threads, so the workers overlap with the query even on
+  // machines with fewer cores; the speedup needs as many cores.
+  const size_t worker_threads = std::max(std::thread::hardware_concurrency(), 4u);
+  double single_thread = 0.0;
+  double multiple_threads = 0.0;
+  const auto expected = query(1u, single_thread);
+  ASSERT_EQ(query(worker_threads, multiple_threads).size(), expected.size());
+
+  const TemporaryFile columns_file(".cols");
+  carla::StopWatch export_timer;
+  ColumnarRecording::Export(recording, columns_file.GetPath());
+  export_timer.Stop();
+  carla::StopWatch load_timer;
+  const ColumnarRecording columns(columns_file.GetPath());
+  load_timer.Stop();
+  carla::StopWatch columnar_timer;
+  const auto blocked = Queries::BlockedActors(columns, 30.0, 1.0);
+  columnar_timer.Stop();
+
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(blocked.size(), expected.size());
+  for (auto i = 0u; i < blocked.size(); ++i) {
+    ASSERT_EQ(blocked[i].actor_id, expected[i].actor_id);
+    ASSERT_DOUBLE_EQ(blocked[i].time, expected[i].time);
+    ASSERT_DOUBLE_EQ(blocked[i].duration, expected[i].duration);
+  }
+
+  carla::logging::log(
+      "Benchmark:", number_of_actors, "actors,", number_of_frames, "frames,",
+      expected.size(), "blocked actors.");
+  carla::logging::log(
+      "  packets: 1 thread", single_thread, "ms,", worker_threads, "threads",
+      multiple_threads, "ms on", std::thread::hardware_concurrency(), "cores");
+  carla::logging::log(
+      "  columns: export", export_timer.GetElapsedTime(), "ms, load",
+      load_timer.GetElapsedTime(), "ms, query", columnar_timer.GetElapsedTime(), "ms");
+}
+
+TEST(benchmark_recorder, actors_100_frames_6000) {
+  benchmark_recorder(100u, 6'000u);
+}
+
+TEST(benchmark_recorder, actors_1000_frames_6000) {
+  benchmark_recorder(1'000u, 6'000u);
+}
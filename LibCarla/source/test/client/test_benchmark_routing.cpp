@@ -0,0 +1,88 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/RouteHierarchy.h>
+#include <carla/road/RoutePlanner.h>
+
+#include <algorithm>
+
+using namespace carla::road;
+using namespace carla::road::element;
+using namespace carla::opendrive;
+using namespace util;
+
+static void benchmark_routing(const size_t number_of_queries) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+
+    carla::StopWatch planner_timer;
+    const RoutePlanner planner(map);
+    planner_timer.Stop();
+    carla::StopWatch hierarchy_timer;
+    const RouteHierarchy hierarchy(planner);
+    hierarchy_timer.Stop();
+
+    const auto waypoints = map.GenerateWaypoints(5.0);
+    ASSERT_FALSE(waypoints.empty());
+    std::vector<std::pair<Waypoint, Waypoint>> queries;
+    queries.reserve(number_of_queries);
+    for (auto i = 0u; i < number_of_queries; ++i) {
+      const auto origin = static_cast<size_t>(Random::Uniform(0.0, static_cast<double>(waypoints.size())));
+      const auto destination = static_cast<size_t>(Random::Uniform(0.0, static_cast<double>(waypoints.size())));
+      queries.emplace_back(
+          waypoints[std::min(origin, waypoints.size() - 1u)],
+          waypoints[std::min(destination, waypoints.size() - 1u)]);
+    }
+
+    auto run = [&](RoutePlanner::Algorithm algorithm, double &microseconds) {
+      carla::StopWatch stop_watch;
+      auto routes = planner.ComputeRoutes(map, queries, algorithm, &hierarchy);
+      microseconds = static_cast<double>(stop_watch.GetElapsedTime<std::chrono::microseconds>()) /
+                     static_cast<double>(number_of_queries);
+      return routes;
+    };
+    double astar = 0.0;
+    double bidirectional = 0.0;
+    double contraction_hierarchy = 0.0;
+    const auto expected = run(RoutePlanner::Algorithm::AStar, astar);
+    run(RoutePlanner::Algorithm::BidirectionalDijkstra, bidirectional);
+    const auto routes = run(RoutePlanner::Algorithm::ContractionHierarchy, contraction_hierarchy);
+
+    ASSERT_EQ(routes.size(), expected.size());
+    for (auto i = 0u; i < routes.size(); ++i) {
+      ASSERT_EQ(routes[i].has_value(), expected[i].has_value());
+      if (routes[i].has_value()) {
+        ASSERT_NEAR(routes[i]->cost, expected[i]->cost, 1e-6 * std::max(1.0, expected[i]->cost));
+      }
+    }
+
+    carla::logging::log(
+        "Benchmark:", file, number_of_queries, "routes,",
+        planner.GetNumberOfLanes(), "lanes,", hierarchy.GetNumberOfShortcuts(), "shortcuts.");
+    carla::logging::log(
+        "  build: planner", planner_timer.GetElapsedTime(), "ms, hierarchy",
+        hierarchy_timer.GetElapsedTime(), "ms");
+    carla::logging::log(
+        "  query: A*", astar, "us, bidirectional", bidirectional,
+        "us, contraction hierarchy", contraction_hierarchy, "us");
+  }
+}
+
+TEST(benchmark_routing, routes_1000) {
+  benchmark_routing(1'000u);
+}
+
+TEST(benchmark_routing, routes_10000) {
+  benchmark_routing(10'000u);
+}
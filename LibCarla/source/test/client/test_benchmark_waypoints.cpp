@@ -0,0 +1,111 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+using namespace carla::road;
+using namespace carla::road::element;
+using namespace carla::opendrive;
+using namespace util;
+
+/// Nearest lane among the @a max_nearests roads with the nearest reference
+/// line, found with a linear scan over every road as Map did before it had
+/// a spatial index.
+static std::tuple<double, RoadId, LaneId> LinearSearch(
+    const MapData &data,
+    const carla::geom::Location &location,
+    const size_t max_nearests) {
+  const carla::geom::Location pos_inverted_y(location.x, -location.y, location.z);
+  std::vector<std::tuple<double, RoadId, double>> nearest_roads;
+  for (const auto &pair : data.GetRoads()) {
+    const auto nearest = pair.second.GetNearestPoint(pos_inverted_y);
+    nearest_roads.emplace_back(nearest.second, pair.first, nearest.first);
+  }
+  const auto count = std::min(max_nearests, nearest_roads.size());
+  std::partial_sort(nearest_roads.begin(), nearest_roads.begin() + count, nearest_roads.end());
+  auto result = std::make_tuple(std::numeric_limits<double>::max(), RoadId(0u), LaneId(0));
+  for (auto i = 0u; i < count; ++i) {
+    const auto road_id = std::get<1>(nearest_roads[i]);
+    const auto lane = data.GetRoad(road_id).GetNearestLane(
+        std::get<2>(nearest_roads[i]),
+        pos_inverted_y,
+        static_cast<uint32_t>(Lane::LaneType::Driving));
+    if (lane.first != nullptr) {
+      result = std::min(result, std::make_tuple(lane.second, road_id, lane.first->GetId()));
+    }
+  }
+  return result;
+}
+
+/// Random locations are mostly far from the roads and at another height, the
+/// nearest lane is found only after visiting many roads.
+static void benchmark_closest_waypoint(const size_t number_of_queries, const bool near_roads) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+    const auto &data = map.GetMap();
+
+    // Locations near the roads are where the queries usually are.
+    const auto waypoints = map.GenerateWaypoints(5.0);
+    ASSERT_FALSE(waypoints.empty());
+    std::vector<carla::geom::Location> locations;
+    locations.reserve(number_of_queries);
+    for (auto i = 0u; i < number_of_queries; ++i) {
+      const auto index = static_cast<size_t>(Random::Uniform(0.0, static_cast<double>(waypoints.size())));
+      const auto &waypoint = waypoints[std::min(index, waypoints.size() - 1u)];
+      locations.emplace_back(near_roads ?
+          map.ComputeTransform(waypoint).location + Random::Location(-5.0f, 5.0f) :
+          Random::Location(-500.0f, 500.0f));
+    }
+
+    double checksum = 0.0;
+    carla::StopWatch linear_timer;
+    for (const auto &location : locations) {
+      checksum += static_cast<double>(std::get<2>(LinearSearch(data, location, 50u)));
+    }
+    linear_timer.Stop();
+    carla::StopWatch index_timer;
+    for (const auto &location : locations) {
+      checksum -= static_cast<double>(map.GetClosestWaypointOnRoad(location)->lane_id);
+    }
+    index_timer.Stop();
+
+    const auto linear = linear_timer.GetElapsedTime<std::chrono::microseconds>();
+    const auto index = index_timer.GetElapsedTime<std::chrono::microseconds>();
+    carla::logging::log(
+        "Benchmark:", file, data.GetRoadCount(), "roads,", number_of_queries,
+        near_roads ? "closest waypoints near the roads:" : "closest waypoints anywhere:",
+        "linear search", linear, "us, spatial index", index,
+        "us, checksum", checksum);
+    // The index pays off with more roads than the 50 candidates of the
+    // linear search.
+    if (data.GetRoadCount() > 100u) {
+      ASSERT_LT(index, linear);
+    }
+  }
+}
+
+TEST(benchmark_waypoints, closest_waypoint_2000) {
+  benchmark_closest_waypoint(2'000u, true);
+}
+
+TEST(benchmark_waypoints, closest_waypoint_20000) {
+  benchmark_closest_waypoint(20'000u, true);
+}
+
+TEST(benchmark_waypoints, closest_waypoint_anywhere_2000) {
+  benchmark_closest_waypoint(2'000u, false);
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Recorder.h"
+
+#include <carla/recorder/ColumnarRecording.h>
+#include <carla/recorder/Queries.h>
+#include <carla/recorder/Recording.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace carla::recorder;
+using util::Recorder;
+using util::TemporaryFile;
+
+/// 200 frames of one second: actor 1 (vehicle) drives along x except while
+/// stopped in frames [100, 150), actor 2 (walker) never moves, actor 3 (a
+/// hero vehicle) leaves in frame 5, and actor 4 is a traffic light. Actors 1
+/// and 2 collide in frames [10, 13) and 50, actors 1 and 3 in frame 4.
+static std::vector<Recorder::Frame> MakeFrames() {
+  std::vector<Recorder::Frame> frames(200u);
+  frames[0u].keyframe = true;
+  frames[0u].added = {
+    {1u, ActorType::Vehicle, "vehicle.test.car"},
+    {2u, ActorType::Walker, "walker.test.pedestrian"},
+    {3u, ActorType::Vehicle, "vehicle.test.hero"},
+    {4u, ActorType::TrafficLight, "traffic.traffic_light"}};
+  frames[5u].removed = {3u};
+  frames[100u].keyframe = true;
+  for (auto i = 10u; i < 13u; ++i) {
+    frames[i].collisions.push_back(Collision{0u, 1u, 2u, false, false});
+  }
+  frames[50u].collisions.push_back(Collision{1u, 1u, 2u, false, false});
+  frames[4u].collisions.push_back(Collision{2u, 1u, 3u, false, true});
+  for (auto i = 0u; i < frames.size(); ++i) {
+    auto &frame = frames[i];
+    const float x = ((i >= 100u) && (i < 150u)) ? 200.0f : 2.0f * static_cast<float>(i);
+    const carla::geom::Rotation rotation{1.0f, 2.0f, 3.0f};
+    frame.positions = {
+      {1u, {carla::geom::Location{x, 10.0f, 0.5f}, rotation}},
+      {2u, {carla::geom::Location{10.0f, 10.0f, 0.5f}, rotation}}};
+    frame.vehicle_animations = {{1u, 0.1f, static_cast<float>(i) / 200.0f, 0.0f, false, 1}};
+    frame.walker_animations = {{2u, 0.0f}};
+    frame.traffic_lights = {{4u, false, 0.5f, static_cast<uint8_t>((i / 10u) % 3u)}};
+  }
+  return frames;
+}
+
+static std::string MakeRecording(bool compress, bool with_index) {
+  return Recorder::Make(MakeFrames(), 1.0, compress, with_index);
+}
+
+TEST(columnar_recording, export_and_load) {
+  const TemporaryFile file(".log", MakeRecording(true, true));
+  const Recording recording(file.GetPath());
+  const TemporaryFile columns_file(".cols");
+  // Chunks not aligned with the ranges read.
+  ColumnarRecording::Export(recording, columns_file.GetPath(), 90u, 2u);
+  const ColumnarRecording columns(columns_file.GetPath());
+  ASSERT_EQ(columns.GetInfo().map, "Town01");
+  ASSERT_EQ(columns.GetNumberOfChunks(), 3u);
+
+  const auto &frames = columns.GetFrames();
+  ASSERT_EQ(frames.size(), 200u);
+  for (auto i = 0u; i < frames.size(); ++i) {
+    ASSERT_EQ(frames.id[i], i);
+    ASSERT_DOUBLE_EQ(frames.elapsed[i], static_cast<double>(i));
+    ASSERT_DOUBLE_EQ(frames.duration[i], 1.0);
+  }
+
+  ASSERT_EQ(columns.GetActors().size(), 4u);
+  ASSERT_EQ(columns.GetActor(5u), nullptr);
+  const auto *car = columns.GetActor(1u);
+  ASSERT_NE(car, nullptr);
+  ASSERT_EQ(car->type, ActorType::Vehicle);
+  ASSERT_EQ(car->type_id, "vehicle.test.car");
+  ASSERT_EQ(car->added_frame, 0u);
+  ASSERT_EQ(car->removed_frame, uint32_t(ActorColumns::NO_FRAME));
+  ASSERT_EQ(car->positions.size(), 200u);
+  ASSERT_EQ(car->vehicle_controls.size(), 200u);
+  ASSERT_EQ(car->walker.size(), 0u);
+  for (auto i = 0u; i < car->positions.size(); ++i) {
+    ASSERT_EQ(car->positions.frame[i], i);
+    ASSERT_EQ(car->vehicle_controls.frame[i], i);
+    ASSERT_FLOAT_EQ(car->vehicle_controls.throttle[i], static_cast<float>(i) / 200.0f);
+  }
+  ASSERT_FLOAT_EQ(car->positions.location[1u].x, 2.0f);
+  ASSERT_FLOAT_EQ(car->positions.location[1u].z, 0.5f);
+  ASSERT_FLOAT_EQ(car->positions.rotation[1u].pitch, 1.0f);
+  ASSERT_FLOAT_EQ(car->positions.rotation[1u].roll, 3.0f);
+  ASSERT_EQ(car->vehicle_controls.gear[5u], 1);
+
+  const auto *walker = columns.GetActor(2u);
+  ASSERT_NE(walker, nullptr);
+  ASSERT_EQ(walker->walker.size(), 200u);
+  const auto *hero = columns.GetActor(3u);
+  ASSERT_NE(hero, nullptr);
+  ASSERT_EQ(hero->removed_frame, 5u);
+  ASSERT_EQ(hero->positions.size(), 0u);
+  const auto *light = columns.GetActor(4u);
+  ASSERT_NE(light, nullptr);
+  ASSERT_EQ(light->type, ActorType::TrafficLight);
+  ASSERT_EQ(light->traffic_light.size(), 200u);
+  ASSERT_EQ(light->traffic_light.state[25u], 2u);
+
+  for (auto min_time : {0.0, 30.0, 60.0}) {
+    const auto expected = Queries::BlockedActors(recording, min_time, 1.0, 1u);
+    const auto blocked = Queries::BlockedActors(columns, min_time, 1.0);
+    ASSERT_EQ(blocked.size(), expected.size());
+    for (auto i = 0u; i < blocked.size(); ++i) {
+      ASSERT_EQ(blocked[i].actor_id, expected[i].actor_id);
+      ASSERT_EQ(blocked[i].type_id, expected[i].type_id);
+      ASSERT_DOUBLE_EQ(blocked[i].time, expected[i].time);
+      ASSERT_DOUBLE_EQ(blocked[i].duration, expected[i].duration);
+    }
+  }
+}
+
+TEST(columnar_recording, invalid_file) {
+  const TemporaryFile file(".log", MakeRecording(false, false));
+  const Recording recording(file.GetPath());
+  const TemporaryFile columns_file(".cols");
+  ColumnarRecording::Export(recording, columns_file.GetPath());
+  ASSERT_EQ(ColumnarRecording(columns_file.GetPath()).GetNumberOfChunks(), 1u);
+  ASSERT_THROW(ColumnarRecording{file.GetPath()}, std::runtime_error);
+  ASSERT_THROW(ColumnarRecording{columns_file.GetPath() + ".missing"}, std::runtime_error);
+
+  // Truncated chunks.
+  std::ifstream in(columns_file.GetPath(), std::ios::binary);
+  std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+  data.erase(100u, 40u);
+  const TemporaryFile truncated(".cols", data);
+  ASSERT_THROW(ColumnarRecording{truncated.GetPath()}, std::runtime_error);
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/s11n/EpisodeStateDelta.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace carla::sensor;
+using carla::client::detail::EpisodeState;
+using ActorDynamicState = data::ActorDynamicState;
+using Serializer = s11n::EpisodeStateSerializer;
+
+static ActorDynamicState MakeActor(carla::ActorId id, float x) {
+  ActorDynamicState actor{};
+  std::memset(&actor.state, 0, sizeof(actor.state));
+  actor.id = id;
+  actor.transform = carla::geom::Transform{carla::geom::Location{x, 0.0f, 0.0f}};
+  return actor;
+}
+
+/// Make the message a client would receive, with the sensor header.
+static carla::SharedPtr<SensorData> MakeMessage(
+    s11n::EpisodeStateDeltaEncoder &encoder,
+    uint64_t frame,
+    const std::vector<ActorDynamicState> &actors) {
+  Serializer::Header header;
+  header.episode_id = 1u;
+  header.platform_timestamp = 0.0;
+  header.delta_seconds = 0.05f;
+  auto body = encoder.Serialize(carla::Buffer{}, header, frame, actors);
+  // The episode state is the first sensor in the registry.
+  auto sensor_header = s11n::SensorHeaderSerializer::Serialize(0u, frame, 0.0, {});
+  carla::Buffer message;
+  message.reset(sensor_header.size() + body.size());
+  std::memcpy(message.data(), sensor_header.data(), sensor_header.size());
+  std::memcpy(message.data() + sensor_header.size(), body.data(), body.size());
+  return Deserializer::Deserialize(std::move(message));
+}
+
+TEST(episode_state, lookup_and_iteration) {
+  s11n::EpisodeStateDeltaEncoder encoder;
+  // Not sorted, iteration follows the order of the message.
+  std::vector<ActorDynamicState> actors{
+      MakeActor(30u, 3.0f), MakeActor(10u, 1.0f), MakeActor(20u, 2.0f)};
+  auto state = std::make_shared<EpisodeState>(MakeMessage(encoder, 1u, actors));
+  ASSERT_EQ(state->GetFrame(), 1u);
+  ASSERT_EQ(state->size(), 3u);
+  ASSERT_TRUE(state->ContainsActorSnapshot(20u));
+  ASSERT_FALSE(state->ContainsActorSnapshot(40u));
+  ASSERT_FALSE(state->GetActorSnapshotIfPresent(40u).has_value());
+  ASSERT_EQ(state->GetActorSnapshot(10u).transform.location.x, 1.0f);
+  std::vector<carla::ActorId> ids;
+  for (auto &&snapshot : *state) {
+    ids.emplace_back(snapshot.id);
+  }
+  ASSERT_EQ(ids, (std::vector<carla::ActorId>{30u, 10u, 20u}));
+  ASSERT_EQ(state->GetActorIds().size(), 3u);
+  ASSERT_EQ(*state->GetActorIds().begin(), 30u);
+
+  // Destroy one actor, spawn another and move one.
+  actors.erase(actors.begin());
+  actors.emplace_back(MakeActor(5u, 5.0f));
+  carla::geom::Transform transform = actors[0u].transform;
+  transform.location.x = 1.5f;
+  actors[0u].transform = transform;
+  auto data = MakeMessage(encoder, 2u, actors);
+  auto &delta = static_cast<const data::RawEpisodeState &>(*data);
+  ASSERT_TRUE(delta.IsDelta());
+  ASSERT_EQ(delta.GetBaseFrame(), 1u);
+  auto next = std::make_shared<EpisodeState>(*state, delta);
+  ASSERT_EQ(next->GetFrame(), 2u);
+  ASSERT_EQ(next->size(), 3u);
+  ASSERT_FALSE(next->ContainsActorSnapshot(30u));
+  ASSERT_NEAR(next->GetActorSnapshot(10u).transform.location.x, 1.5f, 1e-3f);
+  ASSERT_EQ(next->GetActorSnapshot(5u).transform.location.x, 5.0f);
+  ASSERT_EQ(next->GetActorSnapshot(20u).transform.location.x, 2.0f);
+  // The previous state is untouched.
+  ASSERT_TRUE(state->ContainsActorSnapshot(30u));
+  ASSERT_EQ(state->GetActorSnapshot(10u).transform.location.x, 1.0f);
+}
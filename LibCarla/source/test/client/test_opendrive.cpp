@@ -14,6 +14,13 @@
 #include <carla/geom/Math.h>
 #include <carla/opendrive/OpenDriveParser.h>
 #include <carla/road/MapBuilder.h>
+#include <carla/road/LaneCenterlines.h>
+#include <carla/road/LaneTracker.h>
+#include <carla/road/MapSerializer.h>
+#include <carla/road/RouteHierarchy.h>
+#include <carla/road/RoutePlanner.h>
+#include <carla/road/SpatialIndex.h>
+#include <carla/road/WaypointArrays.h>
 #include <carla/road/element/RoadInfoElevation.h>
 #include <carla/road/element/RoadInfoGeometry.h>
 #include <carla/road/element/RoadInfoMarkRecord.h>
@@ -22,7 +29,9 @@
 #include <pugixml/pugixml.hpp>
 
 #include <fstream>
+#include <limits>
 #include <string>
+#include <tuple>
 
 using namespace carla::road;
 using namespace carla::road::element;
@@ -424,3 +433,635 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+TEST(road, get_nearest_roads) {
+  constexpr size_t count = 50u;
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const auto &data = m->GetMap();
+    const SpatialIndex index(data);
+    ASSERT_GT(index.size(), 0u);
+
+    std::vector<Location> locations;
+    for (auto i = 0u; i < 1'000u; ++i) {
+      locations.emplace_back(Random::Location(-500.0f, 500.0f));
+    }
+
+    // Brute-force search over every road.
+    carla::StopWatch stop_watch;
+    std::vector<std::vector<std::pair<double, RoadId>>> expected;
+    for (const auto &location : locations) {
+      std::vector<std::pair<double, RoadId>> roads;
+      for (const auto &pair : data.GetRoads()) {
+        roads.emplace_back(pair.second.GetNearestPoint(location).second, pair.first);
+      }
+      std::sort(roads.begin(), roads.end());
+      roads.resize(std::min(count, roads.size()));
+      expected.emplace_back(std::move(roads));
+    }
+    const auto brute_force_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+    stop_watch.Restart();
+    std::vector<std::vector<SpatialIndex::NearestRoad>> results;
+    for (const auto &location : locations) {
+      results.emplace_back(index.GetNearestRoads(data, location, count));
+    }
+    const auto index_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+    for (auto i = 0u; i < locations.size(); ++i) {
+      ASSERT_EQ(results[i].size(), expected[i].size());
+      for (auto j = 0u; j < results[i].size(); ++j) {
+        ASSERT_EQ(results[i][j].distance, expected[i][j].first);
+        ASSERT_EQ(results[i][j].road_id, expected[i][j].second);
+      }
+    }
+    carla::logging::log(
+        file, "nearest roads: brute force", brute_force_time,
+        "us, spatial index", index_time, "us");
+  }
+}
+
+TEST(road, get_closest_waypoint_on_road) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+    const auto lane_type = static_cast<uint32_t>(Lane::LaneType::Driving);
+    for (auto i = 0u; i < 1'000u; ++i) {
+      const auto location = Random::Location(-500.0f, 500.0f);
+      const auto waypoint = map.GetClosestWaypointOnRoad(location, lane_type);
+      ASSERT_TRUE(waypoint.has_value());
+
+      // Nearest lane of every road, with the same tie-breaks.
+      const Location pos_inverted_y(location.x, -location.y, location.z);
+      auto expected = std::make_tuple(std::numeric_limits<double>::max(), RoadId(0u), LaneId(0));
+      for (const auto &pair : map.GetMap().GetRoads()) {
+        const auto &road = pair.second;
+        const auto nearest_point = road.GetNearestPoint(pos_inverted_y);
+        const auto lane = road.GetNearestLane(nearest_point.first, pos_inverted_y, lane_type);
+        if (lane.first != nullptr) {
+          expected = std::min(expected, std::make_tuple(lane.second, road.GetId(), lane.first->GetId()));
+        }
+      }
+      ASSERT_EQ(waypoint->road_id, std::get<1>(expected));
+      ASSERT_EQ(waypoint->lane_id, std::get<2>(expected));
+    }
+  }
+}
+
+TEST(road, get_waypoints_batch) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    std::vector<Location> locations;
+    for (auto i = 0u; i < 1'000u; ++i) {
+      locations.emplace_back(Random::Location(-500.0f, 500.0f));
+    }
+    for (auto project_to_road : {true, false}) {
+      const auto waypoints = map.GetWaypoints(locations, project_to_road);
+      ASSERT_EQ(waypoints.size(), locations.size());
+      for (auto i = 0u; i < locations.size(); ++i) {
+        const auto expected = project_to_road ?
+            map.GetClosestWaypointOnRoad(locations[i]) :
+            map.GetWaypoint(locations[i]);
+        if (expected.has_value()) {
+          ASSERT_EQ(waypoints[i], *expected);
+        } else {
+          ASSERT_EQ(waypoints[i].lane_id, 0);
+        }
+      }
+    }
+  }
+}
+
+/// GetNext as originally implemented, concatenating the results of the
+/// successors at each level, the larger first unless @a larger_first is false.
+static std::vector<Waypoint> GetNextReference(
+    const Map &map,
+    Waypoint waypoint,
+    double distance,
+    bool larger_first = true) {
+  constexpr double EPSILON = 10.0 * std::numeric_limits<double>::epsilon();
+  const auto &lane = map.GetLane(waypoint);
+  const bool forward = (waypoint.lane_id <= 0);
+  const double relative_s = waypoint.s - lane.GetDistance() + EPSILON;
+  const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s;
+  if (distance <= remaining_lane_length) {
+    waypoint.s += forward ? distance : -distance;
+    waypoint.s += forward ? -EPSILON : EPSILON;
+    return {waypoint};
+  }
+  std::vector<Waypoint> result;
+  for (const auto &successor : map.GetSuccessors(waypoint)) {
+    auto next = GetNextReference(map, successor, distance - remaining_lane_length, larger_first);
+    if (larger_first && (next.size() > result.size())) {
+      std::swap(next, result);
+    }
+    result.insert(result.end(), next.begin(), next.end());
+  }
+  return result;
+}
+
+TEST(road, get_next_order) {
+  size_t reordered = 0u;
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    for (const auto &waypoint : map.GenerateWaypoints(2.0)) {
+      for (const double distance : {5.0, 25.0, 80.0, 200.0}) {
+        const auto expected = GetNextReference(map, waypoint, distance);
+        const auto next = map.GetNext(waypoint, distance);
+        ASSERT_EQ(next, expected) << file << " road " << waypoint.road_id;
+        if (expected != GetNextReference(map, waypoint, distance, false)) {
+          ++reordered;
+        }
+      }
+    }
+  }
+  // Waypoints before several junctions, where the order matters.
+  ASSERT_GT(reordered, 0u);
+}
+
+TEST(road, waypoint_arrays) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    const auto waypoints = map.GenerateWaypoints(1.0);
+    const auto arrays = map.GenerateWaypointArrays(1.0);
+    ASSERT_EQ(arrays.size(), waypoints.size());
+    ASSERT_EQ(arrays.location.size(), waypoints.size());
+    ASSERT_EQ(arrays.rotation.size(), waypoints.size());
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      ASSERT_EQ(arrays.GetWaypoint(i), waypoints[i]);
+      const auto transform = map.ComputeTransform(waypoints[i]);
+      ASSERT_EQ(arrays.location[i], transform.location);
+      ASSERT_EQ(arrays.rotation[i], transform.rotation);
+    }
+    for (auto i = 0u; i < waypoints.size(); i += 10u) {
+      const auto expected = map.GetNext(waypoints[i], 3.0);
+      WaypointArrays next;
+      map.GetNext(waypoints[i], 3.0, next);
+      ASSERT_EQ(next.size(), expected.size());
+      for (auto j = 0u; j < expected.size(); ++j) {
+        ASSERT_EQ(next.GetWaypoint(j), expected[j]);
+        ASSERT_EQ(next.GetTransform(j).location, map.ComputeTransform(expected[j]).location);
+      }
+    }
+  }
+}
+
+TEST(road, lane_centerlines) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    const LaneCenterlines centerlines(map, 0.5);
+    ASSERT_GT(centerlines.GetNumberOfSamples(), 0u);
+    ASSERT_LT(centerlines.GetMaxLocationError(), 0.05f);
+    ASSERT_LT(centerlines.GetMaxRotationError(), 1.0f);
+    // The error is measured halfway between samples, leave some margin for
+    // the rest.
+    const float location_tolerance = 2.0f * centerlines.GetMaxLocationError() + 1e-3f;
+    const float rotation_tolerance = 2.0f * centerlines.GetMaxRotationError() + 1e-2f;
+    for (const auto &waypoint : map.GenerateWaypoints(0.7)) {
+      const auto transform = centerlines.ComputeTransform(waypoint);
+      ASSERT_TRUE(transform.has_value());
+      const auto expected = map.ComputeTransform(waypoint);
+      ASSERT_LE(transform->location.Distance(expected.location), location_tolerance);
+      ASSERT_LE(std::abs(std::remainder(transform->rotation.yaw - expected.rotation.yaw, 360.0f)), rotation_tolerance);
+      ASSERT_LE(std::abs(std::remainder(transform->rotation.pitch - expected.rotation.pitch, 360.0f)), rotation_tolerance);
+    }
+    ASSERT_FALSE(centerlines.ComputeTransform(Waypoint{}).has_value());
+  }
+}
+
+TEST(road, lane_tracker) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    constexpr auto lane_type = static_cast<uint32_t>(Lane::LaneType::Driving);
+    size_t local_hits = 0u;
+    size_t global_searches = 0u;
+    size_t updates = 0u;
+    carla::StopWatch stop_watch;
+    // Drive along the lanes, a few centimetres off the center, and check the
+    // tracker agrees with the map-wide search outside junctions.
+    const auto waypoints = map.GenerateWaypoints(50.0);
+    for (auto i = 0u; i < waypoints.size(); i += 10u) {
+      LaneTracker tracker;
+      auto waypoint = waypoints[i];
+      for (auto step = 0u; step < 100u; ++step) {
+        auto location = map.ComputeTransform(waypoint).location;
+        location.x += static_cast<float>(Random::Uniform(-0.2, 0.2));
+        location.y += static_cast<float>(Random::Uniform(-0.2, 0.2));
+        const auto expected = LaneTracker::Locate(map, location, lane_type);
+        const auto position = tracker.Update(map, location, lane_type);
+        ++updates;
+        ASSERT_EQ(position.has_value(), expected.has_value());
+        if (expected.has_value() &&
+            !map.IsJunction(expected->waypoint.road_id) &&
+            !map.IsJunction(position->waypoint.road_id)) {
+          ASSERT_EQ(position->waypoint, expected->waypoint);
+          ASSERT_EQ(position->is_offroad, expected->is_offroad);
+        }
+        const auto next = map.GetNext(waypoint, 1.0);
+        if (next.empty()) {
+          break;
+        }
+        waypoint = next[0u];
+      }
+      local_hits += tracker.GetLocalHits();
+      global_searches += tracker.GetGlobalSearches();
+    }
+    ASSERT_EQ(local_hits + global_searches, updates);
+    carla::logging::log(
+        file, "lane tracker:", updates, "updates,", local_hits, "local,",
+        global_searches, "global, done in", stop_watch.GetElapsedTime(), "ms");
+  }
+}
+
+/// Two straight roads one after the other along the x axis, the first one
+/// with two lane sections. The right lanes have different markings at each
+/// section, and a shoulder at the edge.
+static const std::string LANE_SECTIONS_XODR = R"(<?xml version="1.0" standalone="yes"?>
+<OpenDRIVE>
+  <header revMajor="1" revMinor="4" name="" version="1" north="0" south="0" east="0" west="0"/>
+  <road name="" length="100.0" id="1" junction="-1">
+    <link><successor elementType="road" elementId="2" contactPoint="start"/></link>
+    <planView><geometry s="0.0" x="0.0" y="0.0" hdg="0.0" length="100.0"><line/></geometry></planView>
+    <elevationProfile><elevation s="0" a="0" b="0" c="0" d="0"/></elevationProfile>
+    <lateralProfile/>
+    <lanes>
+      <laneOffset s="0.0" a="0.0" b="0.0" c="0.0" d="0.0"/>
+      <laneSection s="0.0">
+        <center>
+          <lane id="0" type="none" level="false">
+            <roadMark sOffset="0.0" type="botts dots" weight="standard" color="standard" width="0.15"/>
+          </lane>
+        </center>
+        <right>
+          <lane id="-1" type="driving" level="false">
+            <link><predecessor id="-1"/><successor id="-1"/></link>
+            <width sOffset="0.0" a="3.5" b="0.0" c="0.0" d="0.0"/>
+            <roadMark sOffset="0.0" type="broken" weight="standard" color="standard" width="0.15"/>
+          </lane>
+          <lane id="-2" type="driving" level="false">
+            <link><predecessor id="-2"/><successor id="-2"/></link>
+            <width sOffset="0.0" a="3.5" b="0.0" c="0.0" d="0.0"/>
+            <roadMark sOffset="0.0" type="solid" weight="standard" color="standard" width="0.15"/>
+          </lane>
+          <lane id="-3" type="shoulder" level="false">
+            <link><predecessor id="-3"/><successor id="-3"/></link>
+            <width sOffset="0.0" a="2.0" b="0.0" c="0.0" d="0.0"/>
+            <roadMark sOffset="0.0" type="none" weight="standard" color="standard" width="0.15"/>
+          </lane>
+        </right>
+      </laneSection>
+      <laneSection s="50.0">
+        <center>
+          <lane id="0" type="none" level="false">
+            <roadMark sOffset="0.0" type="botts dots" weight="standard" color="standard" width="0.15"/>
+          </lane>
+        </center>
+        <right>
+          <lane id="-1" type="driving" level="false">
+            <link><predecessor id="-1"/><successor id="-1"/></link>
+            <width sOffset="0.0" a="3.5" b="0.0" c="0.0" d="0.0"/>
+            <roadMark sOffset="0.0" type="solid" weight="standard" color="standard" width="0.15"/>
+          </lane>
+          <lane id="-2" type="driving" level="false">
+            <link><predecessor id="-2"/><successor id="-2"/></link>
+            <width sOffset="0.0" a="3.5" b="0.0" c="0.0" d="0.0"/>
+            <roadMark sOffset="0.0" type="solid" weight="standard" color="standard" width="0.15"/>
+          </lane>
+          <lane id="-3" type="shoulder" level="false">
+            <link><predecessor id="-3"/><successor id="-3"/></link>
+            <width sOffset="0.0" a="2.0" b="0.0" c="0.0" d="0.0"/>
+            <roadMark sOffset="0.0" type="none" weight="standard" color="standard" width="0.15"/>
+          </lane>
+        </right>
+      </laneSection>
+    </lanes>
+  </road>
+  <road name="" length="100.0" id="2" junction="-1">
+    <link><predecessor elementType="road" elementId="1" contactPoint="end"/></link>
+    <planView><geometry s="0.0" x="100.0" y="0.0" hdg="0.0" length="100.0"><line/></geometry></planView>
+    <elevationProfile><elevation s="0" a="0" b="0" c="0" d="0"/></elevationProfile>
+    <lateralProfile/>
+    <lanes>
+      <laneOffset s="0.0" a="0.0" b="0.0" c="0.0" d="0.0"/>
+      <laneSection s="0.0">
+        <center>
+          <lane id="0" type="none" level="false">
+            <roadMark sOffset="0.0" type="botts dots" weight="standard" color="standard" width="0.15"/>
+          </lane>
+        </center>
+        <right>
+          <lane id="-1" type="driving" level="false">
+            <link><predecessor id="-1"/><successor id="-1"/></link>
+            <width sOffset="0.0" a="3.5" b="0.0" c="0.0" d="0.0"/>
+            <roadMark sOffset="0.0" type="solid solid" weight="standard" color="standard" width="0.15"/>
+          </lane>
+          <lane id="-2" type="driving" level="false">
+            <link><predecessor id="-2"/><successor id="-2"/></link>
+            <width sOffset="0.0" a="3.5" b="0.0" c="0.0" d="0.0"/>
+            <roadMark sOffset="0.0" type="solid" weight="standard" color="standard" width="0.15"/>
+          </lane>
+          <lane id="-3" type="shoulder" level="false">
+            <link><predecessor id="-3"/><successor id="-3"/></link>
+            <width sOffset="0.0" a="2.0" b="0.0" c="0.0" d="0.0"/>
+            <roadMark sOffset="0.0" type="none" weight="standard" color="standard" width="0.15"/>
+          </lane>
+        </right>
+      </laneSection>
+    </lanes>
+  </road>
+</OpenDRIVE>
+)";
+
+TEST(road, lane_crossing_at_boundaries) {
+  auto m = OpenDriveParser::Load(LANE_SECTIONS_XODR);
+  ASSERT_TRUE(m.has_value());
+  auto &map = *m;
+  constexpr auto lane_type = static_cast<uint32_t>(Lane::LaneType::Driving);
+  // Centers of the lanes, with Unreal's Y axis.
+  constexpr float lane_1 = 1.75f;
+  constexpr float lane_2 = 5.25f;
+  constexpr float shoulder = 8.0f;
+  auto check = [&](const Location &origin, const Location &destination, const std::vector<LaneMarking::Type> &expected) {
+    const auto crossed = map.CalculateCrossedLanes(origin, destination);
+    LaneTracker tracker;
+    tracker.Update(map, origin, lane_type);
+    const auto tracked = map.CalculateCrossedLanes(tracker, destination);
+    ASSERT_EQ(crossed.size(), expected.size());
+    ASSERT_EQ(tracked.size(), expected.size());
+    for (auto i = 0u; i < expected.size(); ++i) {
+      ASSERT_EQ(crossed[i].type, expected[i]);
+      ASSERT_EQ(tracked[i].type, expected[i]);
+    }
+  };
+  // Within a section, the lane marking of the section.
+  check(Location(20.0f, lane_1, 0.0f), Location(22.0f, lane_2, 0.0f), {LaneMarking::Type::Broken});
+  check(Location(70.0f, lane_1, 0.0f), Location(72.0f, lane_2, 0.0f), {LaneMarking::Type::Solid});
+  // Across the boundary between the sections, the one of the destination.
+  check(Location(49.0f, lane_1, 0.0f), Location(51.0f, lane_2, 0.0f), {LaneMarking::Type::Solid});
+  check(Location(51.0f, lane_1, 0.0f), Location(49.0f, lane_2, 0.0f), {LaneMarking::Type::Broken});
+  check(Location(49.0f, lane_1, 0.0f), Location(51.0f, lane_1, 0.0f), {});
+  // Across the boundary between the roads.
+  check(Location(99.0f, lane_1, 0.0f), Location(101.0f, lane_2, 0.0f), {LaneMarking::Type::SolidSolid});
+  check(Location(101.0f, lane_1, 0.0f), Location(99.0f, lane_2, 0.0f), {LaneMarking::Type::Solid});
+  check(Location(99.0f, lane_1, 0.0f), Location(101.0f, lane_1, 0.0f), {});
+
+  // On the shoulder the location is off-road, but still within the road
+  // tracked.
+  LaneTracker tracker;
+  ASSERT_TRUE(tracker.Update(map, Location(30.0f, lane_2, 0.0f), lane_type).has_value());
+  const auto location = Location(31.0f, shoulder, 0.0f);
+  const auto position = tracker.Update(map, location, lane_type);
+  const auto expected = LaneTracker::Locate(map, location, lane_type);
+  ASSERT_TRUE(position.has_value());
+  ASSERT_TRUE(expected.has_value());
+  ASSERT_TRUE(position->is_offroad);
+  ASSERT_EQ(position->waypoint, expected->waypoint);
+  ASSERT_EQ(position->is_offroad, expected->is_offroad);
+  ASSERT_EQ(tracker.GetLocalHits(), 1u);
+  ASSERT_EQ(tracker.GetGlobalSearches(), 1u);
+  // Past the shoulder it is not.
+  ASSERT_TRUE(tracker.Update(map, Location(32.0f, shoulder + 5.0f, 0.0f), lane_type).has_value());
+  ASSERT_EQ(tracker.GetLocalHits(), 1u);
+  ASSERT_EQ(tracker.GetGlobalSearches(), 2u);
+}
+
+TEST(road, route_planner) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+    carla::StopWatch build_timer;
+    const RoutePlanner planner(map);
+    build_timer.Stop();
+    ASSERT_GT(planner.GetNumberOfLanes(), 0u);
+
+    const auto waypoints = map.GenerateWaypoints(10.0);
+    ASSERT_FALSE(waypoints.empty());
+    auto random_waypoint = [&]() {
+      const auto index = static_cast<size_t>(Random::Uniform(0.0, static_cast<double>(waypoints.size())));
+      return waypoints[std::min(index, waypoints.size() - 1u)];
+    };
+    size_t found = 0u;
+    size_t lane_changes = 0u;
+    double astar_time = 0.0;
+    double bidirectional_time = 0.0;
+    for (auto i = 0u; i < 200u; ++i) {
+      const auto origin = random_waypoint();
+      const auto destination = random_waypoint();
+      carla::StopWatch astar_timer;
+      const auto route = planner.ComputeRoute(map, origin, destination, RoutePlanner::Algorithm::AStar);
+      astar_time += astar_timer.GetElapsedTime<std::chrono::microseconds>();
+      carla::StopWatch bidirectional_timer;
+      const auto other = planner.ComputeRoute(map, origin, destination, RoutePlanner::Algorithm::BidirectionalDijkstra);
+      bidirectional_time += bidirectional_timer.GetElapsedTime<std::chrono::microseconds>();
+
+      // Both algorithms find a shortest route.
+      ASSERT_EQ(route.has_value(), other.has_value());
+      if (!route.has_value()) {
+        continue;
+      }
+      ++found;
+      ASSERT_NEAR(route->cost, other->cost, 1e-6 * std::max(1.0, route->cost));
+
+      // The route starts at the origin, ends at the destination, and every
+      // lane is reached from the previous one.
+      const auto &segments = route->segments;
+      ASSERT_FALSE(segments.empty());
+      ASSERT_NEAR(segments.front().waypoint.s, origin.s, 1e-6);
+      ASSERT_EQ(segments.front().waypoint.lane_id, origin.lane_id);
+      ASSERT_NEAR(segments.back().end_s, destination.s, 1e-6);
+      ASSERT_EQ(segments.back().waypoint.road_id, destination.road_id);
+      ASSERT_EQ(segments.back().waypoint.lane_id, destination.lane_id);
+      double length = 0.0;
+      for (auto j = 1u; j < segments.size(); ++j) {
+        const auto &previous = segments[j - 1u].waypoint;
+        const auto &current = segments[j].waypoint;
+        switch (segments[j].maneuver) {
+          case RoutePlanner::Maneuver::LaneFollow: {
+            const auto successors = map.GetSuccessors(previous);
+            ASSERT_TRUE(std::any_of(successors.begin(), successors.end(), [&](const Waypoint &successor) {
+              return (successor.road_id == current.road_id) &&
+                     (successor.section_id == current.section_id) &&
+                     (successor.lane_id == current.lane_id);
+            }));
+            break;
+          }
+          case RoutePlanner::Maneuver::ChangeLaneLeft:
+            ASSERT_EQ(map.GetLeft(previous)->lane_id, current.lane_id);
+            ++lane_changes;
+            break;
+          case RoutePlanner::Maneuver::ChangeLaneRight:
+            ASSERT_EQ(map.GetRight(previous)->lane_id, current.lane_id);
+            ++lane_changes;
+            break;
+        }
+        length += segments[j - 1u].length;
+      }
+      length += segments.back().length;
+      ASSERT_LE(length, route->cost + 1e-6);
+
+      const auto samples = RoutePlanner::SampleRoute(*route, 2.0);
+      ASSERT_FALSE(samples.empty());
+      for (auto &&sample : samples) {
+        map.ComputeTransform(sample.first);
+      }
+    }
+    carla::logging::log(
+        file, "route planner:", planner.GetNumberOfLanes(), "lanes,",
+        planner.GetNumberOfConnections(), "connections, built in", build_timer.GetElapsedTime(), "ms,",
+        found, "routes,", lane_changes, "lane changes, A*", astar_time / 200.0, "us/query, bidirectional",
+        bidirectional_time / 200.0, "us/query");
+  }
+}
+
+TEST(road, route_hierarchy) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    const auto hash = MapSerializer::ComputeHash(opendrive);
+    auto m = OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+    const RoutePlanner planner(map);
+
+    carla::StopWatch build_timer;
+    const RouteHierarchy hierarchy(planner);
+    build_timer.Stop();
+
+    const auto buffer = hierarchy.Serialize(hash);
+    const auto l = RouteHierarchy::Deserialize(planner, buffer.data(), buffer.size(), hash);
+    ASSERT_TRUE(l.has_value());
+    ASSERT_EQ(l->GetNumberOfShortcuts(), hierarchy.GetNumberOfShortcuts());
+
+    const auto waypoints = map.GenerateWaypoints(10.0);
+    ASSERT_FALSE(waypoints.empty());
+    auto random_waypoint = [&]() {
+      const auto index = static_cast<size_t>(Random::Uniform(0.0, static_cast<double>(waypoints.size())));
+      return waypoints[std::min(index, waypoints.size() - 1u)];
+    };
+    std::vector<std::pair<Waypoint, Waypoint>> queries;
+    for (auto i = 0u; i < 200u; ++i) {
+      queries.emplace_back(random_waypoint(), random_waypoint());
+    }
+    const auto expected = planner.ComputeRoutes(map, queries, RoutePlanner::Algorithm::BidirectionalDijkstra);
+    ASSERT_EQ(expected.size(), queries.size());
+
+    // The batch gives the same routes as the queries one by one.
+    for (auto i = 0u; i < 20u; ++i) {
+      const auto route = planner.ComputeRoute(map, queries[i].first, queries[i].second, RoutePlanner::Algorithm::AStar);
+      ASSERT_EQ(route.has_value(), expected[i].has_value());
+      if (route.has_value()) {
+        ASSERT_NEAR(route->cost, expected[i]->cost, 1e-6 * std::max(1.0, route->cost));
+      }
+    }
+
+    // Same costs as the plain search, and the shortcuts expand to lanes
+    // connected to each other.
+    for (const auto *item : {&hierarchy, &*l}) {
+      const auto routes = planner.ComputeRoutes(map, queries, RoutePlanner::Algorithm::ContractionHierarchy, item);
+      ASSERT_EQ(routes.size(), queries.size());
+      for (auto i = 0u; i < routes.size(); ++i) {
+        ASSERT_EQ(routes[i].has_value(), expected[i].has_value());
+        if (!routes[i].has_value()) {
+          continue;
+        }
+        ASSERT_NEAR(routes[i]->cost, expected[i]->cost, 1e-6 * std::max(1.0, expected[i]->cost));
+        const auto &segments = routes[i]->segments;
+        ASSERT_FALSE(segments.empty());
+        ASSERT_NEAR(segments.front().waypoint.s, queries[i].first.s, 1e-6);
+        ASSERT_EQ(segments.front().waypoint.lane_id, queries[i].first.lane_id);
+        ASSERT_NEAR(segments.back().end_s, queries[i].second.s, 1e-6);
+        ASSERT_EQ(segments.back().waypoint.lane_id, queries[i].second.lane_id);
+        for (auto j = 1u; j < segments.size(); ++j) {
+          const auto &previous = segments[j - 1u].waypoint;
+          const auto &current = segments[j].waypoint;
+          if (segments[j].maneuver == RoutePlanner::Maneuver::LaneFollow) {
+            const auto successors = map.GetSuccessors(previous);
+            ASSERT_TRUE(std::any_of(successors.begin(), successors.end(), [&](const Waypoint &successor) {
+              return (successor.road_id == current.road_id) &&
+                     (successor.section_id == current.section_id) &&
+                     (successor.lane_id == current.lane_id);
+            }));
+          } else {
+            ASSERT_EQ(previous.road_id, current.road_id);
+            ASSERT_EQ(previous.section_id, current.section_id);
+          }
+        }
+      }
+    }
+
+    // Reject data generated from another source, truncated, or corrupted.
+    ASSERT_FALSE(RouteHierarchy::Deserialize(planner, buffer.data(), buffer.size(), hash + 1u).has_value());
+    ASSERT_FALSE(RouteHierarchy::Deserialize(planner, buffer.data(), buffer.size() / 2u, hash).has_value());
+    auto corrupted = buffer;
+    corrupted[corrupted.size() / 2u] ^= 0xFF;
+    ASSERT_FALSE(RouteHierarchy::Deserialize(planner, corrupted.data(), corrupted.size(), hash).has_value());
+
+    carla::logging::log(
+        file, "route hierarchy:", hierarchy.GetNumberOfShortcuts(), "shortcuts, built in",
+        build_timer.GetElapsedTime(), "ms, serialized", buffer.size(), "bytes");
+  }
+}
+
+TEST(road, map_serializer) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    const auto hash = MapSerializer::ComputeHash(opendrive);
+
+    carla::StopWatch parse_timer;
+    auto m = OpenDriveParser::Load(opendrive);
+    parse_timer.Stop();
+    ASSERT_TRUE(m.has_value());
+    const auto &map = *m;
+
+    const auto buffer = MapSerializer::Serialize(map, hash);
+
+    carla::StopWatch load_timer;
+    auto l = MapSerializer::Deserialize(buffer.data(), buffer.size(), hash);
+    load_timer.Stop();
+    ASSERT_TRUE(l.has_value());
+    const auto &loaded = *l;
+
+    ASSERT_EQ(loaded.GetMap().GetRoadCount(), map.GetMap().GetRoadCount());
+    ASSERT_EQ(loaded.GetGeoReference(), map.GetGeoReference());
+
+    // Same waypoints, transforms and topology.
+    for (const auto &waypoint : map.GenerateWaypoints(5.0)) {
+      ASSERT_EQ(loaded.ComputeTransform(waypoint), map.ComputeTransform(waypoint));
+      ASSERT_EQ(loaded.GetLaneWidth(waypoint), map.GetLaneWidth(waypoint));
+      ASSERT_EQ(loaded.GetSuccessors(waypoint), map.GetSuccessors(waypoint));
+      ASSERT_EQ(loaded.GetPredecessors(waypoint), map.GetPredecessors(waypoint));
+    }
+    // Junction roads overlap, the results must not depend on the order of the
+    // roads in the map.
+    for (auto i = 0u; i < 10'000u; ++i) {
+      const auto location = Random::Location(-500.0f, 500.0f);
+      ASSERT_TRUE(loaded.GetClosestWaypointOnRoad(location) == map.GetClosestWaypointOnRoad(location));
+      ASSERT_TRUE(loaded.GetWaypoint(location) == map.GetWaypoint(location));
+    }
+
+    // Reject data generated from another source, truncated, or corrupted.
+    ASSERT_FALSE(MapSerializer::Deserialize(buffer.data(), buffer.size(), hash + 1u).has_value());
+    ASSERT_FALSE(MapSerializer::Deserialize(buffer.data(), buffer.size() / 2u, hash).has_value());
+    auto corrupted = buffer;
+    corrupted[corrupted.size() / 2u] ^= 0xFF;
+    ASSERT_FALSE(MapSerializer::Deserialize(corrupted.data(), corrupted.size(), hash).has_value());
+
+    carla::logging::log(
+        file,
+        "serialized map:", buffer.size(), "bytes,",
+        "parse", parse_timer.GetElapsedTime<std::chrono::microseconds>(), "us,",
+        "deserialize", load_timer.GetElapsedTime<std::chrono::microseconds>(), "us");
+  }
+}
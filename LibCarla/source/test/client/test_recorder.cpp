@@ -0,0 +1,376 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/recorder/ForEachRange.h>
+#include <carla/recorder/Queries.h>
+#include <carla/recorder/Recording.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+using namespace carla::recorder;
+
+namespace fs = boost::filesystem;
+
+// =============================================================================
+// -- Writing recordings with the layout of the simulator ----------------------
+// =============================================================================
+
+namespace {
+
+  class Bytes {
+  public:
+
+    template <typename T>
+    Bytes &Write(const T &value) {
+      data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+      return *this;
+    }
+
+    Bytes &WriteString(const std::string &str) {
+      Write(static_cast<uint16_t>(str.size()));
+      data.append(str);
+      return *this;
+    }
+
+    /// Locations in meters, written in centimeters.
+    Bytes &WriteTransform(float x, float y, float z, float pitch, float yaw, float roll) {
+      Write(100.0f * x).Write(100.0f * y).Write(100.0f * z);
+      return Write(roll).Write(pitch).Write(yaw);
+    }
+
+    Bytes &WritePacket(PacketId id, const Bytes &packet) {
+      Write(static_cast<uint8_t>(id));
+      Write(static_cast<uint32_t>(packet.data.size()));
+      data.append(packet.data);
+      return *this;
+    }
+
+    std::string data;
+  };
+
+  struct TestActor {
+    uint32_t id;
+    ActorType type;
+    std::string type_id;
+  };
+
+  struct TestFrame {
+    std::vector<TestActor> added;
+    std::vector<uint32_t> removed;
+    std::vector<Collision> collisions;
+    std::vector<std::pair<uint32_t, float>> positions;
+    bool keyframe = false;
+  };
+
+  /// 200 frames of one second: actor 1 (vehicle) drives along x except while
+  /// stopped in frames [100, 150), actor 2 (walker) never moves, actor 3 (a
+  /// hero vehicle) leaves in frame 5. Actors 1 and 2 collide in frames [10,
+  /// 13) and 50, actors 1 and 3 in frame 4.
+  static std::vector<TestFrame> MakeFrames() {
+    std::vector<TestFrame> frames(200u);
+    frames[0u].keyframe = true;
+    frames[0u].added = {
+      {1u, ActorType::Vehicle, "vehicle.test.car"},
+      {2u, ActorType::Walker, "walker.test.pedestrian"},
+      {3u, ActorType::Vehicle, "vehicle.test.hero"}};
+    frames[5u].removed = {3u};
+    frames[100u].keyframe = true;
+    for (auto i = 10u; i < 13u; ++i) {
+      frames[i].collisions.push_back(Collision{0u, 1u, 2u, false, false});
+    }
+    frames[50u].collisions.push_back(Collision{1u, 1u, 2u, false, false});
+    frames[4u].collisions.push_back(Collision{2u, 1u, 3u, false, true});
+    for (auto i = 0u; i < frames.size(); ++i) {
+      const float x = ((i >= 100u) && (i < 150u)) ? 200.0f : 2.0f * static_cast<float>(i);
+      frames[i].positions = {{1u, x}, {2u, 10.0f}};
+    }
+    return frames;
+  }
+
+  static std::string MakeRecording(
+      const std::vector<TestFrame> &frames,
+      const bool compress,
+      const bool with_index) {
+    Bytes file;
+    file.Write(uint16_t(1u)).WriteString("CARLA_RECORDER").Write(int64_t(1234)).WriteString("Town01");
+
+    Bytes index;
+    index.Write(static_cast<uint32_t>(frames.size()));
+    uint32_t keyframes = 0u;
+    for (auto i = 0u; i < frames.size(); ++i) {
+      const auto &frame = frames[i];
+      if (frame.keyframe) {
+        file.WritePacket(PacketId::Keyframe, Bytes{}.Write(uint32_t(0u)));
+        ++keyframes;
+      }
+      index.Write(uint64_t(i)).Write(static_cast<double>(i)).Write(static_cast<uint64_t>(file.data.size()));
+
+      Bytes packets;
+      packets.WritePacket(PacketId::FrameStart, Bytes{}.Write(uint64_t(i)).Write(1.0).Write(static_cast<double>(i)));
+      Bytes added;
+      added.Write(static_cast<uint16_t>(frame.added.size()));
+      for (auto &actor : frame.added) {
+        added.Write(actor.id).Write(static_cast<uint8_t>(actor.type));
+        added.WriteTransform(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+        added.Write(uint32_t(7u)).WriteString(actor.type_id);
+        added.Write(uint16_t(1u)).Write(uint8_t(0u)).WriteString("role_name").WriteString("test");
+      }
+      packets.WritePacket(PacketId::EventAdd, added);
+      Bytes removed;
+      removed.Write(static_cast<uint16_t>(frame.removed.size()));
+      for (auto id : frame.removed) {
+        removed.Write(id);
+      }
+      packets.WritePacket(PacketId::EventDel, removed);
+      packets.WritePacket(PacketId::EventParent, Bytes{}.Write(uint16_t(0u)));
+      Bytes collisions;
+      collisions.Write(static_cast<uint16_t>(frame.collisions.size()));
+      for (auto &collision : frame.collisions) {
+        collisions.Write(collision.id).Write(collision.actor1).Write(collision.actor2);
+        collisions.Write(collision.is_actor1_hero).Write(collision.is_actor2_hero);
+      }
+      packets.WritePacket(PacketId::Collision, collisions);
+      Bytes positions;
+      positions.Write(static_cast<uint16_t>(frame.positions.size()));
+      for (auto &position : frame.positions) {
+        positions.Write(position.first).WriteTransform(position.second, 10.0f, 0.5f, 1.0f, 2.0f, 3.0f);
+      }
+      packets.WritePacket(PacketId::Position, positions);
+      packets.WritePacket(PacketId::State, Bytes{}.Write(uint16_t(0u)));
+      packets.WritePacket(PacketId::FrameEnd, Bytes{});
+
+      if (compress) {
+        std::string compressed(compressBound(static_cast<uLong>(packets.data.size())), '\0');
+        uLongf size = static_cast<uLongf>(compressed.size());
+        EXPECT_EQ(Z_OK, compress2(
+            reinterpret_cast<Bytef *>(&compressed[0u]), &size,
+            reinterpret_cast<const Bytef *>(packets.data.data()),
+            static_cast<uLong>(packets.data.size()),
+            Z_BEST_SPEED));
+        compressed.resize(size);
+        Bytes block;
+        block.Write(uint8_t(1u)).Write(static_cast<uint32_t>(packets.data.size()));
+        block.data.append(compressed);
+        file.WritePacket(PacketId::Block, block);
+      } else {
+        file.data.append(packets.data);
+      }
+    }
+    if (with_index) {
+      index.Write(keyframes);
+      for (auto i = 0u; i < keyframes; ++i) {
+        index.Write(uint64_t(0u)).Write(uint64_t(0u));
+      }
+      const auto index_offset = static_cast<uint64_t>(file.data.size());
+      const auto recording_size = index_offset + 5u + index.data.size() + 24u;
+      index.Write(index_offset).Write(static_cast<uint64_t>(recording_size));
+      index.data.append("CRINDEX1", 8u);
+      file.WritePacket(PacketId::FrameIndex, index);
+    }
+    return file.data;
+  }
+
+  /// Recording written to a temporary file, removed on destruction.
+  class TemporaryRecording {
+  public:
+
+    explicit TemporaryRecording(const std::string &data)
+      : path(fs::temp_directory_path() / fs::unique_path("carla-test-%%%%-%%%%.log")) {
+      std::ofstream file(path.string(), std::ios::binary);
+      file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    ~TemporaryRecording() {
+      fs::remove(path);
+    }
+
+    const fs::path path;
+  };
+
+} // namespace
+
+// =============================================================================
+// -- Tests --------------------------------------------------------------------
+// =============================================================================
+
+static void CheckQueries(const Recording &recording, size_t worker_threads) {
+  ASSERT_EQ(recording.GetNumberOfFrames(), 200u);
+  ASSERT_EQ(recording.GetNumberOfKeyframes(), 2u);
+  ASSERT_DOUBLE_EQ(recording.GetDuration(), 199.0);
+
+  const auto summary = Queries::Summary(recording, worker_threads);
+  ASSERT_EQ(summary.info.map, "Town01");
+  ASSERT_EQ(summary.info.date, 1234);
+  ASSERT_EQ(summary.frames, 200u);
+  ASSERT_DOUBLE_EQ(summary.duration, 199.0);
+  ASSERT_EQ(summary.count[static_cast<size_t>(PacketId::FrameStart)], 200u);
+  ASSERT_EQ(summary.count[static_cast<size_t>(PacketId::EventAdd)], 3u);
+  ASSERT_EQ(summary.count[static_cast<size_t>(PacketId::EventDel)], 1u);
+  ASSERT_EQ(summary.count[static_cast<size_t>(PacketId::Collision)], 5u);
+  ASSERT_EQ(summary.count[static_cast<size_t>(PacketId::Position)], 400u);
+  ASSERT_EQ(summary.count[static_cast<size_t>(PacketId::Keyframe)], 2u);
+
+  const auto collisions = Queries::Collisions(recording, 'a', 'a', worker_threads);
+  ASSERT_EQ(collisions.size(), 3u);
+  ASSERT_EQ(collisions[0u].frame, 4u);
+  ASSERT_EQ(collisions[0u].type_id2, "vehicle.test.hero");
+  ASSERT_EQ(collisions[1u].frame, 10u);
+  ASSERT_DOUBLE_EQ(collisions[1u].time, 10.0);
+  ASSERT_EQ(collisions[1u].category1, 'v');
+  ASSERT_EQ(collisions[1u].category2, 'w');
+  ASSERT_EQ(collisions[1u].type_id1, "vehicle.test.car");
+  ASSERT_EQ(collisions[1u].type_id2, "walker.test.pedestrian");
+  ASSERT_EQ(collisions[2u].frame, 50u);
+
+  const auto with_hero = Queries::Collisions(recording, 'v', 'h', worker_threads);
+  ASSERT_EQ(with_hero.size(), 1u);
+  ASSERT_EQ(with_hero[0u].actor2, 3u);
+  ASSERT_EQ(Queries::Collisions(recording, 'w', 'a', worker_threads).size(), 0u);
+
+  const auto blocked = Queries::BlockedActors(recording, 30.0, 1.0, worker_threads);
+  ASSERT_EQ(blocked.size(), 2u);
+  ASSERT_EQ(blocked[0u].actor_id, 2u);
+  ASSERT_EQ(blocked[0u].type_id, "walker.test.pedestrian");
+  ASSERT_DOUBLE_EQ(blocked[0u].time, 1.0);
+  ASSERT_DOUBLE_EQ(blocked[0u].duration, 199.0);
+  ASSERT_EQ(blocked[1u].actor_id, 1u);
+  ASSERT_DOUBLE_EQ(blocked[1u].time, 101.0);
+  ASSERT_DOUBLE_EQ(blocked[1u].duration, 49.0);
+  ASSERT_EQ(Queries::BlockedActors(recording, 60.0, 1.0, worker_threads).size(), 1u);
+}
+
+TEST(recorder, read_frames) {
+  const TemporaryRecording file(MakeRecording(MakeFrames(), false, false));
+  const Recording recording(file.path.string());
+  ASSERT_EQ(recording.GetInfo().version, 1u);
+  ASSERT_FALSE(recording.HasIndex());
+  const auto range = recording.ReadFrames(0u, 3u);
+  ASSERT_EQ(range.frames.size(), 3u);
+  ASSERT_EQ(range.actors_added.GetFrame(0u).size(), 3u);
+  ASSERT_EQ(range.actors_added.GetFrame(1u).size(), 0u);
+  const auto &added = range.actors_added.records[2u];
+  ASSERT_EQ(added.database_id, 3u);
+  ASSERT_EQ(added.description.uid, 7u);
+  ASSERT_EQ(added.description.attributes.size(), 1u);
+  ASSERT_EQ(added.description.attributes[0u].id, "role_name");
+  ASSERT_EQ(added.description.attributes[0u].value, "test");
+  const auto positions = range.positions.GetFrame(1u);
+  ASSERT_EQ(positions.size(), 2u);
+  const auto &transform = positions.begin()->transform;
+  ASSERT_FLOAT_EQ(transform.location.x, 2.0f);
+  ASSERT_FLOAT_EQ(transform.location.y, 10.0f);
+  ASSERT_FLOAT_EQ(transform.location.z, 0.5f);
+  ASSERT_FLOAT_EQ(transform.rotation.pitch, 1.0f);
+  ASSERT_FLOAT_EQ(transform.rotation.yaw, 2.0f);
+  ASSERT_FLOAT_EQ(transform.rotation.roll, 3.0f);
+
+  // Skipped packets are counted but not read.
+  const auto only_collisions = recording.ReadFrames(10u, 20u, PacketMask(PacketId::Collision));
+  ASSERT_EQ(only_collisions.first, 10u);
+  ASSERT_EQ(only_collisions.frames.front().id, 10u);
+  ASSERT_EQ(only_collisions.collisions.records.size(), 3u);
+  ASSERT_EQ(only_collisions.positions.records.size(), 0u);
+  ASSERT_EQ(only_collisions.count[static_cast<size_t>(PacketId::Position)], 20u);
+  ASSERT_EQ(only_collisions.positions.GetFrame(9u).size(), 0u);
+
+  ASSERT_THROW(recording.ReadFrames(0u, 201u), std::out_of_range);
+}
+
+TEST(recorder, for_each_range) {
+  const TemporaryRecording file(MakeRecording(MakeFrames(), false, false));
+  const Recording recording(file.path.string());
+  for (auto worker_threads : {1u, 2u, 3u, 8u, 100u}) {
+    // The ranges are passed in order while the next ones are being read.
+    size_t next_frame = 0u;
+    size_t collisions = 0u;
+    ForEachRange(recording, 7u, PacketMask(PacketId::Collision), worker_threads, [&](FrameRange range) {
+      ASSERT_EQ(range.first, next_frame);
+      ASSERT_EQ(range.frames.size(), std::min<size_t>(7u, 200u - next_frame));
+      next_frame += range.frames.size();
+      collisions += range.collisions.records.size();
+    });
+    ASSERT_EQ(next_frame, 200u);
+    ASSERT_EQ(collisions, 5u);
+    // Exceptions of the callback are rethrown after stopping the workers.
+    size_t calls = 0u;
+    ASSERT_THROW(ForEachRange(recording, 7u, 0u, worker_threads, [&](FrameRange) {
+      if (++calls == 3u) {
+        throw std::runtime_error("stop");
+      }
+    }), std::runtime_error);
+    ASSERT_EQ(calls, 3u);
+  }
+}
+
+TEST(recorder, queries_without_index) {
+  const TemporaryRecording file(MakeRecording(MakeFrames(), false, false));
+  const Recording recording(file.path.string());
+  ASSERT_FALSE(recording.HasIndex());
+  CheckQueries(recording, 1u);
+  CheckQueries(recording, 4u);
+}
+
+TEST(recorder, queries_compressed_with_index) {
+  const TemporaryRecording file(MakeRecording(MakeFrames(), true, true));
+  const Recording recording(file.path.string());
+  ASSERT_TRUE(recording.HasIndex());
+  CheckQueries(recording, 1u);
+  CheckQueries(recording, 0u);
+}
+
+TEST(recorder, compressed_without_index) {
+  const TemporaryRecording file(MakeRecording(MakeFrames(), true, false));
+  const Recording recording(file.path.string());
+  ASSERT_FALSE(recording.HasIndex());
+  CheckQueries(recording, 3u);
+}
+
+TEST(recorder, corrupt_index) {
+  auto data = MakeRecording(MakeFrames(), false, true);
+  // Swap the offsets of two frames in the index, before the 24 bytes footer.
+  uint64_t index_offset;
+  std::memcpy(&index_offset, data.data() + data.size() - 24u, sizeof(index_offset));
+  auto offset_of_frame = [&](size_t i) {
+    // Packet id and size, number of frames, then frame id, elapsed and offset.
+    return static_cast<size_t>(index_offset) + 5u + 4u + 24u * i + 16u;
+  };
+  std::swap_ranges(
+      data.begin() + offset_of_frame(10u),
+      data.begin() + offset_of_frame(10u) + 8u,
+      data.begin() + offset_of_frame(11u));
+  const TemporaryRecording file(data);
+  // The index is ignored and the frames scanned instead.
+  const Recording recording(file.path.string());
+  ASSERT_FALSE(recording.HasIndex());
+  CheckQueries(recording, 2u);
+}
+
+TEST(recorder, unfinished_recording) {
+  auto data = MakeRecording(MakeFrames(), false, false);
+  // Cut the traffic lights and frame end packets of the last frame.
+  data.resize(data.size() - 12u);
+  const TemporaryRecording file(data);
+  const Recording recording(file.path.string());
+  ASSERT_EQ(recording.GetNumberOfFrames(), 200u);
+  const auto range = recording.ReadFrames(199u, 200u);
+  ASSERT_EQ(range.frames.size(), 1u);
+  ASSERT_EQ(range.positions.records.size(), 2u);
+}
+
+TEST(recorder, invalid_recording) {
+  const TemporaryRecording file("This is not a recording");
+  ASSERT_THROW(Recording{file.path.string()}, std::runtime_error);
+  ASSERT_THROW(Recording{(file.path / "missing.log").string()}, std::runtime_error);
+}
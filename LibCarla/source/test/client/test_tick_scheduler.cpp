@@ -0,0 +1,175 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/TickScheduler.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/s11n/EpisodeStateDelta.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace carla::sensor;
+using carla::client::detail::EpisodeState;
+using carla::client::detail::TickScheduler;
+
+static std::shared_ptr<const EpisodeState> MakeState(uint64_t frame) {
+  s11n::EpisodeStateDeltaEncoder encoder;
+  s11n::EpisodeStateSerializer::Header header;
+  header.episode_id = 1u;
+  header.platform_timestamp = 0.0;
+  header.delta_seconds = 0.05f;
+  auto body = encoder.Serialize(carla::Buffer{}, header, frame, {});
+  auto sensor_header = s11n::SensorHeaderSerializer::Serialize(0u, frame, 0.0, {});
+  carla::Buffer message;
+  message.reset(sensor_header.size() + body.size());
+  std::memcpy(message.data(), sensor_header.data(), sensor_header.size());
+  std::memcpy(message.data() + sensor_header.size(), body.data(), body.size());
+  return std::make_shared<EpisodeState>(Deserializer::Deserialize(std::move(message)));
+}
+
+static void WaitForFrame(const TickScheduler &scheduler, uint64_t frame) {
+  for (auto i = 0; i < 1000; ++i) {
+    bool done = true;
+    for (auto &&statistics : scheduler.GetStatistics()) {
+      done = done && (statistics.last_frame >= frame);
+    }
+    if (done) {
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  FAIL() << "timed out waiting for the tick callbacks";
+}
+
+TEST(tick_scheduler, inline_calls) {
+  TickScheduler scheduler;
+  ASSERT_EQ(scheduler.GetWorkerThreads(), 0u);
+  std::vector<uint64_t> frames;
+  const auto id = scheduler.Push([&](auto state) { frames.emplace_back(state->GetFrame()); });
+  scheduler.Push([](auto) { throw std::runtime_error("ignored"); });
+  for (auto frame = 1u; frame <= 3u; ++frame) {
+    scheduler.Call(MakeState(frame));
+  }
+  ASSERT_EQ(frames, (std::vector<uint64_t>{1u, 2u, 3u}));
+  auto statistics = scheduler.GetStatistics();
+  ASSERT_EQ(statistics.size(), 2u);
+  for (auto &&item : statistics) {
+    ASSERT_EQ(item.calls, 3u);
+    ASSERT_EQ(item.pending, 0u);
+    ASSERT_EQ(item.dropped, 0u);
+    ASSERT_EQ(item.last_frame, 3u);
+  }
+  ASSERT_EQ(statistics[0u].exceptions, 0u);
+  ASSERT_EQ(statistics[1u].exceptions, 3u);
+  scheduler.Remove(id);
+  scheduler.Call(MakeState(4u));
+  ASSERT_EQ(frames.size(), 3u);
+  ASSERT_EQ(scheduler.GetStatistics().size(), 1u);
+}
+
+TEST(tick_scheduler, worker_threads) {
+  constexpr auto number_of_ticks = 20u;
+  TickScheduler scheduler(2u);
+  ASSERT_EQ(scheduler.GetWorkerThreads(), 2u);
+
+  std::mutex mutex;
+  std::vector<uint64_t> slow_frames;
+  std::vector<uint64_t> fast_frames;
+  std::atomic_bool release{false};
+  std::atomic_int running{0};
+  bool overlapped = false;
+
+  scheduler.Push([&](auto state) {
+    overlapped = overlapped || (++running > 1);
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    slow_frames.emplace_back(state->GetFrame());
+    --running;
+  });
+  scheduler.Push([&](auto state) {
+    std::lock_guard<std::mutex> lock(mutex);
+    fast_frames.emplace_back(state->GetFrame());
+  });
+
+  // The slow callback is blocked in the first tick, the fast one keeps up.
+  scheduler.Call(MakeState(1u));
+  for (auto i = 0; (i < 1000) && (running == 0); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(running, 1);
+  for (auto frame = 2u; frame <= number_of_ticks; ++frame) {
+    scheduler.Call(MakeState(frame));
+  }
+  for (auto i = 0; i < 1000; ++i) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!fast_frames.empty() && (fast_frames.back() == number_of_ticks)) {
+        break;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_FALSE(fast_frames.empty());
+    ASSERT_EQ(fast_frames.back(), number_of_ticks);
+    ASSERT_TRUE(slow_frames.empty());
+  }
+  // Only the newest tick waits for the slow callback.
+  const auto blocked = scheduler.GetStatistics().front();
+  ASSERT_EQ(blocked.pending, 1u);
+  ASSERT_EQ(blocked.dropped, number_of_ticks - 2u);
+
+  // Late ticks are dropped.
+  scheduler.Call(MakeState(number_of_ticks - 1u));
+
+  release = true;
+  WaitForFrame(scheduler, number_of_ticks);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_FALSE(overlapped);
+  ASSERT_EQ(slow_frames, (std::vector<uint64_t>{1u, number_of_ticks}));
+  const auto statistics = scheduler.GetStatistics();
+  ASSERT_EQ(statistics.size(), 2u);
+  for (auto &&frames : {slow_frames, fast_frames}) {
+    ASSERT_TRUE(std::is_sorted(frames.begin(), frames.end()));
+    ASSERT_EQ(std::adjacent_find(frames.begin(), frames.end()), frames.end());
+    ASSERT_EQ(frames.back(), number_of_ticks);
+  }
+  for (auto i = 0u; i < statistics.size(); ++i) {
+    const auto &frames = (i == 0u ? slow_frames : fast_frames);
+    ASSERT_EQ(statistics[i].calls, frames.size());
+    ASSERT_EQ(statistics[i].calls + statistics[i].dropped, number_of_ticks + 1u);
+    ASSERT_EQ(statistics[i].pending, 0u);
+    ASSERT_EQ(statistics[i].exceptions, 0u);
+    ASSERT_EQ(statistics[i].last_frame, number_of_ticks);
+    ASSERT_GE(statistics[i].total_microseconds, statistics[i].max_microseconds);
+  }
+}
+
+TEST(tick_scheduler, change_worker_threads) {
+  TickScheduler scheduler(1u);
+  std::atomic_size_t calls{0u};
+  scheduler.Push([&](auto) { ++calls; });
+  scheduler.Call(MakeState(1u));
+  scheduler.SetWorkerThreads(3u);
+  scheduler.Call(MakeState(2u));
+  scheduler.SetWorkerThreads(0u);
+  // Without worker threads the call returns after the callback.
+  scheduler.Call(MakeState(3u));
+  ASSERT_EQ(calls, 3u);
+  ASSERT_EQ(scheduler.GetStatistics().front().last_frame, 3u);
+}
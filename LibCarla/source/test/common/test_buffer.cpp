@@ -134,3 +134,49 @@ TEST(buffer, buffer_pool) {
   // Now delete the pool to test the weak reference inside the buffers.
   pool.reset();
 }
+
+TEST(buffer, buffer_pool_size_classes) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  {
+    auto big = pool->Pop(4000u);
+    ASSERT_EQ(big.size(), 4000u);
+    ASSERT_EQ(big.capacity(), 4096u);
+  }
+  {
+    // A small buffer does not take the memory of the big one.
+    auto small = pool->Pop(100u);
+    ASSERT_EQ(small.size(), 100u);
+    ASSERT_EQ(small.capacity(), 128u);
+    auto big = pool->Pop(3000u);
+    ASSERT_EQ(big.capacity(), 4096u);
+  }
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.allocations, 2u);
+  ASSERT_EQ(stats.reuses, 1u);
+  ASSERT_EQ(stats.buffers_held, 2u);
+  ASSERT_EQ(stats.bytes_held, 4096u + 128u);
+}
+
+TEST(buffer, buffer_pool_shrink) {
+  auto pool = std::make_shared<carla::BufferPool>();
+  pool->SetMaxBytesHeld(1024u);
+  {
+    auto a = pool->Pop(512u);
+    auto b = pool->Pop(512u);
+    auto c = pool->Pop(512u);
+  }
+  auto stats = pool->GetStatistics();
+  ASSERT_EQ(stats.buffers_held, 2u);
+  ASSERT_EQ(stats.bytes_held, 1024u);
+  ASSERT_EQ(stats.releases, 1u);
+  pool->Shrink(512u);
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.buffers_held, 1u);
+  ASSERT_EQ(stats.bytes_held, 512u);
+  ASSERT_EQ(stats.releases, 2u);
+  pool->Shrink(0u);
+  stats = pool->GetStatistics();
+  ASSERT_EQ(stats.buffers_held, 0u);
+  ASSERT_EQ(stats.bytes_held, 0u);
+  ASSERT_EQ(stats.releases, 3u);
+}
@@ -0,0 +1,283 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/sensor/s11n/EpisodeStateDelta.h>
+
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+using namespace carla::sensor;
+using ActorDynamicState = data::ActorDynamicState;
+using Serializer = s11n::EpisodeStateSerializer;
+using Delta = s11n::EpisodeStateDelta;
+using Encoder = s11n::EpisodeStateDeltaEncoder;
+
+using ActorMap = std::unordered_map<carla::ActorId, ActorDynamicState>;
+
+static ActorDynamicState MakeActor(carla::ActorId id) {
+  ActorDynamicState actor{};
+  std::memset(&actor.state, 0, sizeof(actor.state));
+  actor.id = id;
+  actor.transform = carla::geom::Transform{
+      util::Random::Location(-1000.0f, 1000.0f),
+      carla::geom::Rotation{0.0f, static_cast<float>(util::Random::Uniform(-180.0, 180.0)), 0.0f}};
+  return actor;
+}
+
+static void Move(ActorDynamicState &actor, float delta_seconds) {
+  carla::geom::Vector3D velocity{
+      static_cast<float>(util::Random::Uniform(-20.0, 20.0)),
+      static_cast<float>(util::Random::Uniform(-20.0, 20.0)),
+      0.0f};
+  carla::geom::Transform transform = actor.transform;
+  transform.location += delta_seconds * velocity;
+  transform.rotation.yaw = static_cast<float>(util::Random::Uniform(-180.0, 180.0));
+  actor.transform = transform;
+  actor.acceleration = (velocity - actor.velocity) / delta_seconds;
+  actor.velocity = velocity;
+}
+
+/// Decode a message on top of @a actors, returns whether it was a keyframe.
+static bool Decode(const carla::Buffer &buffer, ActorMap &actors) {
+  Serializer::Header header;
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  const auto begin = buffer.data() + Serializer::header_offset;
+  if (header.encoding == Serializer::Encoding::Full) {
+    actors.clear();
+    for (auto it = begin; it != buffer.data() + buffer.size(); it += sizeof(ActorDynamicState)) {
+      ActorDynamicState actor;
+      std::memcpy(&actor, it, sizeof(actor));
+      actors.emplace(actor.id, actor);
+    }
+    return true;
+  }
+  Delta::Decode(
+      begin,
+      buffer.data() + buffer.size(),
+      [&](carla::ActorId id) { EXPECT_EQ(actors.erase(id), 1u); },
+      [&](carla::ActorId id) -> ActorDynamicState & {
+        auto &actor = actors[id];
+        actor.id = id;
+        return actor;
+      });
+  return false;
+}
+
+static void ExpectNear(const ActorDynamicState &lhs, const ActorDynamicState &rhs) {
+  const carla::geom::Transform a = lhs.transform;
+  const carla::geom::Transform b = rhs.transform;
+  ASSERT_NEAR(a.location.x, b.location.x, Delta::LOCATION_STEP);
+  ASSERT_NEAR(a.location.y, b.location.y, Delta::LOCATION_STEP);
+  ASSERT_NEAR(a.location.z, b.location.z, Delta::LOCATION_STEP);
+  const auto yaw_error = std::abs(std::remainder(a.rotation.yaw - b.rotation.yaw, 360.0f));
+  ASSERT_LE(yaw_error, Delta::ROTATION_STEP);
+  const carla::geom::Vector3D va = lhs.velocity;
+  const carla::geom::Vector3D vb = rhs.velocity;
+  ASSERT_NEAR(va.x, vb.x, Delta::VELOCITY_STEP);
+  ASSERT_NEAR(va.y, vb.y, Delta::VELOCITY_STEP);
+  const carla::geom::Vector3D aa = lhs.acceleration;
+  const carla::geom::Vector3D ab = rhs.acceleration;
+  ASSERT_NEAR(aa.x, ab.x, Delta::ACCELERATION_STEP);
+  ASSERT_NEAR(aa.y, ab.y, Delta::ACCELERATION_STEP);
+  ASSERT_EQ(std::memcmp(&lhs.state, &rhs.state, sizeof(lhs.state)), 0);
+}
+
+TEST(episode_state_delta, round_trip) {
+  constexpr float delta_seconds = 0.05f;
+  Encoder encoder(10u);
+  std::vector<ActorDynamicState> actors;
+  carla::ActorId next_id = 1u;
+  for (auto i = 0u; i < 50u; ++i) {
+    actors.emplace_back(MakeActor(next_id++));
+  }
+  ActorMap decoded;
+  size_t keyframes = 0u;
+  for (auto frame = 1u; frame <= 100u; ++frame) {
+    // Move some actors, destroy one and spawn another from time to time.
+    for (auto i = 0u; i < actors.size(); i += 3u) {
+      Move(actors[i], delta_seconds);
+    }
+    if (frame % 7u == 0u) {
+      actors.erase(actors.begin() + (frame % actors.size()));
+      actors.emplace_back(MakeActor(next_id++));
+      actors.back().state.traffic_light_data.green_time = static_cast<float>(frame);
+    }
+    Serializer::Header header;
+    header.episode_id = 42u;
+    header.platform_timestamp = 0.0;
+    header.delta_seconds = delta_seconds;
+    auto buffer = encoder.Serialize(carla::Buffer{}, header, frame, actors);
+    if (Decode(buffer, decoded)) {
+      ++keyframes;
+    } else {
+      ASSERT_LT(buffer.size(), Serializer::header_offset + sizeof(ActorDynamicState) * actors.size());
+    }
+    ASSERT_EQ(decoded.size(), actors.size());
+    for (auto &&actor : actors) {
+      auto it = decoded.find(actor.id);
+      ASSERT_NE(it, decoded.end());
+      ExpectNear(it->second, actor);
+    }
+  }
+  ASSERT_EQ(keyframes, 10u);
+}
+
+TEST(episode_state_delta, wide_values) {
+  Encoder encoder;
+  std::vector<ActorDynamicState> actors{MakeActor(1u)};
+  ActorMap decoded;
+  Serializer::Header header;
+  header.episode_id = 1u;
+  header.platform_timestamp = 0.0;
+  header.delta_seconds = 0.05f;
+  ASSERT_TRUE(Decode(encoder.Serialize(carla::Buffer{}, header, 1u, actors), decoded));
+  // Teleport and crash.
+  carla::geom::Transform transform = actors[0u].transform;
+  transform.location.x += 500.0f;
+  actors[0u].transform = transform;
+  actors[0u].acceleration = carla::geom::Vector3D{2000.0f, 0.0f, 0.0f};
+  ASSERT_FALSE(Decode(encoder.Serialize(carla::Buffer{}, header, 2u, actors), decoded));
+  ExpectNear(decoded[1u], actors[0u]);
+  // A new episode always starts with a keyframe.
+  header.episode_id = 2u;
+  ASSERT_TRUE(Decode(encoder.Serialize(carla::Buffer{}, header, 3u, actors), decoded));
+}
+
+TEST(episode_state_delta, mid_stream) {
+  // A client that only applies deltas to their base, as client::detail::Episode
+  // does, and asks for a keyframe when the base is missing.
+  struct LateClient {
+    Encoder &encoder;
+    ActorMap actors;
+    uint64_t frame = 0u;
+    bool synchronized = false;
+    size_t keyframes_requested = 0u;
+
+    void Receive(const carla::Buffer &buffer, uint64_t message_frame) {
+      Serializer::Header header;
+      std::memcpy(&header, buffer.data(), sizeof(header));
+      if (header.encoding == Serializer::Encoding::Delta) {
+        Serializer::DeltaHeader delta_header;
+        std::memcpy(&delta_header, buffer.data() + Serializer::header_offset, sizeof(delta_header));
+        if (!synchronized || (delta_header.base_frame != frame)) {
+          synchronized = false;
+          ++keyframes_requested;
+          encoder.RequestKeyframe();
+          return;
+        }
+      }
+      Decode(buffer, actors);
+      frame = message_frame;
+      synchronized = true;
+    }
+  };
+
+  constexpr float delta_seconds = 0.05f;
+  // No scheduled keyframes, only the first and the ones requested.
+  Encoder encoder(1000u);
+  std::vector<ActorDynamicState> actors;
+  for (auto id = 1u; id <= 20u; ++id) {
+    actors.emplace_back(MakeActor(id));
+  }
+  Serializer::Header header;
+  header.episode_id = 1u;
+  header.platform_timestamp = 0.0;
+  header.delta_seconds = delta_seconds;
+
+  ActorMap reference;
+  LateClient client{encoder, {}};
+  constexpr uint64_t first_frame = 10u;
+  constexpr uint64_t dropped_frame = 20u;
+  for (auto frame = 1u; frame <= 30u; ++frame) {
+    for (auto &actor : actors) {
+      Move(actor, delta_seconds);
+    }
+    auto buffer = encoder.Serialize(carla::Buffer{}, header, frame, actors);
+    const bool is_keyframe = Decode(buffer, reference);
+    ASSERT_EQ(is_keyframe, (frame == 1u) || (frame == first_frame + 1u));
+    if ((frame >= first_frame) && (frame != dropped_frame)) {
+      client.Receive(buffer, frame);
+    }
+    if ((frame == dropped_frame + 1u) && !client.synchronized) {
+      // Answer the request right away with the last state, as the server does
+      // in synchronous mode, the next delta is based on it.
+      auto keyframe = encoder.Serialize(carla::Buffer{}, header, frame, actors);
+      ASSERT_TRUE(Decode(keyframe, reference));
+      client.Receive(keyframe, frame);
+      ASSERT_TRUE(client.synchronized);
+    }
+    if ((frame > first_frame) && (frame != dropped_frame)) {
+      ASSERT_TRUE(client.synchronized) << "frame " << frame;
+      ASSERT_EQ(client.frame, frame);
+      ASSERT_EQ(client.actors.size(), actors.size());
+      for (auto &&actor : actors) {
+        auto it = client.actors.find(actor.id);
+        ASSERT_NE(it, client.actors.end());
+        ExpectNear(it->second, actor);
+        ExpectNear(it->second, reference[actor.id]);
+      }
+    }
+  }
+  ASSERT_EQ(client.keyframes_requested, 2u);
+}
+
+TEST(episode_state_delta, benchmark) {
+  constexpr auto number_of_actors = 2000u;
+  constexpr auto number_of_moving_actors = 200u;
+  constexpr auto number_of_frames = 300u;
+  constexpr float delta_seconds = 0.05f;
+
+  std::vector<ActorDynamicState> actors;
+  for (auto i = 0u; i < number_of_actors; ++i) {
+    actors.emplace_back(MakeActor(i + 1u));
+  }
+
+  Encoder encoder(30u);
+  ActorMap decoded;
+  size_t delta_bytes = 0u;
+  size_t full_bytes = 0u;
+  size_t delta_decode_time = 0u;
+  size_t full_decode_time = 0u;
+  for (auto frame = 1u; frame <= number_of_frames; ++frame) {
+    for (auto i = 0u; i < number_of_moving_actors; ++i) {
+      Move(actors[i], delta_seconds);
+    }
+    Serializer::Header header;
+    header.episode_id = 1u;
+    header.platform_timestamp = 0.0;
+    header.delta_seconds = delta_seconds;
+
+    {
+      auto buffer = encoder.Serialize(carla::Buffer{}, header, frame, actors);
+      delta_bytes += buffer.size();
+      carla::StopWatch stop_watch;
+      Decode(buffer, decoded);
+      delta_decode_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    }
+    {
+      Encoder full_encoder(1u);
+      auto buffer = full_encoder.Serialize(carla::Buffer{}, header, frame, actors);
+      full_bytes += buffer.size();
+      ActorMap full_decoded;
+      carla::StopWatch stop_watch;
+      Decode(buffer, full_decoded);
+      full_decode_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    }
+  }
+  ASSERT_LT(delta_bytes, full_bytes);
+  carla::logging::log(
+      "episode state,", number_of_actors, "actors,", number_of_moving_actors, "moving:",
+      "full", full_bytes / number_of_frames, "bytes/tick",
+      full_decode_time / number_of_frames, "us/tick; delta",
+      delta_bytes / number_of_frames, "bytes/tick",
+      delta_decode_time / number_of_frames, "us/tick");
+}
@@ -9,7 +9,11 @@
 #include <carla/geom/Vector3D.h>
 #include <carla/geom/Math.h>
 #include <carla/geom/Transform.h>
+#include <carla/road/element/Geometry.h>
+#include <carla/StopWatch.h>
+#include <cmath>
 #include <limits>
+#include <vector>
 
 namespace carla {
 namespace geom {
@@ -179,3 +183,110 @@ TEST(geom, nearest_point_arc) {
   ASSERT_NEAR(Math::DistanceArcToPoint(Vector3D(1,2,0),
       Vector3D(0,0,0), 1.57f, 0, 1).second, 1.0f, 0.01f);
 }
+
+/// Points of @a spiral every @a step metres, integrating its heading with
+/// Simpson's rule on each step. Independent of GeometrySpiral, only its
+/// parameters are used.
+static std::vector<std::pair<double, double>> IntegrateSpiral(
+    const carla::road::element::GeometrySpiral &spiral,
+    const double step) {
+  const double length = spiral.GetLength();
+  const double k0 = spiral.GetCurveStart();
+  const double c = (spiral.GetCurveEnd() - k0) / length;
+  auto heading = [&](double s) { return spiral.GetHeading() + k0 * s + 0.5 * c * s * s; };
+  double x = spiral.GetStartPosition().x;
+  double y = spiral.GetStartPosition().y;
+  std::vector<std::pair<double, double>> result{{x, y}};
+  for (double s = 0.0; s < length; s += step) {
+    const double h = std::min(step, length - s);
+    const double a = heading(s);
+    const double m = heading(s + 0.5 * h);
+    const double b = heading(s + h);
+    x += h / 6.0 * (std::cos(a) + 4.0 * std::cos(m) + std::cos(b));
+    y += h / 6.0 * (std::sin(a) + 4.0 * std::sin(m) + std::sin(b));
+    result.emplace_back(x, y);
+  }
+  return result;
+}
+
+TEST(geom, nearest_point_spiral) {
+  using carla::road::element::GeometrySpiral;
+  const std::vector<GeometrySpiral> spirals = [](){
+    std::vector<GeometrySpiral> result;
+    result.emplace_back(0.0, 50.0, 0.3, Location(10.0f, -5.0f, 0.0f), 0.0, 0.05);
+    result.emplace_back(0.0, 80.0, -1.2, Location(-3.0f, 2.0f, 0.0f), 0.0, -0.04);
+    result.emplace_back(0.0, 30.0, 2.0, Location(100.0f, 50.0f, 0.0f), 0.08, 0.0);
+    result.emplace_back(0.0, 60.0, 0.0, Location(0.0f, 0.0f, 0.0f), -0.02, 0.03);
+    result.emplace_back(0.0, 40.0, 1.0, Location(5.0f, 5.0f, 0.0f), 0.01, 0.01 + 1e-9);
+    return result;
+  }();
+
+  // Start and end headings follow the linear change of curvature.
+  for (const auto &spiral : spirals) {
+    const double length = spiral.GetLength();
+    const double expected_heading = spiral.GetHeading() +
+        0.5 * (spiral.GetCurveStart() + spiral.GetCurveEnd()) * length;
+    ASSERT_NEAR(spiral.PosFromDist(0.0).tangent, spiral.GetHeading(), 1e-9);
+    ASSERT_NEAR(spiral.PosFromDist(length).tangent, expected_heading, 1e-9);
+  }
+
+  std::vector<Vector3D> points;
+  for (auto x = -60; x <= 160; x += 7) {
+    for (auto y = -60; y <= 100; y += 7) {
+      points.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    }
+  }
+
+  // Compare against dense sampling every centimetre of the spiral integrated
+  // numerically, instead of evaluated with the Fresnel integrals.
+  constexpr double step = 0.01;
+  size_t sampling_time = 0u;
+  size_t distance_to_time = 0u;
+  for (const auto &spiral : spirals) {
+    const auto samples = IntegrateSpiral(spiral, step);
+    auto sample_at = [&](double s) {
+      return samples[static_cast<size_t>(std::round(s / step))];
+    };
+    auto distance = [](const std::pair<double, double> &sample, const Vector3D &point) {
+      return std::hypot(sample.first - point.x, sample.second - point.y);
+    };
+
+    // The evaluation of the spiral matches the integration.
+    for (double s = 0.0; s <= spiral.GetLength(); s += 1.0) {
+      const auto location = spiral.PosFromDist(s).location;
+      ASSERT_NEAR(location.x, sample_at(s).first, 1e-3) << "s = " << s;
+      ASSERT_NEAR(location.y, sample_at(s).second, 1e-3) << "s = " << s;
+    }
+
+    carla::StopWatch stop_watch;
+    std::vector<double> expected;
+    for (const auto &point : points) {
+      double min_dist = std::numeric_limits<double>::max();
+      for (const auto &sample : samples) {
+        min_dist = std::min(min_dist, distance(sample, point));
+      }
+      expected.emplace_back(min_dist);
+    }
+    sampling_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+    stop_watch.Restart();
+    std::vector<std::pair<float, float>> results;
+    for (const auto &point : points) {
+      results.emplace_back(spiral.DistanceTo(point));
+    }
+    distance_to_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+    for (auto i = 0u; i < points.size(); ++i) {
+      // The nearest point can't be farther than the nearest sample, and it
+      // can't be closer than half a sampling step.
+      ASSERT_LE(results[i].second, expected[i] + 1e-3);
+      ASSERT_GE(results[i].second, expected[i] - 0.5 * step - 1e-3);
+      // The distance returned is the one to the integrated point at the
+      // returned s, within half a step along the spiral.
+      ASSERT_NEAR(distance(sample_at(results[i].first), points[i]), results[i].second, 0.5 * step + 1e-3);
+    }
+  }
+  carla::logging::log(
+      "spiral nearest point: dense sampling", sampling_time,
+      "us, DistanceTo", distance_to_time, "us");
+}
@@ -168,6 +168,102 @@ TEST(streaming, low_level_tcp_small_message) {
   c->Stop();
 }
 
+static void tcp_send_queue_burst(
+    const carla::streaming::detail::tcp::SendQueueOptions &options,
+    size_t number_of_messages,
+    carla::streaming::detail::tcp::SessionStatistics &statistics,
+    size_t &message_count) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+
+  boost::asio::io_context io_context;
+  tcp::Server::endpoint ep(boost::asio::ip::tcp::v4(), TESTING_PORT);
+
+  tcp::Server srv(io_context, ep);
+  srv.SetTimeout(1s);
+  srv.SetSendQueueOptions(options);
+
+  std::atomic_size_t received{0u};
+  std::shared_ptr<tcp::ServerSession> server_session;
+  std::atomic_bool burst_done{false};
+
+  const std::string msg(4096u, 'x');
+
+  srv.Listen([&](std::shared_ptr<tcp::ServerSession> session) {
+    server_session = session;
+    for (auto i = 0u; i < number_of_messages; ++i) {
+      session->Write(carla::Buffer(msg));
+    }
+    burst_done = true;
+  }, [](std::shared_ptr<tcp::ServerSession>) {});
+
+  Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(srv.GetLocalEndpoint())};
+  auto stream = dispatcher.MakeStream();
+  auto c = std::make_shared<tcp::Client>(io_context, stream.token(), [&](carla::Buffer message) {
+    ASSERT_EQ(message.size(), msg.size());
+    ++received;
+  });
+  c->Connect();
+
+  carla::ThreadGroup threads;
+  threads.CreateThreads(
+      std::max(2u, std::thread::hardware_concurrency()),
+      [&]() { io_context.run(); });
+
+  for (auto i = 0u; (i < 200u) && !burst_done; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_TRUE(burst_done);
+  for (auto i = 0u; i < 200u; ++i) {
+    statistics = server_session->GetStatistics();
+    if ((statistics.queued_messages == 0u) &&
+        (received == statistics.sent_messages) &&
+        (statistics.sent_messages + statistics.dropped_messages == number_of_messages)) {
+      break;
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+  message_count = received;
+  // The server sums the counters of its only session.
+  const auto server_statistics = srv.GetStatistics();
+  ASSERT_EQ(server_statistics.sent_messages, statistics.sent_messages);
+  ASSERT_EQ(server_statistics.sent_bytes, statistics.sent_bytes);
+  ASSERT_EQ(server_statistics.dropped_messages, statistics.dropped_messages);
+  io_context.stop();
+  c->Stop();
+}
+
+TEST(streaming, tcp_send_queue_block_tick) {
+  using namespace carla::streaming::detail;
+  constexpr size_t number_of_messages = 2000u;
+  tcp::SendQueueOptions options;
+  options.max_messages = 4u;
+  options.policy = tcp::SendQueuePolicy::BlockTick;
+  tcp::SessionStatistics statistics;
+  size_t message_count = 0u;
+  tcp_send_queue_burst(options, number_of_messages, statistics, message_count);
+  ASSERT_EQ(message_count, number_of_messages);
+  ASSERT_EQ(statistics.sent_messages, number_of_messages);
+  ASSERT_EQ(statistics.sent_bytes, number_of_messages * 4096u);
+  ASSERT_EQ(statistics.dropped_messages, 0u);
+}
+
+TEST(streaming, tcp_send_queue_drop_oldest) {
+  using namespace carla::streaming::detail;
+  constexpr size_t number_of_messages = 2000u;
+  tcp::SendQueueOptions options;
+  options.max_messages = 100u;
+  options.max_bytes = 8u * 4096u;
+  options.policy = tcp::SendQueuePolicy::DropOldest;
+  tcp::SessionStatistics statistics;
+  size_t message_count = 0u;
+  tcp_send_queue_burst(options, number_of_messages, statistics, message_count);
+  ASSERT_EQ(message_count, statistics.sent_messages);
+  ASSERT_EQ(statistics.queued_messages, 0u);
+  ASSERT_EQ(statistics.sent_messages + statistics.dropped_messages, number_of_messages);
+  ASSERT_EQ(statistics.dropped_bytes, statistics.dropped_messages * 4096u);
+}
+
 struct DoneGuard {
   ~DoneGuard() { done = true; };
   std::atomic_bool &done;
@@ -255,3 +351,43 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+TEST(streaming, multi_stream_on_connect) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_clients = 3u;
+  const std::string message = "Welcome!";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(number_of_clients);
+  auto stream = srv.MakeMultiStream();
+
+  // Every client receives the message written when it connects, like the
+  // keyframe of a delta-encoded stream, plus the ones of the clients after.
+  std::atomic_size_t connections{0u};
+  stream.SetOnConnectCallback([&]() {
+    ++connections;
+    stream << message;
+  });
+
+  std::vector<std::pair<std::atomic_size_t, std::unique_ptr<Client>>> v(number_of_clients);
+  for (auto &pair : v) {
+    pair.first = 0u;
+    pair.second = std::make_unique<Client>();
+    pair.second->AsyncRun(1u);
+    pair.second->Subscribe(stream.token(), [&](auto buffer) {
+      const std::string result = as_string(buffer);
+      ASSERT_EQ(result, message);
+      ++pair.first;
+    });
+    for (auto i = 0u; (i < 1000u) && (pair.first == 0u); ++i) {
+      std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_EQ(pair.first, 1u);
+  }
+  std::this_thread::sleep_for(6ms);
+  ASSERT_EQ(connections, number_of_clients);
+  for (auto i = 0u; i < number_of_clients; ++i) {
+    ASSERT_EQ(v[i].first, number_of_clients - i);
+  }
+}
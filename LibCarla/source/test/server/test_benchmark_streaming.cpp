@@ -6,6 +6,7 @@
 
 #include "test.h"
 
+#include <carla/StopWatch.h>
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
 
@@ -161,3 +162,164 @@ TEST(benchmark_streaming, image_800x600_mt) {
 TEST(benchmark_streaming, image_1920x1080_mt) {
   benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9);
 }
+
+/// Write @a number_of_messages as fast as possible to a single stream and
+/// report how many messages per second the client gets. With the default
+/// send queue options the session discards messages while it is busy
+/// sending, so not all of them arrive.
+static void benchmark_throughput(
+    const size_t message_size,
+    const size_t number_of_messages,
+    const ClientOptions &options = ClientOptions{},
+    const SendQueueOptions &queue_options = SendQueueOptions{}) {
+  Server server(TESTING_PORT);
+  server.SetSendQueueOptions(queue_options);
+  server.AsyncRun(1u);
+  Stream stream = server.MakeStream();
+
+  carla::StopWatch stop_watch;
+  std::atomic_size_t number_of_messages_received{0u};
+  std::atomic_size_t time_of_last_message{0u};
+
+  Client client("127.0.0.1", options);
+  client.Subscribe(stream.token(), [&](carla::Buffer DEBUG_ONLY(msg)) {
+    DEBUG_ASSERT_EQ(msg.size(), message_size);
+    ++number_of_messages_received;
+    time_of_last_message = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  });
+  client.AsyncRun(1u);
+
+  std::this_thread::sleep_for(1s); // the client needs to be ready.
+
+  const auto message = make_special_message(message_size);
+  stop_watch.Restart();
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream << message.buffer();
+  }
+
+  // Wait until the messages stop arriving.
+  size_t received = 0u;
+  do {
+    received = number_of_messages_received;
+    std::this_thread::sleep_for(200ms);
+  } while (received != number_of_messages_received);
+
+  ASSERT_GT(received, 0u);
+  const auto seconds = 1e-6 * static_cast<double>(time_of_last_message);
+  const auto messages_per_second = static_cast<double>(received) / seconds;
+  carla::logging::log(
+      "Throughput:", message_size, "bytes messages,",
+      received, '/', number_of_messages, "received,",
+      static_cast<size_t>(messages_per_second), "messages/s,",
+      1e-6 * messages_per_second * static_cast<double>(message_size), "MB/s");
+}
+
+TEST(benchmark_streaming, throughput_small_messages) {
+  benchmark_throughput(64u, 200'000u);
+}
+
+TEST(benchmark_streaming, throughput_large_messages) {
+  ClientOptions options;
+  options.receive_buffer_size = 4 * 1024 * 1024;
+  benchmark_throughput(4u * 800u * 600u, 1'000u, options);
+}
+
+TEST(benchmark_streaming, throughput_large_messages_lossless) {
+  ClientOptions options;
+  options.receive_buffer_size = 4 * 1024 * 1024;
+  SendQueueOptions queue_options;
+  queue_options.max_messages = 8u;
+  queue_options.policy = SendQueuePolicy::BlockTick;
+  benchmark_throughput(4u * 800u * 600u, 1'000u, options, queue_options);
+}
+
+/// Write to a multi-stream with @a number_of_subscribers clients and report
+/// the time spent by the writer (the game thread) on each write.
+///
+/// With the default send queue options a session discards the messages
+/// written while it is still sending the previous one. With many subscribers
+/// the writer outpaces the sessions and most of these drops are expected, so
+/// the benchmark checks that every message not received was counted as
+/// dropped by the server, and that at least @a min_delivery_ratio of them
+/// arrived.
+static void benchmark_multi_stream(
+    const size_t number_of_subscribers,
+    const double min_delivery_ratio,
+    const SendQueueOptions &queue_options = SendQueueOptions{}) {
+  constexpr auto number_of_messages = 1'000u;
+  constexpr auto message_size = 4u * 200u * 200u;
+
+  Server server(TESTING_PORT);
+  server.SetSendQueueOptions(queue_options);
+  server.AsyncRun(get_max_concurrency());
+  MultiStream stream = server.MakeMultiStream();
+
+  std::atomic_size_t number_of_messages_received{0u};
+  std::vector<std::unique_ptr<Client>> clients;
+  for (auto i = 0u; i < number_of_subscribers; ++i) {
+    clients.emplace_back(std::make_unique<Client>());
+    clients.back()->AsyncRun(1u);
+    clients.back()->Subscribe(stream.token(), [&](carla::Buffer DEBUG_ONLY(msg)) {
+      DEBUG_ASSERT_EQ(msg.size(), message_size);
+      ++number_of_messages_received;
+    });
+  }
+
+  std::this_thread::sleep_for(1s); // the clients need to be ready.
+
+  const auto message = make_special_message(message_size);
+  size_t total_write_time = 0u;
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    std::this_thread::sleep_for(1ms);
+    carla::StopWatch stop_watch;
+    stream << message.buffer();
+    stop_watch.Stop();
+    total_write_time += stop_watch.GetElapsedTime<std::chrono::nanoseconds>();
+  }
+
+  // Wait until every message written was either received or dropped.
+  const auto expected = number_of_subscribers * number_of_messages;
+  SessionStatistics statistics;
+  for (auto i = 0u; i < 100u; ++i) {
+    statistics = server.GetStatistics();
+    if ((statistics.queued_messages == 0u) &&
+        (statistics.sent_messages + statistics.dropped_messages == expected) &&
+        (number_of_messages_received == statistics.sent_messages)) {
+      break;
+    }
+    std::this_thread::sleep_for(100ms);
+  }
+  const size_t received = number_of_messages_received;
+
+  carla::logging::log(
+      "Multi-stream:", number_of_subscribers, "subscribers,",
+      1e-3 * static_cast<double>(total_write_time) / number_of_messages, "us per write,",
+      received, '/', expected, "messages received,",
+      statistics.dropped_messages, "dropped by the server");
+  ASSERT_EQ(received, statistics.sent_messages);
+  ASSERT_EQ(received + statistics.dropped_messages, expected);
+  ASSERT_GE(
+      static_cast<double>(received),
+      min_delivery_ratio * static_cast<double>(expected));
+}
+
+TEST(benchmark_streaming, multi_stream_1_subscriber) {
+  benchmark_multi_stream(1u, 0.9);
+}
+
+TEST(benchmark_streaming, multi_stream_8_subscribers) {
+  benchmark_multi_stream(8u, 0.5);
+}
+
+TEST(benchmark_streaming, multi_stream_64_subscribers) {
+  // 64 copies of a 160 KB message every millisecond do not fit through the
+  // loopback, about half of them are dropped on a single core.
+  benchmark_multi_stream(64u, 0.1);
+}
+
+TEST(benchmark_streaming, multi_stream_64_subscribers_lossless) {
+  SendQueueOptions queue_options;
+  queue_options.max_messages = 8u;
+  queue_options.policy = SendQueuePolicy::BlockTick;
+  benchmark_multi_stream(64u, 1.0, queue_options);
+}
@@ -4,6 +4,7 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <carla/BufferPool.h>
 #include <carla/PythonUtil.h>
 #include <carla/client/Client.h>
 #include <carla/client/World.h>
@@ -53,11 +54,30 @@ void export_client() {
   using namespace boost::python;
   namespace cc = carla::client;
 
+  class_<carla::BufferPoolStatistics>("BufferPoolStatistics")
+    .def_readonly("allocations", &carla::BufferPoolStatistics::allocations)
+    .def_readonly("reuses", &carla::BufferPoolStatistics::reuses)
+    .def_readonly("releases", &carla::BufferPoolStatistics::releases)
+    .def_readonly("buffers_held", &carla::BufferPoolStatistics::buffers_held)
+    .def_readonly("bytes_held", &carla::BufferPoolStatistics::bytes_held)
+  ;
+
+  using carla::streaming::detail::tcp::SessionStatistics;
+  class_<SessionStatistics>("StreamingStatistics")
+    .def_readonly("queued_messages", &SessionStatistics::queued_messages)
+    .def_readonly("queued_bytes", &SessionStatistics::queued_bytes)
+    .def_readonly("sent_messages", &SessionStatistics::sent_messages)
+    .def_readonly("sent_bytes", &SessionStatistics::sent_bytes)
+    .def_readonly("dropped_messages", &SessionStatistics::dropped_messages)
+    .def_readonly("dropped_bytes", &SessionStatistics::dropped_bytes)
+  ;
+
   class_<cc::Client>("Client",
       init<std::string, uint16_t, size_t>((arg("host"), arg("port"), arg("worker_threads")=0u)))
     .def("set_timeout", &::SetTimeout, (arg("seconds")))
     .def("get_client_version", &cc::Client::GetClientVersion)
     .def("get_server_version", CONST_CALL_WITHOUT_GIL(cc::Client, GetServerVersion))
+    .def("get_streaming_statistics", CONST_CALL_WITHOUT_GIL(cc::Client, GetStreamingStatistics))
     .def("get_world", &cc::Client::GetWorld)
     .def("get_available_maps", &GetAvailableMaps)
     .def("reload_world", CONST_CALL_WITHOUT_GIL(cc::Client, ReloadWorld))
@@ -71,5 +91,9 @@ void export_client() {
     .def("set_replayer_time_factor", &cc::Client::SetReplayerTimeFactor, (arg("time_factor")))
     .def("apply_batch", &ApplyBatchCommands, (arg("commands"), arg("do_tick")=false))
     .def("apply_batch_sync", &ApplyBatchCommandsSync, (arg("commands"), arg("do_tick")=false))
+    .def("get_buffer_pool_statistics", &carla::BufferPool::GetGlobalStatistics)
+    .staticmethod("get_buffer_pool_statistics")
+    .def("set_buffer_pool_max_bytes_held", &carla::BufferPool::SetDefaultMaxBytesHeld, (arg("bytes")))
+    .staticmethod("set_buffer_pool_max_bytes_held")
   ;
 }
@@ -10,8 +10,10 @@
 #include <carla/client/Waypoint.h>
 #include <carla/road/element/LaneMarking.h>
 
+#include <cstring>
 #include <ostream>
 #include <fstream>
+#include <stdexcept>
 
 namespace carla {
 namespace client {
@@ -49,6 +51,281 @@ static auto GetTopology(const carla::client::Map &self) {
   return result;
 }
 
+/// Read the locations either from an object supporting the buffer protocol
+/// with N x 3 floats (float32 or float64), e.g. a NumPy array, or from any
+/// iterable of carla.Location.
+static std::vector<carla::geom::Location> ToLocationVector(const boost::python::object &locations) {
+  namespace py = boost::python;
+  std::vector<carla::geom::Location> result;
+  if (PyObject_CheckBuffer(locations.ptr())) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(locations.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+      py::throw_error_already_set();
+    }
+    const std::string format = view.format != nullptr ? view.format : "B";
+    const bool is_float = (format == "f") && (view.itemsize == sizeof(float));
+    const bool is_double = (format == "d") && (view.itemsize == sizeof(double));
+    const auto count = static_cast<size_t>(view.len / view.itemsize);
+    if ((!is_float && !is_double) || (count % 3u != 0u)) {
+      PyBuffer_Release(&view);
+      PyErr_SetString(PyExc_ValueError, "expected a contiguous buffer of N x 3 float32 or float64 values");
+      py::throw_error_already_set();
+    }
+    result.reserve(count / 3u);
+    for (auto i = 0u; i < count; i += 3u) {
+      if (is_float) {
+        const auto *data = reinterpret_cast<const float *>(view.buf) + i;
+        result.emplace_back(data[0u], data[1u], data[2u]);
+      } else {
+        const auto *data = reinterpret_cast<const double *>(view.buf) + i;
+        result.emplace_back(
+            static_cast<float>(data[0u]),
+            static_cast<float>(data[1u]),
+            static_cast<float>(data[2u]));
+      }
+    }
+    PyBuffer_Release(&view);
+  } else {
+    result.assign(
+        py::stl_input_iterator<carla::geom::Location>(locations),
+        py::stl_input_iterator<carla::geom::Location>());
+  }
+  return result;
+}
+
+/// Copy @a size bytes of @a data into a new Python bytes object.
+static boost::python::object MakeBytes(const void *data, size_t size) {
+#if PY_MAJOR_VERSION >= 3
+  auto *ptr = PyBytes_FromStringAndSize(reinterpret_cast<const char *>(data), static_cast<Py_ssize_t>(size));
+#else
+  auto *ptr = PyString_FromStringAndSize(reinterpret_cast<const char *>(data), static_cast<Py_ssize_t>(size));
+#endif
+  return boost::python::object(boost::python::handle<>(ptr));
+}
+
+template <typename T>
+static boost::python::object MakeBytes(const std::vector<T> &data) {
+  return MakeBytes(data.data(), data.size() * sizeof(T));
+}
+
+/// Compact record returned by Map.get_waypoints, matches the NumPy dtype
+/// [('road_id', 'u4'), ('section_id', 'u4'), ('lane_id', 'i4'), ('s', 'f8')].
+#pragma pack(push, 1)
+struct PackedWaypoint {
+  uint32_t road_id;
+  uint32_t section_id;
+  int32_t lane_id;
+  double s;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(PackedWaypoint) == 20u, "Invalid PackedWaypoint size.");
+
+static boost::python::object GetWaypoints(
+    const carla::client::Map &self,
+    const boost::python::object &locations,
+    bool project_to_road,
+    carla::road::Lane::LaneType lane_type,
+    size_t worker_threads) {
+  const auto input = ToLocationVector(locations);
+  std::string buffer(input.size() * sizeof(PackedWaypoint), '\0');
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    const auto waypoints = self.GetWaypoints(
+        input,
+        project_to_road,
+        static_cast<uint32_t>(lane_type),
+        worker_threads);
+    auto *out = &buffer[0u];
+    for (const auto &waypoint : waypoints) {
+      const PackedWaypoint packed{
+          waypoint.road_id,
+          waypoint.section_id,
+          waypoint.lane_id,
+          waypoint.s};
+      std::memcpy(out, &packed, sizeof(packed));
+      out += sizeof(packed);
+    }
+  }
+  return MakeBytes(buffer.data(), buffer.size());
+}
+
+static_assert(sizeof(carla::geom::Location) == 3u * sizeof(float), "Invalid Location size.");
+static_assert(sizeof(carla::geom::Rotation) == 3u * sizeof(float), "Invalid Rotation size.");
+
+/// Convert @a arrays into a dict of bytes objects, one per field, see
+/// Map.generate_waypoint_arrays for the NumPy dtypes.
+static boost::python::dict ToDict(const carla::road::WaypointArrays &arrays) {
+  boost::python::dict result;
+  result["road_id"] = MakeBytes(arrays.road_id);
+  result["section_id"] = MakeBytes(arrays.section_id);
+  result["lane_id"] = MakeBytes(arrays.lane_id);
+  result["s"] = MakeBytes(arrays.s);
+  result["location"] = MakeBytes(arrays.location);
+  result["rotation"] = MakeBytes(arrays.rotation);
+  return result;
+}
+
+/// Read a contiguous buffer of values of type T, @a formats lists the buffer
+/// format characters accepted for T.
+template <typename T>
+static std::vector<T> ToVector(const boost::python::object &object, const std::string &formats) {
+  namespace py = boost::python;
+  Py_buffer view;
+  if (PyObject_GetBuffer(object.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+    py::throw_error_already_set();
+  }
+  std::string format = view.format != nullptr ? view.format : "B";
+  // Ignore the byte order prefix, native little-endian is assumed.
+  if (!format.empty() && std::string("@=<").find(format[0u]) != std::string::npos) {
+    format.erase(0u, 1u);
+  }
+  if ((format.size() != 1u) ||
+      (formats.find(format[0u]) == std::string::npos) ||
+      (view.itemsize != sizeof(T))) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_ValueError, "unexpected buffer format in waypoint arrays");
+    py::throw_error_already_set();
+  }
+  const auto *data = reinterpret_cast<const T *>(view.buf);
+  std::vector<T> result(data, data + view.len / view.itemsize);
+  PyBuffer_Release(&view);
+  return result;
+}
+
+/// Read the waypoints either from a dict of arrays as returned by
+/// Map.generate_waypoint_arrays, from the packed records returned by
+/// Map.get_waypoints, or from any iterable of carla.Waypoint.
+static std::vector<carla::road::element::Waypoint> ToWaypointVector(const boost::python::object &waypoints) {
+  namespace py = boost::python;
+  std::vector<carla::road::element::Waypoint> result;
+  py::extract<py::dict> as_dict(waypoints);
+  if (as_dict.check()) {
+    const py::dict dict = as_dict();
+    const auto road_id = ToVector<uint32_t>(dict["road_id"], "IL");
+    const auto section_id = ToVector<uint32_t>(dict["section_id"], "IL");
+    const auto lane_id = ToVector<int32_t>(dict["lane_id"], "il");
+    const auto s = ToVector<double>(dict["s"], "d");
+    if ((section_id.size() != road_id.size()) ||
+        (lane_id.size() != road_id.size()) ||
+        (s.size() != road_id.size())) {
+      throw std::invalid_argument("waypoint arrays must have the same length");
+    }
+    result.reserve(road_id.size());
+    for (auto i = 0u; i < road_id.size(); ++i) {
+      result.emplace_back(carla::road::element::Waypoint{road_id[i], section_id[i], lane_id[i], s[i]});
+    }
+  } else if (PyObject_CheckBuffer(waypoints.ptr())) {
+    const auto bytes = ToVector<unsigned char>(waypoints, "Bbc");
+    if (bytes.size() % sizeof(PackedWaypoint) != 0u) {
+      throw std::invalid_argument("expected a buffer of packed waypoint records");
+    }
+    result.reserve(bytes.size() / sizeof(PackedWaypoint));
+    for (auto i = 0u; i < bytes.size(); i += sizeof(PackedWaypoint)) {
+      PackedWaypoint packed;
+      std::memcpy(&packed, bytes.data() + i, sizeof(packed));
+      result.emplace_back(carla::road::element::Waypoint{
+          packed.road_id,
+          packed.section_id,
+          packed.lane_id,
+          packed.s});
+    }
+  } else {
+    for (py::stl_input_iterator<carla::SharedPtr<carla::client::Waypoint>> it(waypoints), end; it != end; ++it) {
+      const auto &waypoint = **it;
+      result.emplace_back(carla::road::element::Waypoint{
+          waypoint.GetRoadId(),
+          waypoint.GetSectionId(),
+          waypoint.GetLaneId(),
+          waypoint.GetDistance()});
+    }
+  }
+  return result;
+}
+
+static boost::python::dict GenerateWaypointArrays(
+    const carla::client::Map &self,
+    double distance,
+    size_t worker_threads) {
+  carla::road::WaypointArrays arrays;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    arrays = self.GenerateWaypointArrays(distance, worker_threads);
+  }
+  return ToDict(arrays);
+}
+
+static boost::python::dict GetNextArrays(
+    const carla::client::Map &self,
+    const boost::python::object &waypoints,
+    double distance,
+    size_t worker_threads) {
+  const auto input = ToWaypointVector(waypoints);
+  carla::road::WaypointArrays arrays;
+  std::vector<size_t> offsets;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    arrays = self.GetNext(input, distance, offsets, worker_threads);
+  }
+  auto result = ToDict(arrays);
+  const std::vector<uint64_t> packed_offsets(offsets.begin(), offsets.end());
+  result["offsets"] = MakeBytes(packed_offsets);
+  return result;
+}
+
+static auto TraceRoute(
+    const carla::client::Map &self,
+    const carla::geom::Location &origin,
+    const carla::geom::Location &destination,
+    double distance,
+    carla::road::RoutePlanner::Algorithm algorithm) {
+  namespace py = boost::python;
+  carla::client::Map::RouteList route;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    route = self.TraceRoute(origin, destination, distance, algorithm);
+  }
+  py::list result;
+  for (auto &&item : route) {
+    result.append(py::make_tuple(item.first, item.second));
+  }
+  return result;
+}
+
+static auto TraceRoutes(
+    const carla::client::Map &self,
+    const boost::python::object &origins,
+    const boost::python::object &destinations,
+    double distance,
+    carla::road::RoutePlanner::Algorithm algorithm,
+    size_t worker_threads) {
+  namespace py = boost::python;
+  const auto origin_locations = ToLocationVector(origins);
+  const auto destination_locations = ToLocationVector(destinations);
+  if (origin_locations.size() != destination_locations.size()) {
+    throw std::invalid_argument("origins and destinations must have the same length");
+  }
+  std::vector<std::pair<carla::geom::Location, carla::geom::Location>> queries;
+  queries.reserve(origin_locations.size());
+  for (auto i = 0u; i < origin_locations.size(); ++i) {
+    queries.emplace_back(origin_locations[i], destination_locations[i]);
+  }
+  std::vector<carla::client::Map::RouteList> routes;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    routes = self.TraceRoutes(queries, distance, algorithm, worker_threads);
+  }
+  py::list result;
+  for (auto &&route : routes) {
+    py::list items;
+    for (auto &&item : route) {
+      items.append(py::make_tuple(item.first, item.second));
+    }
+    result.append(items);
+  }
+  return result;
+}
+
 static carla::geom::GeoLocation ToGeolocation(
     const carla::client::Map &self,
     const carla::geom::Location &location) {
@@ -121,6 +398,18 @@ void export_map() {
     .value("Grass", cre::LaneMarking::Type::Grass)
     .value("Curb", cre::LaneMarking::Type::Curb)
   ;
+
+  enum_<cr::RoutePlanner::Maneuver>("RouteManeuver")
+    .value("LaneFollow", cr::RoutePlanner::Maneuver::LaneFollow)
+    .value("ChangeLaneLeft", cr::RoutePlanner::Maneuver::ChangeLaneLeft)
+    .value("ChangeLaneRight", cr::RoutePlanner::Maneuver::ChangeLaneRight)
+  ;
+
+  enum_<cr::RoutePlanner::Algorithm>("RouteAlgorithm")
+    .value("AStar", cr::RoutePlanner::Algorithm::AStar)
+    .value("BidirectionalDijkstra", cr::RoutePlanner::Algorithm::BidirectionalDijkstra)
+    .value("ContractionHierarchy", cr::RoutePlanner::Algorithm::ContractionHierarchy)
+  ;
   // ===========================================================================
   // -- Map --------------------------------------------------------------------
   // ===========================================================================
@@ -130,8 +419,15 @@ void export_map() {
     .add_property("name", CALL_RETURNING_COPY(cc::Map, GetName))
     .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_waypoints", &GetWaypoints, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving, arg("worker_threads")=0u))
     .def("get_topology", &GetTopology)
     .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
+    .def("generate_waypoint_arrays", &GenerateWaypointArrays, (arg("distance"), arg("worker_threads")=0u))
+    .def("get_next_arrays", &GetNextArrays, (arg("waypoints"), arg("distance"), arg("worker_threads")=0u))
+    .def("set_lane_centerline_resolution", &cc::Map::SetLaneCenterlineResolution, (arg("resolution")))
+    .def("get_lane_centerline_resolution", &cc::Map::GetLaneCenterlineResolution)
+    .def("trace_route", &TraceRoute, (arg("origin"), arg("destination"), arg("distance")=2.0, arg("algorithm")=cr::RoutePlanner::Algorithm::AStar))
+    .def("trace_routes", &TraceRoutes, (arg("origins"), arg("destinations"), arg("distance")=2.0, arg("algorithm")=cr::RoutePlanner::Algorithm::ContractionHierarchy, arg("worker_threads")=0u))
     .def("transform_to_geolocation", &ToGeolocation, (arg("location")))
     .def("to_opendrive", CALL_RETURNING_COPY(cc::Map, GetOpenDrive))
     .def("save_to_disk", &SaveOpenDriveToDisk, (arg("path")=""))
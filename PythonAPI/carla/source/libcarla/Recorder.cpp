@@ -0,0 +1,282 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/PythonUtil.h>
+#include <carla/recorder/ColumnarRecording.h>
+#include <carla/recorder/Queries.h>
+#include <carla/recorder/Recording.h>
+
+#include <ostream>
+
+namespace carla {
+namespace recorder {
+
+  std::ostream &operator<<(std::ostream &out, const Recording &recording) {
+    out << "Recording(path=" << recording.GetPath()
+        << ", map=" << recording.GetInfo().map
+        << ", frames=" << std::to_string(recording.GetNumberOfFrames()) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const ColumnarRecording &recording) {
+    out << "ColumnarRecording(map=" << recording.GetInfo().map
+        << ", frames=" << std::to_string(recording.GetFrames().size())
+        << ", actors=" << std::to_string(recording.GetActors().size()) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const RecordingSummary &summary) {
+    out << "RecordingSummary(map=" << summary.info.map
+        << ", frames=" << std::to_string(summary.frames)
+        << ", duration=" << std::to_string(summary.duration) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const CollisionInfo &collision) {
+    out << "CollisionInfo(time=" << std::to_string(collision.time)
+        << ", actor1=" << std::to_string(collision.actor1)
+        << ", actor2=" << std::to_string(collision.actor2) << ')';
+    return out;
+  }
+
+  std::ostream &operator<<(std::ostream &out, const BlockedActorInfo &blocked) {
+    out << "BlockedActorInfo(time=" << std::to_string(blocked.time)
+        << ", actor_id=" << std::to_string(blocked.actor_id)
+        << ", duration=" << std::to_string(blocked.duration) << ')';
+    return out;
+  }
+
+} // namespace recorder
+} // namespace carla
+
+static const char *GetPacketName(const carla::recorder::PacketId id) {
+  using carla::recorder::PacketId;
+  switch (id) {
+    case PacketId::FrameStart:  return "frame_start";
+    case PacketId::FrameEnd:    return "frame_end";
+    case PacketId::EventAdd:    return "event_add";
+    case PacketId::EventDel:    return "event_del";
+    case PacketId::EventParent: return "event_parent";
+    case PacketId::Collision:   return "collision";
+    case PacketId::Position:    return "position";
+    case PacketId::State:       return "traffic_light_state";
+    case PacketId::AnimVehicle: return "vehicle_animation";
+    case PacketId::AnimWalker:  return "walker_animation";
+    case PacketId::Keyframe:    return "keyframe";
+    case PacketId::FrameIndex:  return "frame_index";
+    case PacketId::Block:       return "block";
+    default:                    return "unknown";
+  }
+}
+
+static boost::python::dict GetPacketCount(const carla::recorder::RecordingSummary &self) {
+  boost::python::dict result;
+  for (auto i = 0u; i < self.count.size(); ++i) {
+    result[GetPacketName(static_cast<carla::recorder::PacketId>(i))] = self.count[i];
+  }
+  return result;
+}
+
+static auto GetSummary(const carla::recorder::Recording &self, size_t worker_threads) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return carla::recorder::Queries::Summary(self, worker_threads);
+}
+
+static auto QueryCollisions(
+    const carla::recorder::Recording &self,
+    std::string category1,
+    std::string category2,
+    size_t worker_threads) {
+  if ((category1.size() != 1u) || (category2.size() != 1u)) {
+    throw std::invalid_argument("collision categories must be one of 'o', 'v', 'w', 't', 'h' or 'a'");
+  }
+  std::vector<carla::recorder::CollisionInfo> collisions;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    collisions = carla::recorder::Queries::Collisions(self, category1[0u], category2[0u], worker_threads);
+  }
+  boost::python::list result;
+  for (auto &&collision : collisions) {
+    result.append(collision);
+  }
+  return result;
+}
+
+static auto QueryBlockedActors(
+    const carla::recorder::Recording &self,
+    double min_time,
+    double min_distance,
+    size_t worker_threads) {
+  std::vector<carla::recorder::BlockedActorInfo> blocked;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    blocked = carla::recorder::Queries::BlockedActors(self, min_time, min_distance, worker_threads);
+  }
+  boost::python::list result;
+  for (auto &&actor : blocked) {
+    result.append(actor);
+  }
+  return result;
+}
+
+static void ExportColumns(
+    const carla::recorder::Recording &self,
+    const std::string &path,
+    size_t frames_per_chunk,
+    size_t worker_threads) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  carla::recorder::ColumnarRecording::Export(self, path, frames_per_chunk, worker_threads);
+}
+
+static const char *GetActorTypeName(const carla::recorder::ActorType type) {
+  using carla::recorder::ActorType;
+  switch (type) {
+    case ActorType::Vehicle:      return "vehicle";
+    case ActorType::Walker:       return "walker";
+    case ActorType::TrafficLight: return "traffic_light";
+    default:                      return "other";
+  }
+}
+
+static boost::python::object GetFrameIndex(uint32_t frame) {
+  using carla::recorder::ActorColumns;
+  return frame == ActorColumns::NO_FRAME ? boost::python::object() : boost::python::object(frame);
+}
+
+static boost::python::dict GetColumnarFrames(const carla::recorder::ColumnarRecording &self) {
+  const auto &frames = self.GetFrames();
+  boost::python::dict result;
+  result["id"] = MakeBytes(frames.id);
+  result["elapsed"] = MakeBytes(frames.elapsed);
+  result["duration"] = MakeBytes(frames.duration);
+  return result;
+}
+
+static boost::python::list GetColumnarActorIds(const carla::recorder::ColumnarRecording &self) {
+  boost::python::list result;
+  for (auto &&actor : self.GetActors()) {
+    result.append(actor.id);
+  }
+  return result;
+}
+
+/// Time series of an actor, each column a bytes object as in
+/// Map.get_waypoints; the frames are indices into get_frames.
+static boost::python::object GetColumnarActor(const carla::recorder::ColumnarRecording &self, uint32_t id) {
+  const auto *actor = self.GetActor(id);
+  if (actor == nullptr) {
+    return boost::python::object();
+  }
+  boost::python::dict positions;
+  positions["frame"] = MakeBytes(actor->positions.frame);
+  positions["location"] = MakeBytes(actor->positions.location);
+  positions["rotation"] = MakeBytes(actor->positions.rotation);
+  boost::python::dict vehicle_controls;
+  vehicle_controls["frame"] = MakeBytes(actor->vehicle_controls.frame);
+  vehicle_controls["steering"] = MakeBytes(actor->vehicle_controls.steering);
+  vehicle_controls["throttle"] = MakeBytes(actor->vehicle_controls.throttle);
+  vehicle_controls["brake"] = MakeBytes(actor->vehicle_controls.brake);
+  vehicle_controls["handbrake"] = MakeBytes(actor->vehicle_controls.handbrake);
+  vehicle_controls["gear"] = MakeBytes(actor->vehicle_controls.gear);
+  boost::python::dict walker;
+  walker["frame"] = MakeBytes(actor->walker.frame);
+  walker["speed"] = MakeBytes(actor->walker.speed);
+  boost::python::dict traffic_light;
+  traffic_light["frame"] = MakeBytes(actor->traffic_light.frame);
+  traffic_light["state"] = MakeBytes(actor->traffic_light.state);
+  traffic_light["is_frozen"] = MakeBytes(actor->traffic_light.is_frozen);
+  traffic_light["elapsed_time"] = MakeBytes(actor->traffic_light.elapsed_time);
+
+  boost::python::dict result;
+  result["id"] = actor->id;
+  result["type"] = GetActorTypeName(actor->type);
+  result["type_id"] = actor->type_id;
+  result["added_frame"] = GetFrameIndex(actor->added_frame);
+  result["removed_frame"] = GetFrameIndex(actor->removed_frame);
+  result["positions"] = positions;
+  result["vehicle_controls"] = vehicle_controls;
+  result["walker"] = walker;
+  result["traffic_light"] = traffic_light;
+  return result;
+}
+
+static auto QueryColumnarBlockedActors(
+    const carla::recorder::ColumnarRecording &self,
+    double min_time,
+    double min_distance) {
+  std::vector<carla::recorder::BlockedActorInfo> blocked;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    blocked = carla::recorder::Queries::BlockedActors(self, min_time, min_distance);
+  }
+  boost::python::list result;
+  for (auto &&actor : blocked) {
+    result.append(actor);
+  }
+  return result;
+}
+
+void export_recorder() {
+  using namespace boost::python;
+  namespace cr = carla::recorder;
+
+  class_<cr::RecordingSummary>("RecordingSummary", no_init)
+    .def_readonly("frames", &cr::RecordingSummary::frames)
+    .def_readonly("duration", &cr::RecordingSummary::duration)
+    .def_readonly("keyframes", &cr::RecordingSummary::keyframes)
+    .def_readonly("has_index", &cr::RecordingSummary::has_index)
+    .add_property("map", +[](const cr::RecordingSummary &self) { return self.info.map; })
+    .add_property("date", +[](const cr::RecordingSummary &self) { return static_cast<int64_t>(self.info.date); })
+    .add_property("packets", &GetPacketCount)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::CollisionInfo>("CollisionInfo", no_init)
+    .def_readonly("time", &cr::CollisionInfo::time)
+    .def_readonly("frame", &cr::CollisionInfo::frame)
+    .def_readonly("actor1", &cr::CollisionInfo::actor1)
+    .def_readonly("category1", &cr::CollisionInfo::category1)
+    .def_readonly("type_id1", &cr::CollisionInfo::type_id1)
+    .def_readonly("actor2", &cr::CollisionInfo::actor2)
+    .def_readonly("category2", &cr::CollisionInfo::category2)
+    .def_readonly("type_id2", &cr::CollisionInfo::type_id2)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::BlockedActorInfo>("BlockedActorInfo", no_init)
+    .def_readonly("time", &cr::BlockedActorInfo::time)
+    .def_readonly("actor_id", &cr::BlockedActorInfo::actor_id)
+    .def_readonly("type_id", &cr::BlockedActorInfo::type_id)
+    .def_readonly("duration", &cr::BlockedActorInfo::duration)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::Recording, boost::noncopyable, boost::shared_ptr<cr::Recording>>("Recording", no_init)
+    .def(init<std::string>((arg("path"))))
+    .add_property("path", CALL_RETURNING_COPY(cr::Recording, GetPath))
+    .add_property("map", +[](const cr::Recording &self) { return self.GetInfo().map; })
+    .add_property("has_index", &cr::Recording::HasIndex)
+    .add_property("frames", &cr::Recording::GetNumberOfFrames)
+    .add_property("keyframes", &cr::Recording::GetNumberOfKeyframes)
+    .add_property("duration", &cr::Recording::GetDuration)
+    .def("summary", &GetSummary, (arg("worker_threads")=0u))
+    .def("query_collisions", &QueryCollisions, (arg("category1")="a", arg("category2")="a", arg("worker_threads")=0u))
+    .def("query_blocked_actors", &QueryBlockedActors, (arg("min_time")=30.0, arg("min_distance")=1.0, arg("worker_threads")=0u))
+    .def("export_columns", &ExportColumns, (arg("path"), arg("frames_per_chunk")=cr::ColumnarRecording::DEFAULT_FRAMES_PER_CHUNK, arg("worker_threads")=0u))
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<cr::ColumnarRecording, boost::noncopyable, boost::shared_ptr<cr::ColumnarRecording>>("ColumnarRecording", no_init)
+    .def(init<std::string>((arg("path"))))
+    .add_property("map", +[](const cr::ColumnarRecording &self) { return self.GetInfo().map; })
+    .add_property("frames", +[](const cr::ColumnarRecording &self) { return self.GetFrames().size(); })
+    .add_property("actor_ids", &GetColumnarActorIds)
+    .def("get_frames", &GetColumnarFrames)
+    .def("get_actor", &GetColumnarActor, (arg("actor_id")))
+    .def("query_blocked_actors", &QueryColumnarBlockedActors, (arg("min_time")=30.0, arg("min_distance")=1.0))
+    .def(self_ns::str(self_ns::self))
+  ;
+}
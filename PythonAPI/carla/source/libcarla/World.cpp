@@ -26,6 +26,18 @@ namespace client {
     return out;
   }
 
+  std::ostream &operator<<(std::ostream &out, const TickCallbackStatistics &statistics) {
+    out << "TickCallbackStatistics(id=" << std::to_string(statistics.id)
+        << ",calls=" << std::to_string(statistics.calls)
+        << ",pending=" << std::to_string(statistics.pending)
+        << ",dropped=" << std::to_string(statistics.dropped)
+        << ",exceptions=" << std::to_string(statistics.exceptions)
+        << ",last_frame=" << std::to_string(statistics.last_frame)
+        << ",max_microseconds=" << std::to_string(statistics.max_microseconds)
+        << ",total_microseconds=" << std::to_string(statistics.total_microseconds) << ')';
+    return out;
+  }
+
   std::ostream &operator<<(std::ostream &out, const World &world) {
     out << "World(id=" << world.GetId() << ')';
     return out;
@@ -95,6 +107,19 @@ void export_world() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  class_<cc::TickCallbackStatistics>("TickCallbackStatistics", no_init)
+    .def_readonly("id", &cc::TickCallbackStatistics::id)
+    .def_readonly("calls", &cc::TickCallbackStatistics::calls)
+    .def_readonly("pending", &cc::TickCallbackStatistics::pending)
+    .def_readonly("dropped", &cc::TickCallbackStatistics::dropped)
+    .def_readonly("exceptions", &cc::TickCallbackStatistics::exceptions)
+    .def_readonly("last_frame", &cc::TickCallbackStatistics::last_frame)
+    .def_readonly("last_microseconds", &cc::TickCallbackStatistics::last_microseconds)
+    .def_readonly("max_microseconds", &cc::TickCallbackStatistics::max_microseconds)
+    .def_readonly("total_microseconds", &cc::TickCallbackStatistics::total_microseconds)
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<cr::EpisodeSettings>("WorldSettings")
     .def(init<bool, bool, double>(
         (arg("synchronous_mode")=false,
@@ -155,6 +180,9 @@ void export_world() {
     .def("wait_for_tick", &WaitForTick, (arg("seconds")=10.0))
     .def("on_tick", &OnTick, (arg("callback")))
     .def("remove_on_tick", &cc::World::RemoveOnTick, (arg("callback_id")))
+    .def("set_tick_worker_threads", CALL_WITHOUT_GIL_1(cc::World, SetTickWorkerThreads, size_t), (arg("worker_threads")))
+    .def("get_tick_worker_threads", &cc::World::GetTickWorkerThreads)
+    .def("get_tick_callback_statistics", CALL_RETURNING_LIST(cc::World, GetTickCallbackStatistics))
     .def("tick", CALL_WITHOUT_GIL(cc::World, Tick))
     .def(self_ns::str(self_ns::self))
   ;
@@ -180,6 +180,7 @@ static auto MakeCallback(boost::python::object callback) {
 #include "Control.cpp"
 #include "Exception.cpp"
 #include "Map.cpp"
+#include "Recorder.cpp"
 #include "Sensor.cpp"
 #include "SensorData.cpp"
 #include "Snapshot.cpp"
@@ -201,6 +202,7 @@ BOOST_PYTHON_MODULE(libcarla) {
   export_weather();
   export_world();
   export_map();
+  export_recorder();
   export_client();
   export_exception();
   export_commands();
@@ -56,9 +56,17 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
   {
     const auto StreamingPort = Settings.StreamingPort.Get(Settings.RPCPort + 1u);
     auto BroadcastStream = Server.Start(Settings.RPCPort, StreamingPort);
-    Server.AsyncRun(FCarlaEngine_GetNumberOfThreadsForRPCServer());
+    Server.SetStreamingQueue(Settings);
 
     WorldObserver.SetStream(BroadcastStream);
+    if (Settings.bEpisodeDeltaEncoding)
+    {
+      WorldObserver.EnableDeltaEncoding(Settings.EpisodeKeyframeInterval);
+    }
+    // Run in the game-thread by FCarlaServer::RunSome, WorldObserver is alive.
+    Server.SetOnEpisodeKeyframeRequest([this]() { WorldObserver.SendKeyframe(); });
+
+    Server.AsyncRun(FCarlaEngine_GetNumberOfThreadsForRPCServer());
 
     OnPreTickHandle = FWorldDelegates::OnWorldTickStart.AddRaw(
         this,
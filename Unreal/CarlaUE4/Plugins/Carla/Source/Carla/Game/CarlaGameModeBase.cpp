@@ -90,6 +90,12 @@ void ACarlaGameModeBase::InitGame(
   // make connection between Episode and Recorder
   Recorder->SetEpisode(Episode);
   Episode->SetRecorder(Recorder);
+
+  const auto &Settings = GameInstance->GetCarlaSettings();
+  Recorder->SetCompression(Settings.bRecorderCompression ?
+      CarlaRecorderCompression::Zlib :
+      CarlaRecorderCompression::None);
+  Recorder->SetWriterQueueSize(Settings.RecorderQueueSize);
 }
 
 void ACarlaGameModeBase::RestartPlayer(AController *NewPlayer)
@@ -6,33 +6,59 @@
 #include "Runtime/Core/Public/Misc/Paths.h"
 #include "Runtime/Engine/Classes/Kismet/KismetMathLibrary.h"
 #include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "Async/Async.h"
+#include "Misc/ScopeLock.h"
 
 // Carla
 #include "Vehicle/WheeledVehicleAIController.h"
 
 
-// Clingo staticly linked library
-THIRD_PARTY_INCLUDES_START
-#pragma push_macro("check")
-#undef check
-#include <clingo.hh>
-#pragma pop_macro("check")
-THIRD_PARTY_INCLUDES_END
-
-
 // Developer
 #include "Fork.h"
 
 
 // STL
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
 
+// Apply the changes of a batch and solve, may run on a worker thread
+static FMonitorSolveOutcome RunSolver(
+	FMonitorSolver& Solver,
+	const std::vector<FMonitorEventChange>& Changes,
+	const std::vector<std::string>& TrackedVehicles)
+{
+	FMonitorSolveOutcome Outcome;
+	for (const FMonitorEventChange& Change : Changes)
+	{
+		if (Change.bRemoveVehicle)
+		{
+			Solver.RemoveVehicle(Change.Event.Vehicle);
+		}
+		else
+		{
+			Solver.AddEvent(Change.Event);
+		}
+	}
+	try {
+		Outcome.Result = Solver.Solve(TrackedVehicles);
+	}
+	catch (std::exception const &e) {
+		Outcome.Error = e.what();
+	}
+	return Outcome;
+}
+
+
 // Sets default values
 AMonitor::AMonitor(const FObjectInitializer &ObjectInitializer)
 	:Super(ObjectInitializer)
 {
+	PrimaryActorTick.bCanEverTick = true;
+	// Overlap events are generated during physics, solve them in the same frame
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
 	RootComponent =
 		ObjectInitializer.CreateDefaultSubobject<USceneComponent>(this, TEXT("SceneRootComponent"));
 	RootComponent->SetMobility(EComponentMobility::Static);
@@ -92,6 +118,47 @@ void AMonitor::BeginPlay()
 	WriteGeometryToFile();
 
 	LoadTrafficRules();
+
+	CreateSolver();
+}
+
+
+void AMonitor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// The solver must outlive the solve in progress
+	if (SolveInProgress.IsValid())
+	{
+		SolveInProgress.Wait();
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+
+void AMonitor::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	TimeSinceLastSolve += DeltaSeconds;
+	if (SolveInProgress.IsValid())
+	{
+		if (SolveInProgress.IsReady())
+		{
+			const FMonitorSolveOutcome Outcome = SolveInProgress.Get();
+			SolveInProgress = TFuture<FMonitorSolveOutcome>();
+			ApplyOutcome(Outcome);
+		}
+		else if (!bDeadlineMissed && FPlatformTime::Seconds() - SolveStartTime > SolveDeadline)
+		{
+			bDeadlineMissed = true;
+			++DeadlinesMissed;
+			ApplyFallback();
+		}
+	}
+	// New events wait for the solve in progress
+	if (!SolveInProgress.IsValid() && PendingSolveRequests > 0 && TimeSinceLastSolve >= SolveInterval)
+	{
+		Solve();
+	}
 }
 
 
@@ -250,12 +317,45 @@ void AMonitor::LoadTrafficRules()
 }
 
 
-void AMonitor::AddEvent(FString Actor, FString Atom)
+void AMonitor::CreateSolver()
 {
-	// TODO: Use TimeStep to buffer concurrent events
-	FString& PreviousAtoms = ActorToEventsMap.FindOrAdd(Actor);
-	PreviousAtoms += Atom + "\n";
-	UE_LOG(LogTemp, Warning, TEXT("Event: %s"), *Atom);
+	FMonitorSolver::FSettings Settings;
+	Settings.Mode = bIncrementalSolving ? FMonitorSolver::EMode::Incremental : FMonitorSolver::EMode::FromScratch;
+	Settings.MaxVehicles = FMath::Max(MaxVehicles, 1);
+	Settings.MaxTimeSteps = FMath::Max(MaxTimeSteps, 1);
+	Settings.EventHorizon = FMath::CeilToInt(EventHorizon / TimeResolution);
+	try {
+		Solver = MakeUnique<FMonitorSolver>(Geometry, TrafficRules, Settings);
+	}
+	catch (std::exception const &e) {
+		UE_LOG(LogTemp, Warning, TEXT("Clingo failed to ground the incremental program, solving from scratch: %s"), ANSI_TO_TCHAR(e.what()));
+		Settings.Mode = FMonitorSolver::EMode::FromScratch;
+		Solver = MakeUnique<FMonitorSolver>(Geometry, TrafficRules, Settings);
+	}
+}
+
+
+void AMonitor::AddEvent(
+	FMonitorSolver::EEvent Type,
+	const FString &Vehicle,
+	const FString &Place,
+	int32 TimeStep,
+	const FString &Signal)
+{
+	FMonitorEventChange Change{ false, { Type, TCHAR_TO_UTF8(*Vehicle), TCHAR_TO_UTF8(*Place), TCHAR_TO_UTF8(*Signal), TimeStep } };
+	const std::string Atom = FMonitorSolver::ToString(Change.Event);
+	if (bWriteEventLog)
+	{
+		AppendToLogfile(Atom);
+	}
+	PendingChanges.push_back(std::move(Change));
+	UE_LOG(LogTemp, Warning, TEXT("Event: %s"), UTF8_TO_TCHAR(Atom.c_str()));
+}
+
+
+void AMonitor::RequestSolve()
+{
+	++PendingSolveRequests;
 }
 
 
@@ -286,30 +386,22 @@ void AMonitor::OnArrival(
 	int32 TimeStep = FMath::FloorToInt(GetWorld()->GetTimeSeconds() / TimeResolution);
 	FString ArrivingVehicleID = "v_" + OtherActor->GetName();
 	FString Fork = "f_" + OverlappedComp->GetOwner()->GetName();
-	FString Atom = "arrivedAtForkAtTime("
-		+ ArrivingVehicleID + ", "
-		+ Fork + ", "
-		+ FString::FromInt(TimeStep) + ").";
-	AddEvent(OtherActor->GetName(), Atom);
+	AddEvent(FMonitorSolver::EEvent::ArrivedAtFork, ArrivingVehicleID, Fork, TimeStep);
 
 	ACarlaWheeledVehicle* ArrivingVehicle = Cast<ACarlaWheeledVehicle>(OtherActor);
 	if (ArrivingVehicle != nullptr)
 	{
 		FString SignalString = SignalToString(ArrivingVehicle->GetSignalState());
-		Atom = "signaledAtForkAtTime("
-			+ ArrivingVehicleID + ", "
-			+ SignalString + ", "
-			+ Fork + ", "
-			+ FString::FromInt(TimeStep) + ").";
-		AddEvent(OtherActor->GetName(), Atom);
+		AddEvent(FMonitorSolver::EEvent::SignaledAtFork, ArrivingVehicleID, Fork, TimeStep, SignalString);
 		VehiclePointers.Add(OtherActor->GetName(), ArrivingVehicle);
+		WaitingVehicles.Add(OtherActor->GetName());
 	}
 	else
 	{
 		UE_LOG(LogTemp, Warning, TEXT("Cast to ACarlaWheeledVehicle failed!"));
 	}
 
-	Solve();
+	RequestSolve();
 }
 
 
@@ -321,16 +413,12 @@ void AMonitor::OnEntrance(
 	bool bFromSweep,
 	const FHitResult& SweepResult)
 {
-	uint32 TimeStep = FMath::FloorToInt(GetWorld()->GetTimeSeconds() / TimeResolution);
+	int32 TimeStep = FMath::FloorToInt(GetWorld()->GetTimeSeconds() / TimeResolution);
 	FString EnteringVehicle = "v_" + OtherActor->GetName();
 	FString Fork = "f_" + OverlappedComp->GetOwner()->GetName();
-	FString Atom = "enteredForkAtTime("
-		+ EnteringVehicle + ", "
-		+ Fork + ", "
-		+ FString::FromInt(TimeStep) + ").";
-
-	AddEvent(OtherActor->GetName(), Atom);
-	Solve();
+	AddEvent(FMonitorSolver::EEvent::EnteredFork, EnteringVehicle, Fork, TimeStep);
+	WaitingVehicles.Remove(OtherActor->GetName());
+	RequestSolve();
 }
 
 
@@ -339,12 +427,8 @@ void AMonitor::OnEnterLane(AActor* ThisActor, AActor* OtherActor)
 	int32 TimeStep = FMath::FloorToInt(GetWorld()->GetTimeSeconds() / TimeResolution);
 	FString EnteringActorName = "v_" + OtherActor->GetName();
 	FString LaneName = "l_" + ThisActor->GetName();
-	FString Atom = "enteredLaneAtTime("
-		+ EnteringActorName + ", "
-		+ LaneName + ", "
-		+ FString::FromInt(TimeStep) + ").";
-	AddEvent(OtherActor->GetName(), Atom);
-	Solve();
+	AddEvent(FMonitorSolver::EEvent::EnteredLane, EnteringActorName, LaneName, TimeStep);
+	RequestSolve();
 }
 
 
@@ -353,12 +437,8 @@ void AMonitor::OnExitLane(AActor* ThisActor, AActor* OtherActor)
 	int32 TimeStep = FMath::FloorToInt(GetWorld()->GetTimeSeconds() / TimeResolution);
 	FString ExitingActorName = "v_" + OtherActor->GetName();
 	FString LaneName = "l_" + ThisActor->GetName();
-	FString Atom = "leftLaneAtTime("
-		+ ExitingActorName + ", "
-		+ LaneName + ", "
-		+ FString::FromInt(TimeStep) + ").";
-	AddEvent(OtherActor->GetName(), Atom);
-	Solve();
+	AddEvent(FMonitorSolver::EEvent::LeftLane, ExitingActorName, LaneName, TimeStep);
+	RequestSolve();
 }
 
 void AMonitor::OnExitIntersection(
@@ -370,12 +450,8 @@ void AMonitor::OnExitIntersection(
 	int32 TimeStep = FMath::FloorToInt(GetWorld()->GetTimeSeconds() / TimeResolution);
 	FString ExitingActorName = "v_" + OtherActor->GetName();
 	FString ExitName = "e_" + OverlappedComp->GetOwner()->GetName();
-	FString Atom = "exitedFromAtTime("
-		+ ExitingActorName + ", "
-		+ ExitName + ", "
-		+ FString::FromInt(TimeStep) + ").";
-	AddEvent(OtherActor->GetName(), Atom);
-	Solve();
+	AddEvent(FMonitorSolver::EEvent::ExitedFrom, ExitingActorName, ExitName, TimeStep);
+	RequestSolve();
 }
 
 void AMonitor::OnExitMonitor(
@@ -384,87 +460,147 @@ void AMonitor::OnExitMonitor(
 	UPrimitiveComponent* OtherComp,
 	int32 OtherBodyIndex)
 {
-	ActorToEventsMap.Remove(OtherActor->GetName());
+	// Removed after its pending events, in the same batch
+	std::string VehicleName = TCHAR_TO_UTF8(*("v_" + OtherActor->GetName()));
+	if (bWriteEventLog)
+	{
+		AppendToLogfile("%remove " + VehicleName);
+	}
+	FMonitorEventChange Change{ true, {} };
+	Change.Event.Vehicle = std::move(VehicleName);
+	PendingChanges.push_back(std::move(Change));
 	VehiclePointers.Remove(OtherActor->GetName());
+	WaitingVehicles.Remove(OtherActor->GetName());
 	UE_LOG(LogTemp, Warning, TEXT("%s removed from monitor!"), *OtherActor->GetName());
+	// The vehicles waiting behind it may now be allowed to enter
+	RequestSolve();
 }
 
 
 std::string AMonitor::GetEventsString()
 {
-	FString EventsString;
-	for (auto& Pair : ActorToEventsMap)
-	{
-		EventsString += Pair.Value;
-	}
-	return std::string(TCHAR_TO_ANSI(*EventsString));
+	FScopeLock Lock(&SolverMutex);
+	return Solver != nullptr ? Solver->GetEventsString() : std::string();
 }
 
 
 void AMonitor::Solve()
 {
-	try {
-		Clingo::Logger logger = [](Clingo::WarningCode, char const *message) {
-			//UE_LOG(LogTemp, Warning, TEXT("Clingo logger message: %s"), ANSI_TO_TCHAR(message));
-		};
-
-		//std::string ProgramTitle = "#program time_" 
-		//	+ std::to_string(FMath::FloorToInt(GetWorld()->GetTimeSeconds() * 1000))
-		//	+ ".\n";
-		std::string EventsString = GetEventsString();
-		//AppendToLogfile(ProgramTitle + EventsString);
-
-		// Without the "-n 0" option, at most one model is found.
-		Clingo::Control ctl{ {}, logger, 20 };
-
-		ctl.add("base", {}, EventsString.c_str());
-		ctl.add("base", {}, Geometry.c_str());
-		ctl.add("base", {}, TrafficRules.c_str());
-
-		ctl.ground({ {"base", {}} });
-		auto solveHandle = ctl.solve();
-		auto solveResult = solveHandle.get();
-		if (solveResult.is_unsatisfiable())
+	const int32 NumberOfEvents = static_cast<int32>(std::count_if(PendingChanges.begin(), PendingChanges.end(), [](const FMonitorEventChange& Change) {
+		return !Change.bRemoveVehicle;
+	}));
+	EventsCoalesced += FMath::Max(NumberOfEvents - 1, 0);
+	SolvesSkipped += FMath::Max(PendingSolveRequests - 1, 0);
+	PendingSolveRequests = 0;
+	TimeSinceLastSolve = 0.0f;
+
+	std::vector<FMonitorEventChange> Changes;
+	Changes.swap(PendingChanges);
+	if (Solver == nullptr)
+	{
+		return;
+	}
+	if (bWriteEventLog)
+	{
+		AppendToLogfile("%solve");
+	}
+
+	// The event horizon must not forget the vehicles still waiting or driving through
+	std::vector<std::string> TrackedVehicles;
+	if (EventHorizon > 0.0f)
+	{
+		for (const auto& Pair : VehiclePointers)
 		{
-			UE_LOG(LogTemp, Error, TEXT("Not satisfiable!"));
+			TrackedVehicles.emplace_back(TCHAR_TO_UTF8(*("v_" + Pair.Key)));
 		}
-		if (solveResult.is_unknown())
+		for (const FString& VehicleName : WaitingVehicles)
 		{
-			UE_LOG(LogTemp, Error, TEXT("Satisfiability is unknown!"));
+			TrackedVehicles.emplace_back(TCHAR_TO_UTF8(*("v_" + VehicleName)));
 		}
+	}
 
-		for (auto &model : solveHandle) {
-			FString Model;
-			for (auto &atom : model.symbols()) {
-				if (atom.match("mustStopToYield", 1))
-				{
-					FString VehicleName = FString(atom.arguments()[0].name()).RightChop(2); // Chop "v_" off of the name
-					StopVehicle(VehicleName);
-				}
-				else if (atom.match("mustSlowToYield", 1))
-				{
-					FString VehicleName = FString(atom.arguments()[0].name()).RightChop(2);
-					SlowVehicle(VehicleName);
-				}
-				else if (atom.match("needNotStop", 1))
-				{
-					FString VehicleName = FString(atom.arguments()[0].name()).RightChop(2);
-					UnstopVehicle(VehicleName);
-				}
-				else if (atom.match("needNotSlow", 1))
-				{
-					FString VehicleName = FString(atom.arguments()[0].name()).RightChop(2);
-					UnslowVehicle(VehicleName);
-				}
-				FString AtomString(atom.to_string().c_str());
-				Model.Append("\t" + AtomString + "\n");
-			}
-			UE_LOG(LogTemp, Error, TEXT("Clingo Model:\n%s\n"), *Model);
+	auto Job = [this, Changes = std::move(Changes), TrackedVehicles = std::move(TrackedVehicles)]() {
+		FScopeLock Lock(&SolverMutex);
+		return RunSolver(*Solver, Changes, TrackedVehicles);
+	};
+	if (bAsyncSolving)
+	{
+		SolveStartTime = FPlatformTime::Seconds();
+		bDeadlineMissed = false;
+		SolveInProgress = Async(EAsyncExecution::ThreadPool, MoveTemp(Job));
+	}
+	else
+	{
+		ApplyOutcome(Job());
+	}
+}
+
+
+void AMonitor::ApplyOutcome(const FMonitorSolveOutcome &Outcome)
+{
+	if (!Outcome.Error.empty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Clingo failed with: %s"), UTF8_TO_TCHAR(Outcome.Error.c_str()));
+		return;
+	}
+
+	const FMonitorSolver::FResult& Result = Outcome.Result;
+	if (Result.Satisfiability == FMonitorSolver::ESatisfiability::Unsatisfiable)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Not satisfiable!"));
+	}
+	if (Result.Satisfiability == FMonitorSolver::ESatisfiability::Unknown)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Satisfiability is unknown!"));
+	}
+	if (Result.Satisfiability != FMonitorSolver::ESatisfiability::Satisfiable)
+	{
+		return;
+	}
 
+	FString Model;
+	for (const FMonitorSolver::FAtom &Atom : Result.Model)
+	{
+		if (Atom.Arguments.size() == 1u)
+		{
+			FString VehicleName = FString(UTF8_TO_TCHAR(Atom.Arguments[0].c_str())).RightChop(2); // Chop "v_" off of the name
+			if (Atom.Name == "mustStopToYield")
+			{
+				StopVehicle(VehicleName);
+			}
+			else if (Atom.Name == "mustSlowToYield")
+			{
+				SlowVehicle(VehicleName);
+			}
+			else if (Atom.Name == "needNotStop")
+			{
+				UnstopVehicle(VehicleName);
+			}
+			else if (Atom.Name == "needNotSlow")
+			{
+				UnslowVehicle(VehicleName);
+			}
 		}
+		FString AtomString(UTF8_TO_TCHAR(Atom.Text.c_str()));
+		Model.Append("\t" + AtomString + "\n");
 	}
-	catch (std::exception const &e) {
-		UE_LOG(LogTemp, Warning, TEXT("Clingo failed with: %s"), ANSI_TO_TCHAR(e.what()));
+	UE_LOG(LogTemp, Error, TEXT("Clingo Model:\n%s\n"), *Model);
+}
+
+
+void AMonitor::ApplyFallback()
+{
+	UE_LOG(LogTemp, Warning, TEXT("%s: solve missed the deadline of %f seconds"), *GetName(), SolveDeadline);
+	switch (FallbackPolicy)
+	{
+	case EMonitorSolveFallback::StopWaitingVehicles:
+		for (const FString& VehicleName : WaitingVehicles)
+		{
+			StopVehicle(VehicleName);
+		}
+		break;
+	default:
+		break;
 	}
 }
 
@@ -502,6 +638,12 @@ FString AMonitor::SignalToString(EVehicleSignalState Signal)
 
 void AMonitor::StopVehicle(FString VehicleName)
 {
+	// The decisions of a solve may arrive after the vehicle left
+	if (!VehiclePointers.Contains(VehicleName))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s not found in VehiclePointers!"), *VehicleName);
+		return;
+	}
 	ACarlaWheeledVehicle* YieldingVehicle = VehiclePointers[VehicleName];
 	AWheeledVehicleAIController* Controller = Cast<AWheeledVehicleAIController>(YieldingVehicle->GetController());
 	if (Controller != nullptr)
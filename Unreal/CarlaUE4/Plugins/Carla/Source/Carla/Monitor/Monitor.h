@@ -7,12 +7,43 @@
 #include "Runtime/Engine/Classes/Components/StaticMeshComponent.h"
 #include "Runtime/Engine/Classes/Components/BillboardComponent.h"
 #include "Runtime/Engine/Classes/Components/BoxComponent.h"
+#include "Async/Future.h"
+#include "HAL/CriticalSection.h"
 
 // STL
 #include <iostream>
+#include <string>
+#include <vector>
+
+// Developer
+#include "MonitorSolver.h"
 
 #include "Monitor.generated.h"
 
+UENUM()
+enum class EMonitorSolveFallback : uint8
+{
+	// Keep the decisions of the last model until the solver catches up
+	KeepLastDecisions,
+	// Stop the vehicles waiting to enter the intersection until the solver catches up
+	StopWaitingVehicles
+};
+
+// A change to the events of the solver, applied in the order received
+struct FMonitorEventChange
+{
+	bool bRemoveVehicle;
+	// Event to add, or whose vehicle to remove
+	FMonitorSolver::FEvent Event;
+};
+
+// Result of a solve, possibly computed on a worker thread
+struct FMonitorSolveOutcome
+{
+	FMonitorSolver::FResult Result;
+	std::string Error;
+};
+
 UCLASS()
 class CARLA_API AMonitor : public AActor
 {
@@ -27,8 +58,19 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Waits for the solve running on a worker thread
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
-	void AddEvent(FString Actor, FString Atom);
+	// Called every frame, solves the events collected since the last solve
+	virtual void Tick(float DeltaSeconds) override;
+
+	void AddEvent(
+		FMonitorSolver::EEvent Type,
+		const FString &Vehicle,
+		const FString &Place,
+		int32 TimeStep,
+		const FString &Signal = FString());
 	std::string GetEventsString();
 
 	UFUNCTION()
@@ -81,14 +123,66 @@ public:
 	UPROPERTY(EditAnywhere)
 	FString RulesFilename = "uncontrolled-intersection.cl";
 
+	// Ground geometry and rules once and only update the events on each solve
+	UPROPERTY(EditAnywhere)
+	bool bIncrementalSolving = true;
+
+	// Vehicles inside the monitor at the same time supported by incremental solving
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1", EditCondition = "bIncrementalSolving"))
+	int32 MaxVehicles = 8;
+
+	// Distinct time steps of each event supported by incremental solving
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1", EditCondition = "bIncrementalSolving"))
+	int32 MaxTimeSteps = 16;
+
+	// Seconds between solves, if zero the events collected during a tick are solved at the end of it
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0"))
+	float SolveInterval = 0.0f;
+
+	// Events solved together with other events of the same batch
+	UPROPERTY(VisibleInstanceOnly)
+	int32 EventsCoalesced = 0;
+
+	// Solve requests served by a solve of the same batch
+	UPROPERTY(VisibleInstanceOnly)
+	int32 SolvesSkipped = 0;
+
+	// Solve on a worker thread and apply the decisions on the game thread once ready
+	UPROPERTY(EditAnywhere)
+	bool bAsyncSolving = true;
+
+	// Seconds a solve running on a worker thread may take before applying the fallback policy
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0", EditCondition = "bAsyncSolving"))
+	float SolveDeadline = 0.1f;
+
+	UPROPERTY(EditAnywhere, meta = (EditCondition = "bAsyncSolving"))
+	EMonitorSolveFallback FallbackPolicy = EMonitorSolveFallback::StopWaitingVehicles;
+
+	// Solves that missed the deadline
+	UPROPERTY(VisibleInstanceOnly)
+	int32 DeadlinesMissed = 0;
+
+	// Seconds after which the events of a vehicle that is no longer tracked are forgotten, zero (default) to keep
+	// them until it leaves the monitor. Vehicles waiting to enter or driving through are never forgotten
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "0.0"))
+	float EventHorizon = 0.0f;
+
+	// Write events, removals and solves to Saved/<Monitor>Log.cl, to replay them with Examples/MonitorBenchmark
+	UPROPERTY(EditAnywhere)
+	bool bWriteEventLog = false;
+
 private:
 	void CreateLogFile();
 	void SetupTriggers();
 	void LoadGeometryFacts();
 	void WriteGeometryToFile();
 	void LoadTrafficRules();
+	void CreateSolver();
 	void AppendToLogfile(std::string EventMessage);
+	void RequestSolve();
 	void Solve();
+	void ApplyOutcome(const FMonitorSolveOutcome &Outcome);
+	void ApplyFallback();
 	FString SignalToString(EVehicleSignalState Signal);
 
 	template <class ActorClass>
@@ -103,10 +197,25 @@ private:
 	FString LogFileFullName;
 	size_t NumberOfForks;
 
-	TMap<FString, FString> ActorToEventsMap;
-
 	std::string Geometry;
 	std::string TrafficRules;
 
+	// Only accessed by the solve in progress, and under SolverMutex
+	TUniquePtr<FMonitorSolver> Solver;
+	FCriticalSection SolverMutex;
+
+	// Changes of the current batch, not yet applied to the solver
+	std::vector<FMonitorEventChange> PendingChanges;
+	int32 PendingSolveRequests = 0;
+	float TimeSinceLastSolve = 0.0f;
+
+	// Solve in progress on a worker thread
+	TFuture<FMonitorSolveOutcome> SolveInProgress;
+	double SolveStartTime = 0.0;
+	bool bDeadlineMissed = false;
+
+	// Vehicles that arrived at a fork and did not enter the intersection yet
+	TSet<FString> WaitingVehicles;
+
 	TMap<FString, class ACarlaWheeledVehicle*> VehiclePointers;
 };
@@ -0,0 +1,507 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma de Barcelona (UAB). This work is licensed under the terms of the MIT license. For a copy, see <https://opensource.org/licenses/MIT>.
+
+
+#include "MonitorSolver.h"
+
+
+// Clingo staticly linked library
+#ifdef THIRD_PARTY_INCLUDES_START
+THIRD_PARTY_INCLUDES_START
+#endif
+#pragma push_macro("check")
+#undef check
+#include <clingo.hh>
+#pragma pop_macro("check")
+#ifdef THIRD_PARTY_INCLUDES_END
+THIRD_PARTY_INCLUDES_END
+#endif
+
+
+// STL
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#include <utility>
+
+
+namespace
+{
+	using FSymbols = std::vector<Clingo::Symbol>;
+
+	/// Event predicates reported by the monitor, in the order of EEvent, with
+	/// the domain of the arguments between the vehicle and the time step.
+	struct FEventSignature
+	{
+		const char* Name;
+		std::vector<const char*> Domains;
+	};
+
+	const FEventSignature EventSignatures[] = {
+		{ "arrivedAtForkAtTime", { "monitorFork" } },
+		{ "signaledAtForkAtTime", { "monitorSignal", "monitorFork" } },
+		{ "enteredForkAtTime", { "monitorFork" } },
+		{ "enteredLaneAtTime", { "monitorLane" } },
+		{ "leftLaneAtTime", { "monitorLane" } },
+		{ "exitedFromAtTime", { "monitorExit" } }
+	};
+
+	const char* VehicleSlotName = "vehicleSlot";
+
+	Clingo::Symbol MakeSymbol(const FMonitorSolver::FEvent& Event)
+	{
+		const FEventSignature& Signature = EventSignatures[static_cast<size_t>(Event.Type)];
+		FSymbols Arguments;
+		Arguments.reserve(4u);
+		Arguments.emplace_back(Clingo::Id(Event.Vehicle.c_str()));
+		if (Event.Type == FMonitorSolver::EEvent::SignaledAtFork)
+		{
+			Arguments.emplace_back(Clingo::Id(Event.Signal.c_str()));
+		}
+		Arguments.emplace_back(Clingo::Id(Event.Place.c_str()));
+		Arguments.emplace_back(Clingo::Number(Event.TimeStep));
+		return Clingo::Function(Signature.Name, { Arguments.data(), Arguments.size() });
+	}
+
+	void IgnoreMessage(Clingo::WarningCode, char const*)
+	{
+	}
+
+	Clingo::Symbol MakeVehicleSlot(size_t Slot)
+	{
+		return Clingo::Function(VehicleSlotName, { Clingo::Number(static_cast<int>(Slot)) });
+	}
+
+	/// Declares as external every event atom over the vehicle slots, the
+	/// forks, lanes and exits of the geometry and the ranked time steps.
+	std::string MakeDomainProgram(const FMonitorSolver::FSettings& Settings)
+	{
+		std::ostringstream Program;
+		Program << "monitorVehicle(" << VehicleSlotName << "(I)) :- I = 0.." << Settings.MaxVehicles - 1u << ".\n";
+		Program << "monitorTime(0.." << Settings.MaxTimeSteps - 1u << ").\n";
+		Program << "monitorFork(Fork) :- laneFromTo(_, Fork, _).\n";
+		Program << "monitorLane(Lane) :- laneFromTo(Lane, _, _).\n";
+		Program << "monitorExit(Exit) :- laneFromTo(_, _, Exit).\n";
+		Program << "monitorSignal(left; right; emergency; off).\n";
+		for (const FEventSignature& Signature : EventSignatures)
+		{
+			Program << "#external " << Signature.Name << "(Vehicle";
+			for (size_t i = 0u; i < Signature.Domains.size(); ++i)
+			{
+				Program << ", X" << i;
+			}
+			Program << ", Time) : monitorVehicle(Vehicle)";
+			for (size_t i = 0u; i < Signature.Domains.size(); ++i)
+			{
+				Program << ", " << Signature.Domains[i] << "(X" << i << ")";
+			}
+			Program << ", monitorTime(Time).\n";
+		}
+		return Program.str();
+	}
+
+	FMonitorSolver::FAtom MakeAtom(Clingo::Symbol Symbol)
+	{
+		FMonitorSolver::FAtom Atom;
+		Atom.Name = Symbol.name();
+		for (Clingo::Symbol Argument : Symbol.arguments())
+		{
+			Atom.Arguments.emplace_back(Argument.to_string());
+		}
+		Atom.Text = Symbol.to_string();
+		return Atom;
+	}
+
+	/// Runs the search and keeps the last model found. @a Translate is
+	/// applied to every symbol of the model.
+	template <typename TranslateF>
+	FMonitorSolver::FResult GetResult(Clingo::Control& Control, TranslateF&& Translate)
+	{
+		FMonitorSolver::FResult Result;
+		auto Handle = Control.solve();
+		for (auto& Model : Handle)
+		{
+			Result.Model.clear();
+			for (Clingo::Symbol Symbol : Model.symbols())
+			{
+				Result.Model.emplace_back(MakeAtom(Translate(Symbol)));
+			}
+		}
+		auto SolveResult = Handle.get();
+		if (SolveResult.is_satisfiable())
+		{
+			Result.Satisfiability = FMonitorSolver::ESatisfiability::Satisfiable;
+		}
+		else if (SolveResult.is_unsatisfiable())
+		{
+			Result.Satisfiability = FMonitorSolver::ESatisfiability::Unsatisfiable;
+		}
+		return Result;
+	}
+} // namespace
+
+
+// =============================================================================
+// -- FEventStore --------------------------------------------------------------
+// =============================================================================
+
+/// Event atoms grouped by vehicle, each one written as text once for
+/// grounding from scratch.
+class FMonitorSolver::FEventStore
+{
+public:
+
+	struct FVehicleEvents
+	{
+		FSymbols Events;
+		std::string Text;
+		int LatestTimeStep = 0;
+	};
+
+	using FMap = std::map<Clingo::Symbol, FVehicleEvents>;
+
+	bool Add(const std::string& Atom)
+	{
+		Clingo::Symbol Symbol;
+		try
+		{
+			// Remove the trailing dot of the fact.
+			std::string Term = Atom.substr(0u, Atom.find_last_of('.'));
+			Symbol = Clingo::parse_term(Term.c_str(), IgnoreMessage);
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+		if ((Symbol.type() != Clingo::SymbolType::Function) || (Symbol.arguments().size() < 2u))
+		{
+			return false;
+		}
+		Add(Symbol);
+		return true;
+	}
+
+	void Add(Clingo::Symbol Event)
+	{
+		auto Arguments = Event.arguments();
+		FVehicleEvents& Vehicle = Map[Arguments[0u]];
+		Vehicle.Events.emplace_back(Event);
+		Vehicle.Text += Event.to_string();
+		Vehicle.Text += ".\n";
+		Clingo::Symbol Time = Arguments[Arguments.size() - 1u];
+		if (Time.type() == Clingo::SymbolType::Number)
+		{
+			Vehicle.LatestTimeStep = std::max(Vehicle.LatestTimeStep, Time.number());
+			LatestTimeStep = std::max(LatestTimeStep, Time.number());
+		}
+	}
+
+	void Remove(const std::string& Vehicle)
+	{
+		Map.erase(Clingo::Id(Vehicle.c_str()));
+	}
+
+	/// Remove the vehicles without events in the last @a Horizon time steps
+	/// that are not in @a Tracked, returns the number of vehicles removed.
+	size_t Prune(int Horizon, const std::vector<std::string>& Tracked)
+	{
+		std::set<Clingo::Symbol> Keep;
+		for (const std::string& Vehicle : Tracked)
+		{
+			Keep.insert(Clingo::Id(Vehicle.c_str()));
+		}
+		size_t Count = 0u;
+		for (auto It = Map.begin(); It != Map.end();)
+		{
+			if ((It->second.LatestTimeStep < LatestTimeStep - Horizon) && (Keep.count(It->first) == 0u))
+			{
+				It = Map.erase(It);
+				++Count;
+			}
+			else
+			{
+				++It;
+			}
+		}
+		return Count;
+	}
+
+	const FMap& Get() const
+	{
+		return Map;
+	}
+
+	std::string ToString() const
+	{
+		std::string Result;
+		for (const auto& Pair : Map)
+		{
+			Result += Pair.second.Text;
+		}
+		return Result;
+	}
+
+private:
+
+	FMap Map;
+
+	int LatestTimeStep = 0;
+};
+
+
+// =============================================================================
+// -- FIncrementalControl ------------------------------------------------------
+// =============================================================================
+
+/// Long-lived control with the geometry and the rules grounded once.
+class FMonitorSolver::FIncrementalControl
+{
+public:
+
+	FIncrementalControl(
+		const std::string& Geometry,
+		const std::string& TrafficRules,
+		const FSettings& InSettings)
+		: Settings(InSettings),
+		ClingoControl({}, IgnoreMessage, 20),
+		SlotToVehicle(InSettings.MaxVehicles, Clingo::Infimum())
+	{
+		ClingoControl.add("base", {}, Geometry.c_str());
+		ClingoControl.add("base", {}, TrafficRules.c_str());
+		ClingoControl.add("base", {}, MakeDomainProgram(Settings).c_str());
+		ClingoControl.ground({ { "base", {} } });
+	}
+
+	/// Assign the externals of @a Events, returns false if they do not fit in
+	/// the grounded program, in that case no external is assigned.
+	bool Assign(const FEventStore::FMap& Events)
+	{
+		if (!AssignSlots(Events))
+		{
+			return false;
+		}
+
+		// Rank the time steps of each predicate.
+		std::map<std::pair<std::string, size_t>, std::vector<int>> TimeSteps;
+		for (const auto& Pair : Events)
+		{
+			for (Clingo::Symbol Event : Pair.second.Events)
+			{
+				auto Arguments = Event.arguments();
+				Clingo::Symbol Time = Arguments[Arguments.size() - 1u];
+				if (Time.type() != Clingo::SymbolType::Number)
+				{
+					return false;
+				}
+				TimeSteps[{ Event.name(), Arguments.size() }].emplace_back(Time.number());
+			}
+		}
+		for (auto& Pair : TimeSteps)
+		{
+			auto& Steps = Pair.second;
+			std::sort(Steps.begin(), Steps.end());
+			Steps.erase(std::unique(Steps.begin(), Steps.end()), Steps.end());
+			if (Steps.size() > Settings.MaxTimeSteps)
+			{
+				return false;
+			}
+		}
+
+		std::set<Clingo::Symbol> Active;
+		for (const auto& Pair : Events)
+		{
+			const Clingo::Symbol Slot = MakeVehicleSlot(VehicleToSlot.at(Pair.first));
+			for (Clingo::Symbol Event : Pair.second.Events)
+			{
+				auto Span = Event.arguments();
+				FSymbols Arguments(Span.begin(), Span.end());
+				const auto& Steps = TimeSteps.at({ Event.name(), Arguments.size() });
+				const auto Rank = std::lower_bound(Steps.begin(), Steps.end(), Arguments.back().number()) - Steps.begin();
+				Arguments.front() = Slot;
+				Arguments.back() = Clingo::Number(static_cast<int>(Rank));
+				Active.emplace(Clingo::Function(Event.name(), { Arguments.data(), Arguments.size() }));
+			}
+		}
+
+		// Every atom must have been declared external.
+		auto Atoms = ClingoControl.symbolic_atoms();
+		for (Clingo::Symbol Atom : Active)
+		{
+			if (ActiveExternals.count(Atom) == 0u)
+			{
+				auto It = Atoms.find(Atom);
+				if ((It == Atoms.end()) || !(*It).is_external())
+				{
+					return false;
+				}
+			}
+		}
+
+		for (Clingo::Symbol Atom : ActiveExternals)
+		{
+			if (Active.count(Atom) == 0u)
+			{
+				ClingoControl.assign_external(Atom, Clingo::TruthValue::False);
+			}
+		}
+		for (Clingo::Symbol Atom : Active)
+		{
+			if (ActiveExternals.count(Atom) == 0u)
+			{
+				ClingoControl.assign_external(Atom, Clingo::TruthValue::True);
+			}
+		}
+		ActiveExternals = std::move(Active);
+		return true;
+	}
+
+	FResult Solve()
+	{
+		return GetResult(ClingoControl, [this](Clingo::Symbol Symbol) { return ToVehicles(Symbol); });
+	}
+
+private:
+
+	/// Keep the slot of the vehicles still present and give a free one to the
+	/// new vehicles.
+	bool AssignSlots(const FEventStore::FMap& Events)
+	{
+		for (size_t Slot = 0u; Slot < SlotToVehicle.size(); ++Slot)
+		{
+			auto& Vehicle = SlotToVehicle[Slot];
+			if ((Vehicle.type() != Clingo::SymbolType::Infimum) && (Events.count(Vehicle) == 0u))
+			{
+				VehicleToSlot.erase(Vehicle);
+				Vehicle = Clingo::Infimum();
+			}
+		}
+		for (const auto& Pair : Events)
+		{
+			if (VehicleToSlot.count(Pair.first) == 0u)
+			{
+				auto It = std::find_if(SlotToVehicle.begin(), SlotToVehicle.end(), [](Clingo::Symbol Vehicle) {
+					return Vehicle.type() == Clingo::SymbolType::Infimum;
+				});
+				if (It == SlotToVehicle.end())
+				{
+					return false;
+				}
+				*It = Pair.first;
+				VehicleToSlot.emplace(Pair.first, static_cast<size_t>(It - SlotToVehicle.begin()));
+			}
+		}
+		return true;
+	}
+
+	/// Replace the vehicle slots in the arguments of @a Symbol by the
+	/// vehicles.
+	Clingo::Symbol ToVehicles(Clingo::Symbol Symbol) const
+	{
+		if (Symbol.type() != Clingo::SymbolType::Function)
+		{
+			return Symbol;
+		}
+		auto Span = Symbol.arguments();
+		FSymbols Arguments(Span.begin(), Span.end());
+		for (Clingo::Symbol& Argument : Arguments)
+		{
+			if (Argument.match(VehicleSlotName, 1u))
+			{
+				Argument = SlotToVehicle.at(static_cast<size_t>(Argument.arguments()[0u].number()));
+			}
+		}
+		return Clingo::Function(Symbol.name(), { Arguments.data(), Arguments.size() }, Symbol.is_positive());
+	}
+
+	const FSettings Settings;
+
+	Clingo::Control ClingoControl;
+
+	/// Free slots hold #inf.
+	FSymbols SlotToVehicle;
+
+	std::map<Clingo::Symbol, size_t> VehicleToSlot;
+
+	std::set<Clingo::Symbol> ActiveExternals;
+};
+
+
+// =============================================================================
+// -- FMonitorSolver -----------------------------------------------------------
+// =============================================================================
+
+FMonitorSolver::FMonitorSolver(std::string InGeometry, std::string InTrafficRules, const FSettings& InSettings)
+	: Geometry(std::move(InGeometry)),
+	TrafficRules(std::move(InTrafficRules)),
+	Settings(InSettings),
+	Events(std::make_unique<FEventStore>())
+{
+	if (Settings.Mode == EMode::Incremental)
+	{
+		Control = std::make_unique<FIncrementalControl>(Geometry, TrafficRules, Settings);
+	}
+}
+
+
+FMonitorSolver::~FMonitorSolver() = default;
+
+
+void FMonitorSolver::AddEvent(const FEvent& Event)
+{
+	Events->Add(MakeSymbol(Event));
+}
+
+
+bool FMonitorSolver::AddEvent(const std::string& Atom)
+{
+	return Events->Add(Atom);
+}
+
+
+std::string FMonitorSolver::ToString(const FEvent& Event)
+{
+	return MakeSymbol(Event).to_string() + ".";
+}
+
+
+void FMonitorSolver::RemoveVehicle(const std::string& Vehicle)
+{
+	Events->Remove(Vehicle);
+}
+
+
+std::string FMonitorSolver::GetEventsString() const
+{
+	return Events->ToString();
+}
+
+
+FMonitorSolver::FResult FMonitorSolver::Solve(const std::vector<std::string>& TrackedVehicles)
+{
+	if (Settings.EventHorizon > 0)
+	{
+		Statistics.PrunedVehicles += Events->Prune(Settings.EventHorizon, TrackedVehicles);
+	}
+	if (Control != nullptr)
+	{
+		if (Control->Assign(Events->Get()))
+		{
+			++Statistics.IncrementalSolves;
+			return Control->Solve();
+		}
+		++Statistics.Fallbacks;
+	}
+	return SolveFromScratch();
+}
+
+
+FMonitorSolver::FResult FMonitorSolver::SolveFromScratch()
+{
+	++Statistics.FromScratchSolves;
+	Clingo::Control ClingoControl{ {}, IgnoreMessage, 20 };
+	ClingoControl.add("base", {}, GetEventsString().c_str());
+	ClingoControl.add("base", {}, Geometry.c_str());
+	ClingoControl.add("base", {}, TrafficRules.c_str());
+	ClingoControl.ground({ { "base", {} } });
+	return GetResult(ClingoControl, [](Clingo::Symbol Symbol) { return Symbol; });
+}
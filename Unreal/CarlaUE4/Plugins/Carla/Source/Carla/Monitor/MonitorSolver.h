@@ -0,0 +1,168 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma de Barcelona (UAB). This work is licensed under the terms of the MIT license. For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+// This file does not depend on Unreal Engine, so the solver can be built and
+// benchmarked standalone (see Examples/MonitorBenchmark).
+
+// STL
+#include <memory>
+#include <string>
+#include <vector>
+
+/// Solves the traffic rules of a monitor over the events reported so far.
+///
+/// In incremental mode a single clingo control is kept for the lifetime of
+/// the solver. Geometry, traffic rules and an "#external" declaration for
+/// every possible event atom are parsed and grounded once; each solve only
+/// assigns the truth values of the event atoms that changed since the last
+/// one. To keep the set of possible event atoms finite, vehicles are mapped
+/// to a fixed number of slots and the time steps of each event predicate to
+/// their rank among the time steps of that predicate. Hence the rules may
+/// only compare time steps of the same predicate, and only for order or
+/// equality. When the events do not fit in the grounded program (too many
+/// vehicles or time steps, or unknown atoms) the solve falls back to
+/// grounding everything from scratch.
+///
+/// In from-scratch mode every solve creates a new control and grounds
+/// geometry, rules and events again.
+class FMonitorSolver
+{
+public:
+
+	enum class EMode
+	{
+		Incremental,
+		FromScratch
+	};
+
+	struct FSettings
+	{
+		EMode Mode = EMode::Incremental;
+
+		/// Vehicles inside the monitor at the same time.
+		size_t MaxVehicles = 8u;
+
+		/// Distinct time steps of each event predicate.
+		size_t MaxTimeSteps = 16u;
+
+		/// Vehicles without events in the last EventHorizon time steps are
+		/// forgotten unless tracked, zero to keep them until removed.
+		int EventHorizon = 0;
+	};
+
+	/// Event predicates reported by the monitor.
+	enum class EEvent
+	{
+		ArrivedAtFork,
+		SignaledAtFork,
+		EnteredFork,
+		EnteredLane,
+		LeftLane,
+		ExitedFrom
+	};
+
+	struct FEvent
+	{
+		EEvent Type;
+
+		/// e.g. "v_A".
+		std::string Vehicle;
+
+		/// Fork, lane or exit, e.g. "f_B".
+		std::string Place;
+
+		/// Turn signal, only for SignaledAtFork.
+		std::string Signal;
+
+		int TimeStep;
+	};
+
+	enum class ESatisfiability
+	{
+		Satisfiable,
+		Unsatisfiable,
+		Unknown
+	};
+
+	/// An atom of the model, with the vehicles by name.
+	struct FAtom
+	{
+		std::string Name;
+		std::vector<std::string> Arguments;
+		std::string Text;
+	};
+
+	struct FResult
+	{
+		ESatisfiability Satisfiability = ESatisfiability::Unknown;
+		std::vector<FAtom> Model;
+	};
+
+	struct FStatistics
+	{
+		size_t IncrementalSolves = 0u;
+		size_t FromScratchSolves = 0u;
+		/// Solves that fell back to grounding from scratch in incremental mode.
+		size_t Fallbacks = 0u;
+		/// Vehicles forgotten for being older than the event horizon.
+		size_t PrunedVehicles = 0u;
+	};
+
+	/// @throw std::exception if clingo fails to parse or ground the program
+	/// in incremental mode.
+	FMonitorSolver(std::string Geometry, std::string TrafficRules, const FSettings &Settings);
+
+	~FMonitorSolver();
+
+	void AddEvent(const FEvent &Event);
+
+	/// Add an event atom, e.g. "arrivedAtForkAtTime(v_A, f_B, 3).". The
+	/// first argument is the vehicle and the last one the time step. Returns
+	/// false if the atom could not be parsed.
+	bool AddEvent(const std::string &Atom);
+
+	/// The atom of @a Event, e.g. "arrivedAtForkAtTime(v_A, f_B, 3).".
+	static std::string ToString(const FEvent &Event);
+
+	/// Forget every event of @a Vehicle, e.g. "v_A".
+	void RemoveVehicle(const std::string &Vehicle);
+
+	/// Events as a logic program, one fact per line.
+	std::string GetEventsString() const;
+
+	/// The vehicles in @a TrackedVehicles, e.g. "v_A", are not forgotten by
+	/// the event horizon.
+	/// @throw std::exception if clingo fails.
+	FResult Solve(const std::vector<std::string> &TrackedVehicles = {});
+
+	const FSettings &GetSettings() const
+	{
+		return Settings;
+	}
+
+	const FStatistics &GetStatistics() const
+	{
+		return Statistics;
+	}
+
+private:
+
+	class FEventStore;
+
+	class FIncrementalControl;
+
+	FResult SolveFromScratch();
+
+	const std::string Geometry;
+
+	const std::string TrafficRules;
+
+	const FSettings Settings;
+
+	FStatistics Statistics;
+
+	std::unique_ptr<FEventStore> Events;
+
+	std::unique_ptr<FIncrementalControl> Control;
+};
@@ -215,23 +215,20 @@ std::string ACarlaRecorder::Start(std::string Name, FString MapName)
   // get the final path + filename
   std::string Filename = GetRecorderFilename(Name);
 
-  // binary file
-  File.open(Filename, std::ios::binary);
-  if (!File.is_open())
-  {
-    return "";
-  }
-
   // save info
   Info.Version = 1;
   Info.Magic = TEXT("CARLA_RECORDER");
   Info.Date = std::time(0);
   Info.Mapfile = MapName;
 
-  // write general info
-  Info.Write(File);
+  // binary file, with general info
+  if (!Writer.Open(Filename, Info, Compression, WriterQueueSize))
+  {
+    return "";
+  }
 
   Frames.Reset();
+  Keyframes.Reset(KeyframeInterval);
 
   Enable();
 
@@ -245,9 +242,26 @@ void ACarlaRecorder::Stop(void)
 {
   Disable();
 
-  if (File)
+  if (Writer.IsOpen())
   {
-    File.close();
+    // the last frame keeps an unknown duration
+    if (!Pending.Packets.empty())
+    {
+      Writer.Push(std::move(Pending));
+    }
+    Pending = CarlaRecorderWriterBlock();
+
+    // write all the frames left
+    Writer.Close();
+
+    auto Stats = Writer.GetStats();
+    UE_LOG(LogCarla, Log, TEXT("Recorder: %llu frames, %llu bytes written for %llu bytes of packets, queue latency %.3f ms (max %.3f ms), %llu waits for a full queue"),
+        Stats.Frames,
+        Stats.WrittenBytes,
+        Stats.RawBytes,
+        Stats.Frames > 0u ? 1000.0 * Stats.TotalQueueLatency / Stats.Frames : 0.0,
+        1000.0 * Stats.MaxQueueLatency,
+        Stats.QueueFullWaits);
   }
 
   Clear();
@@ -270,25 +284,60 @@ void ACarlaRecorder::Write(double DeltaSeconds)
   // update this frame data
   Frames.SetFrame(DeltaSeconds);
 
+  // the previous frame is complete once its duration is known
+  if (!Pending.Packets.empty())
+  {
+    Frames.WritePreviousDuration(Pending.Packets);
+    Writer.Push(std::move(Pending));
+  }
+  Pending = CarlaRecorderWriterBlock();
+  Pending.Frame = Frames.GetFrame();
+
+  // keyframe with the actors before the events of this frame
+  if (Keyframes.IsDue(Frames.GetFrame().Elapsed))
+  {
+    Packets.str(std::string());
+    Keyframes.Write(Packets, Frames.GetFrame().Elapsed);
+    Pending.Keyframe = Packets.str();
+  }
+
+  Packets.str(std::string());
+
   // start
-  Frames.WriteStart(File);
+  Frames.WriteStart(Packets);
 
   // events
-  EventsAdd.Write(File);
-  EventsDel.Write(File);
-  EventsParent.Write(File);
-  Collisions.Write(File);
+  EventsAdd.Write(Packets);
+  EventsDel.Write(Packets);
+  EventsParent.Write(Packets);
+  Collisions.Write(Packets);
+
+  // keep track of the actors for the next keyframes
+  for (auto &Event : EventsAdd.GetEvents())
+  {
+    Keyframes.Apply(Event);
+  }
+  for (auto &Event : EventsDel.GetEvents())
+  {
+    Keyframes.Apply(Event);
+  }
+  for (auto &Event : EventsParent.GetEvents())
+  {
+    Keyframes.Apply(Event);
+  }
 
   // positions and states
-  Positions.Write(File);
-  States.Write(File);
+  Positions.Write(Packets);
+  States.Write(Packets);
 
   // animations
-  Vehicles.Write(File);
-  Walkers.Write(File);
+  Vehicles.Write(Packets);
+  Walkers.Write(Packets);
 
   // end
-  Frames.WriteEnd(File);
+  Frames.WriteEnd(Packets);
+
+  Pending.Packets = Packets.str();
 
   Clear();
 }
@@ -8,20 +8,25 @@
 
 // #include "GameFramework/Actor.h"
 #include <fstream>
+#include <sstream>
 
 #include "Carla/Actor/ActorDescription.h"
 
 #include "CarlaRecorderAnimVehicle.h"
 #include "CarlaRecorderAnimWalker.h"
+#include "CarlaRecorderBlock.h"
 #include "CarlaRecorderCollision.h"
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
 #include "CarlaRecorderEventParent.h"
 #include "CarlaRecorderFrames.h"
+#include "CarlaRecorderIndex.h"
 #include "CarlaRecorderInfo.h"
+#include "CarlaRecorderKeyframe.h"
 #include "CarlaRecorderPosition.h"
 #include "CarlaRecorderQuery.h"
 #include "CarlaRecorderState.h"
+#include "CarlaRecorderWriter.h"
 #include "CarlaReplayer.h"
 
 #include "CarlaRecorder.generated.h"
@@ -40,7 +45,10 @@ enum class CarlaRecorderPacketId : uint8_t
   Position,
   State,
   AnimVehicle,
-  AnimWalker
+  AnimWalker,
+  Keyframe,
+  FrameIndex,
+  Block
 };
 
 /// Recorder for the simulation
@@ -115,6 +123,30 @@ public:
   std::string ReplayFile(std::string Name, double TimeStart, double Duration, uint32_t FollowId);
   void SetReplayerTimeFactor(double TimeFactor);
 
+  // seconds between keyframes of new recordings, 0 to disable them
+  void SetKeyframeInterval(double Interval)
+  {
+    KeyframeInterval = Interval;
+  }
+
+  // compression of the frames of new recordings
+  void SetCompression(CarlaRecorderCompression NewCompression)
+  {
+    Compression = NewCompression;
+  }
+
+  // frames of new recordings that can wait to be written
+  void SetWriterQueueSize(size_t Size)
+  {
+    WriterQueueSize = Size;
+  }
+
+  // bytes and queue latency of the current recording
+  CarlaRecorderWriterStats GetWriterStats(void) const
+  {
+    return Writer.GetStats();
+  }
+
   void Tick(float DeltaSeconds) final;
 
 private:
@@ -124,7 +156,14 @@ private:
   uint32_t NextCollisionId = 0;
 
   // files
-  std::ofstream File;
+  CarlaRecorderWriter Writer;
+  CarlaRecorderCompression Compression = CarlaRecorderCompression::None;
+  size_t WriterQueueSize = CarlaRecorderWriter::DefaultQueueSize;
+
+  // packets of the current frame, and the previous frame waiting for its
+  // duration to be handed to the writer
+  std::ostringstream Packets;
+  CarlaRecorderWriterBlock Pending;
 
   UCarlaEpisode *Episode = nullptr;
 
@@ -140,6 +179,10 @@ private:
   CarlaRecorderAnimVehicles Vehicles;
   CarlaRecorderAnimWalkers Walkers;
 
+  // keyframes, to start replaying at any time
+  CarlaRecorderKeyframes Keyframes;
+  double KeyframeInterval = CarlaRecorderIndex::DefaultKeyframeInterval;
+
   // replayer
   CarlaReplayer Replayer;
 
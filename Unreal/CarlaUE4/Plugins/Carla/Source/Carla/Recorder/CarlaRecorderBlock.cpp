@@ -0,0 +1,161 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderBlock.h"
+#include "CarlaRecorderHelpers.h"
+
+#include "Misc/Compression.h"
+
+bool CarlaRecorderCompress(
+    CarlaRecorderCompression Compression,
+    const std::string &Packets,
+    std::string &OutData)
+{
+  if (Compression != CarlaRecorderCompression::Zlib || Packets.empty())
+  {
+    return false;
+  }
+
+  int32 Size = FCompression::CompressMemoryBound(NAME_Zlib, Packets.size());
+  OutData.resize(Size);
+  if (!FCompression::CompressMemory(NAME_Zlib, &OutData[0], Size, Packets.data(), Packets.size()))
+  {
+    return false;
+  }
+
+  // not worth it
+  if (static_cast<size_t>(Size) >= Packets.size())
+  {
+    return false;
+  }
+
+  OutData.resize(Size);
+  return true;
+}
+
+bool CarlaRecorderDecompress(
+    const CarlaRecorderBlockHeader &Header,
+    const std::string &Data,
+    std::string &OutPackets)
+{
+  if (Header.Compression != CarlaRecorderCompression::Zlib || Header.RawSize == 0)
+  {
+    return false;
+  }
+
+  OutPackets.resize(Header.RawSize);
+  return FCompression::UncompressMemory(NAME_Zlib, &OutPackets[0], Header.RawSize, Data.data(), Data.size());
+}
+
+// ---------------------------------------------
+
+CarlaRecorderInputFile::CarlaRecorderInputFile(void)
+  : std::istream(nullptr),
+    BlockBuffer(std::ios::in)
+{
+  rdbuf(&FileBuffer);
+}
+
+void CarlaRecorderInputFile::open(const std::string &Filename, std::ios::openmode Mode)
+{
+  LeaveBlock();
+  if (FileBuffer.open(Filename, Mode | std::ios::in) == nullptr)
+  {
+    setstate(std::ios::failbit);
+  }
+  else
+  {
+    clear();
+  }
+}
+
+void CarlaRecorderInputFile::close(void)
+{
+  LeaveBlock();
+  if (FileBuffer.close() == nullptr)
+  {
+    setstate(std::ios::failbit);
+  }
+}
+
+bool CarlaRecorderInputFile::ReadHeader(char &Id, uint32_t &Size)
+{
+  while (true)
+  {
+    // back to the file at the end of a block
+    if (bInBlock && BlockBuffer.in_avail() <= 0)
+    {
+      LeaveBlock();
+    }
+    if (!bInBlock)
+    {
+      PacketOffset = tellg();
+    }
+
+    ReadValue<char>(*this, Id);
+    ReadValue<uint32_t>(*this, Size);
+    if (!*this)
+    {
+      return false;
+    }
+
+    if (Id != static_cast<char>(CarlaRecorderPacketId::Block))
+    {
+      return true;
+    }
+
+    // continue with the first packet of the block
+    if (!ReadBlock(Size))
+    {
+      return false;
+    }
+  }
+}
+
+void CarlaRecorderInputFile::Seek(std::streampos Offset)
+{
+  LeaveBlock();
+  clear();
+  seekg(Offset, std::ios::beg);
+}
+
+bool CarlaRecorderInputFile::ReadBlock(uint32_t Size)
+{
+  CarlaRecorderBlockHeader Header;
+  if (bInBlock || Size < sizeof(CarlaRecorderBlockHeader))
+  {
+    setstate(std::ios::failbit);
+    return false;
+  }
+
+  ReadValue<CarlaRecorderBlockHeader>(*this, Header);
+  Data.resize(Size - sizeof(CarlaRecorderBlockHeader));
+  read(&Data[0], Data.size());
+
+  std::string Packets;
+  if (!*this || !CarlaRecorderDecompress(Header, Data, Packets))
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Could not decompress a block of the recording"));
+    setstate(std::ios::failbit);
+    return false;
+  }
+
+  BlockBuffer.str(Packets);
+  rdbuf(&BlockBuffer);
+  bInBlock = true;
+  return true;
+}
+
+void CarlaRecorderInputFile::LeaveBlock(void)
+{
+  if (bInBlock)
+  {
+    bInBlock = false;
+    BlockBuffer.str(std::string());
+    rdbuf(&FileBuffer);
+  }
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// compression of the frame blocks of a recording, chosen per file
+enum class CarlaRecorderCompression : uint8_t
+{
+  None = 0,
+  Zlib
+};
+
+#pragma pack(push, 1)
+// data of a block packet, followed by the compressed packets of a frame
+struct CarlaRecorderBlockHeader
+{
+  CarlaRecorderCompression Compression;
+  // size of the packets once decompressed
+  uint32_t RawSize;
+};
+#pragma pack(pop)
+
+// compress the packets of a frame, false if the result is not smaller
+bool CarlaRecorderCompress(
+    CarlaRecorderCompression Compression,
+    const std::string &Packets,
+    std::string &OutData);
+
+// decompress the packets of a frame
+bool CarlaRecorderDecompress(
+    const CarlaRecorderBlockHeader &Header,
+    const std::string &Data,
+    std::string &OutPackets);
+
+// Input file of a recording, reading the packets inside the compressed blocks
+// as if they were written directly in the file.
+class CarlaRecorderInputFile : public std::istream
+{
+public:
+
+  CarlaRecorderInputFile(void);
+
+  void open(const std::string &Filename, std::ios::openmode Mode = std::ios::binary);
+
+  bool is_open(void) const
+  {
+    return FileBuffer.is_open();
+  }
+
+  void close(void);
+
+  // read the header of the next packet, from the current block or from the
+  // file, decompressing the blocks found
+  bool ReadHeader(char &Id, uint32_t &Size);
+
+  // move to a position of the file, leaving the current block
+  void Seek(std::streampos Offset);
+
+  // position in the file of the last packet read, or of the block with it
+  std::streampos GetPacketOffset(void) const
+  {
+    return PacketOffset;
+  }
+
+private:
+
+  bool ReadBlock(uint32_t Size);
+
+  void LeaveBlock(void);
+
+  std::filebuf FileBuffer;
+  std::stringbuf BlockBuffer;
+  bool bInBlock { false };
+  std::streampos PacketOffset { 0 };
+  std::string Data;
+};
@@ -14,8 +14,8 @@ struct CarlaRecorderEventParent
     uint32_t DatabaseId;
     uint32_t DatabaseIdParent;
 
-    void Read(std::ifstream &InFile);
-    void Write(std::ofstream &OutFile) const;
+    void Read(std::istream &InFile);
+    void Write(std::ostream &OutFile) const;
 };
 
 class CarlaRecorderEventsParent
@@ -24,7 +24,11 @@ class CarlaRecorderEventsParent
     public:
     void Add(const CarlaRecorderEventParent &Event);
     void Clear(void);
-    void Write(std::ofstream &OutFile);
+    void Write(std::ostream &OutFile);
+    const std::vector<CarlaRecorderEventParent> &GetEvents(void) const
+    {
+        return Events;
+    }
 
     private:
     std::vector<CarlaRecorderEventParent> Events;
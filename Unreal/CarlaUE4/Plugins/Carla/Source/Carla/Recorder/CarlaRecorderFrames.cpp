@@ -8,12 +8,15 @@
 #include "CarlaRecorderFrames.h"
 #include "CarlaRecorderHelpers.h"
 
-void CarlaRecorderFrame::Read(std::ifstream &InFile)
+#include <cstddef>
+#include <cstring>
+
+void CarlaRecorderFrame::Read(std::istream &InFile)
 {
   ReadValue<CarlaRecorderFrame>(InFile, *this);
 }
 
-void CarlaRecorderFrame::Write(std::ofstream &OutFile)
+void CarlaRecorderFrame::Write(std::ostream &OutFile)
 {
   WriteValue<CarlaRecorderFrame>(OutFile, *this);
 }
@@ -30,7 +33,6 @@ void CarlaRecorderFrames::Reset(void)
   Frame.Id = 0;
   Frame.DurationThis = 0.0f;
   Frame.Elapsed = 0.0f;
-  OffsetPreviousFrame = 0;
 }
 
 void CarlaRecorderFrames::SetFrame(double DeltaSeconds)
@@ -49,9 +51,8 @@ void CarlaRecorderFrames::SetFrame(double DeltaSeconds)
   ++Frame.Id;
 }
 
-void CarlaRecorderFrames::WriteStart(std::ofstream &OutFile)
+void CarlaRecorderFrames::WriteStart(std::ostream &OutFile)
 {
-  std::streampos Pos, Offset;
   double Dummy = -1.0f;
 
   // write the packet id
@@ -61,26 +62,21 @@ void CarlaRecorderFrames::WriteStart(std::ofstream &OutFile)
   uint32_t Total = sizeof(CarlaRecorderFrame);
   WriteValue<uint32_t>(OutFile, Total);
 
-  // write frame record
+  // write frame record, the duration is written when the next frame starts
   WriteValue<uint64_t>(OutFile, Frame.Id);
-  Offset = OutFile.tellp();
   WriteValue<double>(OutFile, Dummy);
   WriteValue<double>(OutFile, Frame.Elapsed);
+}
 
-  // we need to write this duration to previous frame
-  if (OffsetPreviousFrame > 0)
-  {
-    Pos = OutFile.tellp();
-    OutFile.seekp(OffsetPreviousFrame, std::ios::beg);
-    WriteValue<double>(OutFile, Frame.DurationThis);
-    OutFile.seekp(Pos, std::ios::beg);
-  }
-
-  // save position for next actualization
-  OffsetPreviousFrame = Offset;
+void CarlaRecorderFrames::WritePreviousDuration(std::string &Packets) const
+{
+  // position of the duration after the packet header
+  const size_t Offset = sizeof(char) + sizeof(uint32_t) + offsetof(CarlaRecorderFrame, DurationThis);
+  check(Packets.size() >= Offset + sizeof(double));
+  std::memcpy(&Packets[Offset], &Frame.DurationThis, sizeof(double));
 }
 
-void CarlaRecorderFrames::WriteEnd(std::ofstream &OutFile)
+void CarlaRecorderFrames::WriteEnd(std::ostream &OutFile)
 {
   // write the packet id
   WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::FrameEnd));
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <fstream>
+#include <string>
 
 #pragma pack(push, 1)
 struct CarlaRecorderFrame
@@ -15,9 +16,9 @@ struct CarlaRecorderFrame
   double DurationThis;
   double Elapsed;
 
-  void Read(std::ifstream &InFile);
+  void Read(std::istream &InFile);
 
-  void Write(std::ofstream &OutFile);
+  void Write(std::ostream &OutFile);
 
 };
 #pragma pack(pop)
@@ -32,11 +33,19 @@ public:
 
   void SetFrame(double DeltaSeconds);
 
-  void WriteStart(std::ofstream &OutFile);
-  void WriteEnd(std::ofstream &OutFile);
+  const CarlaRecorderFrame &GetFrame(void) const
+  {
+    return Frame;
+  }
+
+  void WriteStart(std::ostream &OutFile);
+  void WriteEnd(std::ostream &OutFile);
+
+  // write the duration of the previous frame, known once this one starts, in
+  // the frame start packet at the beginning of its packets
+  void WritePreviousDuration(std::string &Packets) const;
 
 private:
 
   CarlaRecorderFrame Frame;
-  std::streampos OffsetPreviousFrame;
 };
@@ -17,18 +17,18 @@ std::string GetRecorderFilename(std::string Filename);
 
 // write binary data (using sizeof())
 template <typename T>
-void WriteValue(std::ofstream &OutFile, const T &InObj)
+void WriteValue(std::ostream &OutFile, const T &InObj)
 {
   OutFile.write(reinterpret_cast<const char *>(&InObj), sizeof(T));
 }
 
 // write binary data from FVector
-void WriteFVector(std::ofstream &OutFile, const FVector &InObj);
+void WriteFVector(std::ostream &OutFile, const FVector &InObj);
 
 // write binary data from FTransform
-// void WriteFTransform(std::ofstream &OutFile, const FTransform &InObj);
+// void WriteFTransform(std::ostream &OutFile, const FTransform &InObj);
 // write binary data from FString (length + text)
-void WriteFString(std::ofstream &OutFile, const FString &InObj);
+void WriteFString(std::ostream &OutFile, const FString &InObj);
 
 // ---------
 // replayer
@@ -36,15 +36,15 @@ void WriteFString(std::ofstream &OutFile, const FString &InObj);
 
 // read binary data (using sizeof())
 template <typename T>
-void ReadValue(std::ifstream &InFile, T &OutObj)
+void ReadValue(std::istream &InFile, T &OutObj)
 {
   InFile.read(reinterpret_cast<char *>(&OutObj), sizeof(T));
 }
 
 // read binary data from FVector
-void ReadFVector(std::ifstream &InFile, FVector &OutObj);
+void ReadFVector(std::istream &InFile, FVector &OutObj);
 
 // read binary data from FTransform
-// void ReadTransform(std::ifstream &InFile, FTransform &OutObj);
+// void ReadTransform(std::istream &InFile, FTransform &OutObj);
 // read binary data from FString (length + text)
-void ReadFString(std::ifstream &InFile, FString &OutObj);
+void ReadFString(std::istream &InFile, FString &OutObj);
@@ -0,0 +1,288 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderIndex.h"
+#include "CarlaRecorderHelpers.h"
+#include "CarlaRecorderKeyframe.h"
+
+#include <algorithm>
+#include <cstring>
+
+// identifies the footer, and the version of the index format
+static const char CarlaRecorderIndexMagic[8] = { 'C', 'R', 'I', 'N', 'D', 'E', 'X', '1' };
+
+void CarlaRecorderIndex::Clear(void)
+{
+  Frames.clear();
+  Keyframes.clear();
+  KeyframesFilename.clear();
+}
+
+void CarlaRecorderIndex::AddFrame(const CarlaRecorderFrame &Frame, std::streampos Offset)
+{
+  Frames.push_back(CarlaRecorderIndexFrame { Frame.Id, Frame.Elapsed, static_cast<uint64_t>(Offset) });
+}
+
+void CarlaRecorderIndex::AddKeyframe(std::streampos Offset)
+{
+  check(!Frames.empty());
+  Keyframes.push_back(CarlaRecorderIndexKeyframe { Frames.size() - 1, static_cast<uint64_t>(Offset) });
+}
+
+void CarlaRecorderIndex::Write(std::ostream &OutFile, uint64_t RecordingSize)
+{
+  uint64_t IndexOffset = OutFile.tellp();
+
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::FrameIndex));
+
+  // write the packet size
+  uint32_t Total =
+      sizeof(uint32_t) + Frames.size() * sizeof(CarlaRecorderIndexFrame) +
+      sizeof(uint32_t) + Keyframes.size() * sizeof(CarlaRecorderIndexKeyframe) +
+      sizeof(CarlaRecorderIndexFooter);
+  WriteValue<uint32_t>(OutFile, Total);
+
+  // the index appended to a recording ends the file
+  if (RecordingSize == 0)
+  {
+    RecordingSize = IndexOffset + sizeof(char) + sizeof(uint32_t) + Total;
+  }
+
+  // frames
+  Total = Frames.size();
+  WriteValue<uint32_t>(OutFile, Total);
+  if (Total > 0)
+  {
+    OutFile.write(reinterpret_cast<const char *>(Frames.data()), Frames.size() * sizeof(CarlaRecorderIndexFrame));
+  }
+
+  // keyframes
+  Total = Keyframes.size();
+  WriteValue<uint32_t>(OutFile, Total);
+  if (Total > 0)
+  {
+    OutFile.write(reinterpret_cast<const char *>(Keyframes.data()), Keyframes.size() * sizeof(CarlaRecorderIndexKeyframe));
+  }
+
+  // footer
+  CarlaRecorderIndexFooter Footer;
+  Footer.IndexOffset = IndexOffset;
+  Footer.RecordingSize = RecordingSize;
+  std::memcpy(Footer.Magic, CarlaRecorderIndexMagic, sizeof(Footer.Magic));
+  WriteValue<CarlaRecorderIndexFooter>(OutFile, Footer);
+}
+
+bool CarlaRecorderIndex::Read(std::istream &InFile, uint64_t RecordingSize)
+{
+  Frames.clear();
+  Keyframes.clear();
+
+  // read the footer
+  InFile.clear();
+  InFile.seekg(0, std::ios::end);
+  uint64_t FileSize = InFile.tellg();
+  if (FileSize < sizeof(CarlaRecorderIndexFooter))
+  {
+    return false;
+  }
+  CarlaRecorderIndexFooter Footer;
+  InFile.seekg(FileSize - sizeof(CarlaRecorderIndexFooter), std::ios::beg);
+  ReadValue<CarlaRecorderIndexFooter>(InFile, Footer);
+  if (!InFile ||
+      std::memcmp(Footer.Magic, CarlaRecorderIndexMagic, sizeof(Footer.Magic)) != 0 ||
+      Footer.RecordingSize != RecordingSize ||
+      Footer.IndexOffset >= FileSize)
+  {
+    return false;
+  }
+
+  // read the index packet
+  char Id;
+  uint32_t Size, Total;
+  InFile.seekg(Footer.IndexOffset, std::ios::beg);
+  ReadValue<char>(InFile, Id);
+  ReadValue<uint32_t>(InFile, Size);
+  if (!InFile || Id != static_cast<char>(CarlaRecorderPacketId::FrameIndex))
+  {
+    return false;
+  }
+
+  // frames
+  ReadValue<uint32_t>(InFile, Total);
+  if (!InFile || Total * sizeof(CarlaRecorderIndexFrame) > Size)
+  {
+    return false;
+  }
+  Frames.resize(Total);
+  InFile.read(reinterpret_cast<char *>(Frames.data()), Total * sizeof(CarlaRecorderIndexFrame));
+
+  // keyframes
+  ReadValue<uint32_t>(InFile, Total);
+  if (!InFile || Total * sizeof(CarlaRecorderIndexKeyframe) > Size)
+  {
+    Frames.clear();
+    return false;
+  }
+  Keyframes.resize(Total);
+  InFile.read(reinterpret_cast<char *>(Keyframes.data()), Total * sizeof(CarlaRecorderIndexKeyframe));
+
+  if (!InFile)
+  {
+    Frames.clear();
+    Keyframes.clear();
+    return false;
+  }
+  return true;
+}
+
+void CarlaRecorderIndex::Build(CarlaRecorderInputFile &InFile, std::ostream &OutFile, double KeyframeInterval)
+{
+  uint16_t i, Total;
+  char Id;
+  uint32_t Size;
+  CarlaRecorderFrame Frame;
+  CarlaRecorderEventAdd EventAdd;
+  CarlaRecorderEventDel EventDel;
+  CarlaRecorderEventParent EventParent;
+  CarlaRecorderKeyframes Tracker;
+
+  Frames.clear();
+  Keyframes.clear();
+  Tracker.Reset(KeyframeInterval);
+
+  while (InFile)
+  {
+    // get header
+    if (!InFile.ReadHeader(Id, Size))
+    {
+      break;
+    }
+
+    switch (Id)
+    {
+      // frame
+      case static_cast<char>(CarlaRecorderPacketId::FrameStart):
+        Frame.Read(InFile);
+        // the block of the frame if it is compressed
+        AddFrame(Frame, InFile.GetPacketOffset());
+        // keyframe with the actors before the events of this frame
+        if (Tracker.IsDue(Frame.Elapsed))
+        {
+          AddKeyframe(OutFile.tellp());
+          Tracker.Write(OutFile, Frame.Elapsed);
+        }
+        break;
+
+      // events add
+      case static_cast<char>(CarlaRecorderPacketId::EventAdd):
+        ReadValue<uint16_t>(InFile, Total);
+        for (i = 0; i < Total; ++i)
+        {
+          EventAdd.Read(InFile);
+          Tracker.Apply(EventAdd);
+        }
+        break;
+
+      // events del
+      case static_cast<char>(CarlaRecorderPacketId::EventDel):
+        ReadValue<uint16_t>(InFile, Total);
+        for (i = 0; i < Total; ++i)
+        {
+          EventDel.Read(InFile);
+          Tracker.Apply(EventDel);
+        }
+        break;
+
+      // events parent
+      case static_cast<char>(CarlaRecorderPacketId::EventParent):
+        ReadValue<uint16_t>(InFile, Total);
+        for (i = 0; i < Total; ++i)
+        {
+          EventParent.Read(InFile);
+          Tracker.Apply(EventParent);
+        }
+        break;
+
+      // anything else is not needed for the index
+      default:
+        InFile.seekg(Size, std::ios::cur);
+        break;
+    }
+  }
+}
+
+bool CarlaRecorderIndex::Load(const std::string &Filename)
+{
+  Clear();
+
+  std::ifstream File(Filename, std::ios::binary | std::ios::ate);
+  if (!File.is_open())
+  {
+    return false;
+  }
+  uint64_t Size = File.tellg();
+
+  // index at the end of the recording
+  if (Read(File, Size))
+  {
+    KeyframesFilename = Filename;
+    return true;
+  }
+
+  // index built for an older recording
+  std::string IndexFilename = Filename + ".index";
+  {
+    std::ifstream IndexFile(IndexFilename, std::ios::binary);
+    if (IndexFile.is_open() && Read(IndexFile, Size))
+    {
+      KeyframesFilename = IndexFilename;
+      return true;
+    }
+  }
+
+  // build it only once, saving it next to the recording
+  std::ofstream IndexFile(IndexFilename, std::ios::binary);
+  if (!IndexFile.is_open())
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Could not create recorder index %s"), UTF8_TO_TCHAR(IndexFilename.c_str()));
+    return false;
+  }
+  CarlaRecorderInputFile Recording;
+  Recording.open(Filename, std::ios::binary);
+  CarlaRecorderInfo Info;
+  Info.Read(Recording);
+  Build(Recording, IndexFile);
+  Write(IndexFile, Size);
+  IndexFile.close();
+  if (!IndexFile || IsEmpty())
+  {
+    Clear();
+    return false;
+  }
+  KeyframesFilename = IndexFilename;
+  return true;
+}
+
+double CarlaRecorderIndex::GetTotalTime(void) const
+{
+  return Frames.empty() ? 0.0 : Frames.back().Elapsed;
+}
+
+size_t CarlaRecorderIndex::FindFrame(double Time) const
+{
+  auto It = std::upper_bound(Frames.begin(), Frames.end(), Time,
+      [](double Value, const CarlaRecorderIndexFrame &Frame) { return Value < Frame.Elapsed; });
+  return It == Frames.begin() ? 0 : static_cast<size_t>(It - Frames.begin()) - 1;
+}
+
+const CarlaRecorderIndexKeyframe *CarlaRecorderIndex::FindKeyframe(size_t Frame) const
+{
+  auto It = std::upper_bound(Keyframes.begin(), Keyframes.end(), Frame,
+      [](size_t Value, const CarlaRecorderIndexKeyframe &Keyframe) { return Value < Keyframe.Frame; });
+  return It == Keyframes.begin() ? nullptr : &*(It - 1);
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "CarlaRecorderBlock.h"
+#include "CarlaRecorderFrames.h"
+
+#pragma pack(push, 1)
+struct CarlaRecorderIndexFrame
+{
+  uint64_t Id;
+  double Elapsed;
+  // offset of the frame start packet in the recording
+  uint64_t Offset;
+};
+
+struct CarlaRecorderIndexKeyframe
+{
+  // position of the frame of the keyframe in the index
+  uint64_t Frame;
+  // offset of the keyframe packet in the file holding the index
+  uint64_t Offset;
+};
+
+// last bytes of a file holding an index
+struct CarlaRecorderIndexFooter
+{
+  // offset of the index packet
+  uint64_t IndexOffset;
+  // size of the recording the index belongs to
+  uint64_t RecordingSize;
+  char Magic[8];
+};
+#pragma pack(pop)
+
+// Index of the frames and keyframes of a recording, to start replaying at any
+// time without reading all the previous packets.
+//
+// The recorder writes the index as the last packet of the file. For older
+// recordings the index (and its keyframes) is built once and saved next to
+// the recording, with the extension ".index".
+class CarlaRecorderIndex
+{
+public:
+
+  // seconds between keyframes
+  static constexpr double DefaultKeyframeInterval = 10.0;
+
+  void Clear(void);
+
+  bool IsEmpty(void) const
+  {
+    return Frames.empty();
+  }
+
+  void AddFrame(const CarlaRecorderFrame &Frame, std::streampos Offset);
+
+  // add a keyframe to the last frame added
+  void AddKeyframe(std::streampos Offset);
+
+  // write the index packet with the footer at its end, RecordingSize is the
+  // size of the recording or 0 if the index is appended to it
+  void Write(std::ostream &OutFile, uint64_t RecordingSize = 0);
+
+  // read the index from the footer at the end of InFile, only if it belongs
+  // to a recording of RecordingSize bytes
+  bool Read(std::istream &InFile, uint64_t RecordingSize);
+
+  // read all the packets of a recording, after its info header, writing its
+  // keyframes and its index to OutFile
+  void Build(CarlaRecorderInputFile &InFile, std::ostream &OutFile, double KeyframeInterval = DefaultKeyframeInterval);
+
+  // load the index of a recording, from its end, from the ".index" file next
+  // to it, or building it
+  bool Load(const std::string &Filename);
+
+  // total time recorded
+  double GetTotalTime(void) const;
+
+  // position in the index of the last frame starting at or before Time
+  size_t FindFrame(double Time) const;
+
+  // last keyframe at or before the frame in position Frame, null if none
+  const CarlaRecorderIndexKeyframe *FindKeyframe(size_t Frame) const;
+
+  const std::vector<CarlaRecorderIndexFrame> &GetFrames(void) const
+  {
+    return Frames;
+  }
+
+  const std::vector<CarlaRecorderIndexKeyframe> &GetKeyframes(void) const
+  {
+    return Keyframes;
+  }
+
+  // file where the offsets of the keyframes point to
+  const std::string &GetKeyframesFilename(void) const
+  {
+    return KeyframesFilename;
+  }
+
+private:
+
+  std::vector<CarlaRecorderIndexFrame> Frames;
+  std::vector<CarlaRecorderIndexKeyframe> Keyframes;
+  std::string KeyframesFilename;
+};
@@ -0,0 +1,127 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderKeyframe.h"
+#include "CarlaRecorderHelpers.h"
+
+void CarlaRecorderKeyframe::Read(std::istream &InFile)
+{
+  uint16_t i, Total;
+
+  // actors
+  ReadValue<uint16_t>(InFile, Total);
+  Actors.clear();
+  Actors.resize(Total);
+  for (i = 0; i < Total; ++i)
+  {
+    Actors[i].Read(InFile);
+  }
+
+  // parents
+  ReadValue<uint16_t>(InFile, Total);
+  Parents.clear();
+  Parents.resize(Total);
+  for (i = 0; i < Total; ++i)
+  {
+    Parents[i].Read(InFile);
+  }
+}
+
+void CarlaRecorderKeyframe::Write(std::ostream &OutFile) const
+{
+  // write the packet id
+  WriteValue<char>(OutFile, static_cast<char>(CarlaRecorderPacketId::Keyframe));
+
+  std::streampos PosStart = OutFile.tellp();
+
+  // write a dummy packet size
+  uint32_t Total = 0;
+  WriteValue<uint32_t>(OutFile, Total);
+
+  // actors
+  Total = Actors.size();
+  WriteValue<uint16_t>(OutFile, Total);
+  for (uint16_t i = 0; i < Total; ++i)
+  {
+    Actors[i].Write(OutFile);
+  }
+
+  // parents
+  Total = Parents.size();
+  WriteValue<uint16_t>(OutFile, Total);
+  for (uint16_t i = 0; i < Total; ++i)
+  {
+    Parents[i].Write(OutFile);
+  }
+
+  // write the real packet size
+  std::streampos PosEnd = OutFile.tellp();
+  Total = PosEnd - PosStart - sizeof(uint32_t);
+  OutFile.seekp(PosStart, std::ios::beg);
+  WriteValue<uint32_t>(OutFile, Total);
+  OutFile.seekp(PosEnd, std::ios::beg);
+}
+
+// ---------------------------------------------
+
+CarlaRecorderKeyframes::CarlaRecorderKeyframes(void)
+{
+  Reset(0.0);
+}
+
+void CarlaRecorderKeyframes::Reset(double NewInterval)
+{
+  Interval = NewInterval;
+  // the start of the recording does not need a keyframe
+  NextTime = NewInterval;
+  Actors.clear();
+  Parents.clear();
+}
+
+void CarlaRecorderKeyframes::Apply(const CarlaRecorderEventAdd &Event)
+{
+  Actors[Event.DatabaseId] = Event;
+}
+
+void CarlaRecorderKeyframes::Apply(const CarlaRecorderEventDel &Event)
+{
+  Actors.erase(Event.DatabaseId);
+  Parents.erase(Event.DatabaseId);
+}
+
+void CarlaRecorderKeyframes::Apply(const CarlaRecorderEventParent &Event)
+{
+  Parents[Event.DatabaseId] = Event.DatabaseIdParent;
+}
+
+void CarlaRecorderKeyframes::Write(std::ostream &OutFile, double Elapsed)
+{
+  CarlaRecorderKeyframe Keyframe;
+
+  Keyframe.Actors.reserve(Actors.size());
+  for (auto &Actor : Actors)
+  {
+    Keyframe.Actors.push_back(Actor.second);
+  }
+
+  // only parents that are still alive
+  for (auto &Parent : Parents)
+  {
+    if (Actors.count(Parent.second) > 0)
+    {
+      Keyframe.Parents.push_back(CarlaRecorderEventParent { Parent.first, Parent.second });
+    }
+  }
+
+  Keyframe.Write(OutFile);
+
+  // schedule the next one
+  while (NextTime <= Elapsed)
+  {
+    NextTime += Interval;
+  }
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#include "CarlaRecorderEventAdd.h"
+#include "CarlaRecorderEventDel.h"
+#include "CarlaRecorderEventParent.h"
+
+// full state needed to start replaying at a frame: the actors alive and their
+// parents before the events of that frame
+struct CarlaRecorderKeyframe
+{
+  std::vector<CarlaRecorderEventAdd> Actors;
+  std::vector<CarlaRecorderEventParent> Parents;
+
+  // read the packet data (after the header)
+  void Read(std::istream &InFile);
+
+  // write the whole packet, header included
+  void Write(std::ostream &OutFile) const;
+};
+
+// keeps track of the actors alive while recording (or while indexing an old
+// recording) to write a keyframe every some seconds
+class CarlaRecorderKeyframes
+{
+public:
+
+  CarlaRecorderKeyframes(void);
+
+  void Reset(double NewInterval);
+
+  // apply the events of a frame
+  void Apply(const CarlaRecorderEventAdd &Event);
+  void Apply(const CarlaRecorderEventDel &Event);
+  void Apply(const CarlaRecorderEventParent &Event);
+
+  // check if a keyframe needs to be written at the frame starting at Elapsed
+  bool IsDue(double Elapsed) const
+  {
+    return Interval > 0.0 && Elapsed >= NextTime;
+  }
+
+  // write the current state as a keyframe packet and schedule the next one
+  void Write(std::ostream &OutFile, double Elapsed);
+
+private:
+
+  double Interval;
+  double NextTime;
+  std::unordered_map<uint32_t, CarlaRecorderEventAdd> Actors;
+  // parent of each actor
+  std::unordered_map<uint32_t, uint32_t> Parents;
+};
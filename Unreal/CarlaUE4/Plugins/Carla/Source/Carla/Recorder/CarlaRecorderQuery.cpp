@@ -16,10 +16,7 @@ inline bool CarlaRecorderQuery::ReadHeader(void)
     return false;
   }
 
-  ReadValue<char>(File, Header.Id);
-  ReadValue<uint32_t>(File, Header.Size);
-
-  return true;
+  return File.ReadHeader(Header.Id, Header.Size);
 }
 
 inline void CarlaRecorderQuery::SkipPacket(void)
@@ -66,6 +63,7 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
   }
 
   uint16_t i, Total;
+  uint32_t Keyframes = 0;
   bool bFramePrinted = false;
 
   // lambda for repeating task
@@ -262,6 +260,20 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
           SkipPacket();
         break;
 
+      // keyframe
+      case static_cast<char>(CarlaRecorderPacketId::Keyframe):
+        ++Keyframes;
+        if (bShowAll)
+        {
+          CarlaRecorderKeyframe Keyframe;
+          Keyframe.Read(File);
+          // it goes before the start of its frame
+          Info << "Keyframe: " << Keyframe.Actors.size() << " actors, " << Keyframe.Parents.size() << " parents" << std::endl;
+        }
+        else
+          SkipPacket();
+        break;
+
       // frame end
       case static_cast<char>(CarlaRecorderPacketId::FrameEnd):
         // do nothing, it is empty
@@ -275,6 +287,7 @@ std::string CarlaRecorderQuery::QueryInfo(std::string Filename, bool bShowAll)
 
   Info << "\nFrames: " << Frame.Id << "\n";
   Info << "Duration: " << Frame.Elapsed << " seconds\n";
+  Info << "Keyframes: " << Keyframes << "\n";
 
   File.close();
 
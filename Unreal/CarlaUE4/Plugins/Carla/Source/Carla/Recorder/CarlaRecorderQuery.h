@@ -9,12 +9,14 @@
 #include <fstream>
 
 #include "CarlaRecorderAnimWalker.h"
+#include "CarlaRecorderBlock.h"
 #include "CarlaRecorderCollision.h"
 #include "CarlaRecorderEventAdd.h"
 #include "CarlaRecorderEventDel.h"
 #include "CarlaRecorderEventParent.h"
 #include "CarlaRecorderFrames.h"
 #include "CarlaRecorderInfo.h"
+#include "CarlaRecorderKeyframe.h"
 #include "CarlaRecorderPosition.h"
 #include "CarlaRecorderState.h"
 
@@ -40,7 +42,7 @@ public:
 
 private:
 
-  std::ifstream File;
+  CarlaRecorderInputFile File;
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
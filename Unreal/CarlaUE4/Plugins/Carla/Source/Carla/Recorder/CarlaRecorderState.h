@@ -17,9 +17,9 @@ struct CarlaRecorderStateTrafficLight
   float ElapsedTime;
   char State;
 
-  void Read(std::ifstream &InFile);
+  void Read(std::istream &InFile);
 
-  void Write(std::ofstream &OutFile);
+  void Write(std::ostream &OutFile);
 
 };
 
@@ -34,7 +34,7 @@ public:
 
   void Clear(void);
 
-  void Write(std::ofstream &OutFile);
+  void Write(std::ostream &OutFile);
 
 private:
 
@@ -0,0 +1,153 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "CarlaRecorder.h"
+#include "CarlaRecorderWriter.h"
+#include "CarlaRecorderHelpers.h"
+
+#include <algorithm>
+
+CarlaRecorderWriter::~CarlaRecorderWriter(void)
+{
+  Close();
+}
+
+bool CarlaRecorderWriter::Open(
+    const std::string &Filename,
+    CarlaRecorderInfo &Info,
+    CarlaRecorderCompression NewCompression,
+    size_t NewQueueSize)
+{
+  Close();
+
+  File.open(Filename, std::ios::binary);
+  if (!File.is_open())
+  {
+    return false;
+  }
+
+  // the info header is never compressed
+  Info.Write(File);
+
+  Compression = NewCompression;
+  QueueSize = std::max(NewQueueSize, size_t(1u));
+  Index.Clear();
+  Queue.clear();
+  Stats = CarlaRecorderWriterStats();
+  bClosing = false;
+
+  Thread = std::thread(&CarlaRecorderWriter::Run, this);
+  return true;
+}
+
+void CarlaRecorderWriter::Push(CarlaRecorderWriterBlock &&Block)
+{
+  std::unique_lock<std::mutex> Lock(Mutex);
+
+  // wait for the writer if it is behind
+  if (Queue.size() >= QueueSize)
+  {
+    ++Stats.QueueFullWaits;
+    QueueChanged.wait(Lock, [this]() { return Queue.size() < QueueSize; });
+  }
+
+  Block.QueuedAt = std::chrono::steady_clock::now();
+  Queue.push_back(std::move(Block));
+
+  Lock.unlock();
+  QueueChanged.notify_all();
+}
+
+void CarlaRecorderWriter::Close(void)
+{
+  if (!Thread.joinable())
+  {
+    return;
+  }
+
+  // let the writer finish the frames queued
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    bClosing = true;
+  }
+  QueueChanged.notify_all();
+  Thread.join();
+
+  // append the index of the frames
+  Index.Write(File);
+  Index.Clear();
+
+  File.close();
+}
+
+CarlaRecorderWriterStats CarlaRecorderWriter::GetStats(void) const
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Stats;
+}
+
+void CarlaRecorderWriter::Run(void)
+{
+  std::unique_lock<std::mutex> Lock(Mutex);
+  while (true)
+  {
+    QueueChanged.wait(Lock, [this]() { return bClosing || !Queue.empty(); });
+    if (Queue.empty())
+    {
+      // closing, and nothing left to write
+      break;
+    }
+
+    CarlaRecorderWriterBlock Block = std::move(Queue.front());
+    Queue.pop_front();
+    double Latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - Block.QueuedAt).count();
+    Lock.unlock();
+    QueueChanged.notify_all();
+
+    std::streampos Start = File.tellp();
+    Write(Block);
+    std::streampos End = File.tellp();
+
+    Lock.lock();
+    ++Stats.Frames;
+    Stats.RawBytes += Block.Keyframe.size() + Block.Packets.size();
+    Stats.WrittenBytes += End - Start;
+    Stats.TotalQueueLatency += Latency;
+    Stats.MaxQueueLatency = std::max(Stats.MaxQueueLatency, Latency);
+  }
+}
+
+void CarlaRecorderWriter::Write(const CarlaRecorderWriterBlock &Block)
+{
+  // keyframe, just before its frame
+  std::streampos KeyframeOffset = File.tellp();
+  if (!Block.Keyframe.empty())
+  {
+    File.write(Block.Keyframe.data(), Block.Keyframe.size());
+  }
+
+  // frame, in a block packet if it is compressed
+  std::streampos FrameOffset = File.tellp();
+  if (CarlaRecorderCompress(Compression, Block.Packets, Compressed))
+  {
+    CarlaRecorderBlockHeader Header { Compression, static_cast<uint32_t>(Block.Packets.size()) };
+    uint32_t Total = sizeof(CarlaRecorderBlockHeader) + Compressed.size();
+    WriteValue<char>(File, static_cast<char>(CarlaRecorderPacketId::Block));
+    WriteValue<uint32_t>(File, Total);
+    WriteValue<CarlaRecorderBlockHeader>(File, Header);
+    File.write(Compressed.data(), Compressed.size());
+  }
+  else
+  {
+    File.write(Block.Packets.data(), Block.Packets.size());
+  }
+
+  Index.AddFrame(Block.Frame, FrameOffset);
+  if (!Block.Keyframe.empty())
+  {
+    Index.AddKeyframe(KeyframeOffset);
+  }
+}
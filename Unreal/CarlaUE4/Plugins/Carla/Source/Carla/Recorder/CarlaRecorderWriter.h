@@ -0,0 +1,108 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "CarlaRecorderBlock.h"
+#include "CarlaRecorderFrames.h"
+#include "CarlaRecorderIndex.h"
+#include "CarlaRecorderInfo.h"
+
+// all the packets of a frame, ready to be written
+struct CarlaRecorderWriterBlock
+{
+  CarlaRecorderFrame Frame;
+  // keyframe packet, written before the frame if not empty
+  std::string Keyframe;
+  // packets of the frame, from frame start to frame end
+  std::string Packets;
+  std::chrono::steady_clock::time_point QueuedAt;
+};
+
+struct CarlaRecorderWriterStats
+{
+  uint64_t Frames = 0u;
+  // bytes of the packets of the frames
+  uint64_t RawBytes = 0u;
+  // bytes written to the file for them
+  uint64_t WrittenBytes = 0u;
+  // times a frame waited for room in the queue
+  uint64_t QueueFullWaits = 0u;
+  // seconds the frames waited in the queue
+  double TotalQueueLatency = 0.0;
+  double MaxQueueLatency = 0.0;
+};
+
+// Writes the frames of a recording from a background thread, compressing
+// them if asked, so the game thread only gathers the packets of each frame.
+//
+// The queue is bounded, when it is full the game thread waits for the writer
+// instead of holding more frames in memory. Closing the writer writes all the
+// frames queued and the index of the recording.
+class CarlaRecorderWriter
+{
+public:
+
+  // default number of frames that can wait to be written
+  static constexpr size_t DefaultQueueSize = 8u;
+
+  ~CarlaRecorderWriter(void);
+
+  bool Open(
+      const std::string &Filename,
+      CarlaRecorderInfo &Info,
+      CarlaRecorderCompression Compression = CarlaRecorderCompression::None,
+      size_t QueueSize = DefaultQueueSize);
+
+  bool IsOpen(void) const
+  {
+    return Thread.joinable();
+  }
+
+  void Push(CarlaRecorderWriterBlock &&Block);
+
+  // write everything queued, the index, and close the file
+  void Close(void);
+
+  CarlaRecorderWriterStats GetStats(void) const;
+
+private:
+
+  void Run(void);
+
+  void Write(const CarlaRecorderWriterBlock &Block);
+
+  std::ofstream File;
+
+  CarlaRecorderCompression Compression { CarlaRecorderCompression::None };
+
+  size_t QueueSize { DefaultQueueSize };
+
+  // written only from the writer thread while it is running
+  CarlaRecorderIndex Index;
+
+  std::string Compressed;
+
+  mutable std::mutex Mutex;
+
+  std::condition_variable QueueChanged;
+
+  std::deque<CarlaRecorderWriterBlock> Queue;
+
+  bool bClosing { false };
+
+  CarlaRecorderWriterStats Stats;
+
+  std::thread Thread;
+};
@@ -39,10 +39,7 @@ bool CarlaReplayer::ReadHeader()
     return false;
   }
 
-  ReadValue<char>(File, Header.Id);
-  ReadValue<uint32_t>(File, Header.Size);
-
-  return true;
+  return File.ReadHeader(Header.Id, Header.Size);
 }
 
 void CarlaReplayer::SkipPacket(void)
@@ -56,14 +53,14 @@ void CarlaReplayer::Rewind(void)
   TotalTime = 0.0f;
   TimeToStop = 0.0f;
 
-  File.clear();
-  File.seekg(0, std::ios::beg);
+  File.Seek(0);
 
   // mark as header as invalid to force reload a new one next time
   Frame.Elapsed = -1.0f;
   Frame.DurationThis = 0.0f;
 
   MappedId.clear();
+  Positions.Clear();
 
   // read geneal Info
   RecInfo.Read(File);
@@ -72,6 +69,12 @@ void CarlaReplayer::Rewind(void)
 // read last frame in File and return the Total time recorded
 double CarlaReplayer::GetTotalTime(void)
 {
+  // without reading the file if it is indexed
+  if (!Index.IsEmpty())
+  {
+    return Index.GetTotalTime();
+  }
+
   std::streampos Current = File.tellg();
 
   // parse only frames
@@ -95,8 +98,7 @@ double CarlaReplayer::GetTotalTime(void)
     }
   }
 
-  File.clear();
-  File.seekg(Current, std::ios::beg);
+  File.Seek(Current);
   return Frame.Elapsed;
 }
 
@@ -128,6 +130,9 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   // from start
   Rewind();
 
+  // load the index, or build it once for older recordings
+  Index.Load(Filename2);
+
   // check to load map if different
   if (Episode->GetMapName() != RecInfo.Mapfile)
   {
@@ -177,6 +182,8 @@ std::string CarlaReplayer::ReplayFile(std::string Filename, double TimeStart, do
   // if we don't need to load a new map, then start
   if (!Autoplay.Enabled)
   {
+    // start from the nearest keyframe
+    SeekToKeyframe(TimeStart);
     // process all events until the time
     ProcessToTime(TimeStart, true);
     // mark as enabled
@@ -212,6 +219,9 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   // from start
   Rewind();
 
+  // load the index
+  Index.Load(Autoplay.Filename);
+
   // get Total time of recorder
   TotalTime = GetTotalTime();
 
@@ -236,6 +246,9 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   // apply time factor
   TimeFactor = Autoplay.TimeFactor;
 
+  // start from the nearest keyframe
+  SeekToKeyframe(TimeStart);
+
   // process all events until the time
   ProcessToTime(TimeStart, true);
 
@@ -243,6 +256,52 @@ void CarlaReplayer::CheckPlayAfterMapLoaded(void)
   Enabled = true;
 }
 
+void CarlaReplayer::SeekToKeyframe(double Time)
+{
+  if (Index.IsEmpty())
+  {
+    return;
+  }
+
+  const CarlaRecorderIndexKeyframe *Keyframe = Index.FindKeyframe(Index.FindFrame(Time));
+  if (Keyframe == nullptr)
+  {
+    return;
+  }
+
+  // read the keyframe, from the recording or from its index file
+  std::ifstream KeyframeFile(Index.GetKeyframesFilename(), std::ios::binary);
+  if (!KeyframeFile.is_open())
+  {
+    return;
+  }
+  char Id;
+  uint32_t Size;
+  CarlaRecorderKeyframe Data;
+  KeyframeFile.seekg(Keyframe->Offset, std::ios::beg);
+  ReadValue<char>(KeyframeFile, Id);
+  ReadValue<uint32_t>(KeyframeFile, Size);
+  if (!KeyframeFile || Id != static_cast<char>(CarlaRecorderPacketId::Keyframe))
+  {
+    UE_LOG(LogCarla, Warning, TEXT("Invalid keyframe in recorder index, replaying from the start"));
+    return;
+  }
+  Data.Read(KeyframeFile);
+
+  // create the actors alive at that frame
+  for (auto &Actor : Data.Actors)
+  {
+    ProcessEventAdd(Actor);
+  }
+  for (auto &Parent : Data.Parents)
+  {
+    ProcessEventParent(Parent);
+  }
+
+  // and continue from the start of that frame
+  File.Seek(Index.GetFrames()[Keyframe->Frame].Offset);
+}
+
 void CarlaReplayer::ProcessToTime(double Time, bool IsFirstTime)
 {
   double Per = 0.0f;
@@ -374,33 +433,40 @@ void CarlaReplayer::ProcessEventsAdd(void)
   for (i = 0; i < Total; ++i)
   {
     EventAdd.Read(File);
+    ProcessEventAdd(EventAdd);
+  }
+}
+
+void CarlaReplayer::ProcessEventAdd(CarlaRecorderEventAdd &EventAdd)
+{
+  // the Id may be mapped to another actor
+  Positions.Remove(EventAdd.DatabaseId);
 
-    // auto Result = CallbackEventAdd(
-    auto Result = Helper.ProcessReplayerEventAdd(
-        EventAdd.Location,
-        EventAdd.Rotation,
-        std::move(EventAdd.Description),
-        EventAdd.DatabaseId);
+  // auto Result = CallbackEventAdd(
+  auto Result = Helper.ProcessReplayerEventAdd(
+      EventAdd.Location,
+      EventAdd.Rotation,
+      std::move(EventAdd.Description),
+      EventAdd.DatabaseId);
 
-    switch (Result.first)
-    {
-      // actor not created
-      case 0:
-        UE_LOG(LogCarla, Log, TEXT("actor could not be created"));
-        break;
+  switch (Result.first)
+  {
+    // actor not created
+    case 0:
+      UE_LOG(LogCarla, Log, TEXT("actor could not be created"));
+      break;
 
-      // actor created but with different id
-      case 1:
-        // mapping id (recorded Id is a new Id in replayer)
-        MappedId[EventAdd.DatabaseId] = Result.second;
-        break;
+    // actor created but with different id
+    case 1:
+      // mapping id (recorded Id is a new Id in replayer)
+      MappedId[EventAdd.DatabaseId] = Result.second;
+      break;
 
-      // actor reused from existing
-      case 2:
-        // mapping id (say desired Id is mapped to what)
-        MappedId[EventAdd.DatabaseId] = Result.second;
-        break;
-    }
+    // actor reused from existing
+    case 2:
+      // mapping id (say desired Id is mapped to what)
+      MappedId[EventAdd.DatabaseId] = Result.second;
+      break;
   }
 }
 
@@ -416,6 +482,7 @@ void CarlaReplayer::ProcessEventsDel(void)
     EventDel.Read(File);
     Helper.ProcessReplayerEventDel(MappedId[EventDel.DatabaseId]);
     MappedId.erase(EventDel.DatabaseId);
+    Positions.Remove(EventDel.DatabaseId);
   }
 }
 
@@ -430,10 +497,15 @@ void CarlaReplayer::ProcessEventsParent(void)
   for (i = 0; i < Total; ++i)
   {
     EventParent.Read(File);
-    Helper.ProcessReplayerEventParent(MappedId[EventParent.DatabaseId], MappedId[EventParent.DatabaseIdParent]);
+    ProcessEventParent(EventParent);
   }
 }
 
+void CarlaReplayer::ProcessEventParent(const CarlaRecorderEventParent &EventParent)
+{
+  Helper.ProcessReplayerEventParent(MappedId[EventParent.DatabaseId], MappedId[EventParent.DatabaseIdParent]);
+}
+
 void CarlaReplayer::ProcessStates(void)
 {
   uint16_t i, Total;
@@ -492,47 +564,48 @@ void CarlaReplayer::ProcessAnimWalker(void)
 void CarlaReplayer::ProcessPositions(bool IsFirstTime)
 {
   uint16_t i, Total;
+  uint32_t Slot;
+  CarlaRecorderPosition Pos;
 
-  // save current as previous
-  PrevPos = std::move(CurrPos);
+  // save current as previous, the first time there are no previous ones
+  Positions.BeginFrame(IsFirstTime);
 
   // read all positions
   ReadValue<uint16_t>(File, Total);
-  CurrPos.clear();
-  CurrPos.reserve(Total);
   for (i = 0; i < Total; ++i)
   {
-    CarlaRecorderPosition Pos;
     Pos.Read(File);
-    // assign mapped Id
-    auto NewId = MappedId.find(Pos.DatabaseId);
-    if (NewId != MappedId.end())
+    if (!Positions.FindSlot(Pos.DatabaseId, Slot))
     {
-      Pos.DatabaseId = NewId->second;
+      // assign mapped Id
+      uint32_t NewId = Pos.DatabaseId;
+      auto Result = MappedId.find(Pos.DatabaseId);
+      if (Result != MappedId.end())
+      {
+        NewId = Result->second;
+      }
+      else
+        UE_LOG(LogCarla, Log, TEXT("Actor not found when trying to move from replayer (id. %d)"), Pos.DatabaseId);
+      Slot = Positions.AddSlot(Pos.DatabaseId, NewId);
     }
-    else
-      UE_LOG(LogCarla, Log, TEXT("Actor not found when trying to move from replayer (id. %d)"), Pos.DatabaseId);
-    CurrPos.push_back(std::move(Pos));
-  }
-
-  // check to copy positions the first time
-  if (IsFirstTime)
-  {
-    PrevPos.clear();
+    Positions.SetCurrent(Slot, Pos.Location, Pos.Rotation);
   }
 }
 
 void CarlaReplayer::UpdatePositions(double Per, double DeltaTime)
 {
-  unsigned int i;
   uint32_t NewFollowId = 0;
-  std::unordered_map<int, int> TempMap;
+  uint32_t FollowSlot;
+
+  // check if time factor is high to assign the first position, otherwise
+  // interpolate (all actors at once)
+  Positions.Interpolate(TimeFactor >= 2.0 ? 0.0f : static_cast<float>(Per));
 
-  // map the id of all previous positions to its index
-  for (i = 0; i < PrevPos.size(); ++i)
+  // go through each actor and update
+  Positions.ForEachUpdated([this](uint32_t DatabaseId, const FVector &Location, const FVector &Rotation, TWeakObjectPtr<AActor> &Actor)
   {
-    TempMap[PrevPos[i].DatabaseId] = i;
-  }
+    Helper.ProcessReplayerPosition(DatabaseId, Location, Rotation, Actor);
+  });
 
   // get the Id of the actor to follow
   if (FollowId != 0)
@@ -544,47 +617,13 @@ void CarlaReplayer::UpdatePositions(double Per, double DeltaTime)
     }
   }
 
-  // go through each actor and update
-  for (i = 0; i < CurrPos.size(); ++i)
+  // move the camera to follow this actor if required
+  if (NewFollowId != 0 && Positions.FindSlot(FollowId, FollowSlot) && Positions.IsUpdated(FollowSlot))
   {
-    // check if exist a previous position
-    auto Result = TempMap.find(CurrPos[i].DatabaseId);
-    if (Result != TempMap.end())
-    {
-      // check if time factor is high
-      if (TimeFactor >= 2.0)
-        // assign first position
-        InterpolatePosition(PrevPos[Result->second], CurrPos[i], 0.0, DeltaTime);
-      else
-        // interpolate
-        InterpolatePosition(PrevPos[Result->second], CurrPos[i], Per, DeltaTime);
-    }
-    else
-    {
-      // assign last position (we don't have previous one)
-      InterpolatePosition(CurrPos[i], CurrPos[i], 0.0, DeltaTime);
-    }
-
-    // move the camera to follow this actor if required
-    if (NewFollowId != 0)
-    {
-      if (NewFollowId == CurrPos[i].DatabaseId)
-        Helper.SetCameraPosition(NewFollowId, FVector(-1000, 0, 500), FQuat::MakeFromEuler({0, -25, 0}));
-    }
+    Helper.SetCameraPosition(NewFollowId, FVector(-1000, 0, 500), FQuat::MakeFromEuler({0, -25, 0}));
   }
 }
 
-// interpolate a position (transform, velocity...)
-void CarlaReplayer::InterpolatePosition(
-    const CarlaRecorderPosition &Pos1,
-    const CarlaRecorderPosition &Pos2,
-    double Per,
-    double DeltaTime)
-{
-  // call the callback
-  Helper.ProcessReplayerPosition(Pos1, Pos2, Per, DeltaTime);
-}
-
 // tick for the replayer
 void CarlaReplayer::Tick(float Delta)
 {
@@ -20,7 +20,11 @@
 #include "CarlaRecorderPosition.h"
 #include "CarlaRecorderState.h"
 #include "CarlaRecorderHelpers.h"
+#include "CarlaRecorderBlock.h"
+#include "CarlaRecorderIndex.h"
+#include "CarlaRecorderKeyframe.h"
 #include "CarlaReplayerHelper.h"
+#include "CarlaReplayerPositions.h"
 
 class UCarlaEpisode;
 
@@ -89,13 +93,14 @@ private:
   bool Enabled;
   UCarlaEpisode *Episode = nullptr;
   // binary file reader
-  std::ifstream File;
+  CarlaRecorderInputFile File;
   Header Header;
   CarlaRecorderInfo RecInfo;
   CarlaRecorderFrame Frame;
+  // index of frames and keyframes
+  CarlaRecorderIndex Index;
   // positions (to be able to interpolate)
-  std::vector<CarlaRecorderPosition> CurrPos;
-  std::vector<CarlaRecorderPosition> PrevPos;
+  CarlaReplayerPositions Positions;
   // mapping id
   std::unordered_map<uint32_t, uint32_t> MappedId;
   // times
@@ -118,6 +123,9 @@ private:
 
   void Rewind(void);
 
+  // jump to the last keyframe before a time
+  void SeekToKeyframe(double Time);
+
   // processing packets
   void ProcessToTime(double Time, bool IsFirstTime = false);
 
@@ -125,6 +133,9 @@ private:
   void ProcessEventsDel(void);
   void ProcessEventsParent(void);
 
+  void ProcessEventAdd(CarlaRecorderEventAdd &EventAdd);
+  void ProcessEventParent(const CarlaRecorderEventParent &EventParent);
+
   void ProcessPositions(bool IsFirstTime = false);
 
   void ProcessStates(void);
@@ -134,6 +145,4 @@ private:
 
   // positions
   void UpdatePositions(double Per, double DeltaTime);
-
-  void InterpolatePosition(const CarlaRecorderPosition &Start, const CarlaRecorderPosition &End, double Per, double DeltaTime);
 };
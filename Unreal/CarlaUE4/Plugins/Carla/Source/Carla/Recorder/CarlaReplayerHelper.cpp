@@ -222,29 +222,22 @@ bool CarlaReplayerHelper::ProcessReplayerEventParent(uint32_t ChildId, uint32_t
 }
 
 // reposition actors
-bool CarlaReplayerHelper::ProcessReplayerPosition(CarlaRecorderPosition Pos1, CarlaRecorderPosition Pos2, double Per, double DeltaTime)
+bool CarlaReplayerHelper::ProcessReplayerPosition(
+    uint32_t DatabaseId,
+    const FVector &Location,
+    const FVector &Rotation,
+    TWeakObjectPtr<AActor> &CachedActor)
 {
   check(Episode != nullptr);
-  AActor *Actor = Episode->GetActorRegistry().Find(Pos1.DatabaseId).GetActor();
-  FVector Location;
-  FRotator Rotation;
-  if (Actor  && !Actor->IsPendingKill())
+  if (!CachedActor.IsValid())
+  {
+    CachedActor = Episode->GetActorRegistry().Find(DatabaseId).GetActor();
+  }
+  AActor *Actor = CachedActor.Get();
+  if (Actor && !Actor->IsPendingKill())
   {
-    // check to assign first position or interpolate between both
-    if (Per == 0.0)
-    {
-      // assign position 1
-      Location = FVector(Pos1.Location);
-      Rotation = FRotator::MakeFromEuler(Pos1.Rotation);
-    }
-    else
-    {
-      // interpolate positions
-      Location = FMath::Lerp(FVector(Pos1.Location), FVector(Pos2.Location), Per);
-      Rotation = FMath::Lerp(FRotator::MakeFromEuler(Pos1.Rotation), FRotator::MakeFromEuler(Pos2.Rotation), Per);
-    }
     // set new transform
-    FTransform Trans(Rotation, Location, FVector(1, 1, 1));
+    FTransform Trans(FRotator::MakeFromEuler(Rotation), Location, FVector(1, 1, 1));
     Actor->SetActorTransform(Trans, false, nullptr, ETeleportType::None);
     return true;
   }
@@ -34,8 +34,12 @@ public:
   // replay event for parenting actors
   bool ProcessReplayerEventParent(uint32_t ChildId, uint32_t ParentId);
 
-  // reposition actors
-  bool ProcessReplayerPosition(CarlaRecorderPosition Pos1, CarlaRecorderPosition Pos2, double Per, double DeltaTime);
+  // reposition an actor, looking it up only if the cached one is not valid
+  bool ProcessReplayerPosition(
+      uint32_t DatabaseId,
+      const FVector &Location,
+      const FVector &Rotation,
+      TWeakObjectPtr<AActor> &CachedActor);
 
   // replay event for traffic light state
   bool ProcessReplayerStateTrafficLight(CarlaRecorderStateTrafficLight State);
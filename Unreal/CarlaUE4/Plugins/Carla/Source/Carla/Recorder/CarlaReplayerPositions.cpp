@@ -0,0 +1,142 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "Carla.h"
+#include "Carla/Recorder/CarlaReplayerPositions.h"
+
+#include <algorithm>
+#include <cmath>
+
+void CarlaReplayerPositions::Clear(void)
+{
+  Slots.clear();
+  FreeSlots.clear();
+  DatabaseIds.clear();
+  Actors.clear();
+  Updated.clear();
+  PrevUpdated.clear();
+  for (size_t i = 0; i < NumComponents; ++i)
+  {
+    Prev[i].clear();
+    Curr[i].clear();
+    Out[i].clear();
+  }
+}
+
+void CarlaReplayerPositions::Remove(uint32_t RecordedId)
+{
+  auto Result = Slots.find(RecordedId);
+  if (Result == Slots.end())
+  {
+    return;
+  }
+  uint32_t Slot = Result->second;
+  Slots.erase(Result);
+  Actors[Slot] = nullptr;
+  Updated[Slot] = 0u;
+  PrevUpdated[Slot] = 0u;
+  FreeSlots.push_back(Slot);
+}
+
+bool CarlaReplayerPositions::FindSlot(uint32_t RecordedId, uint32_t &Slot) const
+{
+  auto Result = Slots.find(RecordedId);
+  if (Result == Slots.end())
+  {
+    return false;
+  }
+  Slot = Result->second;
+  return true;
+}
+
+uint32_t CarlaReplayerPositions::AddSlot(uint32_t RecordedId, uint32_t DatabaseId)
+{
+  uint32_t Slot;
+  if (!FreeSlots.empty())
+  {
+    Slot = FreeSlots.back();
+    FreeSlots.pop_back();
+  }
+  else
+  {
+    Slot = static_cast<uint32_t>(DatabaseIds.size());
+    const size_t Size = DatabaseIds.size() + 1;
+    DatabaseIds.resize(Size);
+    Actors.resize(Size);
+    Updated.resize(Size, 0u);
+    PrevUpdated.resize(Size, 0u);
+    for (size_t i = 0; i < NumComponents; ++i)
+    {
+      Prev[i].resize(Size, 0.0f);
+      Curr[i].resize(Size, 0.0f);
+      Out[i].resize(Size, 0.0f);
+    }
+  }
+  DatabaseIds[Slot] = DatabaseId;
+  Slots[RecordedId] = Slot;
+  return Slot;
+}
+
+void CarlaReplayerPositions::BeginFrame(bool bDiscardPrevious)
+{
+  // the arrays of the slots not read in this frame keep stale values, they
+  // are neither applied nor used as previous positions
+  std::swap(Prev, Curr);
+  std::swap(PrevUpdated, Updated);
+  std::fill(Updated.begin(), Updated.end(), 0u);
+  if (bDiscardPrevious)
+  {
+    std::fill(PrevUpdated.begin(), PrevUpdated.end(), 0u);
+  }
+}
+
+void CarlaReplayerPositions::SetCurrent(uint32_t Slot, const FVector &Location, const FVector &Rotation)
+{
+  const float Values[NumComponents] = {
+      Location.X, Location.Y, Location.Z, Rotation.X, Rotation.Y, Rotation.Z };
+  for (size_t i = 0; i < NumComponents; ++i)
+  {
+    Curr[i][Slot] = Values[i];
+  }
+  // without a previous position, it is assigned the current one
+  if (PrevUpdated[Slot] == 0u)
+  {
+    for (size_t i = 0; i < NumComponents; ++i)
+    {
+      Prev[i][Slot] = Values[i];
+    }
+  }
+  Updated[Slot] = 1u;
+}
+
+void CarlaReplayerPositions::Interpolate(float Per)
+{
+  const size_t Size = DatabaseIds.size();
+  for (size_t i = X; i <= Z; ++i)
+  {
+    const float *Start = Prev[i].data();
+    const float *End = Curr[i].data();
+    float *Result = Out[i].data();
+    for (size_t Slot = 0; Slot < Size; ++Slot)
+    {
+      Result[Slot] = Start[Slot] + (End[Slot] - Start[Slot]) * Per;
+    }
+  }
+  // angles through the shortest way, as FMath::Lerp does for rotators
+  for (size_t i = Roll; i <= Yaw; ++i)
+  {
+    const float *Start = Prev[i].data();
+    const float *End = Curr[i].data();
+    float *Result = Out[i].data();
+    for (size_t Slot = 0; Slot < Size; ++Slot)
+    {
+      float Delta = End[Slot] - Start[Slot];
+      // normalize to (-180, 180]
+      Delta -= 360.0f * std::ceil((Delta - 180.0f) / 360.0f);
+      Result[Slot] = Start[Slot] + Delta * Per;
+    }
+  }
+}
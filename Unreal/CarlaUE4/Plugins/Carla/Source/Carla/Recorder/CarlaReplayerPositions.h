@@ -0,0 +1,91 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+class AActor;
+
+// Previous and current positions of the actors being replayed, to interpolate
+// between frames.
+//
+// Each actor keeps the same slot while it exists, so the positions of all the
+// actors are stored as one array per component and interpolated in a single
+// pass. Slots are found by the Id in the recording, and hold the Id of the
+// actor in the episode and a weak pointer to it, so actors are only looked up
+// again after they are destroyed.
+class CarlaReplayerPositions
+{
+public:
+
+  // forget all the actors
+  void Clear(void);
+
+  // release the slot of an actor, its Id can be mapped to another actor
+  void Remove(uint32_t RecordedId);
+
+  // slot of an actor, false if it has no slot yet
+  bool FindSlot(uint32_t RecordedId, uint32_t &Slot) const;
+
+  // assign a slot to an actor, DatabaseId is its Id in the episode
+  uint32_t AddSlot(uint32_t RecordedId, uint32_t DatabaseId);
+
+  // the current positions become the previous ones, or are discarded to
+  // place the actors at the positions read next
+  void BeginFrame(bool bDiscardPrevious = false);
+
+  // position read in this frame, also the previous one if the actor had none
+  void SetCurrent(uint32_t Slot, const FVector &Location, const FVector &Rotation);
+
+  bool IsUpdated(uint32_t Slot) const
+  {
+    return Updated[Slot] != 0u;
+  }
+
+  // interpolate the positions of all the slots, Per = 0 gives the previous
+  // positions
+  void Interpolate(float Per);
+
+  // call Callback(DatabaseId, Location, Rotation, Actor) with the position
+  // interpolated of each actor read in this frame
+  template <typename FunctorT>
+  void ForEachUpdated(FunctorT &&Callback)
+  {
+    for (uint32_t Slot = 0u; Slot < DatabaseIds.size(); ++Slot)
+    {
+      if (Updated[Slot] != 0u)
+      {
+        Callback(
+            DatabaseIds[Slot],
+            FVector(Out[X][Slot], Out[Y][Slot], Out[Z][Slot]),
+            FVector(Out[Roll][Slot], Out[Pitch][Slot], Out[Yaw][Slot]),
+            Actors[Slot]);
+      }
+    }
+  }
+
+private:
+
+  // components of a position, as stored in the recording
+  enum Component { X, Y, Z, Roll, Pitch, Yaw, NumComponents };
+
+  using Components = std::array<std::vector<float>, NumComponents>;
+
+  std::unordered_map<uint32_t, uint32_t> Slots;
+  std::vector<uint32_t> FreeSlots;
+
+  // per slot
+  std::vector<uint32_t> DatabaseIds;
+  std::vector<TWeakObjectPtr<AActor>> Actors;
+  std::vector<uint8_t> Updated;
+  std::vector<uint8_t> PrevUpdated;
+  Components Prev;
+  Components Curr;
+  Components Out;
+};
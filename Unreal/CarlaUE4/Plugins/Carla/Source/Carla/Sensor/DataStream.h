@@ -50,6 +50,15 @@ public:
     return (*Stream).token();
   }
 
+  /// Call @a Callback, from a streaming thread, every time a client
+  /// subscribes to this stream. Only available for FDataMultiStream.
+  template <typename FunctorT>
+  void SetOnConnectCallback(FunctorT &&Callback)
+  {
+    check(Stream.has_value());
+    (*Stream).SetOnConnectCallback(std::forward<FunctorT>(Callback));
+  }
+
 private:
 
   boost::optional<StreamType> Stream;
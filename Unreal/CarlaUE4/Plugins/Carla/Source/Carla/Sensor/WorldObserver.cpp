@@ -15,6 +15,7 @@
 #include <compiler/disable-ue4-macros.h>
 #include <carla/sensor/SensorRegistry.h>
 #include <carla/sensor/data/ActorDynamicState.h>
+#include <carla/sensor/s11n/EpisodeStateDelta.h>
 #include <compiler/enable-ue4-macros.h>
 
 static auto FWorldObserver_GetActorState(const FActorView &View, const FActorRegistry &Registry)
@@ -22,6 +23,8 @@ static auto FWorldObserver_GetActorState(const FActorView &View, const FActorReg
   using AType = FActorView::ActorType;
 
   carla::sensor::data::ActorDynamicState::TypeDependentState state;
+  // Zero the unused bytes so unchanged states compare equal in delta mode.
+  std::memset(&state, 0, sizeof(state));
 
   if (AType::Vehicle == View.GetActorType())
   {
@@ -99,6 +102,37 @@ static carla::geom::Vector3D FWorldObserver_GetAcceleration(
   return {Acceleration.X, Acceleration.Y, Acceleration.Z};
 }
 
+static carla::sensor::data::ActorDynamicState FWorldObserver_GetActorDynamicState(
+    const FActorView &View,
+    const FActorRegistry &Registry,
+    float DeltaSeconds)
+{
+  check(View.IsValid());
+  constexpr float TO_METERS = 1e-2;
+  const auto Velocity = TO_METERS * View.GetActor()->GetVelocity();
+
+  return {
+    View.GetActorId(),
+    View.GetActor()->GetActorTransform(),
+    carla::geom::Vector3D{Velocity.X, Velocity.Y, Velocity.Z},
+    FWorldObserver_GetAngularVelocity(*View.GetActor()),
+    FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds),
+    FWorldObserver_GetActorState(View, Registry)
+  };
+}
+
+static carla::sensor::s11n::EpisodeStateSerializer::Header FWorldObserver_MakeHeader(
+    const UCarlaEpisode &Episode,
+    float DeltaSeconds)
+{
+  carla::sensor::s11n::EpisodeStateSerializer::Header header;
+  header.episode_id = Episode.GetId();
+  header.platform_timestamp = FPlatformTime::Seconds();
+  header.delta_seconds = DeltaSeconds;
+  header.encoding = carla::sensor::s11n::EpisodeStateSerializer::Encoding::Full;
+  return header;
+}
+
 static carla::Buffer FWorldObserver_Serialize(
     carla::Buffer &&buffer,
     const UCarlaEpisode &Episode,
@@ -119,42 +153,108 @@ static carla::Buffer FWorldObserver_Serialize(
   };
 
   // Write header.
-  Serializer::Header header;
-  header.episode_id = Episode.GetId();
-  header.platform_timestamp = FPlatformTime::Seconds();
-  header.delta_seconds = DeltaSeconds;
-  write_data(header);
+  write_data(FWorldObserver_MakeHeader(Episode, DeltaSeconds));
 
   // Write every actor.
   for (auto &&View : Registry)
   {
-    check(View.IsValid());
-    constexpr float TO_METERS = 1e-2;
-    const auto Velocity = TO_METERS * View.GetActor()->GetVelocity();
-
-    ActorDynamicState info = {
-      View.GetActorId(),
-      View.GetActor()->GetActorTransform(),
-      carla::geom::Vector3D{Velocity.X, Velocity.Y, Velocity.Z},
-      FWorldObserver_GetAngularVelocity(*View.GetActor()),
-      FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds),
-      FWorldObserver_GetActorState(View, Registry)
-    };
-    write_data(info);
+    write_data(FWorldObserver_GetActorDynamicState(View, Registry, DeltaSeconds));
   }
 
   check(begin == buffer.end());
   return std::move(buffer);
 }
 
+static void FWorldObserver_GetActorStates(
+    std::vector<carla::sensor::data::ActorDynamicState> &ActorStates,
+    const UCarlaEpisode &Episode,
+    float DeltaSeconds)
+{
+  const auto &Registry = Episode.GetActorRegistry();
+
+  ActorStates.clear();
+  ActorStates.reserve(Registry.Num());
+  for (auto &&View : Registry)
+  {
+    ActorStates.emplace_back(FWorldObserver_GetActorDynamicState(View, Registry, DeltaSeconds));
+  }
+}
+
+FWorldObserver::FWorldObserver() = default;
+
+FWorldObserver::~FWorldObserver() = default;
+
+void FWorldObserver::EnableDeltaEncoding(uint32 KeyframeInterval)
+{
+  DeltaEncoder = std::make_shared<carla::sensor::s11n::EpisodeStateDeltaEncoder>(KeyframeInterval);
+  BindKeyframeOnConnect();
+}
+
+void FWorldObserver::SetStream(FDataMultiStream InStream)
+{
+  Stream = std::move(InStream);
+  BindKeyframeOnConnect();
+}
+
+void FWorldObserver::BindKeyframeOnConnect()
+{
+  if (DeltaEncoder == nullptr)
+  {
+    return;
+  }
+  // Called from a streaming thread, the encoder only raises a flag.
+  std::weak_ptr<carla::sensor::s11n::EpisodeStateDeltaEncoder> WeakEncoder = DeltaEncoder;
+  Stream.SetOnConnectCallback([WeakEncoder]()
+  {
+    auto Encoder = WeakEncoder.lock();
+    if (Encoder != nullptr)
+    {
+      Encoder->RequestKeyframe();
+    }
+  });
+}
+
 void FWorldObserver::BroadcastTick(const UCarlaEpisode &Episode, float DeltaSeconds)
 {
   auto AsyncStream = Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
 
-  auto buffer = FWorldObserver_Serialize(
+  if (DeltaEncoder == nullptr)
+  {
+    AsyncStream.Send(*this, FWorldObserver_Serialize(
+        AsyncStream.PopBufferFromPool(),
+        Episode,
+        DeltaSeconds));
+    return;
+  }
+
+  FWorldObserver_GetActorStates(ActorStates, Episode, DeltaSeconds);
+  LastHeader = FWorldObserver_MakeHeader(Episode, DeltaSeconds);
+  LastTimestamp = Episode.GetElapsedGameTime();
+  LastFrame = GFrameCounter;
+
+  AsyncStream.Send(*this, DeltaEncoder->Serialize(
       AsyncStream.PopBufferFromPool(),
-      Episode,
-      DeltaSeconds);
+      LastHeader,
+      GFrameCounter,
+      ActorStates));
+}
 
-  AsyncStream.Send(*this, std::move(buffer));
+void FWorldObserver::SendKeyframe()
+{
+  if (DeltaEncoder == nullptr)
+  {
+    return;
+  }
+  DeltaEncoder->RequestKeyframe();
+  // The frame of the message is the current one, the states must be too.
+  if (!LastFrame.IsSet() || (LastFrame.GetValue() != GFrameCounter))
+  {
+    return;
+  }
+  auto AsyncStream = Stream.MakeAsyncDataStream(*this, LastTimestamp);
+  AsyncStream.Send(*this, DeltaEncoder->Serialize(
+      AsyncStream.PopBufferFromPool(),
+      LastHeader,
+      GFrameCounter,
+      ActorStates));
 }
@@ -8,6 +8,18 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/ActorDynamicState.h>
+#include <carla/sensor/s11n/EpisodeStateSerializer.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <memory>
+#include <vector>
+
+namespace carla { namespace sensor { namespace s11n {
+  class EpisodeStateDeltaEncoder;
+}}}
+
 class UCarlaEpisode;
 
 /// Serializes and sends all the actors in the current UCarlaEpisode.
@@ -18,11 +30,18 @@ public:
   /// Prevent this sensor to be spawned by users.
   using not_spawnable = void;
 
+  FWorldObserver();
+
+  ~FWorldObserver();
+
+  /// Send only the changes since the previous tick, with a full state every
+  /// @a KeyframeInterval ticks and whenever a client subscribes.
+  ///
+  /// @pre The stream has been set.
+  void EnableDeltaEncoding(uint32 KeyframeInterval);
+
   /// Replace the Stream associated with this sensor.
-  void SetStream(FDataMultiStream InStream)
-  {
-    Stream = std::move(InStream);
-  }
+  void SetStream(FDataMultiStream InStream);
 
   /// Return the token that allows subscribing to this sensor's stream.
   auto GetToken() const
@@ -34,6 +53,14 @@ public:
   /// Episode.
   void BroadcastTick(const UCarlaEpisode &Episode, float DeltaSeconds);
 
+  /// Send again the state of the last tick as a full state, for clients that
+  /// missed the base of a delta. If this frame has not been broadcast yet,
+  /// the next tick is sent as a full state instead. Does nothing without
+  /// delta encoding.
+  ///
+  /// @pre This functions needs to be called in the game-thread.
+  void SendKeyframe();
+
   /// Dummy. Required for compatibility with other sensors only.
   FTransform GetActorTransform() const
   {
@@ -42,5 +69,24 @@ public:
 
 private:
 
+  /// Make the encoder send a keyframe every time a client subscribes.
+  void BindKeyframeOnConnect();
+
   FDataMultiStream Stream;
+
+  /// Shared with the callback of the stream, which may outlive this object.
+  std::shared_ptr<carla::sensor::s11n::EpisodeStateDeltaEncoder> DeltaEncoder;
+
+  /// @name State of the last tick broadcast, in delta encoding only
+  /// @{
+
+  std::vector<carla::sensor::data::ActorDynamicState> ActorStates;
+
+  carla::sensor::s11n::EpisodeStateSerializer::Header LastHeader;
+
+  double LastTimestamp = 0.0;
+
+  TOptional<uint64> LastFrame;
+
+  /// @}
 };
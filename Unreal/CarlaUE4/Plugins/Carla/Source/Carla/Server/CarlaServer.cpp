@@ -8,6 +8,7 @@
 #include "Carla/Server/CarlaServer.h"
 
 #include "Carla/OpenDrive/OpenDrive.h"
+#include "Carla/Settings/CarlaSettings.h"
 #include "Carla/Util/DebugShapeDrawer.h"
 #include "Carla/Util/NavigationMesh.h"
 #include "Carla/Vehicle/CarlaWheeledVehicle.h"
@@ -80,6 +81,8 @@ public:
 
   size_t TickCuesReceived = 0u;
 
+  TFunction<void()> OnEpisodeKeyframeRequest;
+
 private:
 
   void BindActions();
@@ -156,6 +159,11 @@ void FCarlaServer::FPimpl::BindActions()
     return carla::version();
   };
 
+  BIND_ASYNC(get_streaming_statistics) << [this]() -> R<carla::streaming::SessionStatistics>
+  {
+    return StreamingServer.GetStatistics();
+  };
+
   // ~~ Tick ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_SYNC(tick_cue) << [this]() -> R<uint64_t>
@@ -164,6 +172,16 @@ void FCarlaServer::FPimpl::BindActions()
     return GFrameCounter + 1u;
   };
 
+  BIND_SYNC(request_episode_keyframe) << [this]() -> R<void>
+  {
+    CARLA_ENSURE_GAME_THREAD();
+    if (OnEpisodeKeyframeRequest)
+    {
+      OnEpisodeKeyframeRequest();
+    }
+    return R<void>::Success();
+  };
+
   // ~~ Load new episode ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_ASYNC(get_available_maps) << [this]() -> R<std::vector<std::string>>
@@ -961,6 +979,38 @@ FDataMultiStream FCarlaServer::Start(uint16_t RPCPort, uint16_t StreamingPort)
   return Pimpl->BroadcastStream;
 }
 
+void FCarlaServer::SetStreamingQueue(const UCarlaSettings &Settings)
+{
+  check(Pimpl != nullptr);
+  carla::streaming::SendQueueOptions Options;
+  Options.max_messages = Settings.StreamingQueueSize;
+  Options.max_bytes = Settings.StreamingQueueMaxBytes;
+  Options.block_timeout = carla::time_duration::milliseconds(Settings.StreamingQueueBlockTimeout);
+  if (Settings.StreamingQueuePolicy == TEXT("DropOldest"))
+  {
+    Options.policy = carla::streaming::SendQueuePolicy::DropOldest;
+  }
+  else if (Settings.StreamingQueuePolicy == TEXT("BlockTick"))
+  {
+    Options.policy = carla::streaming::SendQueuePolicy::BlockTick;
+  }
+  else if (Settings.StreamingQueuePolicy != TEXT("DropNewest"))
+  {
+    UE_LOG(
+        LogCarlaServer,
+        Warning,
+        TEXT("Unknown streaming queue policy '%s', using DropNewest"),
+        *Settings.StreamingQueuePolicy);
+  }
+  Pimpl->StreamingServer.SetSendQueueOptions(Options);
+}
+
+void FCarlaServer::SetOnEpisodeKeyframeRequest(TFunction<void()> Callback)
+{
+  check(Pimpl != nullptr);
+  Pimpl->OnEpisodeKeyframeRequest = std::move(Callback);
+}
+
 void FCarlaServer::NotifyBeginEpisode(UCarlaEpisode &Episode)
 {
   check(Pimpl != nullptr);
@@ -12,6 +12,7 @@
 #include "CoreMinimal.h"
 
 class UCarlaEpisode;
+class UCarlaSettings;
 
 class FCarlaServer
 {
@@ -23,6 +24,14 @@ public:
 
   FDataMultiStream Start(uint16_t RPCPort, uint16_t StreamingPort);
 
+  /// Apply the send queue settings to the streaming sessions opened from now
+  /// on.
+  void SetStreamingQueue(const UCarlaSettings &Settings);
+
+  /// Set the function called, in the game-thread, when a client asks for a
+  /// full state of the episode. Must be set before AsyncRun.
+  void SetOnEpisodeKeyframeRequest(TFunction<void()> Callback);
+
   void NotifyBeginEpisode(UCarlaEpisode &Episode);
 
   void NotifyEndEpisode();
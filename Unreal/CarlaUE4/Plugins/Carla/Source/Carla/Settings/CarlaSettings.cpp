@@ -70,6 +70,10 @@ static void LoadSettingsFromConfig(
   {
     ConfigFile.GetInt(S_CARLA_SERVER, TEXT("WorldPort"), Settings.RPCPort);
     ConfigFile.GetInt(S_CARLA_SERVER, TEXT("RPCPort"), Settings.RPCPort);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("StreamingQueueSize"), Settings.StreamingQueueSize);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("StreamingQueueMaxBytes"), Settings.StreamingQueueMaxBytes);
+    ConfigFile.GetString(S_CARLA_SERVER, TEXT("StreamingQueuePolicy"), Settings.StreamingQueuePolicy);
+    ConfigFile.GetInt(S_CARLA_SERVER, TEXT("StreamingQueueBlockTimeout"), Settings.StreamingQueueBlockTimeout);
   }
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("SynchronousMode"), Settings.bSynchronousMode);
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("DisableRendering"), Settings.bDisableRendering);
@@ -123,6 +127,35 @@ void UCarlaSettings::LoadSettings()
     {
       StreamingPort = Value;
     }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-streaming-queue-size="), Value))
+    {
+      StreamingQueueSize = Value;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-streaming-queue-bytes="), Value))
+    {
+      StreamingQueueMaxBytes = Value;
+    }
+    FParse::Value(FCommandLine::Get(), TEXT("-carla-streaming-queue-policy="), StreamingQueuePolicy);
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-streaming-queue-timeout="), Value))
+    {
+      StreamingQueueBlockTimeout = Value;
+    }
+    if (FParse::Param(FCommandLine::Get(), TEXT("-carla-episode-delta")))
+    {
+      bEpisodeDeltaEncoding = true;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-episode-keyframe-interval="), Value))
+    {
+      EpisodeKeyframeInterval = Value;
+    }
+    if (FParse::Param(FCommandLine::Get(), TEXT("-carla-recorder-compression")))
+    {
+      bRecorderCompression = true;
+    }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-carla-recorder-queue-size="), Value))
+    {
+      RecorderQueueSize = Value;
+    }
     FString StringQualityLevel;
     if (FParse::Value(FCommandLine::Get(), TEXT("-quality-level="), StringQualityLevel))
     {
@@ -154,7 +187,15 @@ void UCarlaSettings::LogSettings() const
   UE_LOG(LogCarla, Log, TEXT("[%s]"), S_CARLA_SERVER);
   UE_LOG(LogCarla, Log, TEXT("RPC Port = %d"), RPCPort);
   UE_LOG(LogCarla, Log, TEXT("Streaming Port = %d"), StreamingPort.Get(RPCPort + 1u));
+  UE_LOG(LogCarla, Log, TEXT("Streaming Queue Size = %d"), StreamingQueueSize);
+  UE_LOG(LogCarla, Log, TEXT("Streaming Queue Max Bytes = %d"), StreamingQueueMaxBytes);
+  UE_LOG(LogCarla, Log, TEXT("Streaming Queue Policy = %s"), *StreamingQueuePolicy);
+  UE_LOG(LogCarla, Log, TEXT("Streaming Queue Block Timeout = %d ms"), StreamingQueueBlockTimeout);
   UE_LOG(LogCarla, Log, TEXT("Synchronous Mode = %s"), EnabledDisabled(bSynchronousMode));
+  UE_LOG(LogCarla, Log, TEXT("Episode Delta Encoding = %s"), EnabledDisabled(bEpisodeDeltaEncoding));
+  UE_LOG(LogCarla, Log, TEXT("Episode Keyframe Interval = %d"), EpisodeKeyframeInterval);
+  UE_LOG(LogCarla, Log, TEXT("Recorder Compression = %s"), EnabledDisabled(bRecorderCompression));
+  UE_LOG(LogCarla, Log, TEXT("Recorder Queue Size = %d"), RecorderQueueSize);
   UE_LOG(LogCarla, Log, TEXT("Rendering = %s"), EnabledDisabled(!bDisableRendering));
   UE_LOG(LogCarla, Log, TEXT("[%s]"), S_CARLA_QUALITYSETTINGS);
   UE_LOG(LogCarla, Log, TEXT("Quality Level = %s"), *QualityLevelToString(QualityLevel));
@@ -85,6 +85,43 @@ public:
   /// Optional setting for the secondary port.
   TOptional<uint32> StreamingPort;
 
+  /// Messages each streaming session can queue while the previous one is
+  /// still being sent, 0 to discard them.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 StreamingQueueSize = 0u;
+
+  /// Maximum bytes queued by each streaming session, 0 for no limit.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 StreamingQueueMaxBytes = 0u;
+
+  /// What a streaming session does with a new message when its queue is full,
+  /// "DropNewest", "DropOldest" or "BlockTick".
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  FString StreamingQueuePolicy = TEXT("DropNewest");
+
+  /// With the "BlockTick" policy, milliseconds the tick waits for room in a
+  /// queue before dropping the message.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 StreamingQueueBlockTimeout = 1000u;
+
+  /// Send only the changes of the actors every tick instead of the full
+  /// episode state.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  bool bEpisodeDeltaEncoding = false;
+
+  /// When sending the changes only, ticks between full episode states.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 EpisodeKeyframeInterval = 30u;
+
+  /// Compress the frames of the recordings.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  bool bRecorderCompression = false;
+
+  /// Frames of a recording that can wait to be written to disk before the
+  /// game thread waits for them.
+  UPROPERTY(Category = "CARLA Server", VisibleAnywhere)
+  uint32 RecorderQueueSize = 8u;
+
   /// In synchronous mode, CARLA waits every tick until the control from the
   /// client is received.
   UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
@@ -25,3 +25,10 @@ CMAKE_CONFIG_FILE=${CARLA_BUILD_FOLDER}/CMakeLists.txt.in
 
 LIBCARLA_TEST_CONTENT_FOLDER=${CARLA_BUILD_FOLDER}/test-content
 CARLA_EXAMPLES_FOLDER=${CURDIR}/Examples
+
+# Toolchain used by Setup.sh to build the dependencies, keep them in sync.
+CARLA_CXX_TAG=c7
+CARLA_CC=/usr/bin/clang-7
+CARLA_CXX=/usr/bin/clang++-7
+
+CLINGO_INSTALL_FOLDER=${CARLA_BUILD_FOLDER}/clingo-${CARLA_CXX_TAG}-install